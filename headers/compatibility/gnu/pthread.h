@@ -17,11 +17,21 @@ extern "C" {
 #endif
 
 
+/* rwlock kinds */
+#define PTHREAD_RWLOCK_PREFER_READER_NP					0
+#define PTHREAD_RWLOCK_PREFER_WRITER_NP					1
+#define PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP	2
+
+
 extern int pthread_getattr_np(pthread_t thread, pthread_attr_t* attr);
 
 extern int pthread_getname_np(pthread_t thread, char* buffer, size_t length);
 extern int pthread_setname_np(pthread_t thread, const char* name);
 
+extern int pthread_rwlockattr_getkind_np(const pthread_rwlockattr_t* attr,
+	int* kind);
+extern int pthread_rwlockattr_setkind_np(pthread_rwlockattr_t* attr, int kind);
+
 
 #ifdef __cplusplus
 }
@@ -650,6 +650,37 @@ extern ssize_t		wait_for_objects(object_wait_info* infos, int numInfos);
 extern ssize_t		wait_for_objects_etc(object_wait_info* infos, int numInfos,
 						uint32 flags, bigtime_t timeout);
 
+enum {
+	B_EVENT_EDGE_TRIGGERED		= 0x00010000,	/* only report new events */
+	B_EVENT_ONE_SHOT			= 0x00020000	/* deselect after reporting */
+};
+
+typedef struct event_wait_info {
+	int32		object;						/* ID of the object */
+	uint16		type;						/* type of the object */
+	int32		events;						/* events mask and flags */
+	void*		user_data;					/* returned with the events */
+} event_wait_info;
+
+/* An event queue keeps a set of objects selected in the kernel, so that
+   waiting for them doesn't get more expensive the more objects there are.
+   create_event_queue() returns a file descriptor for a new queue; the only
+   supported open flag is O_CLOEXEC. event_queue_select() adds an object to
+   the queue, or updates its events mask and user data, if it is already in
+   there. event_queue_deselect() removes it again. Objects that become
+   invalid are removed automatically, after B_EVENT_INVALID was reported.
+   event_queue_wait() returns up to numInfos objects for which some of the
+   selected events occurred. An object is reported for as long as its events
+   persist, unless it was selected with B_EVENT_EDGE_TRIGGERED, in which case
+   it will only be reported again when a new event occurs. Objects selected
+   with B_EVENT_ONE_SHOT are removed once they have been reported. */
+
+extern int			create_event_queue(int openFlags);
+extern status_t		event_queue_select(int queue, const event_wait_info* info);
+extern status_t		event_queue_deselect(int queue, int32 object, uint16 type);
+extern ssize_t		event_queue_wait(int queue, event_wait_info* infos,
+						int numInfos, uint32 flags, bigtime_t timeout);
+
 
 #ifdef __cplusplus
 }
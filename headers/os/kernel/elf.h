@@ -543,7 +543,9 @@ typedef struct {
 #define DT_PREINIT_ARRAY	32	/* preinitialization array */
 #define DT_PREINIT_ARRAYSZ	33	/* preinitialization array size */
 
+#define DT_GNU_HASH		0x6ffffef5	/* GNU-style symbol hash table */
 #define DT_VERSYM       0x6ffffff0	/* symbol version table */
+#define DT_FLAGS_1		0x6ffffffb	/* state flags (see below) */
 #define DT_VERDEF		0x6ffffffc	/* version definition table */
 #define DT_VERDEFNUM	0x6ffffffd	/* number of version definitions */
 #define DT_VERNEED		0x6ffffffe 	/* table with needed versions */
@@ -559,6 +561,9 @@ typedef struct {
 #define DF_BIND_NOW		0x08
 #define DF_STATIC_TLS	0x10
 
+/* DT_FLAGS_1 values */
+#define DF_1_NOW		0x01
+
 
 /* version definition section */
 
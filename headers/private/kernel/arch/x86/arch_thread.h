@@ -17,6 +17,7 @@ extern "C" {
 #endif
 
 struct sigaction;
+struct VMAddressSpace;
 
 
 struct iframe* x86_get_user_iframe(void);
@@ -24,6 +25,8 @@ struct iframe* x86_get_current_iframe(void);
 struct iframe* x86_get_thread_user_iframe(Thread* thread);
 
 phys_addr_t x86_next_page_directory(Thread* from, Thread* to);
+void x86_activate_address_space(struct cpu_ent* cpuData,
+	struct VMAddressSpace* addressSpace);
 void x86_initial_return_to_userland(Thread* thread, struct iframe* iframe);
 
 void x86_restart_syscall(struct iframe* frame);
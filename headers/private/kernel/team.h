@@ -75,6 +75,7 @@ pid_t _user_wait_for_child(thread_id child, uint32 flags, siginfo_t* info,
 status_t _user_exec(const char *path, const char* const* flatArgs,
 			size_t flatArgsSize, int32 argCount, int32 envCount, mode_t umask);
 thread_id _user_fork(void);
+thread_id _user_vfork(void);
 team_id _user_get_current_team(void);
 pid_t _user_process_info(pid_t process, int32 which);
 pid_t _user_setpgid(pid_t process, pid_t group);
@@ -49,6 +49,8 @@ enum team_state {
 	// team has executed exec*()
 #define	TEAM_FLAG_DUMP_CORE	0x02
 	// a core dump is in progress
+#define	TEAM_FLAG_VFORKED	0x04
+	// team still runs in the address space of the team that vfork()ed it
 
 typedef enum job_control_state {
 	JOB_CONTROL_STATE_NONE,
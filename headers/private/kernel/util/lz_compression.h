@@ -0,0 +1,33 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef LZ_COMPRESSION_H
+#define LZ_COMPRESSION_H
+
+
+#include <OS.h>
+
+
+// number of entries of the work memory passed to lz_compress()
+#define LZ_HASH_TABLE_SIZE		4096
+
+// largest input lz_compress() accepts (match offsets are 16 bit)
+#define LZ_MAX_INPUT_SIZE		65536
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t lz_compress(const void *source, size_t sourceLength, void *dest,
+			size_t destLength, uint16 *hashTable);
+ssize_t lz_decompress(const void *source, size_t sourceLength, void *dest,
+			size_t destLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif	/* LZ_COMPRESSION_H */
@@ -200,6 +200,11 @@ public:
 			uint32				temporary : 1;
 			uint32				type : 6;
 
+			// working set estimation, see vm_page_check_refault()
+			uint32				evicted_pages;
+			uint32				refaulted_pages;
+			uint32				working_set_refaults;
+
 #if DEBUG_CACHE_LIST
 			VMCache*			debug_previous;
 			VMCache*			debug_next;
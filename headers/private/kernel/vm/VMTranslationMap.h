@@ -75,6 +75,10 @@ public:
 
 	virtual	void				Flush() = 0;
 
+	// large page support (optional)
+	virtual	size_t				LargePageSize() const;
+	virtual	status_t			PromoteLargePage(addr_t virtualAddress);
+
 	// backends for KDL commands
 	virtual	void				DebugPrintMappingInfo(addr_t virtualAddress);
 	virtual	bool				DebugGetReverseMappingInfo(
@@ -94,6 +98,10 @@ protected:
 };
 
 
+extern int32 gLargePageRangesPromoted;
+extern int32 gLargePageRangesDemoted;
+
+
 struct VMTranslationMap::ReverseMappingInfoCallback {
 	virtual						~ReverseMappingInfoCallback();
 
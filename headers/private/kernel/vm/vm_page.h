@@ -39,6 +39,7 @@ void vm_page_free_etc(VMCache* cache, vm_page* page,
 
 void vm_page_set_state(struct vm_page *page, int state);
 void vm_page_requeue(struct vm_page *page, bool tail);
+void vm_page_check_refault(VMCache* cache, struct vm_page *page);
 
 // get some data about the number of pages in the system
 page_num_t vm_page_num_pages(void);
@@ -21,12 +21,34 @@ typedef struct select_info {
 	uint16				selected_events;
 } select_info;
 
-typedef struct select_sync {
-	int32				ref_count;
-	sem_id				sem;
-	uint32				count;
-	struct select_info*	set;
-} select_sync;
+
+/*!	The object all select_infos of a select()/poll()/wait_for_objects() call,
+	or of an event queue, point to. Notify() is called whenever one of the
+	objects reports an event for the given info; it may be called with
+	interrupts disabled and spinlocks held.
+	The objects hold a reference to the sync for as long as the info is in
+	their list (except for semaphores and ports, which must be deselected
+	explicitly).
+*/
+struct select_sync {
+								select_sync();
+	virtual						~select_sync();
+
+	virtual	status_t			Notify(select_info* info, uint16 events) = 0;
+
+			int32				ref_count;
+};
+
+struct wait_for_objects_sync : public select_sync {
+								wait_for_objects_sync();
+	virtual						~wait_for_objects_sync();
+
+	virtual	status_t			Notify(select_info* info, uint16 events);
+
+			sem_id				sem;
+			uint32				count;
+			struct select_info*	set;
+};
 
 #define SELECT_FLAG(type) (1L << (type - 1))
 
@@ -46,9 +68,22 @@ extern void		put_select_sync(select_sync* sync);
 extern status_t	notify_select_events(select_info* info, uint16 events);
 extern void		notify_select_events_list(select_info* list, uint16 events);
 
+extern status_t	select_object(uint32 type, int32 object,
+					struct select_info* info, bool kernel);
+extern status_t	deselect_object(uint32 type, int32 object,
+					struct select_info* info, bool kernel);
+
 extern ssize_t	_user_wait_for_objects(object_wait_info* userInfos,
 					int numInfos, uint32 flags, bigtime_t timeout);
 
+extern int		_user_create_event_queue(int openFlags);
+extern status_t	_user_event_queue_select(int queue,
+					const event_wait_info* userInfo);
+extern status_t	_user_event_queue_deselect(int queue, int32 object,
+					uint16 type);
+extern ssize_t	_user_event_queue_wait(int queue, event_wait_info* userInfos,
+					int numInfos, uint32 flags, bigtime_t timeout);
+
 
 #ifdef __cplusplus
 }
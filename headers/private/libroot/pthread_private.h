@@ -97,6 +97,10 @@ status_t __pthread_mutex_lock(pthread_mutex_t* mutex, bigtime_t timeout);
 int __pthread_getname_np(pthread_t thread, char* buffer, size_t length);
 int __pthread_setname_np(pthread_t thread, const char* name);
 
+int __pthread_rwlockattr_getkind_np(const pthread_rwlockattr_t* attr,
+	int* kind);
+int __pthread_rwlockattr_setkind_np(pthread_rwlockattr_t* attr, int kind);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,11 @@ typedef struct net_buffer {
 	uint32					flags;
 	uint32					size;
 	uint8					protocol;
+	uint16					segment_size;
+		// if not 0, the buffer holds a TCP segment that has to be split into
+		// segments of at most this many data bytes before it is sent; on
+		// receive, it marks segments the stack merged, and whose checksum
+		// it has verified
 } net_buffer;
 
 struct ancillary_data_container;
@@ -101,6 +106,10 @@ struct net_buffer_module_info {
 	void			(*swap_addresses)(net_buffer* buffer);
 
 	void			(*dump)(net_buffer* buffer);
+
+	status_t		(*append_external)(net_buffer* buffer, const void* data,
+						size_t bytes, void (*release)(void* cookie),
+						void* cookie);
 };
 
 
@@ -35,8 +35,15 @@ typedef struct net_device {
 	struct net_hardware_address address;
 
 	struct ifreq_stats stats;
+
+	uint32	features;	// NET_DEVICE_*_OFFLOAD
 } net_device;
 
+// net_device::features
+#define NET_DEVICE_SEGMENTATION_OFFLOAD	0x01
+	// the device accepts TCP segments larger than its MTU (see
+	// net_buffer::segment_size), and splits them up on its own
+
 
 struct net_device_module_info {
 	struct module_info info;
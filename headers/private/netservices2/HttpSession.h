@@ -45,9 +45,14 @@ public:
 			void				SetMaxConnectionsPerHost(size_t maxConnections);
 			void				SetMaxHosts(size_t maxConnections);
 
+	// Connection reuse
+			void				SetMaxPipelinedRequests(size_t maxRequests);
+			void				SetIdleTimeout(bigtime_t timeout);
+
 private:
 	struct Redirect;
 	class Request;
+	class Connection;
 	class Impl;
 			std::shared_ptr<Impl> fImpl;
 };
@@ -111,6 +111,7 @@ typedef struct image_t {
 
 	// pointer to symbol participation data structures
 	uint32				*symhash;
+	uint32				*gnu_hash;		// DT_GNU_HASH table, if any
 	elf_sym				*syms;
 	char				*strtab;
 	elf_rel				*rel;
@@ -119,6 +120,7 @@ typedef struct image_t {
 	int					rela_len;
 	elf_rel				*pltrel;
 	int					pltrel_len;
+	addr_t				*pltgot;		// DT_PLTGOT, for lazy binding
 	addr_t				*init_array;
 	int					init_array_len;
 	addr_t				*preinit_array;
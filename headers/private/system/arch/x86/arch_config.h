@@ -9,6 +9,9 @@
 
 #define STACK_GROWS_DOWNWARDS
 
+#define VFORK_SHARES_ADDRESS_SPACE
+	// arch_vm_aspace_swap() can switch into any userland address space
+
 //#define ATOMIC_FUNCS_ARE_SYSCALLS
 //#define ATOMIC64_FUNCS_ARE_SYSCALLS
 
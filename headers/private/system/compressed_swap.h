@@ -0,0 +1,26 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SYSTEM_COMPRESSED_SWAP_H
+#define _SYSTEM_COMPRESSED_SWAP_H
+
+#include <OS.h>
+
+
+#define COMPRESSED_SWAP_SYSCALLS		"compressed swap"
+#define GET_COMPRESSED_SWAP_INFO		0x01
+
+
+typedef struct compressed_swap_info {
+	uint64	max_size;		// size limit of the pool in bytes, 0 if disabled
+	uint64	used_size;		// bytes used by the compressed pages
+	uint64	stored_pages;	// pages currently held in the pool
+	uint64	stores;			// pages written to the pool
+	uint64	loads;			// pages read back from the pool
+	uint64	rejects;		// pages that did not compress well enough
+	uint64	overflows;		// pages passed on to the swap file (pool full)
+} compressed_swap_info;
+
+
+#endif	/* _SYSTEM_COMPRESSED_SWAP_H */
@@ -0,0 +1,24 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SYSTEM_WORKING_SET_H
+#define _SYSTEM_WORKING_SET_H
+
+#include <OS.h>
+
+
+#define WORKING_SET_SYSCALLS			"working set"
+#define GET_WORKING_SET_INFO			0x01
+
+
+typedef struct working_set_info {
+	uint64	shadow_entries;		// size of the eviction shadow table
+	uint64	evicted_pages;		// cached pages that have been reclaimed
+	uint64	refaults;			// evicted pages that were read in again
+	uint64	activations;		// refaults that were within the working set
+	uint64	streaming_pages;	// pages read into caches detected as streaming
+} working_set_info;
+
+
+#endif	/* _SYSTEM_WORKING_SET_H */
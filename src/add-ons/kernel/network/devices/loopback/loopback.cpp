@@ -61,6 +61,7 @@ loopback_init(const char *name, net_device **_device)
 	device->type = IFT_LOOP;
 	device->mtu = 16384;
 	device->media = IFM_ACTIVE;
+	device->features = NET_DEVICE_SEGMENTATION_OFFLOAD;
 
 	*_device = device;
 	return B_OK;
@@ -9,13 +9,38 @@
 #define DEFINITIONS_H
 
 
-const char* kPortNameReq = "dns_resolver_req";
-const char* kPortNameRpl = "dns_resolver_rpl";
+#include <SupportDefs.h>
+
+
+const char* const kPortNameReq = "dns_resolver_req";
+const char* const kPortNameRpl = "dns_resolver_rpl";
 
 enum MsgCodes {
 	MsgReply,
 	MsgError,
 	MsgGetAddrInfo,
+
+	// The following requests start with the port_id the reply is sent to,
+	// they are used by the dnscache command.
+	MsgGetAddrInfoWithPort,
+	MsgGetStatistics,
+	MsgFlushCache,
+};
+
+
+struct dns_resolver_statistics {
+	uint64	requests;
+	uint64	hits;
+	uint64	negative_hits;
+	uint64	misses;
+	uint64	uncached;
+		// requests that cannot be cached, like numeric addresses
+	uint64	waits;
+		// requests that waited for the same lookup already in progress
+	uint64	refreshes;
+	uint64	evictions;
+	uint32	entries;
+	uint32	max_entries;
 };
 
 
@@ -0,0 +1,412 @@
+/*
+ * Copyright 2026 Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "ResolverCache.h"
+
+#include <new>
+#include <stdlib.h>
+
+
+static const uint32 kMinHitsForRefresh = 2;
+	// only entries that were used at least this often are refreshed ahead
+static const uint32 kRefreshFraction = 8;
+	// entries are refreshed when less than this fraction of their TTL is left
+
+
+static uint32
+hash_request(const char* request, size_t size)
+{
+	// FNV-1a
+	uint32 hash = 2166136261U;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (uint8)request[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+
+/*!	Caches the answers of getaddrinfo() requests for as long as the resolve
+	function allows: for names from the name server, that is the smallest
+	TTL of the records of the answer. Failed lookups are cached as well, but
+	only for a short time. While a request is being resolved, other
+	identical requests wait for its result instead of asking the name server
+	again. Entries that are in use shortly
+	before they expire are refreshed in the background, so that frequently
+	used names never have to wait for the name server.
+*/
+ResolverCache::ResolverCache(resolve_func resolve, uint32 maxEntries)
+	:
+	fResolve(resolve),
+	fMaxEntries(maxEntries),
+	fRefreshThread(-1),
+	fQuit(false)
+{
+	pthread_mutex_init(&fLock, NULL);
+	pthread_cond_init(&fCondition, NULL);
+	pthread_cond_init(&fRefreshCondition, NULL);
+
+	memset(&fStatistics, 0, sizeof(fStatistics));
+	fStatistics.max_entries = maxEntries;
+}
+
+
+ResolverCache::~ResolverCache()
+{
+	if (fRefreshThread >= 0) {
+		pthread_mutex_lock(&fLock);
+		fQuit = true;
+		pthread_cond_signal(&fRefreshCondition);
+		pthread_mutex_unlock(&fLock);
+
+		status_t result;
+		wait_for_thread(fRefreshThread, &result);
+	}
+
+	Entry* entry = fTable.Clear(true);
+	while (entry != NULL) {
+		Entry* next = entry->hash_next;
+		free(entry->request);
+		free(entry->reply);
+		delete entry;
+		entry = next;
+	}
+
+	pthread_cond_destroy(&fRefreshCondition);
+	pthread_cond_destroy(&fCondition);
+	pthread_mutex_destroy(&fLock);
+}
+
+
+status_t
+ResolverCache::Init()
+{
+	status_t status = fTable.Init();
+	if (status != B_OK)
+		return status;
+
+	fRefreshThread = spawn_thread(&_RefreshThread, "refresh entries",
+		B_LOW_PRIORITY, this);
+	if (fRefreshThread < 0)
+		return fRefreshThread;
+
+	return resume_thread(fRefreshThread);
+}
+
+
+/*!	Returns the answer to the given getaddrinfo() \a request, either from the
+	cache, or by resolving it. The caller is responsible for freeing the
+	reply of the \a answer.
+*/
+void
+ResolverCache::Resolve(const char* request, size_t requestSize,
+	resolver_answer& answer)
+{
+	Key key;
+	key.data = request;
+	key.size = requestSize;
+	key.hash = hash_request(request, requestSize);
+
+	pthread_mutex_lock(&fLock);
+	fStatistics.requests++;
+
+	Entry* entry;
+	bool waited = false;
+	while (true) {
+		entry = fTable.Lookup(key);
+		if (entry == NULL)
+			break;
+
+		bigtime_t now = system_time();
+		if (!entry->in_flight && entry->expires > now) {
+			// cache hit
+			if (entry->error != B_OK)
+				fStatistics.negative_hits++;
+			else
+				fStatistics.hits++;
+
+			entry->hits++;
+			fEntries.Remove(entry);
+			fEntries.Add(entry);
+
+			if (!entry->refreshing && entry->error == B_OK
+				&& entry->hits >= kMinHitsForRefresh
+				&& entry->expires - now < entry->ttl / kRefreshFraction)
+				_ScheduleRefresh(entry);
+
+			if (_CopyAnswer(entry, answer)) {
+				pthread_mutex_unlock(&fLock);
+				return;
+			}
+
+			// we're out of memory, try to resolve it ourselves
+			break;
+		}
+
+		if (!entry->in_flight && !entry->refreshing)
+			break;
+
+		// the same request is being resolved right now, wait for it
+		if (!waited) {
+			fStatistics.waits++;
+			waited = true;
+		}
+		pthread_cond_wait(&fCondition, &fLock);
+	}
+
+	if (entry == NULL)
+		entry = _CreateEntry(request, requestSize);
+	if (entry == NULL || entry->in_flight || entry->refreshing) {
+		// can't use the cache
+		pthread_mutex_unlock(&fLock);
+		fResolve(request, requestSize, answer);
+		return;
+	}
+
+	fStatistics.misses++;
+	entry->in_flight = true;
+	pthread_mutex_unlock(&fLock);
+
+	fResolve(request, requestSize, answer);
+
+	pthread_mutex_lock(&fLock);
+
+	entry->in_flight = false;
+	if (answer.ttl > 0)
+		_StoreAnswer(entry, answer);
+	else
+		_DeleteEntry(entry);
+
+	pthread_cond_broadcast(&fCondition);
+	pthread_mutex_unlock(&fLock);
+}
+
+
+/*!	Resolves a \a request that must not be cached, for example because it
+	only contains numeric addresses.
+*/
+void
+ResolverCache::ResolveUncached(const char* request, size_t requestSize,
+	resolver_answer& answer)
+{
+	pthread_mutex_lock(&fLock);
+	fStatistics.requests++;
+	fStatistics.uncached++;
+	pthread_mutex_unlock(&fLock);
+
+	fResolve(request, requestSize, answer);
+}
+
+
+void
+ResolverCache::Flush()
+{
+	pthread_mutex_lock(&fLock);
+
+	EntryList::Iterator iterator = fEntries.GetIterator();
+	while (Entry* entry = iterator.Next()) {
+		if (entry->in_flight || entry->refreshing) {
+			// just let it expire
+			entry->expires = 0;
+			continue;
+		}
+
+		_DeleteEntry(entry);
+	}
+
+	pthread_mutex_unlock(&fLock);
+}
+
+
+void
+ResolverCache::GetStatistics(dns_resolver_statistics& statistics)
+{
+	pthread_mutex_lock(&fLock);
+	statistics = fStatistics;
+	pthread_mutex_unlock(&fLock);
+}
+
+
+ResolverCache::Entry*
+ResolverCache::_CreateEntry(const char* request, size_t requestSize)
+{
+	if (fStatistics.entries >= fMaxEntries && !_EvictEntry())
+		return NULL;
+
+	Entry* entry = new(std::nothrow) Entry;
+	if (entry == NULL)
+		return NULL;
+
+	entry->request = (char*)malloc(requestSize);
+	if (entry->request == NULL) {
+		delete entry;
+		return NULL;
+	}
+
+	memcpy(entry->request, request, requestSize);
+	entry->request_size = requestSize;
+	entry->hash = hash_request(request, requestSize);
+	entry->error = B_OK;
+	entry->reply = NULL;
+	entry->reply_size = 0;
+	entry->ttl = 0;
+	entry->expires = 0;
+	entry->hits = 0;
+	entry->in_flight = false;
+	entry->refreshing = false;
+
+	fTable.Insert(entry);
+	fEntries.Add(entry);
+	fStatistics.entries++;
+	return entry;
+}
+
+
+void
+ResolverCache::_DeleteEntry(Entry* entry)
+{
+	fTable.Remove(entry);
+	fEntries.Remove(entry);
+	fStatistics.entries--;
+
+	free(entry->request);
+	free(entry->reply);
+	delete entry;
+}
+
+
+/*!	Removes the least recently used entry that is not busy from the cache.
+	Returns \c false if there is none.
+*/
+bool
+ResolverCache::_EvictEntry()
+{
+	EntryList::Iterator iterator = fEntries.GetIterator();
+	while (Entry* entry = iterator.Next()) {
+		if (entry->in_flight || entry->refreshing)
+			continue;
+
+		_DeleteEntry(entry);
+		fStatistics.evictions++;
+		return true;
+	}
+
+	return false;
+}
+
+
+bool
+ResolverCache::_CopyAnswer(const Entry* entry, resolver_answer& answer)
+{
+	answer.error = entry->error;
+	answer.reply = NULL;
+	answer.reply_size = 0;
+	answer.ttl = entry->expires - system_time();
+
+	if (entry->error != B_OK || entry->reply_size == 0)
+		return true;
+
+	answer.reply = (char*)malloc(entry->reply_size);
+	if (answer.reply == NULL)
+		return false;
+
+	memcpy(answer.reply, entry->reply, entry->reply_size);
+	answer.reply_size = entry->reply_size;
+	return true;
+}
+
+
+/*!	Stores a copy of the \a answer in the \a entry. If that fails, the entry
+	is removed from the cache.
+*/
+void
+ResolverCache::_StoreAnswer(Entry* entry, resolver_answer& answer)
+{
+	char* reply = NULL;
+	if (answer.error == B_OK && answer.reply_size > 0) {
+		reply = (char*)malloc(answer.reply_size);
+		if (reply == NULL) {
+			if (!entry->refreshing)
+				_DeleteEntry(entry);
+			return;
+		}
+		memcpy(reply, answer.reply, answer.reply_size);
+	}
+
+	free(entry->reply);
+	entry->reply = reply;
+	entry->reply_size = reply != NULL ? answer.reply_size : 0;
+	entry->error = answer.error;
+	entry->ttl = answer.ttl;
+	entry->expires = system_time() + answer.ttl;
+	entry->hits = 0;
+}
+
+
+void
+ResolverCache::_ScheduleRefresh(Entry* entry)
+{
+	entry->refreshing = true;
+	fRefreshQueue.Add(entry);
+	pthread_cond_signal(&fRefreshCondition);
+}
+
+
+/*static*/ status_t
+ResolverCache::_RefreshThread(void* self)
+{
+	((ResolverCache*)self)->_Refresh();
+	return B_OK;
+}
+
+
+void
+ResolverCache::_Refresh()
+{
+	pthread_mutex_lock(&fLock);
+
+	while (!fQuit) {
+		Entry* entry = fRefreshQueue.RemoveHead();
+		if (entry == NULL) {
+			pthread_cond_wait(&fRefreshCondition, &fLock);
+			continue;
+		}
+
+		// The entry cannot go away while it's refreshing, but the request
+		// must not be used without holding the lock.
+		char* request = (char*)malloc(entry->request_size);
+		if (request == NULL) {
+			entry->refreshing = false;
+			pthread_cond_broadcast(&fCondition);
+			continue;
+		}
+		size_t requestSize = entry->request_size;
+		memcpy(request, entry->request, requestSize);
+
+		pthread_mutex_unlock(&fLock);
+
+		resolver_answer answer;
+		fResolve(request, requestSize, answer);
+		free(request);
+
+		pthread_mutex_lock(&fLock);
+
+		fStatistics.refreshes++;
+		if (answer.ttl > 0 && answer.error == B_OK)
+			_StoreAnswer(entry, answer);
+			// otherwise, keep the old answer until it expires
+
+		entry->refreshing = false;
+		if (entry->expires <= system_time())
+			_DeleteEntry(entry);
+
+		pthread_cond_broadcast(&fCondition);
+		free(answer.reply);
+	}
+
+	pthread_mutex_unlock(&fLock);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef RESOLVER_CACHE_H
+#define RESOLVER_CACHE_H
+
+
+#include <pthread.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+
+#include "Definitions.h"
+
+
+struct resolver_answer {
+	status_t	error;
+		// the result of getaddrinfo()
+	char*		reply;
+	uint32		reply_size;
+		// the serialized addrinfo list, if error is B_OK
+	bigtime_t	ttl;
+		// how long the answer may be cached, 0 if it must not be cached
+};
+
+typedef void (*resolve_func)(const char* request, size_t requestSize,
+	resolver_answer& answer);
+
+
+class ResolverCache {
+public:
+								ResolverCache(resolve_func resolve,
+									uint32 maxEntries);
+								~ResolverCache();
+
+			status_t			Init();
+
+			void				Resolve(const char* request,
+									size_t requestSize,
+									resolver_answer& answer);
+			void				ResolveUncached(const char* request,
+									size_t requestSize,
+									resolver_answer& answer);
+
+			void				Flush();
+			void				GetStatistics(
+									dns_resolver_statistics& statistics);
+
+private:
+			struct Key {
+				const char*	data;
+				size_t		size;
+				uint32		hash;
+			};
+
+			struct Entry : DoublyLinkedListLinkImpl<Entry> {
+				DoublyLinkedListLink<Entry> refresh_link;
+				Entry*		hash_next;
+				char*		request;
+				size_t		request_size;
+				uint32		hash;
+
+				status_t	error;
+				char*		reply;
+				uint32		reply_size;
+				bigtime_t	ttl;
+				bigtime_t	expires;
+				uint32		hits;
+					// since the entry was last resolved
+				bool		in_flight;
+					// being resolved, and has no valid answer yet
+				bool		refreshing;
+					// queued for, or being refreshed
+			};
+
+			struct HashDefinition {
+				typedef Key		KeyType;
+				typedef Entry	ValueType;
+
+				size_t HashKey(const Key& key) const
+					{ return key.hash; }
+				size_t Hash(const Entry* entry) const
+					{ return entry->hash; }
+				bool Compare(const Key& key, const Entry* entry) const
+					{ return key.hash == entry->hash
+						&& key.size == entry->request_size
+						&& memcmp(key.data, entry->request, key.size) == 0; }
+				Entry*& GetLink(Entry* entry) const
+					{ return entry->hash_next; }
+			};
+
+			typedef BOpenHashTable<HashDefinition> EntryTable;
+			typedef DoublyLinkedList<Entry> EntryList;
+			typedef DoublyLinkedList<Entry,
+				DoublyLinkedListMemberGetLink<Entry, &Entry::refresh_link> >
+					RefreshList;
+
+			Entry*				_CreateEntry(const char* request,
+									size_t requestSize);
+			void				_DeleteEntry(Entry* entry);
+			bool				_EvictEntry();
+			bool				_CopyAnswer(const Entry* entry,
+									resolver_answer& answer);
+			void				_StoreAnswer(Entry* entry,
+									resolver_answer& answer);
+			void				_ScheduleRefresh(Entry* entry);
+
+	static	status_t			_RefreshThread(void* self);
+			void				_Refresh();
+
+private:
+			pthread_mutex_t		fLock;
+			pthread_cond_t		fCondition;
+			pthread_cond_t		fRefreshCondition;
+			resolve_func		fResolve;
+			EntryTable			fTable;
+			EntryList			fEntries;
+				// least recently used first
+			RefreshList			fRefreshQueue;
+			uint32				fMaxEntries;
+			thread_id			fRefreshThread;
+			bool				fQuit;
+			dns_resolver_statistics fStatistics;
+};
+
+
+#endif	// RESOLVER_CACHE_H
@@ -7,22 +7,45 @@
  */
 
 
+#include <new>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
-#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <resolv.h>
+#include <sys/socket.h>
 
 #include <AutoDeleter.h>
+#include <FindDirectory.h>
 #include <OS.h>
 #include <SupportDefs.h>
+#include <util/DoublyLinkedList.h>
 
 #include "Definitions.h"
+#include "ResolverCache.h"
+
+
+static const bigtime_t kHostsFileTTL = 60000000LL;
+	// names from the hosts file have no TTL, but the file may change
+static const bigtime_t kMaxTTL = 86400000000LL;
+static const bigtime_t kNegativeTTL = 30000000LL;
+static const uint32 kMaxCacheEntries = 512;
+static const int32 kLookupThreads = 4;
+static const int32 kMaxLookups = 64;
+	// lookups that are queued or in progress, further ones are refused
+static const int32 kMaxLookupReplyPorts = 8;
+static const bigtime_t kReplyTimeout = 1000000LL;
 
 
 port_id		gRequestPort;
 port_id		gReplyPort;
+ResolverCache* gCache;
 
 
 status_t
@@ -98,42 +121,509 @@ Serialize(char** _reply, uint32* _totalSize, const struct addrinfo* ai)
 }
 
 
-status_t
-GetAddrInfo(const char* buffer)
+static void
+ParseRequest(const char* buffer, const char*& node, const char*& service,
+	const struct addrinfo*& hints)
 {
-	const char* node = buffer[0] == '\0' ? NULL : buffer;
+	node = buffer[0] == '\0' ? NULL : buffer;
 	uint32 nodeSize = node != NULL ? strlen(node) + 1 : 1;
 
-	const char* service = buffer[nodeSize] == '\0' ? NULL : buffer + nodeSize;
+	service = buffer[nodeSize] == '\0' ? NULL : buffer + nodeSize;
 	uint32 serviceSize = service != NULL ? strlen(service) + 1 : 1;
 
-	const struct addrinfo* hints
-		= reinterpret_cast<const addrinfo*>(buffer + nodeSize + serviceSize);
+	hints = reinterpret_cast<const addrinfo*>(buffer + nodeSize + serviceSize);
+}
 
-	struct addrinfo* ai;
-	status_t result = getaddrinfo(node, service, hints, &ai);
-	if (result != B_OK)
-		return write_port(gReplyPort, MsgError, &result, sizeof(result));
 
-	uint32 totalSize;
-	char* reply;
-	result = Serialize(&reply, &totalSize, ai);
+static bool
+IsValidRequest(const char* buffer, size_t size)
+{
+	size_t nodeSize = strnlen(buffer, size) + 1;
+	if (nodeSize >= size)
+		return false;
+
+	size_t serviceSize = strnlen(buffer + nodeSize, size - nodeSize) + 1;
+	return nodeSize + serviceSize + sizeof(addrinfo) <= size;
+}
+
+
+static bool
+IsNumericHost(const char* node, const struct addrinfo* hints)
+{
+	if (node == NULL || (hints->ai_flags & AI_NUMERICHOST) != 0)
+		return true;
+
+	in6_addr address;
+	return inet_pton(AF_INET, node, &address) == 1
+		|| inet_pton(AF_INET6, node, &address) == 1;
+}
+
+
+/*!	Returns whether \a node is listed in the hosts file. getaddrinfo()
+	prefers the hosts file over the name server, so these names are resolved
+	by it.
+*/
+static bool
+IsInHostsFile(const char* node)
+{
+	char path[B_PATH_NAME_LENGTH];
+	if (find_directory(B_SYSTEM_SETTINGS_DIRECTORY, -1, false, path,
+			sizeof(path)) != B_OK) {
+		return false;
+	}
+	strlcat(path, "/network/hosts", sizeof(path));
+
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+
+	bool found = false;
+	char line[1024];
+	while (!found && fgets(line, sizeof(line), file) != NULL) {
+		char* comment = strchr(line, '#');
+		if (comment != NULL)
+			*comment = '\0';
+
+		char* next;
+		char* token = strtok_r(line, " \t\r\n", &next);
+			// the address
+		while (token != NULL && !found) {
+			token = strtok_r(NULL, " \t\r\n", &next);
+			found = token != NULL && strcasecmp(token, node) == 0;
+		}
+	}
+
+	fclose(file);
+	return found;
+}
+
+
+/*!	Appends the entries getaddrinfo() would create for \a address to the
+	list \a _last points into, and moves \a _last to the new end.
+*/
+static int
+AddAddress(int family, const void* address, const char* service,
+	const struct addrinfo& hints, struct addrinfo**& _last)
+{
+	char buffer[INET6_ADDRSTRLEN];
+	if (inet_ntop(family, address, buffer, sizeof(buffer)) == NULL)
+		return EAI_FAIL;
+
+	struct addrinfo numericHints = hints;
+	numericHints.ai_flags |= AI_NUMERICHOST;
+	numericHints.ai_flags &= ~AI_CANONNAME;
+	numericHints.ai_family = family;
+
+	struct addrinfo* list;
+	int error = getaddrinfo(buffer, service, &numericHints, &list);
+	if (error != 0)
+		return error;
+
+	*_last = list;
+	while (list->ai_next != NULL)
+		list = list->ai_next;
+	_last = &list->ai_next;
+	return 0;
+}
+
+
+/*!	Asks the name server for the records of type \a type of \a node, and
+	appends the addresses to the list. \a _ttl is set to the smallest TTL of
+	the answer, including the CNAME records that led to the addresses.
+*/
+static int
+QueryAddresses(const char* node, int type, const char* service,
+	const struct addrinfo& hints, struct addrinfo**& _last,
+	char* canonicalName, uint32& _ttl)
+{
+	unsigned char* buffer = (unsigned char*)malloc(NS_MAXMSG);
+	if (buffer == NULL)
+		return EAI_MEMORY;
+	MemoryDeleter _(buffer);
+
+	int length = res_search(node, ns_c_in, type, buffer, NS_MAXMSG);
+	if (length < 0) {
+		switch (h_errno) {
+			case HOST_NOT_FOUND:
+			case NO_DATA:
+				return EAI_NONAME;
+			case TRY_AGAIN:
+				return EAI_AGAIN;
+			default:
+				return EAI_FAIL;
+		}
+	}
+
+	ns_msg message;
+	if (ns_initparse(buffer, min_c(length, NS_MAXMSG), &message) != 0)
+		return EAI_FAIL;
+
+	bool found = false;
+	int count = ns_msg_count(message, ns_s_an);
+	for (int i = 0; i < count; i++) {
+		ns_rr record;
+		if (ns_parserr(&message, ns_s_an, i, &record) != 0)
+			return EAI_FAIL;
+		if (ns_rr_class(record) != ns_c_in)
+			continue;
+
+		int family;
+		if (ns_rr_type(record) == ns_t_a && ns_rr_rdlen(record) == 4)
+			family = AF_INET;
+		else if (ns_rr_type(record) == ns_t_aaaa
+			&& ns_rr_rdlen(record) == 16) {
+			family = AF_INET6;
+		} else if (ns_rr_type(record) == ns_t_cname) {
+			_ttl = min_c(_ttl, ns_rr_ttl(record));
+			continue;
+		} else
+			continue;
+
+		int error = AddAddress(family, ns_rr_rdata(record), service, hints,
+			_last);
+		if (error != 0)
+			return error;
+
+		if (!found && canonicalName[0] == '\0')
+			strlcpy(canonicalName, ns_rr_name(record), NS_MAXDNAME);
+		_ttl = min_c(_ttl, ns_rr_ttl(record));
+		found = true;
+	}
+
+	return found ? 0 : EAI_NONAME;
+}
+
+
+/*!	Resolves \a node with the name server, and builds the list getaddrinfo()
+	would return from the answer, so that the TTL of the records is known
+	without asking the name server a second time.
+*/
+static int
+ResolveWithNameServer(const char* node, const char* service,
+	const struct addrinfo& hints, struct addrinfo** _list, bigtime_t& _ttl)
+{
+	struct addrinfo* list = NULL;
+	struct addrinfo** last = &list;
+	char canonicalName[NS_MAXDNAME];
+	canonicalName[0] = '\0';
+	uint32 ttl = UINT32_MAX;
+
+	int error = 0;
+	if (hints.ai_family == AF_INET6 || hints.ai_family == AF_UNSPEC) {
+		error = QueryAddresses(node, ns_t_aaaa, service, hints, last,
+			canonicalName, ttl);
+	}
+	if (hints.ai_family == AF_INET || hints.ai_family == AF_UNSPEC) {
+		int inetError = QueryAddresses(node, ns_t_a, service, hints, last,
+			canonicalName, ttl);
+		if (error == 0 || error == EAI_NONAME)
+			error = inetError;
+	}
+
+	if (list == NULL) {
+		_ttl = error == EAI_NONAME ? kNegativeTTL : 0;
+		return error;
+	}
+	if (error != 0 && error != EAI_NONAME) {
+		// one of the queries failed, try it again soon
+		ttl = min_c(ttl, (uint32)(kNegativeTTL / 1000000));
+	}
+
+	if ((hints.ai_flags & AI_CANONNAME) != 0) {
+		list->ai_canonname = strdup(canonicalName);
+		if (list->ai_canonname == NULL) {
+			freeaddrinfo(list);
+			_ttl = 0;
+			return EAI_MEMORY;
+		}
+	}
+
+	*_list = list;
+	_ttl = min_c((bigtime_t)ttl * 1000000, kMaxTTL);
+	return 0;
+}
+
+
+/*!	The resolve function of the cache. Names are resolved with the name
+	server directly, so that the answer can be cached for the TTL of its
+	records. Everything else, like numeric addresses, names from the hosts
+	file, or unusual address families, is left to getaddrinfo().
+*/
+static void
+Resolve(const char* request, size_t requestSize, resolver_answer& answer)
+{
+	const char* node;
+	const char* service;
+	const struct addrinfo* requestHints;
+	ParseRequest(request, node, service, requestHints);
+
+	struct addrinfo hints;
+	memcpy(&hints, requestHints, sizeof(addrinfo));
+
+	answer.reply = NULL;
+	answer.reply_size = 0;
+	answer.ttl = 0;
+
+	struct addrinfo* ai;
+	bigtime_t ttl = 0;
+	if (IsNumericHost(node, &hints) || IsInHostsFile(node)
+		|| (hints.ai_family != AF_UNSPEC && hints.ai_family != AF_INET
+			&& hints.ai_family != AF_INET6)) {
+		answer.error = getaddrinfo(node, service, &hints, &ai);
+		if (answer.error == 0)
+			ttl = node != NULL ? kHostsFileTTL : 0;
+		else if (answer.error == EAI_NONAME)
+			ttl = kNegativeTTL;
+	} else
+		answer.error = ResolveWithNameServer(node, service, hints, &ai, ttl);
+
+	answer.ttl = ttl;
+	if (answer.error != 0)
+		return;
+
+	answer.error = Serialize(&answer.reply, &answer.reply_size, ai);
 	freeaddrinfo(ai);
-	if (result != B_OK)
-		return write_port(gReplyPort, MsgError, &result, sizeof(result));
-	result = write_port(gReplyPort, MsgReply, reply, totalSize);
-	free(reply);
+	if (answer.error != B_OK)
+		answer.ttl = 0;
+}
+
+
+/*!	Clears everything in the request but the node, the service, and the
+	fields of the hints getaddrinfo() looks at, so that identical requests
+	consist of identical bytes, and can be found in the cache. Returns the
+	size of the normalized request, or 0 if it is invalid.
+*/
+static size_t
+NormalizeRequest(char* buffer, size_t size)
+{
+	if (!IsValidRequest(buffer, size))
+		return 0;
+
+	size_t nodeSize = strlen(buffer) + 1;
+	size_t hintsOffset = nodeSize + strlen(buffer + nodeSize) + 1;
+
+	struct addrinfo hints;
+	memcpy(&hints, buffer + hintsOffset, sizeof(addrinfo));
+
+	struct addrinfo normalized;
+	memset(&normalized, 0, sizeof(addrinfo));
+	normalized.ai_flags = hints.ai_flags;
+	normalized.ai_family = hints.ai_family;
+	normalized.ai_socktype = hints.ai_socktype;
+	normalized.ai_protocol = hints.ai_protocol;
+	memcpy(buffer + hintsOffset, &normalized, sizeof(addrinfo));
+
+	return hintsOffset + sizeof(addrinfo);
+}
+
+
+/*!	Resolves a normalized request, using the cache if possible. The caller is
+	responsible for freeing the reply of the \a answer.
+*/
+static void
+ResolveRequest(const char* buffer, size_t size, resolver_answer& answer)
+{
+	const char* node;
+	const char* service;
+	const struct addrinfo* hints;
+	ParseRequest(buffer, node, service, hints);
+
+	if (IsNumericHost(node, hints))
+		gCache->ResolveUncached(buffer, size, answer);
+	else
+		gCache->Resolve(buffer, size, answer);
+}
+
+
+static status_t
+SendAnswer(port_id replyPort, const resolver_answer& answer, uint32 flags,
+	bigtime_t timeout)
+{
+	if (answer.error != B_OK) {
+		return write_port_etc(replyPort, MsgError, &answer.error,
+			sizeof(answer.error), flags, timeout);
+	}
+
+	return write_port_etc(replyPort, MsgReply, answer.reply, answer.reply_size,
+		flags, timeout);
+}
+
+
+status_t
+GetAddrInfo(char* buffer, size_t size, port_id replyPort)
+{
+	size = NormalizeRequest(buffer, size);
+	if (size == 0) {
+		status_t result = B_BAD_VALUE;
+		return write_port(replyPort, MsgError, &result, sizeof(result));
+	}
+
+	resolver_answer answer;
+	ResolveRequest(buffer, size, answer);
+
+	status_t result = SendAnswer(replyPort, answer, 0, 0);
+	free(answer.reply);
 	return result;
 }
 
 
+struct LookupRequest : DoublyLinkedListLinkImpl<LookupRequest> {
+	port_id		reply_ports[kMaxLookupReplyPorts];
+	int32		reply_port_count;
+	bool		in_progress;
+	size_t		size;
+	char		data[0];
+};
+
+typedef DoublyLinkedList<LookupRequest> LookupList;
+
+
+static pthread_mutex_t sLookupLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sLookupCondition = PTHREAD_COND_INITIALIZER;
+static LookupList sLookups;
+static int32 sLookupCount;
+
+
+/*!	Answers the lookups of the dnscache command. Those are not serialized by
+	the kernel add-on, so a few of these threads handle them concurrently to
+	the lookups of the kernel.
+*/
+static status_t
+LookupThread(void*)
+{
+	pthread_mutex_lock(&sLookupLock);
+
+	while (true) {
+		LookupRequest* request;
+		LookupList::Iterator iterator = sLookups.GetIterator();
+		while ((request = iterator.Next()) != NULL && request->in_progress)
+			;
+
+		if (request == NULL) {
+			pthread_cond_wait(&sLookupCondition, &sLookupLock);
+			continue;
+		}
+
+		request->in_progress = true;
+		pthread_mutex_unlock(&sLookupLock);
+
+		resolver_answer answer;
+		ResolveRequest(request->data, request->size, answer);
+
+		pthread_mutex_lock(&sLookupLock);
+		sLookups.Remove(request);
+		sLookupCount--;
+		pthread_mutex_unlock(&sLookupLock);
+
+		// no more reply ports can be added now
+		for (int32 i = 0; i < request->reply_port_count; i++) {
+			SendAnswer(request->reply_ports[i], answer, B_RELATIVE_TIMEOUT,
+				kReplyTimeout);
+		}
+
+		free(answer.reply);
+		free(request);
+
+		pthread_mutex_lock(&sLookupLock);
+	}
+
+	return B_OK;
+}
+
+
+static status_t
+StartLookupThreads()
+{
+	for (int32 i = 0; i < kLookupThreads; i++) {
+		thread_id thread = spawn_thread(&LookupThread, "lookup",
+			B_NORMAL_PRIORITY, NULL);
+		if (thread < 0)
+			return thread;
+
+		status_t status = resume_thread(thread);
+		if (status != B_OK)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Queues a lookup of the dnscache command. If the same lookup is already
+	queued or in progress, its answer is sent to \a replyPort as well.
+*/
+static void
+StartLookup(port_id replyPort, char* buffer, size_t size)
+{
+	size = NormalizeRequest(buffer, size);
+	if (size == 0) {
+		status_t error = B_BAD_VALUE;
+		write_port_etc(replyPort, MsgError, &error, sizeof(error),
+			B_RELATIVE_TIMEOUT, kReplyTimeout);
+		return;
+	}
+
+	pthread_mutex_lock(&sLookupLock);
+
+	LookupList::Iterator iterator = sLookups.GetIterator();
+	while (LookupRequest* request = iterator.Next()) {
+		if (request->size == size && memcmp(request->data, buffer, size) == 0
+			&& request->reply_port_count < kMaxLookupReplyPorts) {
+			request->reply_ports[request->reply_port_count++] = replyPort;
+			pthread_mutex_unlock(&sLookupLock);
+			return;
+		}
+	}
+
+	LookupRequest* request = NULL;
+	if (sLookupCount < kMaxLookups) {
+		request = reinterpret_cast<LookupRequest*>(
+			malloc(sizeof(LookupRequest) + size));
+	}
+	if (request == NULL) {
+		pthread_mutex_unlock(&sLookupLock);
+
+		status_t error = sLookupCount < kMaxLookups ? B_NO_MEMORY : B_BUSY;
+		write_port_etc(replyPort, MsgError, &error, sizeof(error),
+			B_RELATIVE_TIMEOUT, kReplyTimeout);
+		return;
+	}
+
+	new(request) LookupRequest;
+	request->reply_ports[0] = replyPort;
+	request->reply_port_count = 1;
+	request->in_progress = false;
+	request->size = size;
+	memcpy(request->data, buffer, size);
+
+	sLookups.Add(request);
+	sLookupCount++;
+	pthread_cond_signal(&sLookupCondition);
+	pthread_mutex_unlock(&sLookupLock);
+}
+
+
+/*!	Only ports of the team that sent a request may receive its reply.
+*/
+static bool
+IsValidReplyPort(port_id port, team_id sender)
+{
+	port_info info;
+	return get_port_info(port, &info) == B_OK && info.team == sender;
+}
+
+
 status_t
 MainLoop()
 {
 	do {
-		ssize_t size = port_buffer_size(gRequestPort);
-		if (size < B_OK)
+		port_message_info messageInfo;
+		if (get_port_message_info_etc(gRequestPort, &messageInfo, 0, 0)
+				!= B_OK) {
 			return 0;
+		}
+
+		ssize_t size = messageInfo.size;
 
 		void* buffer = malloc(size);
 		if (buffer == NULL)
@@ -148,9 +638,40 @@ MainLoop()
 		status_t result;
 		switch (code) {
 			case MsgGetAddrInfo:
-				result = GetAddrInfo(reinterpret_cast<char*>(buffer));
+				result = GetAddrInfo(reinterpret_cast<char*>(buffer), size,
+					gReplyPort);
 				break;
 
+			case MsgGetAddrInfoWithPort:
+			case MsgGetStatistics:
+			case MsgFlushCache:
+			{
+				// The reply goes to the port of the caller, and errors
+				// replying to it must not stop the server.
+				result = B_OK;
+				if (size < (ssize_t)sizeof(port_id))
+					break;
+
+				port_id replyPort = *reinterpret_cast<port_id*>(buffer);
+				if (!IsValidReplyPort(replyPort, messageInfo.sender_team))
+					break;
+
+				if (code == MsgGetAddrInfoWithPort) {
+					StartLookup(replyPort, reinterpret_cast<char*>(buffer)
+						+ sizeof(port_id), size - sizeof(port_id));
+				} else if (code == MsgGetStatistics) {
+					dns_resolver_statistics statistics;
+					gCache->GetStatistics(statistics);
+					write_port_etc(replyPort, MsgReply, &statistics,
+						sizeof(statistics), B_RELATIVE_TIMEOUT, kReplyTimeout);
+				} else {
+					gCache->Flush();
+					write_port_etc(replyPort, MsgReply, NULL, 0,
+						B_RELATIVE_TIMEOUT, kReplyTimeout);
+				}
+				break;
+			}
+
 			default:
 				result = B_BAD_VALUE;
 				write_port(gReplyPort, MsgError, &result, sizeof(result));
@@ -178,6 +699,20 @@ main(int argc, char** argv)
 		return gReplyPort;
 	}
 
+	ResolverCache cache(&Resolve, kMaxCacheEntries);
+	status_t status = cache.Init();
+	if (status != B_OK) {
+		fprintf(stderr, "%s\n", strerror(status));
+		return status;
+	}
+	gCache = &cache;
+
+	status = StartLookupThreads();
+	if (status != B_OK) {
+		fprintf(stderr, "%s\n", strerror(status));
+		return status;
+	}
+
 	return MainLoop();
 }
 
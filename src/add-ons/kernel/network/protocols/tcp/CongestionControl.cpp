@@ -0,0 +1,263 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "CongestionControl.h"
+
+#include <new>
+#include <stdint.h>
+#include <string.h>
+
+#include <KernelExport.h>
+
+
+static const char* kDefaultCongestionControl = "cubic";
+
+
+CongestionControl::~CongestionControl()
+{
+}
+
+
+void
+CongestionControl::RoundTripTimeSample(uint32 roundTripTime)
+{
+}
+
+
+//	#pragma mark - NewReno
+
+
+const char*
+NewRenoCongestionControl::Name() const
+{
+	return "newreno";
+}
+
+
+uint32
+NewRenoCongestionControl::CongestionAvoidance(uint32 congestionWindow,
+	uint32 bytesAcknowledged, uint32 maxSegmentSize)
+{
+	// one segment per round trip (RFC 5681)
+	uint32 increment = maxSegmentSize * maxSegmentSize;
+	if (increment < congestionWindow)
+		return 1;
+
+	return increment / congestionWindow;
+}
+
+
+uint32
+NewRenoCongestionControl::LossDetected(uint32 congestionWindow,
+	uint32 flightSize, uint32 maxSegmentSize)
+{
+	return max_c(flightSize / 2, 2 * maxSegmentSize);
+}
+
+
+//	#pragma mark - CUBIC
+
+
+/*!	CUBIC as specified in RFC 8312. After a loss, the window follows a cubic
+	function of the time since then, which quickly approaches the window size
+	at which the loss happened, stays there for a while, and probes for more
+	bandwidth afterwards. Since this doesn't depend on the round trip time,
+	connections with long delays reach high throughput much faster than with
+	NewReno.
+
+	Like in other kernels, all computations are done in integers: windows in
+	segments, and times in 1/1024 seconds.
+*/
+
+
+static const uint32 kBetaScale = 1024;
+static const uint32 kBeta = 717;
+	// multiplicative decrease factor, 0.7
+static const uint32 kCubeScale = 410;
+	// C, 0.4, scaled by 1024
+static const uint32 kFriendlyFactor = 542;
+	// standard TCP's additive increase relative to CUBIC's window reduction,
+	// 3 * (1 - beta) / (1 + beta), scaled by 1024
+static const uint64 kMaxTimeOffset = 1 << 18;
+	// keeps the cube from overflowing, about 256 seconds
+
+
+static uint32
+cube_root(uint64 value)
+{
+	// 2642245 is the largest number whose cube fits into 64 bits
+	uint32 low = 0;
+	uint32 high = 2642245;
+	while (low < high) {
+		uint32 middle = low + (high - low + 1) / 2;
+		if ((uint64)middle * middle * middle <= value)
+			low = middle;
+		else
+			high = middle - 1;
+	}
+
+	return low;
+}
+
+
+CubicCongestionControl::CubicCongestionControl()
+	:
+	fEpochStart(0),
+	fMaxWindow(0),
+	fOriginWindow(0),
+	fTime(0),
+	fFriendlyWindow(0),
+	fAcknowledgedBytes(0),
+	fMinRoundTripTime(UINT32_MAX)
+{
+}
+
+
+const char*
+CubicCongestionControl::Name() const
+{
+	return "cubic";
+}
+
+
+uint32
+CubicCongestionControl::CongestionAvoidance(uint32 congestionWindow,
+	uint32 bytesAcknowledged, uint32 maxSegmentSize)
+{
+	if (fEpochStart == 0)
+		_StartEpoch(congestionWindow, maxSegmentSize);
+
+	uint32 segments = max_c(congestionWindow / maxSegmentSize, 1);
+
+	// the window we want to have one round trip from now
+	uint64 elapsed = ((system_time() - fEpochStart) << 10) / 1000000;
+	if (fMinRoundTripTime != UINT32_MAX)
+		elapsed += ((uint64)fMinRoundTripTime << 10) / 1000;
+
+	uint64 offset = elapsed < fTime ? fTime - elapsed : elapsed - fTime;
+	if (offset > kMaxTimeOffset)
+		offset = kMaxTimeOffset;
+
+	uint32 delta = (kCubeScale * offset * offset * offset) >> 40;
+	uint32 target;
+	if (elapsed < fTime)
+		target = fOriginWindow > delta ? fOriginWindow - delta : 0;
+	else
+		target = fOriginWindow + delta;
+
+	// the number of bytes to be acknowledged until the window grows by
+	// another segment
+	uint64 count;
+	if (target > segments)
+		count = congestionWindow / (target - segments);
+	else
+		count = 100 * (uint64)congestionWindow;
+
+	// grow at least as fast as standard TCP would in the same time
+	fFriendlyWindow += (uint64)kFriendlyFactor * maxSegmentSize
+		* bytesAcknowledged / congestionWindow;
+	uint64 friendlyWindow = fFriendlyWindow >> 10;
+	if (friendlyWindow > congestionWindow) {
+		uint64 friendlyCount = (uint64)congestionWindow * maxSegmentSize
+			/ (friendlyWindow - congestionWindow);
+		if (friendlyCount < count)
+			count = friendlyCount;
+	}
+
+	// never more than by half of the window in a round trip
+	if (count < 2 * maxSegmentSize)
+		count = 2 * maxSegmentSize;
+
+	// Bytes that were counted while the window grew more slowly only add a
+	// single segment, instead of causing a burst.
+	uint32 increment = 0;
+	if (fAcknowledgedBytes >= count) {
+		fAcknowledgedBytes = 0;
+		increment = maxSegmentSize;
+	}
+
+	fAcknowledgedBytes += bytesAcknowledged;
+	if (fAcknowledgedBytes >= count) {
+		increment += maxSegmentSize * (fAcknowledgedBytes / count);
+		fAcknowledgedBytes %= count;
+	}
+
+	return increment;
+}
+
+
+uint32
+CubicCongestionControl::LossDetected(uint32 congestionWindow,
+	uint32 flightSize, uint32 maxSegmentSize)
+{
+	fEpochStart = 0;
+
+	// If the window didn't get back to where it was at the last loss, another
+	// flow probably needs the bandwidth; release some of it (fast
+	// convergence).
+	uint32 segments = congestionWindow / maxSegmentSize;
+	if (segments < fMaxWindow)
+		fMaxWindow = segments * (kBetaScale + kBeta) / (2 * kBetaScale);
+	else
+		fMaxWindow = segments;
+
+	return max_c((uint64)congestionWindow * kBeta / kBetaScale,
+		2 * maxSegmentSize);
+}
+
+
+void
+CubicCongestionControl::RoundTripTimeSample(uint32 roundTripTime)
+{
+	if (roundTripTime < fMinRoundTripTime)
+		fMinRoundTripTime = roundTripTime;
+}
+
+
+void
+CubicCongestionControl::_StartEpoch(uint32 congestionWindow,
+	uint32 maxSegmentSize)
+{
+	fEpochStart = system_time();
+	fAcknowledgedBytes = 0;
+	fFriendlyWindow = (uint64)congestionWindow << 10;
+
+	uint32 segments = congestionWindow / maxSegmentSize;
+	if (segments < fMaxWindow) {
+		// K = cbrt((W_max - cwnd) / C)
+		fTime = cube_root(((uint64)(fMaxWindow - segments) << 40)
+			/ kCubeScale);
+		fOriginWindow = fMaxWindow;
+	} else {
+		fTime = 0;
+		fOriginWindow = segments;
+	}
+}
+
+
+//	#pragma mark -
+
+
+status_t
+create_congestion_control(const char* name, CongestionControl** _control)
+{
+	if (name == NULL)
+		name = kDefaultCongestionControl;
+
+	CongestionControl* control;
+	if (strcmp(name, "cubic") == 0)
+		control = new(std::nothrow) CubicCongestionControl;
+	else if (strcmp(name, "newreno") == 0)
+		control = new(std::nothrow) NewRenoCongestionControl;
+	else
+		return B_NAME_NOT_FOUND;
+
+	if (control == NULL)
+		return B_NO_MEMORY;
+
+	*_control = control;
+	return B_OK;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef CONGESTION_CONTROL_H
+#define CONGESTION_CONTROL_H
+
+
+#include <SupportDefs.h>
+
+
+/*!	A congestion control algorithm decides how the congestion window of an
+	endpoint grows in congestion avoidance, and how far it is reduced when
+	a loss is detected. Slow start, fast retransmit, and fast recovery are
+	the same for all algorithms, and are left to the TCPEndpoint.
+
+	All windows and sizes are in bytes.
+*/
+class CongestionControl {
+public:
+	virtual						~CongestionControl();
+
+	virtual	const char*			Name() const = 0;
+
+	/*!	Returns the number of bytes the window grows by, when
+		\a bytesAcknowledged new bytes have been acknowledged outside of
+		slow start.
+	*/
+	virtual	uint32				CongestionAvoidance(uint32 congestionWindow,
+									uint32 bytesAcknowledged,
+									uint32 maxSegmentSize) = 0;
+
+	/*!	Returns the new slow start threshold after a loss has been detected,
+		either by duplicate acknowledgements, or by a retransmit timeout.
+	*/
+	virtual	uint32				LossDetected(uint32 congestionWindow,
+									uint32 flightSize,
+									uint32 maxSegmentSize) = 0;
+
+	virtual	void				RoundTripTimeSample(uint32 roundTripTime);
+									// in milliseconds
+};
+
+
+class NewRenoCongestionControl : public CongestionControl {
+public:
+	virtual	const char*			Name() const;
+
+	virtual	uint32				CongestionAvoidance(uint32 congestionWindow,
+									uint32 bytesAcknowledged,
+									uint32 maxSegmentSize);
+	virtual	uint32				LossDetected(uint32 congestionWindow,
+									uint32 flightSize,
+									uint32 maxSegmentSize);
+};
+
+
+class CubicCongestionControl : public CongestionControl {
+public:
+								CubicCongestionControl();
+
+	virtual	const char*			Name() const;
+
+	virtual	uint32				CongestionAvoidance(uint32 congestionWindow,
+									uint32 bytesAcknowledged,
+									uint32 maxSegmentSize);
+	virtual	uint32				LossDetected(uint32 congestionWindow,
+									uint32 flightSize,
+									uint32 maxSegmentSize);
+	virtual	void				RoundTripTimeSample(uint32 roundTripTime);
+
+private:
+			void				_StartEpoch(uint32 congestionWindow,
+									uint32 maxSegmentSize);
+
+private:
+			bigtime_t			fEpochStart;
+			uint32				fMaxWindow;
+			uint32				fOriginWindow;
+				// in segments
+			uint32				fTime;
+				// the time it takes to get back to fMaxWindow (K), in
+				// 1/1024 seconds
+			uint64				fFriendlyWindow;
+				// the window standard TCP would have, in 1/1024 bytes
+			uint32				fAcknowledgedBytes;
+			uint32				fMinRoundTripTime;
+};
+
+
+status_t	create_congestion_control(const char* name,
+				CongestionControl** _control);
+					// NULL selects the default algorithm
+
+
+#endif	// CONGESTION_CONTROL_H
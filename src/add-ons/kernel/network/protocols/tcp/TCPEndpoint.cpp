@@ -34,6 +34,7 @@
 #include <util/AutoLock.h>
 #include <util/list.h>
 
+#include "CongestionControl.h"
 #include "EndpointManager.h"
 
 
@@ -451,6 +452,7 @@ TCPEndpoint::TCPEndpoint(net_socket* socket)
 	fReceivedTimestamp(0),
 	fCongestionWindow(0),
 	fSlowStartThreshold(0),
+	fCongestionControl(NULL),
 	fState(CLOSED),
 	fFlags(FLAG_OPTION_WINDOW_SCALE | FLAG_OPTION_TIMESTAMP | FLAG_OPTION_SACK_PERMITTED)
 {
@@ -468,6 +470,8 @@ TCPEndpoint::TCPEndpoint(net_socket* socket)
 	gStackModule->init_timer(&fTimeWaitTimer, TCPEndpoint::_TimeWaitTimer,
 		this);
 
+	create_congestion_control(NULL, &fCongestionControl);
+
 	T(APICall(this, "constructor"));
 }
 
@@ -496,12 +500,16 @@ TCPEndpoint::~TCPEndpoint()
 	gStackModule->wait_for_timer(&fTimeWaitTimer);
 
 	gDatalinkModule->put_route(Domain(), fRoute);
+	delete fCongestionControl;
 }
 
 
 status_t
 TCPEndpoint::InitCheck() const
 {
+	if (fCongestionControl == NULL)
+		return B_NO_MEMORY;
+
 	return B_OK;
 }
 
@@ -1055,6 +1063,17 @@ TCPEndpoint::SetReceiveBufferSize(size_t length)
 status_t
 TCPEndpoint::GetOption(int option, void* _value, int* _length)
 {
+	if (option == TCP_CONGESTION) {
+		if (*_length <= 0)
+			return B_BAD_VALUE;
+
+		MutexLocker _(fLock);
+		const char* name = fCongestionControl->Name();
+		strlcpy((char*)_value, name, *_length);
+		*_length = min_c(*_length, (int)strlen(name) + 1);
+		return B_OK;
+	}
+
 	if (*_length != sizeof(int))
 		return B_BAD_VALUE;
 
@@ -1081,6 +1100,21 @@ TCPEndpoint::GetOption(int option, void* _value, int* _length)
 status_t
 TCPEndpoint::SetOption(int option, const void* _value, int length)
 {
+	if (option == TCP_CONGESTION) {
+		if (length <= 0)
+			return B_BAD_VALUE;
+
+		// the name doesn't need to be null terminated, so only the given
+		// length must be read
+		char name[TCP_CA_NAME_MAX];
+		size_t nameLength = min_c((size_t)length, sizeof(name) - 1);
+		memcpy(name, _value, nameLength);
+		name[nameLength] = '\0';
+
+		MutexLocker _(fLock);
+		return _SetCongestionControl(name);
+	}
+
 	if (option != TCP_NODELAY)
 		return B_BAD_VALUE;
 
@@ -1298,7 +1332,8 @@ TCPEndpoint::_DuplicateAcknowledge(tcp_segment_header &segment)
 			(fSendUnacknowledged - fPreviousHighestAcknowledge) <= 4 * fSendMaxSegmentSize)) {
 			fFlags |= FLAG_RECOVERY;
 			fRecover = fSendMax.Number() - 1;
-			fSlowStartThreshold = max_c(fPreviousFlightSize / 2, 2 * fSendMaxSegmentSize);
+			fSlowStartThreshold = fCongestionControl->LossDetected(
+				fCongestionWindow, fPreviousFlightSize, fSendMaxSegmentSize);
 			fCongestionWindow = fSlowStartThreshold + 3 * fSendMaxSegmentSize;
 			fSendNext = segment.acknowledge;
 			_SendQueued();
@@ -1477,6 +1512,11 @@ TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
 	fOptions = parent->fOptions;
 	fAcceptSemaphore = parent->fAcceptSemaphore;
 
+	if (strcmp(fCongestionControl->Name(),
+			parent->fCongestionControl->Name()) != 0) {
+		_SetCongestionControl(parent->fCongestionControl->Name());
+	}
+
 	_PrepareReceivePath(segment);
 
 	// send SYN+ACK
@@ -1800,6 +1840,7 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 	// The buffer may be freed if its data is added to the queue, so cache
 	// the size as we still need it later.
 	uint32 bufferSize = buffer->size;
+	uint16 segmentSize = buffer->segment_size;
 
 	if ((bufferSize > 0 || (segment.flags & TCP_FLAG_FINISH) != 0)
 		&& _ShouldReceive())
@@ -1858,6 +1899,11 @@ TCPEndpoint::_Receive(tcp_segment_header& segment, net_buffer* buffer)
 	if (bufferSize > 0 || (segment.flags & TCP_FLAG_SYNCHRONIZE) != 0)
 		action |= ACKNOWLEDGE;
 
+	// Merged segments stand for at least two segments of the peer, and we
+	// acknowledge every other segment.
+	if (segmentSize != 0 && bufferSize > segmentSize)
+		action |= IMMEDIATE_ACKNOWLEDGE;
+
 	_UpdateTimestamps(segment, segmentLength);
 
 	TRACE("Receive() Action %" B_PRId32, action);
@@ -1969,7 +2015,7 @@ TCPEndpoint::_ShouldSendSegment(tcp_segment_header& segment, uint32 length,
 		// - the buffer is at least larger than half of the maximum send window,
 		//   or
 		// - we're retransmitting data
-		if (length == segmentMaxSize
+		if (length >= segmentMaxSize
 			|| (fOptions & TCP_NODELAY) != 0
 			|| tcp_sequence(fSendNext + length) == fSendQueue.LastSequence()
 			|| (fSendMaxWindow > 0 && length >= fSendMaxWindow / 2))
@@ -2119,6 +2165,20 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 			- tcp_options_length(segment);
 		uint32 segmentLength = min_c(length, segmentMaxSize);
 
+		if (length > segmentMaxSize && !retransmit
+			&& (segment.flags & (TCP_FLAG_SYNCHRONIZE | TCP_FLAG_URGENT))
+				== 0) {
+			// Pass down several segments at once, they are split up right
+			// before they are handed to the device, if it can't do that.
+			uint32 maxLength = min_c(TCP_MAX_OFFLOAD_SIZE,
+				(uint64)fSendMaxSegments * segmentMaxSize);
+			if (length <= maxLength)
+				segmentLength = length;
+			else
+				segmentLength = max_c(maxLength - maxLength % segmentMaxSize,
+					segmentMaxSize);
+		}
+
 		if (fSendNext + segmentLength == fSendQueue.LastSequence() && !force) {
 			if (state_needs_finish(fState))
 				segment.flags |= TCP_FLAG_FINISH;
@@ -2140,6 +2200,13 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 		if (buffer == NULL)
 			return B_NO_MEMORY;
 
+		uint32 segmentCount = 1;
+		if (segmentLength > segmentMaxSize) {
+			buffer->segment_size = segmentMaxSize;
+			segmentCount = (segmentLength + segmentMaxSize - 1)
+				/ segmentMaxSize;
+		}
+
 		status_t status = B_OK;
 		if (segmentLength > 0)
 			status = fSendQueue.Get(buffer, fSendNext, segmentLength);
@@ -2197,7 +2264,7 @@ TCPEndpoint::_SendQueued(bool force, uint32 sendWindow)
 			+ ((uint32)segment.advertised_window << fReceiveWindowShift);
 
 		if (segmentLength != 0 && fState == ESTABLISHED)
-			--fSendMaxSegments;
+			fSendMaxSegments -= min_c(segmentCount, fSendMaxSegments);
 
 		status = next->module->send_routed_data(next, fRoute, buffer);
 		if (status < B_OK) {
@@ -2318,14 +2385,8 @@ TCPEndpoint::_Acknowledged(tcp_segment_header& segment)
 			if (fCongestionWindow < fSlowStartThreshold)
 				fCongestionWindow += min_c(bytesAcknowledged, fSendMaxSegmentSize);
 			else {
-				uint32 increment = fSendMaxSegmentSize * fSendMaxSegmentSize;
-
-				if (increment < fCongestionWindow)
-					increment = 1;
-				else
-					increment /= fCongestionWindow;
-
-				fCongestionWindow += increment;
+				fCongestionWindow += fCongestionControl->CongestionAvoidance(
+					fCongestionWindow, bytesAcknowledged, fSendMaxSegmentSize);
 			}
 
 			fSendMaxSegments = UINT32_MAX;
@@ -2407,6 +2468,9 @@ TCPEndpoint::_Retransmit()
 void
 TCPEndpoint::_UpdateRoundTripTime(int32 roundTripTime, int32 expectedSamples)
 {
+	if (roundTripTime >= 0)
+		fCongestionControl->RoundTripTimeSample(roundTripTime);
+
 	if (fSmoothedRoundTripTime == 0) {
 		fSmoothedRoundTripTime = roundTripTime;
 		fRoundTripVariation = roundTripTime / 2;
@@ -2436,12 +2500,26 @@ TCPEndpoint::_UpdateRoundTripTime(int32 roundTripTime, int32 expectedSamples)
 void
 TCPEndpoint::_ResetSlowStart()
 {
-	fSlowStartThreshold = max_c((fSendMax - fSendUnacknowledged).Number() / 2,
-		2 * fSendMaxSegmentSize);
+	fSlowStartThreshold = fCongestionControl->LossDetected(fCongestionWindow,
+		(fSendMax - fSendUnacknowledged).Number(), fSendMaxSegmentSize);
 	fCongestionWindow = fSendMaxSegmentSize;
 }
 
 
+status_t
+TCPEndpoint::_SetCongestionControl(const char* name)
+{
+	CongestionControl* control;
+	status_t status = create_congestion_control(name, &control);
+	if (status != B_OK)
+		return status;
+
+	delete fCongestionControl;
+	fCongestionControl = control;
+	return B_OK;
+}
+
+
 //	#pragma mark - timer
 
 
@@ -2585,5 +2663,6 @@ TCPEndpoint::Dump() const
 	kprintf("  retransmit timeout: %" B_PRId64 "\n", fRetransmitTimeout);
 	kprintf("  congestion window: %" B_PRIu32 "\n", fCongestionWindow);
 	kprintf("  slow start threshold: %" B_PRIu32 "\n", fSlowStartThreshold);
+	kprintf("  congestion control: %s\n", fCongestionControl->Name());
 }
 
@@ -26,6 +26,9 @@
 #include <stddef.h>
 
 
+class CongestionControl;
+
+
 class TCPEndpoint : public net_protocol, public ProtocolSocket {
 public:
 						TCPEndpoint(net_socket* socket);
@@ -109,6 +112,7 @@ private:
 			void		_Retransmit();
 			void		_UpdateRoundTripTime(int32 roundTripTime, int32 expectedSamples);
 			void		_ResetSlowStart();
+			status_t	_SetCongestionControl(const char* name);
 			void		_DuplicateAcknowledge(tcp_segment_header& segment);
 
 	static	void		_TimeWaitTimer(net_timer* timer, void* _endpoint);
@@ -179,6 +183,8 @@ private:
 
 	uint32			fCongestionWindow;
 	uint32			fSlowStartThreshold;
+	CongestionControl*
+					fCongestionControl;
 
 	tcp_state		fState;
 	uint32			fFlags;
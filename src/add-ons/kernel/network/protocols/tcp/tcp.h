@@ -187,6 +187,10 @@ operator==(tcp_sequence a, tcp_sequence b)
 #define TCP_MAX_SEGMENT_LIFETIME		60000000	// 60 secs
 #define TCP_PERSIST_TIMEOUT				1000000		// 1 sec
 
+// Maximum data length of a segment that is split up further down the stack;
+// leaves room for the IP and TCP headers
+#define TCP_MAX_OFFLOAD_SIZE			(65535 - 128)
+
 // Initial estimate for packet round trip time (RTT)
 #define TCP_INITIAL_RTT					2000000		// 2 secs
 // Minimum retransmit timeout (consider delayed ack)
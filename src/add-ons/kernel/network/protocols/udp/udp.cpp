@@ -18,7 +18,6 @@
 #include <util/DoublyLinkedList.h>
 #include <util/OpenHashTable.h>
 
-#include <AutoDeleter.h>
 #include <KernelExport.h>
 
 #include <NetBufferUtilities.h>
@@ -38,6 +37,10 @@
 //      lock before holding a child UdpEndpoint's lock. This restriction
 //      is dictated by the receive path as blind access to the endpoint
 //      hash is required when holding the DomainSupport's lock.
+//      The receive path only needs read access to the endpoint hash, and
+//      the domain list of the UdpEndpointManager, so that datagrams can be
+//      demultiplexed on several CPUs in parallel; only binding, connecting,
+//      and unbinding an endpoint requires write access.
 
 
 //#define TRACE_UDP
@@ -191,7 +194,9 @@ private:
 	status_t _FinishBind(UdpEndpoint *endpoint, const sockaddr *address);
 
 	UdpEndpoint *_FindActiveEndpoint(const sockaddr *ourAddress,
-		const sockaddr *peerAddress, uint32 index = 0);
+		const sockaddr *peerAddress, uint32 index = 0, uint32 flowHash = 0);
+	bool _IsCandidate(UdpEndpoint *endpoint, const sockaddr *ourAddress,
+		const sockaddr *peerAddress, uint32 index) const;
 	status_t _DemuxBroadcast(net_buffer *buffer);
 	status_t _DemuxUnicast(net_buffer *buffer);
 
@@ -203,7 +208,7 @@ private:
 
 	typedef BOpenHashTable<UdpHashDefinition, false> EndpointTable;
 
-	mutex			fLock;
+	rw_lock			fLock;
 	net_domain		*fDomain;
 	uint16			fLastUsedEphemeral;
 	EndpointTable	fActiveEndpoints;
@@ -243,7 +248,7 @@ private:
 									bool create);
 			UdpDomainSupport*	_GetDomainSupport(net_buffer* buffer);
 
-			mutex				fLock;
+			rw_lock				fLock;
 			status_t			fStatus;
 			UdpDomainList		fDomains;
 };
@@ -266,7 +271,7 @@ UdpDomainSupport::UdpDomainSupport(net_domain *domain)
 	fActiveEndpoints(domain->address_module),
 	fEndpointCount(0)
 {
-	mutex_init(&fLock, "udp domain");
+	rw_lock_init(&fLock, "udp domain");
 
 	fLastUsedEphemeral = kFirst + rand() % (kLast - kFirst);
 }
@@ -274,7 +279,7 @@ UdpDomainSupport::UdpDomainSupport(net_domain *domain)
 
 UdpDomainSupport::~UdpDomainSupport()
 {
-	mutex_destroy(&fLock);
+	rw_lock_destroy(&fLock);
 }
 
 
@@ -289,7 +294,7 @@ status_t
 UdpDomainSupport::DemuxIncomingBuffer(net_buffer *buffer)
 {
 	// NOTE: multicast is delivered directly to the endpoint
-	MutexLocker _(fLock);
+	ReadLocker _(fLock);
 
 	if ((buffer->flags & MSG_BCAST) != 0)
 		return _DemuxBroadcast(buffer);
@@ -306,7 +311,7 @@ UdpDomainSupport::DeliverError(status_t error, net_buffer* buffer)
 	if ((buffer->flags & (MSG_BCAST | MSG_MCAST)) != 0)
 		return B_ERROR;
 
-	MutexLocker _(fLock);
+	ReadLocker _(fLock);
 
 	// Forward the error to the socket
 	UdpEndpoint* endpoint = _FindActiveEndpoint(buffer->source,
@@ -328,7 +333,7 @@ UdpDomainSupport::BindEndpoint(UdpEndpoint *endpoint,
 	if (!AddressModule()->is_same_family(address))
 		return EAFNOSUPPORT;
 
-	MutexLocker _(fLock);
+	WriteLocker _(fLock);
 
 	if (endpoint->IsActive())
 		return EINVAL;
@@ -341,7 +346,7 @@ status_t
 UdpDomainSupport::ConnectEndpoint(UdpEndpoint *endpoint,
 	const sockaddr *address)
 {
-	MutexLocker _(fLock);
+	WriteLocker _(fLock);
 
 	if (endpoint->IsActive()) {
 		fActiveEndpoints.Remove(endpoint);
@@ -395,7 +400,7 @@ UdpDomainSupport::ConnectEndpoint(UdpEndpoint *endpoint,
 status_t
 UdpDomainSupport::UnbindEndpoint(UdpEndpoint *endpoint)
 {
-	MutexLocker _(fLock);
+	WriteLocker _(fLock);
 
 	if (endpoint->IsActive())
 		fActiveEndpoints.Remove(endpoint);
@@ -501,30 +506,74 @@ UdpDomainSupport::_FinishBind(UdpEndpoint *endpoint, const sockaddr *address)
 }
 
 
+/*!	Returns the endpoint bound to the given addresses that should receive the
+	datagram. If there is a group of endpoints bound with SO_REUSEPORT to the
+	very same addresses, the \a flowHash is used to choose one of them, so
+	that all datagrams of a flow end up at the same socket.
+*/
 UdpEndpoint *
 UdpDomainSupport::_FindActiveEndpoint(const sockaddr *ourAddress,
-	const sockaddr *peerAddress, uint32 index)
+	const sockaddr *peerAddress, uint32 index, uint32 flowHash)
 {
-	ASSERT_LOCKED_MUTEX(&fLock);
+	ASSERT_READ_LOCKED_RW_LOCK(&fLock);
 
 	TRACE_DOMAIN("finding Endpoint for %s <- %s",
 		AddressString(fDomain, ourAddress, true).Data(),
 		AddressString(fDomain, peerAddress, true).Data());
 
-	UdpEndpoint* endpoint = fActiveEndpoints.Lookup(
+	// Endpoints with the same addresses are not necessarily adjacent in the
+	// hash chain, so we have to walk it to the end
+	UdpEndpoint* first = fActiveEndpoints.Lookup(
 		std::make_pair(ourAddress, peerAddress));
+	while (first != NULL
+		&& !_IsCandidate(first, ourAddress, peerAddress, index)) {
+		first = first->HashTableLink();
+	}
 
-	// Make sure the bound_to_device constraint is fulfilled
-	while (endpoint != NULL && endpoint->socket->bound_to_device != 0
-		&& index != 0 && endpoint->socket->bound_to_device != index) {
-		endpoint = endpoint->HashTableLink();
-		if (endpoint != NULL
-			&& (!endpoint->LocalAddress().EqualTo(ourAddress, true)
-				|| !endpoint->PeerAddress().EqualTo(peerAddress, true)))
-			return NULL;
+	if (first == NULL || (first->Socket()->options & SO_REUSEPORT) == 0)
+		return first;
+
+	uint32 count = 0;
+	for (UdpEndpoint* endpoint = first; endpoint != NULL;
+			endpoint = endpoint->HashTableLink()) {
+		if ((endpoint->Socket()->options & SO_REUSEPORT) != 0
+			&& _IsCandidate(endpoint, ourAddress, peerAddress, index))
+			count++;
 	}
 
-	return endpoint;
+	if (count == 1)
+		return first;
+
+	// Fibonacci hashing spreads the flows evenly over the group
+	uint32 selected = (uint32)(((uint64)(flowHash * 2654435761U) * count)
+		>> 32);
+
+	for (UdpEndpoint* endpoint = first; endpoint != NULL;
+			endpoint = endpoint->HashTableLink()) {
+		if ((endpoint->Socket()->options & SO_REUSEPORT) == 0
+			|| !_IsCandidate(endpoint, ourAddress, peerAddress, index))
+			continue;
+
+		if (selected-- == 0)
+			return endpoint;
+	}
+
+	return first;
+}
+
+
+bool
+UdpDomainSupport::_IsCandidate(UdpEndpoint *endpoint,
+	const sockaddr *ourAddress, const sockaddr *peerAddress,
+	uint32 index) const
+{
+	// Make sure the bound_to_device constraint is fulfilled
+	if (endpoint->socket->bound_to_device != 0 && index != 0
+		&& endpoint->socket->bound_to_device != index)
+		return false;
+
+	return endpoint->LocalAddress().EqualTo(ourAddress, true)
+		&& endpoint->PeerAddress().EqualTo(peerAddress, true);
 }
 
 
@@ -584,22 +633,27 @@ UdpDomainSupport::_DemuxUnicast(net_buffer* buffer)
 
 	const sockaddr* localAddress = buffer->destination;
 	const sockaddr* peerAddress = buffer->source;
+	uint32 flowHash = AddressModule()->hash_address_pair(localAddress,
+		peerAddress);
 
 	// look for full (most special) match:
 	UdpEndpoint* endpoint = _FindActiveEndpoint(localAddress, peerAddress,
-		buffer->index);
+		buffer->index, flowHash);
 	if (endpoint == NULL) {
 		// look for endpoint matching local address & port:
-		endpoint = _FindActiveEndpoint(localAddress, NULL, buffer->index);
+		endpoint = _FindActiveEndpoint(localAddress, NULL, buffer->index,
+			flowHash);
 		if (endpoint == NULL) {
 			// look for endpoint matching peer address & port and local port:
 			SocketAddressStorage local(AddressModule());
 			local.SetToEmpty();
 			local.SetPort(AddressModule()->get_port(localAddress));
-			endpoint = _FindActiveEndpoint(*local, peerAddress, buffer->index);
+			endpoint = _FindActiveEndpoint(*local, peerAddress, buffer->index,
+				flowHash);
 			if (endpoint == NULL) {
 				// last chance: look for endpoint matching local port only:
-				endpoint = _FindActiveEndpoint(*local, NULL, buffer->index);
+				endpoint = _FindActiveEndpoint(*local, NULL, buffer->index,
+					flowHash);
 			}
 		}
 	}
@@ -665,14 +719,14 @@ UdpDomainSupport::_EndpointWithPort(uint16 port) const
 
 UdpEndpointManager::UdpEndpointManager()
 {
-	mutex_init(&fLock, "UDP endpoints");
+	rw_lock_init(&fLock, "UDP endpoints");
 	fStatus = B_OK;
 }
 
 
 UdpEndpointManager::~UdpEndpointManager()
 {
-	mutex_destroy(&fLock);
+	rw_lock_destroy(&fLock);
 }
 
 
@@ -700,36 +754,20 @@ UdpEndpointManager::DumpEndpoints(int argc, char *argv[])
 // #pragma mark - inbound
 
 
-struct DomainSupportDelete
-{
-	inline void operator()(UdpDomainSupport* object)
-	{
-		sUdpEndpointManager->FreeEndpoint(object);
-	}
-};
-
-
-struct DomainSupportDeleter
-	: BPrivate::AutoDeleter<UdpDomainSupport, DomainSupportDelete>
-{
-	DomainSupportDeleter(UdpDomainSupport* object)
-		: BPrivate::AutoDeleter<UdpDomainSupport, DomainSupportDelete>(object)
-	{}
-};
-
-
 status_t
 UdpEndpointManager::ReceiveData(net_buffer *buffer)
 {
 	TRACE_EPM("ReceiveData(%p [%" B_PRIu32 " bytes])", buffer, buffer->size);
 
+	// The read lock keeps the domain support alive while we're using it
+	ReadLocker locker(fLock);
+
 	UdpDomainSupport* domainSupport = _GetDomainSupport(buffer);
 	if (domainSupport == NULL) {
 		// we don't instantiate domain supports in the receiving path, as
 		// we are only interested in delivering data to existing sockets.
 		return B_ERROR;
 	}
-	DomainSupportDeleter deleter(domainSupport);
 
 	status_t status = Deframe(buffer);
 	if (status != B_OK) {
@@ -738,10 +776,13 @@ UdpEndpointManager::ReceiveData(net_buffer *buffer)
 
 	status = domainSupport->DemuxIncomingBuffer(buffer);
 	if (status != B_OK) {
+		net_domain* domain = domainSupport->Domain();
+		locker.Unlock();
+
 		TRACE_EPM("  ReceiveData(): no endpoint.");
 		// Send port unreachable error
-		domainSupport->Domain()->module->error_reply(NULL, buffer,
-			B_NET_ERROR_UNREACH_PORT, NULL);
+		domain->module->error_reply(NULL, buffer, B_NET_ERROR_UNREACH_PORT,
+			NULL);
 		return B_ERROR;
 	}
 
@@ -760,13 +801,14 @@ UdpEndpointManager::ReceiveError(status_t error, net_buffer* buffer)
 	if (buffer->size < 4)
 		return B_BAD_VALUE;
 
+	ReadLocker _(fLock);
+
 	UdpDomainSupport* domainSupport = _GetDomainSupport(buffer);
 	if (domainSupport == NULL) {
 		// we don't instantiate domain supports in the receiving path, as
 		// we are only interested in delivering data to existing sockets.
 		return B_ERROR;
 	}
-	DomainSupportDeleter deleter(domainSupport);
 
 	// Deframe the buffer manually, as we usually only get 8 bytes from the
 	// original packet
@@ -848,9 +890,11 @@ UdpEndpointManager::Deframe(net_buffer* buffer)
 UdpDomainSupport *
 UdpEndpointManager::OpenEndpoint(UdpEndpoint *endpoint)
 {
-	MutexLocker _(fLock);
+	WriteLocker _(fLock);
 
 	UdpDomainSupport* domain = _GetDomainSupport(endpoint->Domain(), true);
+	if (domain != NULL)
+		domain->Ref();
 	return domain;
 }
 
@@ -858,7 +902,7 @@ UdpEndpointManager::OpenEndpoint(UdpEndpoint *endpoint)
 status_t
 UdpEndpointManager::FreeEndpoint(UdpDomainSupport *domain)
 {
-	MutexLocker _(fLock);
+	WriteLocker _(fLock);
 
 	if (domain->Put()) {
 		fDomains.Remove(domain);
@@ -885,7 +929,7 @@ UdpEndpointManager::_GetDomain(net_buffer* buffer)
 UdpDomainSupport*
 UdpEndpointManager::_GetDomainSupport(net_domain* domain, bool create)
 {
-	ASSERT_LOCKED_MUTEX(&fLock);
+	ASSERT_READ_LOCKED_RW_LOCK(&fLock);
 
 	if (domain == NULL)
 		return NULL;
@@ -898,10 +942,8 @@ UdpEndpointManager::_GetDomainSupport(net_domain* domain, bool create)
 	//      family.
 	UdpDomainList::Iterator iterator = fDomains.GetIterator();
 	while (UdpDomainSupport* domainSupport = iterator.Next()) {
-		if (domainSupport->Domain() == domain) {
-			domainSupport->Ref();
+		if (domainSupport->Domain() == domain)
 			return domainSupport;
-		}
 	}
 
 	if (!create)
@@ -915,7 +957,6 @@ UdpEndpointManager::_GetDomainSupport(net_domain* domain, bool create)
 	}
 
 	fDomains.Add(domainSupport);
-	domainSupport->Ref();
 	return domainSupport;
 }
 
@@ -923,11 +964,13 @@ UdpEndpointManager::_GetDomainSupport(net_domain* domain, bool create)
 /*!	Retrieves the UdpDomainSupport object responsible for this buffer, if the
 	domain can be determined. This is only successful if the domain support is
 	already existing, ie. there must already be an endpoint for the domain.
+	The caller must hold the manager's lock for as long as it uses the
+	returned object.
 */
 UdpDomainSupport*
 UdpEndpointManager::_GetDomainSupport(net_buffer* buffer)
 {
-	MutexLocker _(fLock);
+	ASSERT_READ_LOCKED_RW_LOCK(&fLock);
 
 	return _GetDomainSupport(_GetDomain(buffer), false);
 }
@@ -10,7 +10,9 @@
 #include <AutoDeleter.h>
 
 #include <net_stack.h>
+#include <team.h>
 #include <util/ring_buffer.h>
+#include <vm/vm.h>
 
 #include "unix.h"
 
@@ -32,7 +34,11 @@ UnixRequest::UnixRequest(const iovec* vecs, size_t count,
 	fTotalSize(0),
 	fBytesTransferred(0),
 	fVecIndex(0),
-	fVecOffset(0)
+	fVecOffset(0),
+	fLockedVecIndex(0),
+	fLockedVecOffset(0),
+	fLockedSize(0),
+	fLockedEnd(0)
 {
 	for (size_t i = 0; i < fVecCount; i++)
 		fTotalSize += fVecs[i].iov_len;
@@ -92,6 +98,65 @@ UnixRequest::AddAncillaryData(ancillary_data_container* data)
 }
 
 
+/*!	Locks the memory of up to \a maxSize of the remaining bytes of the
+	request, so that their physical pages can be accessed from another team.
+*/
+status_t
+UnixRequest::LockMemory(team_id team, size_t maxSize)
+{
+	fLockedVecIndex = fVecIndex;
+	fLockedVecOffset = fVecOffset;
+	fLockedSize = 0;
+	fLockedEnd = fBytesTransferred;
+
+	size_t locked = 0;
+	size_t offset = fVecOffset;
+	for (size_t i = fVecIndex; i < fVecCount && locked < maxSize; i++) {
+		if (fVecs[i].iov_len > offset) {
+			size_t size = min_c(fVecs[i].iov_len - offset, maxSize - locked);
+			status_t status = lock_memory_etc(team,
+				(uint8*)fVecs[i].iov_base + offset, size, 0);
+			if (status != B_OK) {
+				_UnlockMemory(team, locked);
+				fLockedEnd = fBytesTransferred;
+				return status;
+			}
+			locked += size;
+		}
+		offset = 0;
+	}
+
+	fLockedSize = locked;
+	fLockedEnd += locked;
+	return B_OK;
+}
+
+
+void
+UnixRequest::UnlockMemory(team_id team)
+{
+	_UnlockMemory(team, fLockedSize);
+	fLockedSize = 0;
+	fLockedEnd = fBytesTransferred;
+}
+
+
+void
+UnixRequest::_UnlockMemory(team_id team, size_t size)
+{
+	size_t offset = fLockedVecOffset;
+	for (size_t i = fLockedVecIndex; i < fVecCount && size > 0; i++) {
+		if (fVecs[i].iov_len > offset) {
+			size_t unlockSize = min_c(fVecs[i].iov_len - offset, size);
+			unlock_memory_etc(team, (uint8*)fVecs[i].iov_base + offset,
+				unlockSize, 0);
+			size -= unlockSize;
+		}
+		offset = 0;
+	}
+}
+
+
 // #pragma mark - UnixBufferQueue
 
 
@@ -266,8 +331,9 @@ UnixFifo::UnixFifo(size_t capacity)
 	fWriters(),
 	fReadRequested(0),
 	fWriteRequested(0),
-	fShutdown(0)
-
+	fShutdown(0),
+	fDirectWriter(NULL),
+	fDirectWriterTeam(-1)
 {
 	fReadCondition.Init(this, "unix fifo read");
 	fWriteCondition.Init(this, "unix fifo write");
@@ -324,6 +390,13 @@ UnixFifo::Read(const iovec* vecs, size_t vecCount,
 	fReaders.Remove(&request);
 	fReadRequested -= request.TotalSize();
 
+	if (fDirectWriter != NULL && fReaders.IsEmpty()) {
+		// Nobody is left to take over the writer's data directly; let it
+		// use the buffer instead.
+		fDirectWriter = NULL;
+		fWriteCondition.NotifyAll();
+	}
+
 	if (firstInQueue && !fReaders.IsEmpty() && fBuffer.Readable() > 0
 			&& !IsReadShutdown()) {
 		// There's more to read, other readers, and we were first in the queue.
@@ -459,7 +532,7 @@ UnixFifo::_Read(UnixRequest& request, bigtime_t timeout)
 			RETURN_ERROR(error);
 	}
 
-	if (fBuffer.Readable() == 0) {
+	if (fBuffer.Readable() == 0 && fDirectWriter == NULL) {
 		if (IsReadShutdown())
 			RETURN_ERROR(UNIX_FIFO_SHUTDOWN);
 
@@ -472,7 +545,7 @@ UnixFifo::_Read(UnixRequest& request, bigtime_t timeout)
 
 	// wait for any data to become available
 // TODO: Support low water marks!
-	while (fBuffer.Readable() == 0
+	while (fBuffer.Readable() == 0 && fDirectWriter == NULL
 			&& !IsReadShutdown() && !IsWriteShutdown()) {
 		ConditionVariableEntry entry;
 		fReadCondition.Add(&entry);
@@ -489,6 +562,8 @@ UnixFifo::_Read(UnixRequest& request, bigtime_t timeout)
 	if (fBuffer.Readable() == 0) {
 		if (IsReadShutdown())
 			RETURN_ERROR(UNIX_FIFO_SHUTDOWN);
+		if (fDirectWriter != NULL)
+			RETURN_ERROR(_ReadDirectly(request));
 		if (IsWriteShutdown())
 			RETURN_ERROR(0);
 	}
@@ -497,6 +572,55 @@ UnixFifo::_Read(UnixRequest& request, bigtime_t timeout)
 }
 
 
+/*!	Copies the data of the waiting direct writer into the \a request. The
+	writer's memory is locked, so its pages can be accessed by their physical
+	address, and the data only needs to be copied once.
+	The writer is released afterwards, even if the request could not take all
+	of its data, and will queue the rest into the buffer.
+*/
+status_t
+UnixFifo::_ReadDirectly(UnixRequest& request)
+{
+	UnixRequest& writer = *fDirectWriter;
+	bool user = gStackModule->is_syscall();
+	status_t status = B_OK;
+
+	void* data;
+	size_t size;
+	void* source;
+	size_t sourceSize;
+	while (writer.LockedRemaining() > 0 && request.GetCurrentChunk(data, size)
+		&& writer.GetCurrentChunk(source, sourceSize)) {
+		// copy at most up to the end of the source page
+		size_t toCopy = min_c(size, sourceSize);
+		toCopy = min_c(toCopy, (size_t)writer.LockedRemaining());
+		toCopy = min_c(toCopy, B_PAGE_SIZE - (addr_t)source % B_PAGE_SIZE);
+
+		physical_entry entry;
+		uint32 count = 1;
+		status = get_memory_map_etc(fDirectWriterTeam, source, toCopy, &entry,
+			&count);
+		if (status == B_BUFFER_OVERFLOW && count == 1)
+			status = B_OK;
+		if (status != B_OK)
+			break;
+
+		toCopy = min_c(toCopy, (size_t)entry.size);
+		status = vm_memcpy_from_physical(data, entry.address, toCopy, user);
+		if (status != B_OK)
+			break;
+
+		request.AddBytesTransferred(toCopy);
+		writer.AddBytesTransferred(toCopy);
+	}
+
+	fDirectWriter = NULL;
+	fWriteCondition.NotifyAll();
+
+	RETURN_ERROR(status);
+}
+
+
 status_t
 UnixFifo::_Write(UnixRequest& request, bigtime_t timeout)
 {
@@ -527,8 +651,18 @@ UnixFifo::_Write(UnixRequest& request, bigtime_t timeout)
 		return 0;
 
 	status_t error = B_OK;
+	bool tryDirect = gStackModule->is_syscall();
 
 	while (error == B_OK && request.BytesRemaining() > 0) {
+		if (tryDirect && _CanWriteDirectly(request)) {
+			error = _WriteDirectly(request, timeout);
+			if (error == B_NOT_SUPPORTED) {
+				tryDirect = false;
+				error = B_OK;
+			}
+			continue;
+		}
+
 		// wait for any space to become available
 		while (error == B_OK && fBuffer.Writable() == 0 && !IsWriteShutdown()
 				&& !IsReadShutdown()) {
@@ -577,3 +711,55 @@ UnixFifo::_WriteNonBlocking(UnixRequest& request)
 	RETURN_ERROR(fBuffer.Write(request));
 }
 
+
+/*!	Returns whether the \a request should bypass the buffer, and be handed to
+	a reader directly: this is the case for large writes when the buffer is
+	empty, and a reader is already waiting for data.
+*/
+bool
+UnixFifo::_CanWriteDirectly(UnixRequest& request) const
+{
+	return fDirectWriter == NULL && request.AncillaryData() == NULL
+		&& request.BytesRemaining() >= UNIX_FIFO_MINIMAL_DIRECT_TRANSFER
+		&& fBuffer.Readable() == 0 && !fReaders.IsEmpty()
+		&& !IsReadShutdown() && !IsWriteShutdown();
+}
+
+
+/*!	Locks the (remaining) memory of the \a request, and waits until a reader
+	copied data out of it, see _ReadDirectly().
+	Returns \c B_NOT_SUPPORTED if the memory could not be locked, in which
+	case the caller needs to fall back to writing into the buffer.
+*/
+status_t
+UnixFifo::_WriteDirectly(UnixRequest& request, bigtime_t timeout)
+{
+	team_id team = team_get_current_team_id();
+	if (request.LockMemory(team, UNIX_FIFO_MAXIMAL_DIRECT_TRANSFER) != B_OK)
+		return B_NOT_SUPPORTED;
+
+	fDirectWriter = &request;
+	fDirectWriterTeam = team;
+	fReadCondition.NotifyAll();
+
+	status_t error = B_OK;
+	while (fDirectWriter == &request && !IsReadShutdown()
+			&& !IsWriteShutdown()) {
+		ConditionVariableEntry entry;
+		fWriteCondition.Add(&entry);
+
+		mutex_unlock(&fLock);
+		error = entry.Wait(B_ABSOLUTE_TIMEOUT | B_CAN_INTERRUPT, timeout);
+		mutex_lock(&fLock);
+
+		if (error != B_OK)
+			break;
+	}
+
+	if (fDirectWriter == &request)
+		fDirectWriter = NULL;
+
+	request.UnlockMemory(team);
+	return error;
+}
+
@@ -24,6 +24,11 @@
 #define UNIX_FIFO_MINIMAL_CAPACITY	1024
 #define UNIX_FIFO_MAXIMAL_CAPACITY	(128 * 1024)
 
+#define UNIX_FIFO_MINIMAL_DIRECT_TRANSFER	(16 * 1024)
+	// writes of at least this size are handed to a waiting reader directly
+#define UNIX_FIFO_MAXIMAL_DIRECT_TRANSFER	(1024 * 1024)
+	// the maximal amount of a writer's memory locked at a time
+
 
 struct ring_buffer;
 
@@ -43,6 +48,14 @@ public:
 	void SetAncillaryData(ancillary_data_container* data);
 	void AddAncillaryData(ancillary_data_container* data);
 
+	status_t LockMemory(team_id team, size_t maxSize);
+	void UnlockMemory(team_id team);
+	off_t LockedRemaining() const
+		{ return fLockedEnd - fBytesTransferred; }
+
+private:
+	void _UnlockMemory(team_id team, size_t size);
+
 private:
 	const iovec*				fVecs;
 	size_t						fVecCount;
@@ -51,6 +64,10 @@ private:
 	off_t						fBytesTransferred;
 	size_t						fVecIndex;
 	size_t						fVecOffset;
+	size_t						fLockedVecIndex;
+	size_t						fLockedVecOffset;
+	size_t						fLockedSize;
+	off_t						fLockedEnd;
 };
 
 
@@ -128,8 +145,11 @@ private:
 
 private:
 	status_t _Read(UnixRequest& request, bigtime_t timeout);
+	status_t _ReadDirectly(UnixRequest& request);
 	status_t _Write(UnixRequest& request, bigtime_t timeout);
 	status_t _WriteNonBlocking(UnixRequest& request);
+	bool _CanWriteDirectly(UnixRequest& request) const;
+	status_t _WriteDirectly(UnixRequest& request, bigtime_t timeout);
 
 private:
 	mutex				fLock;
@@ -141,6 +161,8 @@ private:
 	ConditionVariable	fReadCondition;
 	ConditionVariable	fWriteCondition;
 	uint32				fShutdown;
+	UnixRequest*		fDirectWriter;
+	team_id				fDirectWriterTeam;
 };
 
 
@@ -344,6 +344,39 @@ datalink_control(net_domain* _domain, int32 option, void* value,
 }
 
 
+/*!	Sends a TCP segment that is larger than the MTU of the device as separate
+	segments. The \a buffer is only freed if all of them could be sent.
+*/
+static status_t
+send_segments(domain_datalink* datalink, net_buffer* buffer)
+{
+	struct list segments;
+	list_init(&segments);
+
+	status_t status = segment_buffer(buffer, &segments);
+	if (status != B_OK)
+		return status;
+
+	while (net_buffer* segment
+			= (net_buffer*)list_remove_head_item(&segments)) {
+		if (status == B_OK) {
+			status = datalink->first_info->send_data(datalink->first_protocol,
+				segment);
+			if (status == B_OK)
+				continue;
+		}
+
+		// drop the remaining segments after an error
+		gNetBufferModule.free(segment);
+	}
+
+	if (status == B_OK)
+		gNetBufferModule.free(buffer);
+
+	return status;
+}
+
+
 static status_t
 datalink_send_routed_data(struct net_route* route, net_buffer* buffer)
 {
@@ -386,6 +419,12 @@ datalink_send_routed_data(struct net_route* route, net_buffer* buffer)
 	// this goes out to the datalink protocols
 	domain_datalink* datalink
 		= interface->DomainDatalink(address->domain->family);
+
+	if (buffer->segment_size != 0 && (interface->device->features
+			& NET_DEVICE_SEGMENTATION_OFFLOAD) == 0) {
+		return send_segments(datalink, buffer);
+	}
+
 	return datalink->first_info->send_data(datalink->first_protocol, buffer);
 }
 
@@ -36,6 +36,8 @@
 #endif
 
 
+static const size_t kMaxReceiveBatch = 32;
+
 static mutex sLock;
 static DeviceInterfaceList sInterfaces;
 static uint32 sDeviceIndex;
@@ -82,56 +84,77 @@ device_reader_thread(void* _interface)
 }
 
 
+static void
+device_receive_buffer(net_device_interface* interface, net_buffer* buffer)
+{
+	ASSERT_LOCKED_RECURSIVE(&interface->receive_lock);
+
+	if (buffer->interface_address != NULL) {
+		// If the interface is already specified, this buffer was
+		// delivered locally.
+		if (buffer->interface_address->domain->module->receive_data(buffer)
+				== B_OK)
+			buffer = NULL;
+	} else {
+		sockaddr_dl& linkAddress = *(sockaddr_dl*)buffer->source;
+		int32 genericType = buffer->type;
+		int32 specificType = B_NET_FRAME_TYPE(linkAddress.sdl_type,
+			ntohs(linkAddress.sdl_e_type));
+
+		buffer->index = interface->device->index;
+
+		// Find handler for this packet
+
+		DeviceHandlerList::Iterator iterator
+			= interface->receive_funcs.GetIterator();
+		while (buffer != NULL && iterator.HasNext()) {
+			net_device_handler* handler = iterator.Next();
+
+			// If the handler returns B_OK, it consumed the buffer - first
+			// handler wins.
+			if ((handler->type == genericType
+					|| handler->type == specificType)
+				&& handler->func(handler->cookie, interface->device, buffer)
+					== B_OK)
+				buffer = NULL;
+		}
+	}
+
+	if (buffer != NULL)
+		gNetBufferModule.free(buffer);
+}
+
+
+/*!	Takes the buffers out of the receive queue of the device interface, and
+	passes them on to the protocols. It dequeues as many buffers as available
+	up to kMaxReceiveBatch at once, so that consecutive TCP segments can be
+	merged, and the receive lock has to be acquired only once per batch.
+*/
 static status_t
 device_consumer_thread(void* _interface)
 {
 	net_device_interface* interface = (net_device_interface*)_interface;
-	net_device* device = interface->device;
-	net_buffer* buffer;
 
 	while (atomic_get(&interface->ref_count) > 0) {
-		ssize_t status = fifo_dequeue_buffer(&interface->receive_queue, 0,
-			B_INFINITE_TIMEOUT, &buffer);
-		if (status != B_OK) {
+		struct list buffers;
+		list_init(&buffers);
+
+		ssize_t status = fifo_dequeue_buffers(&interface->receive_queue,
+			B_INFINITE_TIMEOUT, &buffers, kMaxReceiveBatch);
+		if (status < B_OK) {
 			if (status == B_INTERRUPTED)
 				continue;
 			break;
 		}
 
-		if (buffer->interface_address != NULL) {
-			// If the interface is already specified, this buffer was
-			// delivered locally.
-			if (buffer->interface_address->domain->module->receive_data(buffer)
-					== B_OK)
-				buffer = NULL;
-		} else {
-			sockaddr_dl& linkAddress = *(sockaddr_dl*)buffer->source;
-			int32 genericType = buffer->type;
-			int32 specificType = B_NET_FRAME_TYPE(linkAddress.sdl_type,
-				ntohs(linkAddress.sdl_e_type));
-
-			buffer->index = interface->device->index;
+		coalesce_segments(&buffers);
 
-			// Find handler for this packet
+		RecursiveLocker locker(interface->receive_lock);
 
-			RecursiveLocker locker(interface->receive_lock);
-
-			DeviceHandlerList::Iterator iterator
-				= interface->receive_funcs.GetIterator();
-			while (buffer != NULL && iterator.HasNext()) {
-				net_device_handler* handler = iterator.Next();
-
-				// If the handler returns B_OK, it consumed the buffer - first
-				// handler wins.
-				if ((handler->type == genericType
-						|| handler->type == specificType)
-					&& handler->func(handler->cookie, device, buffer) == B_OK)
-					buffer = NULL;
-			}
+		while (net_buffer* buffer
+				= (net_buffer*)list_remove_head_item(&buffers)) {
+			device_receive_buffer(interface, buffer);
 		}
-
-		if (buffer != NULL)
-			gNetBufferModule.free(buffer);
 	}
 
 	return B_OK;
@@ -768,6 +791,10 @@ unregister_device_monitor(net_device* device, net_device_monitor* monitor)
 status_t
 device_link_changed(net_device* device)
 {
+	// routes to devices without a link are avoided, so cached routes might
+	// no longer be the best choice
+	invalidate_route_caches();
+
 	notify_link_changed(device);
 	return B_OK;
 }
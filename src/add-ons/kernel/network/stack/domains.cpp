@@ -86,6 +86,9 @@ dump_domains(int argc, char** argv)
 				route->flags, route->interface_address);
 		}
 
+		kprintf("  route cache:    %" B_PRIu64 " hits, %" B_PRIu64 " misses\n",
+			domain->route_cache.hits, domain->route_cache.misses);
+
 		if (!domain->route_infos.IsEmpty())
 			kprintf("  route infos:\n");
 	
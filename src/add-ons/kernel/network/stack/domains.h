@@ -25,6 +25,7 @@ struct net_domain_private : net_domain,
 
 	RouteList			routes;
 	RouteInfoList		route_infos;
+	RouteCache			route_cache;
 };
 
 
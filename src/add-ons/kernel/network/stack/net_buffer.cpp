@@ -70,6 +70,9 @@ struct data_header {
 	uint8*			data_end;
 	header_space	space;
 	uint16			tail_space;
+	void			(*release)(void* cookie);
+	void*			release_cookie;
+		// only set for headers of external data
 };
 
 struct data_node {
@@ -149,6 +152,8 @@ struct net_buffer_private : net_buffer {
 #define DATA_HEADER_SIZE				_ALIGN(sizeof(data_header))
 #define DATA_NODE_SIZE					_ALIGN(sizeof(data_node))
 #define MAX_FREE_BUFFER_SIZE			(BUFFER_SIZE - DATA_HEADER_SIZE)
+#define MAX_EXTERNAL_NODE_SIZE			(8 * B_PAGE_SIZE)
+	// must fit into data_node::used
 
 
 static object_cache* sNetBufferCache;
@@ -813,6 +818,8 @@ create_data_header(size_t headerSpace)
 	header->tail_space = (uint8*)header + BUFFER_SIZE - header->data_end
 		- headerSpace;
 	header->first_free = NULL;
+	header->release = NULL;
+	header->release_cookie = NULL;
 
 	TRACE(("%d:   create new data header %p\n", find_thread(NULL), header));
 	T2(CreateDataHeader(header));
@@ -829,6 +836,9 @@ release_data_header(data_header* header)
 		return;
 
 	TRACE(("%d:   free header %p\n", find_thread(NULL), header));
+	if (header->release != NULL)
+		header->release(header->release_cookie);
+
 	free_data_header(header);
 }
 
@@ -1081,6 +1091,7 @@ copy_metadata(net_buffer* destination, const net_buffer* source)
 	destination->offset = source->offset;
 	destination->protocol = source->protocol;
 	destination->type = source->type;
+	destination->segment_size = source->segment_size;
 }
 
 
@@ -1128,6 +1139,7 @@ create_buffer(size_t headerSpace)
 	buffer->offset = 0;
 	buffer->flags = 0;
 	buffer->size = 0;
+	buffer->segment_size = 0;
 
 	CHECK_BUFFER(buffer);
 	CREATE_PARANOIA_CHECK_SET(buffer, "net_buffer");
@@ -2008,6 +2020,67 @@ append_cloned_data(net_buffer* _buffer, net_buffer* _source, uint32 offset,
 }
 
 
+/*!	Appends \a bytes bytes at \a data to the buffer without copying them.
+	The memory is referenced by read-only data nodes, and must stay valid
+	until \a release is called with \a cookie; this happens as soon as the
+	last buffer that references the data, including clones of it, is freed.
+	\a release is also called if the data could not be appended.
+*/
+static status_t
+append_external_data(net_buffer* _buffer, const void* data, size_t bytes,
+	void (*release)(void* cookie), void* cookie)
+{
+	net_buffer_private* buffer = (net_buffer_private*)_buffer;
+	TRACE(("%d: append_external_data(buffer %p, data %p, bytes = %ld)\n",
+		find_thread(NULL), buffer, data, bytes));
+
+	ParanoiaChecker _(buffer);
+
+	// The header only keeps track of the references to the data, it does not
+	// contain any itself.
+	data_header* header = create_data_header(0);
+	if (header == NULL) {
+		release(cookie);
+		return ENOBUFS;
+	}
+
+	header->release = release;
+	header->release_cookie = cookie;
+
+	const uint8* source = (const uint8*)data;
+	size_t sizeAppended = 0;
+	status_t status = B_OK;
+
+	while (sizeAppended < bytes) {
+		data_node* node = add_data_node(buffer, header);
+		if (node == NULL) {
+			remove_trailer(buffer, sizeAppended);
+			status = ENOBUFS;
+			break;
+		}
+
+		node->offset = buffer->size;
+		node->start = (uint8*)source + sizeAppended;
+		node->used = min_c(bytes - sizeAppended, MAX_EXTERNAL_NODE_SIZE);
+		node->flags = DATA_NODE_READ_ONLY;
+
+		list_add_item(&buffer->buffers, node);
+
+		buffer->size += node->used;
+		sizeAppended += node->used;
+	}
+
+	// the nodes hold the references to the data now
+	release_data_header(header);
+
+	CHECK_BUFFER(buffer);
+	SET_PARANOIA_CHECK(PARANOIA_SUSPICIOUS, buffer, &buffer->size,
+		sizeof(buffer->size));
+
+	return status;
+}
+
+
 void
 set_ancillary_data(net_buffer* buffer, ancillary_data_container* container)
 {
@@ -2402,5 +2475,7 @@ net_buffer_module_info gNetBufferModule = {
 	swap_addresses,
 
 	dump_buffer,	// dump
+
+	append_external_data,
 };
 
@@ -1488,6 +1488,89 @@ socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
 }
 
 
+/*!	Sends \a length bytes at \a data over a connected stream socket without
+	copying them: the data is attached to the buffers by reference, and
+	\a release is called with \a cookie once the protocol no longer needs it,
+	ie. when it has been acknowledged by the peer. Other sockets get a copy of
+	the data.
+	In any case, \a release will be called exactly once.
+*/
+ssize_t
+socket_send_external(net_socket* socket, const void* data, size_t length,
+	int flags, void (*release)(void* cookie), void* cookie)
+{
+	if (length > SSIZE_MAX) {
+		release(cookie);
+		return B_BAD_VALUE;
+	}
+
+	if (socket->type != SOCK_STREAM || socket->peer.ss_len == 0
+		|| socket->first_info->send_data_no_buffer != NULL) {
+		ssize_t bytesSent = socket_send(socket, NULL, data, length, flags);
+		release(cookie);
+		return bytesSent;
+	}
+
+	// All buffers we send are clones of this one
+	net_buffer* source = gNetBufferModule.create(0);
+	if (source == NULL) {
+		release(cookie);
+		return ENOBUFS;
+	}
+
+	status_t status = gNetBufferModule.append_external(source, data, length,
+		release, cookie);
+	if (status != B_OK) {
+		gNetBufferModule.free(source);
+		return status;
+	}
+
+	ssize_t bytesSent = 0;
+
+	while ((size_t)bytesSent < length) {
+		size_t bufferSize = min_c(length - bytesSent,
+			socket->send.buffer_size);
+
+		net_buffer* buffer = gNetBufferModule.create(256);
+		if (buffer == NULL) {
+			status = ENOBUFS;
+			break;
+		}
+
+		status = gNetBufferModule.append_cloned(buffer, source, bytesSent,
+			bufferSize);
+		if (status != B_OK) {
+			gNetBufferModule.free(buffer);
+			break;
+		}
+
+		buffer->flags = flags;
+		memcpy(buffer->source, &socket->address, socket->address.ss_len);
+		memcpy(buffer->destination, &socket->peer, socket->peer.ss_len);
+
+		status = socket->first_info->send_data(socket->first_protocol, buffer);
+		if (status != B_OK) {
+			size_t sizeAfterSend = buffer->size;
+			gNetBufferModule.free(buffer);
+
+			if ((sizeAfterSend != bufferSize || bytesSent > 0)
+				&& (status == B_INTERRUPTED || status == B_WOULD_BLOCK)) {
+				// this appears to be a partial write
+				bytesSent += bufferSize - sizeAfterSend;
+				status = B_OK;
+			}
+			break;
+		}
+
+		bytesSent += bufferSize;
+	}
+
+	gNetBufferModule.free(source);
+
+	return status == B_OK ? bytesSent : status;
+}
+
+
 status_t
 socket_set_option(net_socket* socket, int level, int option, const void* value,
 	int length)
@@ -1766,6 +1849,8 @@ net_socket_module_info gNetSocketModule = {
 	socket_send,
 	socket_setsockopt,
 	socket_shutdown,
-	socket_socketpair
+	socket_socketpair,
+
+	socket_send_external
 };
 
@@ -37,6 +37,9 @@
 #endif
 
 
+static int32 sLinkGeneration;
+
+
 net_route_private::net_route_private()
 {
 	destination = mask = gateway = NULL;
@@ -51,6 +54,17 @@ net_route_private::~net_route_private()
 }
 
 
+RouteCache::RouteCache()
+	:
+	generation(1),
+	link_generation(0),
+	hits(0),
+	misses(0)
+{
+	memset(entries, 0, sizeof(entries));
+}
+
+
 //	#pragma mark - private functions
 
 
@@ -187,6 +201,56 @@ find_route(net_domain* _domain, const sockaddr* address)
 }
 
 
+/*!	Looks up the route for the given address in the domain's route cache,
+	and only falls back to walking the routing table if that fails.
+*/
+static net_route_private*
+find_cached_route(net_domain_private* domain, const sockaddr* address)
+{
+	ASSERT_LOCKED_RECURSIVE(&domain->lock);
+	RouteCache& cache = domain->route_cache;
+
+	int32 linkGeneration = atomic_get(&sLinkGeneration);
+	if (cache.link_generation != linkGeneration) {
+		cache.link_generation = linkGeneration;
+		cache.generation++;
+	}
+
+	uint32 hash = domain->address_module->hash_address(address, false);
+	route_cache_entry& entry
+		= cache.entries[(hash * 2654435761U >> 16) & (ROUTE_CACHE_SIZE - 1)];
+
+	if (entry.generation == cache.generation && entry.route != NULL
+		&& domain->address_module->equal_addresses(address,
+			(const sockaddr*)&entry.destination)) {
+		cache.hits++;
+		return entry.route;
+	}
+
+	cache.misses++;
+
+	net_route_private* route = find_route(domain, address);
+	if (route != NULL && address->sa_len <= sizeof(entry.destination)) {
+		memcpy(&entry.destination, address, address->sa_len);
+		entry.route = route;
+		entry.generation = cache.generation;
+	}
+
+	return route;
+}
+
+
+/*!	Invalidates all entries of the domain's route cache. Must be called
+	whenever the routing table changes.
+*/
+static void
+flush_route_cache(net_domain_private* domain)
+{
+	ASSERT_LOCKED_RECURSIVE(&domain->lock);
+	domain->route_cache.generation++;
+}
+
+
 static void
 put_route_internal(struct net_domain_private* domain, net_route* _route)
 {
@@ -230,7 +294,7 @@ get_route_internal(struct net_domain_private* domain,
 				break;
 		}
 	} else
-		route = find_route(domain, address);
+		route = find_cached_route(domain, address);
 
 	if (route != NULL && atomic_add(&route->ref_count, 1) == 0) {
 		// route has been deleted already
@@ -514,6 +578,7 @@ add_route(struct net_domain* _domain, const struct net_route* newRoute)
 	}
 
 	domain->routes.Insert(before, route);
+	flush_route_cache(domain);
 	update_route_infos(domain);
 
 	return B_OK;
@@ -542,6 +607,7 @@ remove_route(struct net_domain* _domain, const struct net_route* removeRoute)
 		return B_ENTRY_NOT_FOUND;
 
 	domain->routes.Remove(route);
+	flush_route_cache(domain);
 
 	put_route_internal(domain, route);
 	update_route_infos(domain);
@@ -619,6 +685,16 @@ invalidate_routes(InterfaceAddress* address)
 }
 
 
+/*!	Makes sure that routes are looked up again after the link state of a
+	device changed, as that influences which route is chosen.
+*/
+void
+invalidate_route_caches()
+{
+	atomic_add(&sLinkGeneration, 1);
+}
+
+
 struct net_route*
 get_route(struct net_domain* _domain, const struct sockaddr* address)
 {
@@ -31,6 +31,31 @@ typedef DoublyLinkedList<net_route_info,
 	DoublyLinkedListCLink<net_route_info> > RouteInfoList;
 
 
+#define ROUTE_CACHE_SIZE	64
+	// must be a power of two
+
+struct route_cache_entry {
+	sockaddr_storage	destination;
+	net_route_private*	route;
+	uint32				generation;
+};
+
+/*!	Caches the result of recent route lookups per destination address. The
+	entries do not hold a reference to their route; they are only valid as
+	long as their generation matches the one of the cache, which is increased
+	whenever the routing table, or the link state of a device changes.
+*/
+struct RouteCache {
+	route_cache_entry	entries[ROUTE_CACHE_SIZE];
+	uint32				generation;
+	int32				link_generation;
+	uint64				hits;
+	uint64				misses;
+
+	RouteCache();
+};
+
+
 uint32 route_table_size(struct net_domain_private* domain);
 status_t list_routes(struct net_domain_private* domain, void* buffer,
 				size_t size);
@@ -45,6 +70,7 @@ status_t get_route_information(struct net_domain* domain, void* buffer,
 				size_t length);
 void invalidate_routes(net_domain* domain, net_interface* interface);
 void invalidate_routes(InterfaceAddress* address);
+void invalidate_route_caches();
 struct net_route* get_route(struct net_domain* domain,
 				const struct sockaddr* address);
 status_t get_device_route(struct net_domain* domain, uint32 index,
@@ -0,0 +1,415 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Generic segmentation and receive offload: splits TCP segments larger than
+	the MTU before they are sent, and merges consecutive segments of the same
+	connection after they have been received.
+*/
+
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip6.h>
+#include <netinet/tcp.h>
+#include <string.h>
+
+#include <KernelExport.h>
+
+#include <NetUtilities.h>
+
+#include "interfaces.h"
+#include "stack_private.h"
+#include "utility.h"
+
+
+//#define TRACE_SEGMENTATION
+#ifdef TRACE_SEGMENTATION
+#	define TRACE(x...) dprintf(STACK_DEBUG_PREFIX x)
+#else
+#	define TRACE(x...) ;
+#endif
+
+
+static const size_t kMaxHeaderLength = sizeof(ip6_hdr) + 60;
+	// IPv4 headers with options are smaller than that, too
+
+static const uint8 kFinishFlag = 0x01;
+static const uint8 kPushFlag = 0x08;
+static const uint8 kAcknowledgeFlag = 0x10;
+
+
+/*!	Creates a segment with a copy of the \a header, and the \a length bytes
+	at \a offset of the \a source buffer.
+*/
+static net_buffer*
+create_segment(net_buffer* source, const uint8* header, size_t headerLength,
+	uint32 offset, size_t length)
+{
+	net_buffer* segment = gNetBufferModule.create(128);
+	if (segment == NULL)
+		return NULL;
+
+	if (gNetBufferModule.append(segment, header, headerLength) != B_OK
+		|| gNetBufferModule.append_cloned(segment, source, offset, length)
+			!= B_OK) {
+		gNetBufferModule.free(segment);
+		return NULL;
+	}
+
+	memcpy(segment->source, source->source, source->source->sa_len);
+	memcpy(segment->destination, source->destination,
+		source->destination->sa_len);
+	segment->flags = source->flags;
+	segment->protocol = source->protocol;
+	segment->interface_address = source->interface_address;
+	if (segment->interface_address != NULL)
+		((InterfaceAddress*)segment->interface_address)->AcquireReference();
+
+	return segment;
+}
+
+
+/*!	Splits a TCP segment over IPv4 or IPv6 that is marked by
+	net_buffer::segment_size into segments that fit into the MTU, and adds
+	them to \a segments. The headers are copied, and their lengths, sequence
+	numbers, and checksums adapted; the data is shared with the \a buffer.
+	The \a buffer itself remains untouched.
+*/
+status_t
+segment_buffer(net_buffer* buffer, struct list* segments)
+{
+	uint32 headerBuffer[kMaxHeaderLength / 4];
+	uint8* header = (uint8*)headerBuffer;
+	size_t available = min_c(buffer->size, sizeof(headerBuffer));
+	if (gNetBufferModule.read(buffer, 0, header, available) != B_OK)
+		return B_BAD_DATA;
+
+	ip* ipv4 = NULL;
+	ip6_hdr* ipv6 = NULL;
+	size_t networkLength;
+	if ((header[0] >> 4) == 4) {
+		ipv4 = (ip*)header;
+		networkLength = ipv4->ip_hl * 4;
+		if (ipv4->ip_p != IPPROTO_TCP)
+			return B_BAD_VALUE;
+	} else if ((header[0] >> 4) == 6) {
+		ipv6 = (ip6_hdr*)header;
+		networkLength = sizeof(ip6_hdr);
+		if (ipv6->ip6_nxt != IPPROTO_TCP)
+			return B_BAD_VALUE;
+	} else
+		return B_BAD_VALUE;
+
+	if (networkLength + sizeof(tcphdr) > available)
+		return B_BAD_DATA;
+
+	tcphdr* tcp = (tcphdr*)(header + networkLength);
+	size_t headerLength = networkLength + tcp->th_off * 4;
+	if (headerLength > available)
+		return B_BAD_DATA;
+
+	uint32 sequence = ntohl(tcp->th_seq);
+	uint16 id = ipv4 != NULL ? ntohs(ipv4->ip_id) : 0;
+	uint8 flags = tcp->th_flags;
+	uint32 dataLength = buffer->size - headerLength;
+
+	TRACE("segment_buffer(%p): %" B_PRIu32 " bytes in segments of %" B_PRIu16
+		"\n", buffer, dataLength, buffer->segment_size);
+
+	for (uint32 offset = 0; offset < dataLength;
+			offset += buffer->segment_size) {
+		uint32 length = min_c(dataLength - offset, buffer->segment_size);
+		uint16 segmentLength = headerLength - networkLength + length;
+		bool last = offset + length == dataLength;
+
+		// FIN and PSH only belong to the last segment
+		tcp->th_seq = htonl(sequence + offset);
+		tcp->th_flags = last ? flags : flags & ~(kFinishFlag | kPushFlag);
+		tcp->th_sum = 0;
+
+		Checksum checksum;
+		if (ipv4 != NULL) {
+			ipv4->ip_len = htons(networkLength + segmentLength);
+			ipv4->ip_id = htons(id++);
+			ipv4->ip_sum = 0;
+			ipv4->ip_sum = gNetStackModule.checksum(header, networkLength);
+
+			checksum << (uint32)ipv4->ip_src.s_addr
+				<< (uint32)ipv4->ip_dst.s_addr;
+		} else {
+			ipv6->ip6_plen = htons(segmentLength);
+
+			// source and destination address
+			const uint32* addresses
+				= headerBuffer + offsetof(ip6_hdr, ip6_src) / 4;
+			for (int i = 0; i < 8; i++)
+				checksum << addresses[i];
+		}
+
+		net_buffer* segment = create_segment(buffer, header, headerLength,
+			headerLength + offset, length);
+		if (segment == NULL) {
+			while ((segment = (net_buffer*)list_remove_head_item(segments))
+					!= NULL) {
+				gNetBufferModule.free(segment);
+			}
+			return B_NO_MEMORY;
+		}
+
+		checksum << (uint16)htons(IPPROTO_TCP) << (uint16)htons(segmentLength)
+			<< (uint32)gNetBufferModule.checksum(segment, networkLength,
+				segmentLength, false);
+		uint16 sum = checksum;
+		gNetBufferModule.write(segment,
+			networkLength + offsetof(tcphdr, th_sum), &sum, sizeof(sum));
+
+		list_add_item(segments, segment);
+	}
+
+	return B_OK;
+}
+
+
+//	#pragma mark - receive offload
+
+
+struct coalesced_segment {
+	net_buffer*	buffer;
+	uint32		header_buffer[kMaxHeaderLength / 4];
+	size_t		network_length;
+	size_t		header_length;
+	uint32		next_sequence;
+	bool		verified;
+	bool		closed;
+};
+
+
+/*!	Reads the headers of the \a buffer into \a segment, and checks whether
+	it holds a plain TCP segment with data that could be merged with others.
+*/
+static bool
+read_segment(net_buffer* buffer, coalesced_segment& segment)
+{
+	if (buffer->interface_address != NULL || buffer->segment_size != 0
+		|| (buffer->type != B_NET_FRAME_TYPE_IPV4
+			&& buffer->type != B_NET_FRAME_TYPE_IPV6))
+		return false;
+
+	uint8* header = (uint8*)segment.header_buffer;
+	size_t available = min_c(buffer->size, sizeof(segment.header_buffer));
+	if (available < sizeof(ip) + sizeof(tcphdr)
+		|| gNetBufferModule.read(buffer, 0, header, available) != B_OK)
+		return false;
+
+	if ((header[0] >> 4) == 4) {
+		ip* ipv4 = (ip*)header;
+		if (ipv4->ip_hl != sizeof(ip) / 4 || ipv4->ip_p != IPPROTO_TCP
+			|| ntohs(ipv4->ip_len) != buffer->size
+			|| (ntohs(ipv4->ip_off) & (IP_MF | IP_OFFMASK)) != 0
+			|| gNetStackModule.checksum(header, sizeof(ip)) != 0)
+			return false;
+
+		segment.network_length = sizeof(ip);
+	} else if ((header[0] >> 4) == 6) {
+		ip6_hdr* ipv6 = (ip6_hdr*)header;
+		if (available < sizeof(ip6_hdr) + sizeof(tcphdr)
+			|| ipv6->ip6_nxt != IPPROTO_TCP
+			|| ntohs(ipv6->ip6_plen) + sizeof(ip6_hdr) != buffer->size)
+			return false;
+
+		segment.network_length = sizeof(ip6_hdr);
+	} else
+		return false;
+
+	tcphdr* tcp = (tcphdr*)(header + segment.network_length);
+	segment.header_length = segment.network_length + tcp->th_off * 4;
+	if (tcp->th_off < sizeof(tcphdr) / 4
+		|| segment.header_length > available
+		|| segment.header_length >= buffer->size
+		|| (tcp->th_flags & ~kPushFlag) != kAcknowledgeFlag)
+		return false;
+
+	segment.buffer = buffer;
+	segment.next_sequence = ntohl(tcp->th_seq) + buffer->size
+		- segment.header_length;
+	segment.verified = false;
+	segment.closed = (tcp->th_flags & kPushFlag) != 0;
+	return true;
+}
+
+
+//!	Verifies the TCP checksum of the segment.
+static bool
+verify_segment(coalesced_segment& segment)
+{
+	if (segment.verified)
+		return true;
+
+	net_buffer* buffer = segment.buffer;
+	uint16 length = buffer->size - segment.network_length;
+
+	Checksum checksum;
+	if (segment.network_length == sizeof(ip)) {
+		ip* ipv4 = (ip*)segment.header_buffer;
+		checksum << (uint32)ipv4->ip_src.s_addr << (uint32)ipv4->ip_dst.s_addr;
+	} else {
+		const uint32* addresses
+			= segment.header_buffer + offsetof(ip6_hdr, ip6_src) / 4;
+		for (int i = 0; i < 8; i++)
+			checksum << addresses[i];
+	}
+
+	checksum << (uint16)htons(IPPROTO_TCP) << (uint16)htons(length)
+		<< (uint32)gNetBufferModule.checksum(buffer, segment.network_length,
+			length, false);
+
+	segment.verified = (uint16)checksum == 0;
+	return segment.verified;
+}
+
+
+/*!	Returns whether the \a next segment directly follows the \a first one,
+	and belongs to the same connection. Everything but the sequence number,
+	the checksum, and the PSH flag has to be identical in the headers.
+*/
+static bool
+is_next_segment(const coalesced_segment& first, const coalesced_segment& next)
+{
+	if (first.closed || first.network_length != next.network_length
+		|| first.header_length != next.header_length)
+		return false;
+
+	const uint8* firstHeader = (const uint8*)first.header_buffer;
+	const uint8* nextHeader = (const uint8*)next.header_buffer;
+	const tcphdr* firstTCP = (const tcphdr*)(firstHeader + first.network_length);
+	const tcphdr* nextTCP = (const tcphdr*)(nextHeader + next.network_length);
+
+	if (ntohl(nextTCP->th_seq) != first.next_sequence)
+		return false;
+
+	// the next segment must not be larger than the first one
+	uint32 segmentSize = first.buffer->segment_size != 0
+		? first.buffer->segment_size
+		: first.buffer->size - first.header_length;
+	if (next.buffer->size - next.header_length > segmentSize
+		|| first.buffer->size + next.buffer->size - next.header_length > 65535)
+		return false;
+
+	if (first.network_length == sizeof(ip)) {
+		const ip* firstIP = (const ip*)firstHeader;
+		const ip* nextIP = (const ip*)nextHeader;
+		if (firstIP->ip_tos != nextIP->ip_tos
+			|| firstIP->ip_ttl != nextIP->ip_ttl
+			|| firstIP->ip_src.s_addr != nextIP->ip_src.s_addr
+			|| firstIP->ip_dst.s_addr != nextIP->ip_dst.s_addr)
+			return false;
+	} else {
+		// version, traffic class, and flow label, and the addresses
+		if (memcmp(firstHeader, nextHeader, 4) != 0
+			|| memcmp(firstHeader + offsetof(ip6_hdr, ip6_hlim),
+				nextHeader + offsetof(ip6_hdr, ip6_hlim),
+				sizeof(ip6_hdr) - offsetof(ip6_hdr, ip6_hlim)) != 0)
+			return false;
+	}
+
+	return firstTCP->th_sport == nextTCP->th_sport
+		&& firstTCP->th_dport == nextTCP->th_dport
+		&& firstTCP->th_ack == nextTCP->th_ack
+		&& firstTCP->th_win == nextTCP->th_win
+		&& memcmp(firstTCP + 1, nextTCP + 1,
+			first.header_length - first.network_length - sizeof(tcphdr)) == 0;
+}
+
+
+//!	Writes the adapted headers back into a segment that others were merged in.
+static void
+finish_segment(coalesced_segment& segment)
+{
+	net_buffer* buffer = segment.buffer;
+	if (buffer == NULL || buffer->segment_size == 0)
+		return;
+
+	uint8* header = (uint8*)segment.header_buffer;
+	if (segment.network_length == sizeof(ip)) {
+		ip* ipv4 = (ip*)header;
+		ipv4->ip_len = htons(buffer->size);
+		ipv4->ip_sum = 0;
+		ipv4->ip_sum = gNetStackModule.checksum(header, sizeof(ip));
+	} else {
+		ip6_hdr* ipv6 = (ip6_hdr*)header;
+		ipv6->ip6_plen = htons(buffer->size - sizeof(ip6_hdr));
+	}
+
+	tcphdr* tcp = (tcphdr*)(header + segment.network_length);
+	if (segment.closed)
+		tcp->th_flags |= kPushFlag;
+
+	gNetBufferModule.write(buffer, 0, header,
+		segment.network_length + sizeof(tcphdr));
+}
+
+
+/*!	Merges consecutive TCP segments of the same connection in the \a buffers
+	list, so that the protocols only have to process them once. The checksums
+	of merged segments have been verified; they are marked by having their
+	net_buffer::segment_size set to the size of the original segments.
+	The buffers that have been merged into others are removed from the list.
+*/
+void
+coalesce_segments(struct list* buffers)
+{
+	coalesced_segment current;
+	coalesced_segment next;
+	current.buffer = NULL;
+
+	net_buffer* buffer = (net_buffer*)list_get_first_item(buffers);
+	while (buffer != NULL) {
+		net_buffer* nextBuffer
+			= (net_buffer*)list_get_next_item(buffers, buffer);
+
+		if (!read_segment(buffer, next)) {
+			finish_segment(current);
+			current.buffer = NULL;
+			buffer = nextBuffer;
+			continue;
+		}
+
+		if (current.buffer == NULL || !is_next_segment(current, next)
+			|| !verify_segment(current) || !verify_segment(next)) {
+			finish_segment(current);
+			current = next;
+			buffer = nextBuffer;
+			continue;
+		}
+
+		net_buffer* first = current.buffer;
+		if (first->segment_size == 0)
+			first->segment_size = first->size - current.header_length;
+
+		list_remove_item(buffers, buffer);
+		size_t dataLength = buffer->size - next.header_length;
+
+		if (gNetBufferModule.remove_header(buffer, next.header_length) != B_OK
+			|| gNetBufferModule.merge(first, buffer, true) != B_OK) {
+			// the buffers are in an undefined state now, drop them both
+			TRACE("coalesce_segments(): merging %p into %p failed\n", buffer,
+				first);
+			list_remove_item(buffers, first);
+			gNetBufferModule.free(first);
+			gNetBufferModule.free(buffer);
+			current.buffer = NULL;
+			buffer = nextBuffer;
+			continue;
+		}
+
+		current.next_sequence = next.next_sequence;
+		current.closed = next.closed || dataLength < first->segment_size;
+
+		buffer = nextBuffer;
+	}
+
+	finish_segment(current);
+}
@@ -52,6 +52,10 @@ status_t notify_link_changed(net_device* device);
 status_t init_notifications();
 void uninit_notifications();
 
+// segmentation.cpp
+status_t segment_buffer(net_buffer* buffer, struct list* segments);
+void coalesce_segments(struct list* buffers);
+
 status_t init_stack();
 status_t uninit_stack();
 
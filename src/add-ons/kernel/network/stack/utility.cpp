@@ -425,6 +425,48 @@ fifo_dequeue_buffer(net_fifo* fifo, uint32 flags, bigtime_t timeout,
 }
 
 
+/*!	Removes up to \a maxCount buffers from the \a fifo at once, and adds them
+	to the \a buffers list. If the fifo is empty, it waits until at least one
+	buffer has been enqueued, or the \a timeout has passed.
+	Returns the number of buffers dequeued, or an error code.
+*/
+ssize_t
+fifo_dequeue_buffers(net_fifo* fifo, bigtime_t timeout, struct list* buffers,
+	size_t maxCount)
+{
+	MutexLocker locker(fifo->lock);
+
+	while (list_is_empty(&fifo->buffers)) {
+		if (timeout == 0)
+			return B_WOULD_BLOCK;
+
+		fifo->waiting++;
+		locker.Unlock();
+
+		status_t status = acquire_sem_etc(fifo->notify, 1,
+			B_CAN_INTERRUPT | B_RELATIVE_TIMEOUT, timeout);
+		if (status < B_OK)
+			return status;
+
+		locker.Lock();
+	}
+
+	ssize_t count = 0;
+	while ((size_t)count < maxCount) {
+		net_buffer* buffer
+			= (net_buffer*)list_remove_head_item(&fifo->buffers);
+		if (buffer == NULL)
+			break;
+
+		fifo->current_bytes -= buffer->size;
+		list_add_item(buffers, buffer);
+		count++;
+	}
+
+	return count;
+}
+
+
 status_t
 clear_fifo(net_fifo* fifo)
 {
@@ -57,6 +57,8 @@ void		uninit_fifo(net_fifo* fifo);
 status_t	fifo_enqueue_buffer(net_fifo* fifo, struct net_buffer* buffer);
 ssize_t		fifo_dequeue_buffer(net_fifo* fifo, uint32 flags, bigtime_t timeout,
 				struct net_buffer** _buffer);
+ssize_t		fifo_dequeue_buffers(net_fifo* fifo, bigtime_t timeout,
+				struct list* buffers, size_t maxCount);
 status_t	clear_fifo(net_fifo* fifo);
 status_t	fifo_socket_enqueue_buffer(net_fifo* fifo, net_socket* socket,
 				uint8 event, net_buffer* buffer);
@@ -25,6 +25,7 @@ const DataSource* kSources[] = {
 	new CachedMemoryDataSource(),
 	new SwapSpaceDataSource(),
 	new PageFaultsDataSource(),
+	new PageRefaultsDataSource(),
 	new CPUFrequencyDataSource(),
 	new CPUUsageDataSource(),
 	new CPUCombinedUsageDataSource(),
@@ -1331,6 +1332,114 @@ PageFaultsDataSource::Primary() const
 //	#pragma mark -
 
 
+PageRefaultsDataSource::PageRefaultsDataSource()
+	:
+	fPreviousRefaults(0),
+	fPreviousTime(0)
+{
+	SystemInfo info;
+	NextValue(info);
+
+	fMinimum = 0;
+	fMaximum = 1000000000LL;
+
+	fColor = (rgb_color){150, 0, 200, 0};
+}
+
+
+PageRefaultsDataSource::PageRefaultsDataSource(
+		const PageRefaultsDataSource& other)
+	: DataSource(other)
+{
+	fPreviousRefaults = other.fPreviousRefaults;
+	fPreviousTime = other.fPreviousTime;
+}
+
+
+PageRefaultsDataSource::~PageRefaultsDataSource()
+{
+}
+
+
+DataSource*
+PageRefaultsDataSource::Copy() const
+{
+	return new PageRefaultsDataSource(*this);
+}
+
+
+void
+PageRefaultsDataSource::Print(BString& text, int64 value) const
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), B_TRANSLATE("%.1f refaults/s"),
+		value / 1024.0);
+
+	text = buffer;
+}
+
+
+int64
+PageRefaultsDataSource::NextValue(SystemInfo& info)
+{
+	uint64 refaults = info.PageRefaults();
+
+	int64 refaultsPerSecond = uint64(1024
+		* double(refaults - fPreviousRefaults)
+		/ (info.Time() - fPreviousTime) * 1000000.0);
+
+	fPreviousRefaults = refaults;
+	fPreviousTime = info.Time();
+
+	return refaultsPerSecond;
+}
+
+
+const char*
+PageRefaultsDataSource::Label() const
+{
+	return B_TRANSLATE("Page refaults");
+}
+
+
+const char*
+PageRefaultsDataSource::ShortLabel() const
+{
+	return B_TRANSLATE("P-refaults");
+}
+
+
+const char*
+PageRefaultsDataSource::InternalName() const
+{
+	return "Page refaults";
+}
+
+
+const char*
+PageRefaultsDataSource::Name() const
+{
+	return B_TRANSLATE("Page refaults");
+}
+
+
+bool
+PageRefaultsDataSource::AdaptiveScale() const
+{
+	return true;
+}
+
+
+bool
+PageRefaultsDataSource::Primary() const
+{
+	return false;
+}
+
+
+//	#pragma mark -
+
+
 NetworkUsageDataSource::NetworkUsageDataSource(bool in)
 	:
 	fIn(in),
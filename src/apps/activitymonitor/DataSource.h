@@ -318,6 +318,31 @@ private:
 };
 
 
+class PageRefaultsDataSource : public DataSource {
+public:
+						PageRefaultsDataSource();
+						PageRefaultsDataSource(
+							const PageRefaultsDataSource& other);
+	virtual				~PageRefaultsDataSource();
+
+	virtual DataSource*	Copy() const;
+
+	virtual void		Print(BString& text, int64 value) const;
+	virtual	int64		NextValue(SystemInfo& info);
+
+	virtual const char*	InternalName() const;
+	virtual const char*	Name() const;
+	virtual const char*	Label() const;
+	virtual const char*	ShortLabel() const;
+	virtual bool		AdaptiveScale() const;
+	virtual bool		Primary() const;
+
+private:
+	uint64				fPreviousRefaults;
+	bigtime_t			fPreviousTime;
+};
+
+
 class NetworkUsageDataSource : public DataSource {
 public:
 						NetworkUsageDataSource(bool in);
@@ -9,12 +9,18 @@
 #include <NetworkInterface.h>
 #include <NetworkRoster.h>
 
+#ifdef __HAIKU__
+#	include <syscalls.h>
+#	include <working_set.h>
+#endif
+
 #include "SystemInfoHandler.h"
 
 
 SystemInfo::SystemInfo(SystemInfoHandler* handler)
 	:
 	fTime(system_time()),
+	fPageRefaults(0),
 	fRetrievedNetwork(false),
 	fRunningApps(0),
 	fClipboardSize(0),
@@ -27,6 +33,14 @@ SystemInfo::SystemInfo(SystemInfoHandler* handler)
 	fCPUInfos = new cpu_info[fSystemInfo.cpu_count];
 	get_cpu_info(0, fSystemInfo.cpu_count, fCPUInfos);
 
+#ifdef __HAIKU__
+	working_set_info workingSetInfo;
+	if (_kern_generic_syscall(WORKING_SET_SYSCALLS, GET_WORKING_SET_INFO,
+			&workingSetInfo, sizeof(workingSetInfo)) == B_OK) {
+		fPageRefaults = workingSetInfo.refaults;
+	}
+#endif
+
 	if (handler != NULL) {
 		fRunningApps = handler->RunningApps();
 		fClipboardSize = handler->ClipboardSize();
@@ -83,6 +97,13 @@ SystemInfo::PageFaults() const
 }
 
 
+uint64
+SystemInfo::PageRefaults() const
+{
+	return fPageRefaults;
+}
+
+
 uint64
 SystemInfo::UsedSwapSpace() const
 {
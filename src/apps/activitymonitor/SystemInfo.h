@@ -25,6 +25,7 @@ public:
 			uint64		MaxMemory() const;
 
 			uint32		PageFaults() const;
+			uint64		PageRefaults() const;
 
 			uint64		MaxSwapSpace() const;
 			uint64		UsedSwapSpace() const;
@@ -68,6 +69,7 @@ private:
 	system_info			fSystemInfo;
 	cpu_info*			fCPUInfos;
 	bigtime_t			fTime;
+	uint64				fPageRefaults;
 	bool				fRetrievedNetwork;
 	uint64				fBytesReceived;
 	uint64				fBytesSent;
@@ -9,16 +9,20 @@
 #include "PoorManServer.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <new>
 #include <pthread.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h> //for struct timeval
+#include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <poll.h>
+#include <unistd.h>
 
-#include <File.h>
+#include <AutoDeleter.h>
 #include <Debug.h>
 #include <OS.h>
 #include <String.h>
@@ -388,17 +392,12 @@ status_t PoorManServer::_HandleGet(httpd_conn* hc)
 {
 	PRINT(("HandleGet() called\n"));
 
-	ssize_t bytesRead;
-	uint8* buf;
 	BString log;
 
-	BFile file(hc->expnfilename, B_READ_ONLY);
-	if (file.InitCheck() != B_OK)
-		return B_ERROR;
-
-	buf = new uint8[POOR_MAN_BUF_SIZE];
-	if (buf == NULL)
+	int fd = open(hc->expnfilename, O_RDONLY);
+	if (fd < 0)
 		return B_ERROR;
+	FileDescriptorCloser fdCloser(fd);
 	
 	static_cast<PoorManApplication*>(be_app)->GetPoorManWindow()->SetHits(
 		static_cast<PoorManApplication*>(be_app)->
@@ -413,35 +412,54 @@ status_t PoorManServer::_HandleGet(httpd_conn* hc)
 	poorman_log(log.String(), true, &hc->client_addr);
 	
 	//send mime headers
-	if (send(hc->conn_fd, hc->response, hc->responselen, 0) < 0) {
-		delete [] buf;
+	if (send(hc->conn_fd, hc->response, hc->responselen, 0) < 0)
+		return B_ERROR;
+	
+	if (_SendFileData(hc->conn_fd, fd, hc->first_byte_index) != B_OK) {
+		log.SetTo("Error sending file: ");
+		if (pthread_rwlock_rdlock(&fWebDirLock) == 0) {
+			log << hc->hs->cwd;
+			pthread_rwlock_unlock(&fWebDirLock);
+		}
+		log << '/' << hc->expnfilename << '\n';
+		poorman_log(log.String(), true, &hc->client_addr, RED);
 		return B_ERROR;
 	}
 	
-	file.Seek(hc->first_byte_index, SEEK_SET);
+	return B_OK;
+}
+
+
+/*!	Sends the file \a fd from \a offset to its end. The kernel passes the
+	data on from the file cache directly; only if that is not possible, it
+	is copied through a buffer.
+*/
+status_t PoorManServer::_SendFileData(int socket, int fd, off_t offset)
+{
+	off_t startOffset = offset;
+	ssize_t bytesSent;
+	while ((bytesSent = sendfile(socket, fd, &offset, POOR_MAN_BUF_SIZE)) > 0)
+		;
+	if (bytesSent == 0)
+		return B_OK;
+	if (offset != startOffset)
+		return B_ERROR;
+
+	uint8* buf = new(std::nothrow) uint8[POOR_MAN_BUF_SIZE];
+	if (buf == NULL)
+		return B_NO_MEMORY;
+	ArrayDeleter<uint8> bufDeleter(buf);
+
 	while (true) {
-		bytesRead = file.Read(buf, POOR_MAN_BUF_SIZE);
+		ssize_t bytesRead = pread(fd, buf, POOR_MAN_BUF_SIZE, offset);
 		if (bytesRead == 0)
-			break;
-		else if (bytesRead < 0) {
-			delete [] buf;
+			return B_OK;
+		if (bytesRead < 0)
 			return B_ERROR;
-		}
-		if (send(hc->conn_fd, (void*)buf, bytesRead, 0) < 0) {
-			log.SetTo("Error sending file: ");
-			if (pthread_rwlock_rdlock(&fWebDirLock) == 0) {
-				log << hc->hs->cwd;
-				pthread_rwlock_unlock(&fWebDirLock);
-			}
-			log << '/' << hc->expnfilename << '\n';
-			poorman_log(log.String(), true, &hc->client_addr, RED);
-			delete [] buf;
+		if (send(socket, buf, bytesRead, 0) < 0)
 			return B_ERROR;
-		}
+		offset += bytesRead;
 	}
-	
-	delete [] buf;
-	return B_OK;
 }
 
 
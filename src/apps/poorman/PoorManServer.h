@@ -59,6 +59,7 @@ private:
 			status_t   _HandleGet(httpd_conn* hc);
 			status_t   _HandleHead(httpd_conn* hc);
 			status_t   _HandlePost(httpd_conn* hc);
+			status_t   _SendFileData(int socket, int fd, off_t offset);
 };
 #endif
 
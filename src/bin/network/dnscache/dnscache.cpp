@@ -0,0 +1,244 @@
+/*
+ * Copyright 2026 Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include "Definitions.h"
+
+
+extern const char* __progname;
+static const char* kProgramName = __progname;
+
+static const bigtime_t kTimeout = 30000000LL;
+
+
+static void
+usage(int status)
+{
+	printf("Usage: %s [stats]\n"
+		"       %s flush\n"
+		"       %s lookup <host> [...]\n\n"
+		"Shows the statistics of the DNS cache of the dns_resolver_server, "
+		"flushes it,\nor resolves host names through it.\n",
+		kProgramName, kProgramName, kProgramName);
+	exit(status);
+}
+
+
+/*!	Sends a request to the dns_resolver_server, and waits for its reply.
+	The caller needs to free the returned \a _reply buffer.
+*/
+static status_t
+send_request(int32 code, const void* data, size_t size, int32& _replyCode,
+	void** _reply, size_t& _replySize)
+{
+	port_id requestPort = find_port(kPortNameReq);
+	if (requestPort < 0)
+		return requestPort;
+
+	port_id replyPort = create_port(1, "dnscache reply");
+	if (replyPort < 0)
+		return replyPort;
+
+	char* request = (char*)malloc(sizeof(port_id) + size);
+	if (request == NULL) {
+		delete_port(replyPort);
+		return B_NO_MEMORY;
+	}
+
+	memcpy(request, &replyPort, sizeof(port_id));
+	if (size > 0)
+		memcpy(request + sizeof(port_id), data, size);
+
+	status_t status = write_port_etc(requestPort, code, request,
+		sizeof(port_id) + size, B_RELATIVE_TIMEOUT, kTimeout);
+	free(request);
+
+	ssize_t replySize = status;
+	if (status == B_OK) {
+		replySize = port_buffer_size_etc(replyPort, B_RELATIVE_TIMEOUT,
+			kTimeout);
+	}
+	if (replySize < 0) {
+		delete_port(replyPort);
+		return replySize;
+	}
+
+	void* reply = malloc(replySize > 0 ? replySize : 1);
+	if (reply == NULL) {
+		delete_port(replyPort);
+		return B_NO_MEMORY;
+	}
+
+	replySize = read_port(replyPort, &_replyCode, reply, replySize);
+	delete_port(replyPort);
+
+	if (replySize < 0) {
+		free(reply);
+		return replySize;
+	}
+
+	*_reply = reply;
+	_replySize = replySize;
+	return B_OK;
+}
+
+
+static void
+show_statistics()
+{
+	int32 code;
+	void* reply;
+	size_t size;
+	status_t status = send_request(MsgGetStatistics, NULL, 0, code, &reply,
+		size);
+	if (status != B_OK) {
+		fprintf(stderr, "%s: Could not get statistics: %s\n", kProgramName,
+			strerror(status));
+		exit(1);
+	}
+	if (code != MsgReply || size < sizeof(dns_resolver_statistics)) {
+		fprintf(stderr, "%s: Invalid reply from the server\n", kProgramName);
+		exit(1);
+	}
+
+	dns_resolver_statistics& statistics = *(dns_resolver_statistics*)reply;
+	uint64 cachable = statistics.hits + statistics.negative_hits
+		+ statistics.misses;
+
+	printf("entries:       %" B_PRIu32 " of %" B_PRIu32 "\n",
+		statistics.entries, statistics.max_entries);
+	printf("requests:      %" B_PRIu64 "\n", statistics.requests);
+	printf("hits:          %" B_PRIu64 " (%.1f%%)\n", statistics.hits,
+		cachable > 0 ? 100.0 * statistics.hits / cachable : 0.0);
+	printf("negative hits: %" B_PRIu64 "\n", statistics.negative_hits);
+	printf("misses:        %" B_PRIu64 "\n", statistics.misses);
+	printf("uncached:      %" B_PRIu64 "\n", statistics.uncached);
+	printf("waits:         %" B_PRIu64 "\n", statistics.waits);
+	printf("refreshes:     %" B_PRIu64 "\n", statistics.refreshes);
+	printf("evictions:     %" B_PRIu64 "\n", statistics.evictions);
+
+	free(reply);
+}
+
+
+static void
+flush_cache()
+{
+	int32 code;
+	void* reply;
+	size_t size;
+	status_t status = send_request(MsgFlushCache, NULL, 0, code, &reply,
+		size);
+	if (status != B_OK) {
+		fprintf(stderr, "%s: Could not flush the cache: %s\n", kProgramName,
+			strerror(status));
+		exit(1);
+	}
+
+	free(reply);
+}
+
+
+static bool
+lookup(const char* host)
+{
+	// Build the request the same way the kernel add-on does
+	size_t hostSize = strlen(host) + 1;
+	size_t size = hostSize + 1 + sizeof(addrinfo);
+	char* request = (char*)calloc(1, size);
+	if (request == NULL)
+		return false;
+
+	strcpy(request, host);
+	addrinfo* hints = (addrinfo*)(request + hostSize + 1);
+	hints->ai_family = AF_UNSPEC;
+	hints->ai_socktype = SOCK_STREAM;
+
+	bigtime_t start = system_time();
+
+	int32 code;
+	void* reply;
+	size_t replySize;
+	status_t status = send_request(MsgGetAddrInfoWithPort, request, size,
+		code, &reply, replySize);
+	free(request);
+
+	bigtime_t elapsed = system_time() - start;
+
+	if (status != B_OK) {
+		fprintf(stderr, "%s: %s: %s\n", kProgramName, host, strerror(status));
+		return false;
+	}
+	if (code == MsgError) {
+		printf("%s: %s (%" B_PRId64 " us)\n", host,
+			gai_strerror(*(status_t*)reply), elapsed);
+		free(reply);
+		return false;
+	}
+
+	printf("%s (%" B_PRId64 " us):\n", host, elapsed);
+
+	// The addresses are relative to the start of the reply
+	char* base = (char*)reply;
+	for (size_t offset = 0; offset < replySize;) {
+		addrinfo* info = (addrinfo*)(base + offset);
+		if (info->ai_addr != NULL) {
+			sockaddr* address = (sockaddr*)(base + (addr_t)info->ai_addr);
+			char buffer[INET6_ADDRSTRLEN];
+			const void* data = address->sa_family == AF_INET6
+				? (const void*)&((sockaddr_in6*)address)->sin6_addr
+				: (const void*)&((sockaddr_in*)address)->sin_addr;
+			if (inet_ntop(address->sa_family, data, buffer,
+					sizeof(buffer)) != NULL)
+				printf("\t%s\n", buffer);
+		}
+
+		if (info->ai_next == NULL)
+			break;
+		offset = (addr_t)info->ai_next;
+	}
+
+	free(reply);
+	return true;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc < 2 || !strcmp(argv[1], "stats")) {
+		show_statistics();
+		return 0;
+	}
+
+	if (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))
+		usage(0);
+
+	if (!strcmp(argv[1], "flush") || !strcmp(argv[1], "-f")) {
+		flush_cache();
+		return 0;
+	}
+
+	if (!strcmp(argv[1], "lookup") && argc > 2) {
+		bool ok = true;
+		for (int i = 2; i < argc; i++)
+			ok &= lookup(argv[i]);
+		return ok ? 0 : 1;
+	}
+
+	usage(1);
+	return 1;
+}
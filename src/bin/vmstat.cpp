@@ -9,7 +9,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <compressed_swap.h>
+#include <syscalls.h>
 #include <system_info.h>
+#include <working_set.h>
 
 
 static struct option const kLongOptions[] = {
@@ -85,6 +88,42 @@ main(int argc, char** argv)
 		info.free_swap_pages * B_PAGE_SIZE);
 	printf("page faults:\t\t%" B_PRIu32 "\n", info.page_faults);
 
+	compressed_swap_info compressedInfo;
+	if (_kern_generic_syscall(COMPRESSED_SWAP_SYSCALLS,
+			GET_COMPRESSED_SWAP_INFO, &compressedInfo,
+			sizeof(compressedInfo)) == B_OK
+		&& compressedInfo.max_size > 0) {
+		printf("max compressed swap:\t%" B_PRIu64 "\n",
+			compressedInfo.max_size);
+		printf("used compressed swap:\t%" B_PRIu64 "\n",
+			compressedInfo.used_size);
+		printf("compressed pages:\t%" B_PRIu64 "\n",
+			compressedInfo.stored_pages);
+		if (compressedInfo.used_size > 0) {
+			printf("compression ratio:\t%.2f\n",
+				(double)compressedInfo.stored_pages * B_PAGE_SIZE
+					/ compressedInfo.used_size);
+		}
+		printf("compressed stores:\t%" B_PRIu64 "\n", compressedInfo.stores);
+		printf("compressed loads:\t%" B_PRIu64 "\n", compressedInfo.loads);
+		printf("compression rejects:\t%" B_PRIu64 "\n",
+			compressedInfo.rejects);
+		printf("compressed overflows:\t%" B_PRIu64 "\n",
+			compressedInfo.overflows);
+	}
+
+	working_set_info workingSetInfo;
+	if (_kern_generic_syscall(WORKING_SET_SYSCALLS, GET_WORKING_SET_INFO,
+			&workingSetInfo, sizeof(workingSetInfo)) == B_OK) {
+		printf("evicted pages:\t\t%" B_PRIu64 "\n",
+			workingSetInfo.evicted_pages);
+		printf("page refaults:\t\t%" B_PRIu64 "\n", workingSetInfo.refaults);
+		printf("working set refaults:\t%" B_PRIu64 "\n",
+			workingSetInfo.activations);
+		printf("streaming pages:\t%" B_PRIu64 "\n",
+			workingSetInfo.streaming_pages);
+	}
+
 	if (periodically) {
 		puts("\npage faults  used memory    used swap  block cache");
 		system_info lastInfo = info;
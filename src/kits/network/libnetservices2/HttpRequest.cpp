@@ -487,15 +487,14 @@ BHttpRequest::SerializeHeaderTo(HttpBuffer& buffer) const
 			host << ':' << fData->url.Port();
 
 		outputFields.AddFields({
-			{"Host"sv, std::string_view(host.String())}, {"Accept-Encoding"sv, "gzip"sv},
+			{"Host"sv, std::string_view(host.String())}, {"Accept-Encoding"sv, "gzip"sv}
 			// Allows the server to compress data using the "gzip" format.
 			// "deflate" is not supported, because there are two interpretations
 			// of what it means (the RFC and Microsoft products), and we don't
 			// want to handle this. Very few websites support only deflate,
 			// and most of them will send gzip, or at worst, uncompressed data.
-			{"Connection"sv, "close"sv}
-			// Let the remote server close the connection after response since
-			// we don't handle multiple request on a single connection
+			// There is no "Connection" field: HTTP/1.1 connections are persistent by default,
+			// and BHttpSession keeps them open for later requests to the same host.
 		});
 	}
 
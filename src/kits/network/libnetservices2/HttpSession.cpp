@@ -14,6 +14,9 @@
 #include <optional>
 #include <vector>
 
+#include <errno.h>
+#include <sys/socket.h>
+
 #include <AutoLocker.h>
 #include <DataIO.h>
 #include <ErrorsExt.h>
@@ -55,6 +58,46 @@ struct CounterDeleter {
 };
 
 
+/*!
+	\brief A connection to a host that can be shared by several requests.
+
+	The socket and the receive buffer belong to the connection rather than to the request, so that
+	the connection can be kept open after a request is finished, and so that data of pipelined
+	responses that has already been read remains available for the next request.
+
+	The public members are shared between the control and the data thread, and are protected by
+	the lock of the session.
+*/
+class BHttpSession::Connection
+{
+public:
+	Connection(std::pair<BString, int> host, std::unique_ptr<BSocket> socket,
+		std::unique_ptr<int32, CounterDeleter> counter) noexcept;
+
+	const std::pair<BString, int>& Host() const noexcept { return fHost; }
+	int Socket() const noexcept { return fSocket->Socket(); }
+	BDataIO* Stream() const noexcept { return fSocket.get(); }
+	HttpBuffer& Buffer() noexcept { return fBuffer; }
+	bool IsAlive() const noexcept;
+
+	size_t pendingRequests = 0;
+		// requests that are assigned to the connection, and not finished yet
+	size_t totalRequests = 0;
+	bool persistent = false;
+		// the server has kept the connection open after a response
+	bool pipelinable = true;
+		// all pending requests may be pipelined
+	bool closed = false;
+	bigtime_t idleSince = 0;
+
+private:
+	std::pair<BString, int> fHost;
+	std::unique_ptr<BSocket> fSocket;
+	HttpBuffer fBuffer;
+	std::unique_ptr<int32, CounterDeleter> fConnectionCounter;
+};
+
+
 class BHttpSession::Request
 {
 public:
@@ -74,15 +117,25 @@ public:
 	std::pair<BString, int> GetHost() const;
 	void SetCounter(int32* counter) noexcept;
 
+	// Helpers for sharing connections
+	std::shared_ptr<Connection> GetConnection() const noexcept { return fConnection; }
+	void SetConnection(std::shared_ptr<Connection> connection) noexcept;
+	void ResetConnection(bool retry) noexcept;
+	bool IsPipelinable() const noexcept;
+	bool CanRetry() const noexcept;
+	bool KeepAlive() const noexcept { return fKeepAlive && fRequestStatus == ContentReceived; }
+	bool SendStarted() const noexcept { return fSerializer.IsInitialized(); }
+	bool IsCanceled() const noexcept { return fCanceled; }
+	void SetCanceled() noexcept { fCanceled = true; }
+
 	// Operational methods
 	void ResolveHostName();
 	void OpenConnection();
 	void TransferRequest();
-	bool ReceiveResult();
-	void Disconnect() noexcept;
+	bool ReceiveResult(bool fromBuffer = false);
 
 	// Object information
-	int Socket() const noexcept { return fSocket->Socket(); }
+	int Socket() const noexcept { return fConnection->Socket(); }
 	int32 Id() const noexcept { return fResult->id; }
 	bool CanCancel() const noexcept { return fResult->CanCancel(); }
 
@@ -101,7 +154,10 @@ private:
 
 	// Connection
 	BNetworkAddress fRemoteAddress;
-	std::unique_ptr<BSocket> fSocket;
+	std::shared_ptr<Connection> fConnection;
+	bool fReused = false;
+	bool fRetried = false;
+	bool fCanceled = false;
 
 	// Sending and receiving
 	HttpBuffer fBuffer;
@@ -111,6 +167,8 @@ private:
 	// Receive state
 	BHttpStatus fStatus;
 	BHttpFields fFields;
+	bool fResponseStarted = false;
+	bool fKeepAlive = false;
 
 	// Redirection
 	bool fMightRedirect = false;
@@ -131,14 +189,32 @@ public:
 	void Cancel(int32 identifier);
 	void SetMaxConnectionsPerHost(size_t maxConnections);
 	void SetMaxHosts(size_t maxConnections);
+	void SetMaxPipelinedRequests(size_t maxRequests);
+	void SetIdleTimeout(bigtime_t timeout);
 
 private:
+	struct ConnectionRequests {
+		std::shared_ptr<Connection> connection;
+		std::deque<BHttpSession::Request> requests;
+			// in the order they are sent; the first one receives the next response
+	};
+
 		// Thread functions
 	static status_t ControlThreadFunc(void* arg);
 	static status_t DataThreadFunc(void* arg);
 
 	// Helper functions
 	std::vector<BHttpSession::Request> GetRequestsForControlThread();
+	void AssignConnection(Request& request, std::shared_ptr<Connection> connection);
+	std::shared_ptr<Connection> TakeIdleConnection(const std::pair<BString, int>& host);
+	std::shared_ptr<Connection> FindPipelineConnection(const std::pair<BString, int>& host);
+	bool CloseIdleConnections(bigtime_t idleBefore);
+	bigtime_t IdleConnectionTimeout();
+	void AddToConnection(BHttpSession::Request&& request);
+	bool CancelRequest(ConnectionRequests& connection, int32 identifier);
+	bool ProcessConnection(ConnectionRequests& connection, uint16 events);
+	bool FinishRequest(ConnectionRequests& connection);
+	void CloseConnection(ConnectionRequests& connection, std::exception_ptr error);
 
 private:
 		// constants (can be accessed unlocked)
@@ -160,12 +236,18 @@ private:
 	using Host = std::pair<BString, int>;
 	std::map<Host, int32> fConnectionCount;
 
+	// open connections; idle ones are kept in the order they became idle (protected by fLock).
+	// These refer to fConnectionCount, so they must be destroyed before it.
+	std::list<std::shared_ptr<Connection>> fConnections;
+
 	// data that can only be accessed atomically
 	std::atomic<size_t> fMaxConnectionsPerHost = 2;
 	std::atomic<size_t> fMaxHosts = 10;
+	std::atomic<size_t> fMaxPipelinedRequests = 4;
+	std::atomic<bigtime_t> fIdleTimeout = 5000000;
 
 	// data owned by the dataThread
-	std::map<int, BHttpSession::Request> connectionMap;
+	std::map<int, ConnectionRequests> connectionMap;
 	std::vector<object_wait_info> objectList;
 };
 
@@ -272,16 +354,40 @@ BHttpSession::Impl::SetMaxHosts(size_t maxConnections)
 }
 
 
+void
+BHttpSession::Impl::SetMaxPipelinedRequests(size_t maxRequests)
+{
+	if (maxRequests <= 0)
+		throw BRuntimeError(__PRETTY_FUNCTION__, "MaxPipelinedRequests must be 1 or more");
+	fMaxPipelinedRequests.store(maxRequests, std::memory_order_relaxed);
+}
+
+
+void
+BHttpSession::Impl::SetIdleTimeout(bigtime_t timeout)
+{
+	if (timeout < 0)
+		throw BRuntimeError(__PRETTY_FUNCTION__, "IdleTimeout cannot be negative");
+	fIdleTimeout.store(timeout, std::memory_order_relaxed);
+
+	// wake up the control thread to apply the new timeout
+	release_sem(fControlQueueSem);
+}
+
+
 /*static*/ status_t
 BHttpSession::Impl::ControlThreadFunc(void* arg)
 {
 	BHttpSession::Impl* impl = static_cast<BHttpSession::Impl*>(arg);
 
-	// Outer loop to use the fControlQueueSem when new items have entered the queue
+	// Outer loop to use the fControlQueueSem when new items have entered the queue, or to close
+	// connections that have been idle for too long
 	while (true) {
-		if (auto status = acquire_sem(impl->fControlQueueSem); status == B_INTERRUPTED)
+		auto status = acquire_sem_etc(
+			impl->fControlQueueSem, 1, B_RELATIVE_TIMEOUT, impl->IdleConnectionTimeout());
+		if (status == B_INTERRUPTED)
 			continue;
-		else if (status != B_OK) {
+		else if (status != B_OK && status != B_TIMED_OUT) {
 			// Most likely B_BAD_SEM_ID indicating that the sem was deleted; go to cleanup
 			break;
 		}
@@ -314,7 +420,9 @@ BHttpSession::Impl::ControlThreadFunc(void* arg)
 			}
 
 			impl->fLock.Lock();
-			impl->fDataQueue.push_back(std::move(request));
+			auto connection = request.GetConnection();
+			impl->fConnections.push_back(connection);
+			impl->AssignConnection(request, connection);
 			impl->fLock.Unlock();
 			release_sem(impl->fDataQueueSem);
 		}
@@ -343,9 +451,6 @@ BHttpSession::Impl::ControlThreadFunc(void* arg)
 }
 
 
-static constexpr uint16 EVENT_CANCELLED = 0x4000;
-
-
 /*static*/ status_t
 BHttpSession::Impl::DataThreadFunc(void* arg)
 {
@@ -382,25 +487,24 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 				auto request = std::move(data->fDataQueue.front());
 				data->fDataQueue.pop_front();
 				auto socket = request.Socket();
-
-				data->connectionMap.insert(std::make_pair(socket, std::move(request)));
-
-				// Add to objectList
-				data->objectList.push_back(
-					object_wait_info{socket, B_OBJECT_TYPE_FD, B_EVENT_WRITE});
+				data->AddToConnection(std::move(request));
+
+				// Try to write the new request right away
+				auto item = std::find_if(data->objectList.begin() + 1, data->objectList.end(),
+					[socket](const auto& item) { return item.object == socket; });
+				if (item != data->objectList.end())
+					item->events |= B_EVENT_WRITE;
+				else {
+					data->objectList.push_back(
+						object_wait_info{socket, B_OBJECT_TYPE_FD, B_EVENT_WRITE});
+				}
 			}
 
 			for (auto id: data->fCancelList) {
-				// To cancel, we set a special event status on the
-				// object_wait_info list so that we can handle it below.
-				// Also: the first item in the waitlist is always the semaphore
-				// so the fun starts at offset 1.
-				size_t offset = 0;
-				for (auto it = data->connectionMap.cbegin(); it != data->connectionMap.cend();
-					it++) {
-					offset++;
-					if (it->second.Id() == id) {
-						data->objectList[offset].events = EVENT_CANCELLED;
+				for (auto it = data->connectionMap.begin(); it != data->connectionMap.end(); it++) {
+					if (data->CancelRequest(it->second, id)) {
+						if (it->second.connection->closed || it->second.connection->idleSince != 0)
+							data->connectionMap.erase(it);
 						break;
 					}
 				}
@@ -413,108 +517,51 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 		}
 
 		// Process all objects that are ready
-		bool resizeObjectList = false;
 		for (auto& item: data->objectList) {
-			if (item.type != B_OBJECT_TYPE_FD)
+			if (item.type != B_OBJECT_TYPE_FD || item.events == 0)
 				continue;
-			if ((item.events & B_EVENT_WRITE) == B_EVENT_WRITE) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				auto error = false;
-				try {
-					request.TransferRequest();
-				} catch (...) {
-					request.SetError(std::current_exception());
-					error = true;
-				}
-
-				// End failed writes
-				if (error) {
-					request.Disconnect();
-					data->connectionMap.erase(item.object);
-					release_sem(data->fControlQueueSem);
-						// wake up control thread; there may queued requests unblocked.
-					resizeObjectList = true;
-				}
-			} else if ((item.events & B_EVENT_READ) == B_EVENT_READ) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				auto finished = false;
-				try {
-					if (request.CanCancel())
-						finished = true;
-					else
-						finished = request.ReceiveResult();
-				} catch (const Redirect& r) {
-					// Request is redirected, send back to the controlThread
-					// Move existing request into a new request and hand over to the control queue
-					auto lock = AutoLocker<BLocker>(data->fLock);
-					data->fControlQueue.emplace_back(request, r);
-					release_sem(data->fControlQueueSem);
 
-					finished = true;
-				} catch (...) {
-					request.SetError(std::current_exception());
-					finished = true;
-				}
+			auto it = data->connectionMap.find(item.object);
+			if (it == data->connectionMap.end()) {
+				// The connection was closed while handling another event
+				continue;
+			}
 
-				if (finished) {
-					// Clean up finished requests; including redirected requests
-					request.Disconnect();
-					data->connectionMap.erase(item.object);
-					release_sem(data->fControlQueueSem);
-						// wake up control thread; there may queued requests unblocked.
-					resizeObjectList = true;
-				}
-			} else if ((item.events & B_EVENT_DISCONNECTED) == B_EVENT_DISCONNECTED) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				try {
-					throw BNetworkRequestError(
-						__PRETTY_FUNCTION__, BNetworkRequestError::NetworkError);
-				} catch (...) {
-					request.SetError(std::current_exception());
-				}
-				data->connectionMap.erase(item.object);
-				resizeObjectList = true;
-			} else if ((item.events & EVENT_CANCELLED) == EVENT_CANCELLED) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				request.Disconnect();
-				try {
-					throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
-				} catch (...) {
-					request.SetError(std::current_exception());
+			if ((item.events & B_EVENT_INVALID) == B_EVENT_INVALID) {
+				// This should not happen
+				for (auto& request: it->second.requests) {
+					request.SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
+						msg.AddUInt32(UrlEventData::DebugType, UrlEventData::DebugError);
+						msg.AddString(
+							UrlEventData::DebugMessage, "Unexpected event; socket deleted?");
+					});
 				}
-				data->connectionMap.erase(item.object);
-				release_sem(data->fControlQueueSem);
-					// wake up control thread; there may queued requests unblocked.
-				resizeObjectList = true;
-			} else if (item.events == 0) {
-				// No events for this item, skip
-				continue;
-			} else {
-				// Likely to be B_EVENT_INVALID. This should not happen
-				auto& request = data->connectionMap.find(item.object)->second;
-				request.SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
-					msg.AddUInt32(UrlEventData::DebugType, UrlEventData::DebugError);
-					msg.AddString(UrlEventData::DebugMessage, "Unexpected event; socket deleted?");
-				});
 				throw BRuntimeError(
 					__PRETTY_FUNCTION__, "Socket was deleted at an unexpected time");
 			}
+
+			if (!data->ProcessConnection(it->second, item.events))
+				data->connectionMap.erase(it);
 		}
 
 		// Reset objectList
 		data->objectList[0].events = B_EVENT_ACQUIRE_SEMAPHORE;
-		if (resizeObjectList)
-			data->objectList.resize(data->connectionMap.size() + 1);
+		data->objectList.resize(data->connectionMap.size() + 1);
 
 		auto i = 1;
 		for (auto it = data->connectionMap.cbegin(); it != data->connectionMap.cend(); it++) {
-			data->objectList[i].object = it->first;
-			if (it->second.State() == Request::InitialState)
-				throw BRuntimeError(__PRETTY_FUNCTION__, "Invalid state of request");
-			else if (it->second.State() == Request::Connected)
-				data->objectList[i].events = B_EVENT_WRITE | B_EVENT_DISCONNECTED;
-			else
-				data->objectList[i].events = B_EVENT_READ | B_EVENT_DISCONNECTED;
+			uint16 events = B_EVENT_DISCONNECTED;
+			for (const auto& request: it->second.requests) {
+				if (request.State() == Request::InitialState)
+					throw BRuntimeError(__PRETTY_FUNCTION__, "Invalid state of request");
+				else if (request.State() == Request::Connected)
+					events |= B_EVENT_WRITE;
+			}
+			if (!it->second.requests.empty()
+				&& it->second.requests.front().State() == Request::RequestSent)
+				events |= B_EVENT_READ;
+
+			data->objectList[i] = object_wait_info{it->first, B_OBJECT_TYPE_FD, events};
 			i++;
 		}
 	}
@@ -522,10 +569,12 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 	if (data->fQuitting.load()) {
 		// Cancel all requests
 		for (auto it = data->connectionMap.begin(); it != data->connectionMap.end(); it++) {
-			try {
-				throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
-			} catch (...) {
-				it->second.SetError(std::current_exception());
+			for (auto& request: it->second.requests) {
+				try {
+					throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
+				} catch (...) {
+					request.SetError(std::current_exception());
+				}
 			}
 		}
 	} else {
@@ -540,6 +589,9 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 	\brief Internal helper that filters the lists of requests to guard against the concurrent
 		requests limit.
 
+	Requests that can reuse an idle connection, or that can be pipelined on a busy connection,
+	are handed to the data thread directly. The returned requests need a new connection.
+
 	This method will do the locking of the internal structure.
 */
 std::vector<BHttpSession::Request>
@@ -547,6 +599,11 @@ BHttpSession::Impl::GetRequestsForControlThread()
 {
 	std::vector<BHttpSession::Request> requests;
 
+	auto lock = AutoLocker<BLocker>(fLock);
+
+	// Close the connections that have been idle for too long
+	CloseIdleConnections(system_time() - fIdleTimeout.load(std::memory_order_relaxed));
+
 	// Clean up connection list if it is at the max number of hosts
 	if (fConnectionCount.size() >= fMaxHosts.load()) {
 		for (auto it = fConnectionCount.begin(); it != fConnectionCount.end();) {
@@ -559,13 +616,25 @@ BHttpSession::Impl::GetRequestsForControlThread()
 	}
 
 	// Process the list of pending requests and review if they can be started.
-	auto lock = AutoLocker<BLocker>(fLock);
-	fControlQueue.remove_if([this, &requests](auto& request) {
+	bool dataQueued = false;
+	fControlQueue.remove_if([this, &requests, &dataQueued](auto& request) {
 		auto host = request.GetHost();
+		if (auto connection = TakeIdleConnection(host)) {
+			AssignConnection(request, connection);
+			dataQueued = true;
+			return true;
+		}
+
 		auto it = fConnectionCount.find(host);
 		if (it != fConnectionCount.end()) {
 			if (static_cast<size_t>(atomic_get(std::addressof(it->second)))
 				>= fMaxConnectionsPerHost.load(std::memory_order_relaxed)) {
+				if (auto connection = FindPipelineConnection(host);
+					connection && request.IsPipelinable()) {
+					AssignConnection(request, connection);
+					dataQueued = true;
+					return true;
+				}
 				request.SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
 					msg.AddUInt32(UrlEventData::DebugType, UrlEventData::DebugWarning);
 					msg.AddString(UrlEventData::DebugMessage,
@@ -578,6 +647,10 @@ BHttpSession::Impl::GetRequestsForControlThread()
 			}
 		} else {
 			if (fConnectionCount.size() == fMaxHosts.load()) {
+				// Make room by closing the idle connections; the host count is cleaned up in the
+				// next round
+				if (CloseIdleConnections(B_INFINITE_TIMEOUT))
+					release_sem(fControlQueueSem);
 				request.SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
 					msg.AddUInt32(UrlEventData::DebugType, UrlEventData::DebugWarning);
 					msg.AddString(UrlEventData::DebugMessage,
@@ -594,10 +667,375 @@ BHttpSession::Impl::GetRequestsForControlThread()
 		requests.emplace_back(std::move(request));
 		return true;
 	});
+
+	if (dataQueued)
+		release_sem(fDataQueueSem);
+
 	return requests;
 }
 
 
+/*!
+	\brief Assign \a connection to the \a request, and move the request to the data queue.
+
+	The caller must hold the lock.
+*/
+void
+BHttpSession::Impl::AssignConnection(Request& request, std::shared_ptr<Connection> connection)
+{
+	request.SetConnection(connection);
+	connection->pendingRequests++;
+	connection->totalRequests++;
+	connection->idleSince = 0;
+	if (!request.IsPipelinable())
+		connection->pipelinable = false;
+
+	fDataQueue.push_back(std::move(request));
+}
+
+
+/*!
+	\brief Take the most recently used idle connection to \a host out of the pool.
+
+	Connections that were closed by the server in the mean time are dropped. The caller must hold
+	the lock.
+*/
+std::shared_ptr<BHttpSession::Connection>
+BHttpSession::Impl::TakeIdleConnection(const std::pair<BString, int>& host)
+{
+	for (auto it = fConnections.rbegin(); it != fConnections.rend();) {
+		auto& connection = *it;
+		if (connection->idleSince == 0 || connection->Host() != host) {
+			it++;
+			continue;
+		}
+
+		if (!connection->IsAlive()) {
+			connection->closed = true;
+			it = decltype(it)(fConnections.erase(std::next(it).base()));
+			continue;
+		}
+
+		return connection;
+	}
+
+	return nullptr;
+}
+
+
+/*!
+	\brief Find a busy connection to \a host that a request can be pipelined on.
+
+	Only connections where the server has kept the connection open after a previous response, and
+	where all the pending requests can be safely repeated, are used. The connection with the fewest
+	pending requests is chosen. The caller must hold the lock.
+*/
+std::shared_ptr<BHttpSession::Connection>
+BHttpSession::Impl::FindPipelineConnection(const std::pair<BString, int>& host)
+{
+	auto maxRequests = fMaxPipelinedRequests.load(std::memory_order_relaxed);
+	std::shared_ptr<Connection> result;
+	for (auto& connection: fConnections) {
+		if (connection->Host() != host || connection->closed || !connection->persistent
+			|| !connection->pipelinable || connection->pendingRequests >= maxRequests)
+			continue;
+		if (!result || connection->pendingRequests < result->pendingRequests)
+			result = connection;
+	}
+	return result;
+}
+
+
+/*!
+	\brief Close the idle connections that became idle before \a idleBefore.
+
+	The caller must hold the lock.
+
+	\returns \c true if any connection was closed.
+*/
+bool
+BHttpSession::Impl::CloseIdleConnections(bigtime_t idleBefore)
+{
+	bool closed = false;
+	for (auto it = fConnections.begin(); it != fConnections.end();) {
+		if ((*it)->idleSince != 0 && (*it)->idleSince < idleBefore) {
+			(*it)->closed = true;
+			it = fConnections.erase(it);
+			closed = true;
+		} else
+			it++;
+	}
+	return closed;
+}
+
+
+/*!
+	\brief Return how long the control thread can wait before the next idle connection expires.
+*/
+bigtime_t
+BHttpSession::Impl::IdleConnectionTimeout()
+{
+	auto lock = AutoLocker<BLocker>(fLock);
+
+	bigtime_t oldest = B_INFINITE_TIMEOUT;
+	for (const auto& connection: fConnections) {
+		if (connection->idleSince != 0)
+			oldest = std::min(oldest, connection->idleSince);
+	}
+	if (oldest == B_INFINITE_TIMEOUT)
+		return B_INFINITE_TIMEOUT;
+
+	return std::max(oldest + fIdleTimeout.load(std::memory_order_relaxed) - system_time(),
+		bigtime_t(0));
+}
+
+
+/*!
+	\brief Add a \a request from the data queue to the requests of its connection.
+
+	A connection may have been closed while the request was waiting in the queue; then the request
+	goes back to the control queue to get another one. The caller must hold the lock.
+*/
+void
+BHttpSession::Impl::AddToConnection(BHttpSession::Request&& request)
+{
+	auto connection = request.GetConnection();
+	if (connection->closed) {
+		connection->pendingRequests--;
+		request.ResetConnection(false);
+		fControlQueue.push_back(std::move(request));
+		release_sem(fControlQueueSem);
+		return;
+	}
+
+	auto it = connectionMap.find(connection->Socket());
+	if (it == connectionMap.end())
+		it = connectionMap.insert({connection->Socket(), ConnectionRequests{connection, {}}}).first;
+	it->second.requests.push_back(std::move(request));
+}
+
+
+/*!
+	\brief Cancel the request with \a identifier, if it is one of the requests of \a connection.
+
+	Requests that have not been sent are simply removed. When the request currently receiving its
+	response is cancelled, the connection is closed. Other requests are marked, and the connection
+	is closed once it is their turn to receive the response. The caller must hold the lock.
+
+	\returns \c true if the request was found.
+*/
+bool
+BHttpSession::Impl::CancelRequest(ConnectionRequests& connection, int32 identifier)
+{
+	auto& requests = connection.requests;
+	auto it = std::find_if(requests.begin(), requests.end(),
+		[identifier](const auto& request) { return request.Id() == identifier; });
+	if (it == requests.end())
+		return false;
+
+	if (it->SendStarted() && it != requests.begin()) {
+		it->SetCanceled();
+		return true;
+	}
+
+	try {
+		throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
+	} catch (...) {
+		it->SetError(std::current_exception());
+	}
+
+	if (!it->SendStarted()) {
+		requests.erase(it);
+		auto& shared = *connection.connection;
+		shared.pendingRequests--;
+		if (shared.pendingRequests == 0) {
+			// nothing was sent, so the connection can be used by other requests
+			shared.pipelinable = true;
+			shared.idleSince = system_time();
+		}
+		release_sem(fControlQueueSem);
+		return true;
+	}
+
+	requests.pop_front();
+	connection.connection->pendingRequests--;
+	CloseConnection(connection, std::make_exception_ptr(BNetworkRequestError(
+		__PRETTY_FUNCTION__, BNetworkRequestError::Canceled)));
+	return true;
+}
+
+
+/*!
+	\brief Handle the \a events that occurred on the socket of \a connection.
+
+	Requests are written in the order they were added, and the responses are parsed in the same
+	order.
+
+	\returns \c false when the connection should be removed from the data thread, either because
+		it is closed, or because it is idle.
+*/
+bool
+BHttpSession::Impl::ProcessConnection(ConnectionRequests& connection, uint16 events)
+{
+	auto& requests = connection.requests;
+
+	if ((events & B_EVENT_WRITE) == B_EVENT_WRITE) {
+		for (auto& request: requests) {
+			if (request.State() != Request::Connected)
+				continue;
+
+			try {
+				request.TransferRequest();
+			} catch (...) {
+				CloseConnection(connection, std::current_exception());
+				return false;
+			}
+
+			if (request.State() == Request::Connected) {
+				// Wait until the socket can take more data
+				break;
+			}
+		}
+	}
+
+	if ((events & B_EVENT_READ) == B_EVENT_READ) {
+		bool fromBuffer = false;
+		while (!requests.empty() && requests.front().State() == Request::RequestSent) {
+			auto& request = requests.front();
+			if (request.IsCanceled()) {
+				try {
+					throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
+				} catch (...) {
+					request.SetError(std::current_exception());
+				}
+				requests.pop_front();
+				auto lock = AutoLocker<BLocker>(fLock);
+				connection.connection->pendingRequests--;
+				CloseConnection(connection, nullptr);
+				return false;
+			}
+
+			auto finished = false;
+			try {
+				if (request.CanCancel())
+					finished = true;
+				else
+					finished = request.ReceiveResult(fromBuffer);
+			} catch (const Redirect& r) {
+				// Request is redirected, send back to the controlThread
+				// Move existing request into a new request and hand over to the control queue
+				auto lock = AutoLocker<BLocker>(fLock);
+				fControlQueue.emplace_back(request, r);
+				release_sem(fControlQueueSem);
+
+				finished = true;
+			} catch (...) {
+				CloseConnection(connection, std::current_exception());
+				return false;
+			}
+
+			if (!finished)
+				break;
+
+			// Clean up finished requests; including redirected requests. The connection can only
+			// be used for the next request if the response was read completely.
+			bool keepAlive = request.KeepAlive();
+			requests.pop_front();
+			if (!keepAlive) {
+				auto lock = AutoLocker<BLocker>(fLock);
+				connection.connection->pendingRequests--;
+				CloseConnection(connection, nullptr);
+				return false;
+			}
+
+			if (!FinishRequest(connection))
+				return false;
+
+			// The next response may have been read along with the previous one
+			fromBuffer = connection.connection->Buffer().RemainingBytes() > 0;
+			if (!fromBuffer)
+				break;
+		}
+	} else if ((events & B_EVENT_DISCONNECTED) == B_EVENT_DISCONNECTED) {
+		CloseConnection(connection,
+			std::make_exception_ptr(BNetworkRequestError(
+				__PRETTY_FUNCTION__, BNetworkRequestError::NetworkError)));
+		return false;
+	}
+
+	return true;
+}
+
+
+/*!
+	\brief Book keeping after a request on \a connection finished with the connection intact.
+
+	When there are no more requests for the connection, it becomes idle, and can be used by
+	later requests to the same host.
+
+	\returns \c false when the connection became idle.
+*/
+bool
+BHttpSession::Impl::FinishRequest(ConnectionRequests& connection)
+{
+	auto lock = AutoLocker<BLocker>(fLock);
+	auto& shared = *connection.connection;
+
+	shared.persistent = true;
+	shared.pendingRequests--;
+	release_sem(fControlQueueSem);
+		// wake up control thread; there may queued requests unblocked.
+
+	if (shared.pendingRequests > 0)
+		return true;
+
+	if (shared.Buffer().RemainingBytes() > 0) {
+		// The server sent more than it was asked for; the connection cannot be trusted
+		CloseConnection(connection, nullptr);
+		return false;
+	}
+
+	shared.pipelinable = true;
+	shared.idleSince = system_time();
+	return false;
+}
+
+
+/*!
+	\brief Close \a connection, and deal with its remaining requests.
+
+	Requests that did not receive any part of their response yet, and that can be safely repeated,
+	go back to the control queue to be sent on another connection. The other requests fail with
+	\a error, or with a network error if \a error is not set.
+*/
+void
+BHttpSession::Impl::CloseConnection(ConnectionRequests& connection, std::exception_ptr error)
+{
+	if (!error) {
+		error = std::make_exception_ptr(BNetworkRequestError(__PRETTY_FUNCTION__,
+			BNetworkRequestError::NetworkError, "Connection closed before the response"));
+	}
+
+	auto lock = AutoLocker<BLocker>(fLock);
+	auto& shared = connection.connection;
+	shared->closed = true;
+	shared->pendingRequests -= connection.requests.size();
+	fConnections.remove(shared);
+
+	for (auto& request: connection.requests) {
+		if (request.CanRetry()) {
+			request.ResetConnection(true);
+			fControlQueue.push_back(std::move(request));
+		} else
+			request.SetError(error);
+	}
+	connection.requests.clear();
+
+	release_sem(fControlQueueSem);
+		// wake up control thread; there may queued requests unblocked.
+}
+
+
 // #pragma mark -- BHttpSession (public interface)
 
 
@@ -651,6 +1089,20 @@ BHttpSession::SetMaxHosts(size_t maxConnections)
 }
 
 
+void
+BHttpSession::SetMaxPipelinedRequests(size_t maxRequests)
+{
+	fImpl->SetMaxPipelinedRequests(maxRequests);
+}
+
+
+void
+BHttpSession::SetIdleTimeout(bigtime_t timeout)
+{
+	fImpl->SetIdleTimeout(timeout);
+}
+
+
 // #pragma mark -- BHttpSession::Request (helpers)
 BHttpSession::Request::Request(BHttpRequest&& request, BBorrow<BDataIO> target, BMessenger observer)
 	:
@@ -722,10 +1174,25 @@ BHttpSession::Request::SetError(std::exception_ptr e)
 }
 
 
+/*!
+	\brief Get the host to count the connections for, and to share connections with.
+
+	Connections can only be shared by requests that use the same protocol, host and port.
+*/
 std::pair<BString, int>
 BHttpSession::Request::GetHost() const
 {
-	return {fRequest.Url().Host(), fRequest.Url().Port()};
+	int port;
+	if (fRequest.Url().HasPort())
+		port = fRequest.Url().Port();
+	else if (fRequest.Url().Protocol() == "https")
+		port = 443;
+	else
+		port = 80;
+
+	BString host = fRequest.Url().Protocol();
+	host << "://" << fRequest.Url().Host();
+	return {host, port};
 }
 
 
@@ -736,22 +1203,85 @@ BHttpSession::Request::SetCounter(int32* counter) noexcept
 }
 
 
+/*!
+	\brief Send the request over an existing \a connection.
+*/
+void
+BHttpSession::Request::SetConnection(std::shared_ptr<Connection> connection) noexcept
+{
+	fReused = connection->totalRequests > 0;
+	fConnection = std::move(connection);
+	fRequestStatus = Connected;
+}
+
+
+/*!
+	\brief Bring the request back to the initial state, so that it can be sent again.
+
+	This is used when the connection of the request was closed before the response arrived. When
+	\a retry is set, the request was already sent, and will not be sent a third time.
+*/
+void
+BHttpSession::Request::ResetConnection(bool retry) noexcept
+{
+	if (retry)
+		fRetried = true;
+
+	fConnection.reset();
+	fReused = false;
+	fRequestStatus = InitialState;
+
+	fBuffer.Clear();
+	fSerializer = HttpSerializer();
+	fParser = HttpParser();
+	if (fRequest.Method() == BHttpMethod::Head)
+		fParser.SetNoContent();
+
+	fStatus = BHttpStatus();
+	fFields = BHttpFields();
+	fResponseStarted = false;
+	fKeepAlive = false;
+	fMightRedirect = false;
+}
+
+
+/*!
+	\brief Check if the request can be safely pipelined, or repeated when the connection fails.
+
+	This is the case for GET and HEAD requests without a body.
+*/
+bool
+BHttpSession::Request::IsPipelinable() const noexcept
+{
+	return (fRequest.Method() == BHttpMethod::Get || fRequest.Method() == BHttpMethod::Head)
+		&& fRequest.RequestBody() == nullptr;
+}
+
+
+/*!
+	\brief Check if the request can be sent again after its connection failed.
+
+	A server may close an idle connection at the same time a new request is sent over it. Requests
+	that were sent over a connection that was used before, and that did not receive any of their
+	response, are retried once.
+*/
+bool
+BHttpSession::Request::CanRetry() const noexcept
+{
+	return fReused && !fRetried && !fResponseStarted && !fCanceled && !fResult->CanCancel()
+		&& IsPipelinable();
+}
+
+
 /*!
 	\brief Resolve the hostname for a request
 */
 void
 BHttpSession::Request::ResolveHostName()
 {
-	int port;
-	if (fRequest.Url().HasPort())
-		port = fRequest.Url().Port();
-	else if (fRequest.Url().Protocol() == "https")
-		port = 443;
-	else
-		port = 80;
-
 	// TODO: proxy
-	if (auto status = fRemoteAddress.SetTo(fRequest.Url().Host(), port); status != B_OK) {
+	if (auto status = fRemoteAddress.SetTo(fRequest.Url().Host(), GetHost().second);
+		status != B_OK) {
 		throw BNetworkRequestError(
 			"BNetworkAddress::SetTo()", BNetworkRequestError::HostnameError, status);
 	}
@@ -768,30 +1298,35 @@ void
 BHttpSession::Request::OpenConnection()
 {
 	// Set up the socket
+	std::unique_ptr<BSocket> socket;
 	if (fRequest.Url().Protocol() == "https") {
 		// To do: secure socket with callbacks to check certificates
-		fSocket = std::make_unique<BSecureSocket>();
+		socket = std::make_unique<BSecureSocket>();
 	} else {
-		fSocket = std::make_unique<BSocket>();
+		socket = std::make_unique<BSocket>();
 	}
 
 	// Set timeout
-	fSocket->SetTimeout(fRequest.Timeout());
+	socket->SetTimeout(fRequest.Timeout());
 
 	// Open connection
-	if (auto status = fSocket->Connect(fRemoteAddress); status != B_OK) {
+	if (auto status = socket->Connect(fRemoteAddress); status != B_OK) {
 		// TODO: inform listeners that the connection failed
 		throw BNetworkRequestError(
 			"BSocket::Connect()", BNetworkRequestError::NetworkError, status);
 	}
 
 	// Make the rest of the interaction non-blocking
-	auto flags = fcntl(fSocket->Socket(), F_GETFL, 0);
+	auto flags = fcntl(socket->Socket(), F_GETFL, 0);
 	if (flags == -1)
 		throw BRuntimeError("fcntl()", "Error getting socket flags");
-	if (fcntl(fSocket->Socket(), F_SETFL, flags | O_NONBLOCK) != 0)
+	if (fcntl(socket->Socket(), F_SETFL, flags | O_NONBLOCK) != 0)
 		throw BRuntimeError("fcntl()", "Error setting non-blocking flag on socket");
 
+	// The connection counter now belongs to the connection, which may outlive this request
+	fConnection = std::make_shared<Connection>(
+		GetHost(), std::move(socket), std::move(fConnectionCounter));
+
 	SendMessage(UrlEvent::ConnectionOpened);
 
 	fRequestStatus = Connected;
@@ -814,7 +1349,7 @@ BHttpSession::Request::TransferRequest()
 	if (!fSerializer.IsInitialized())
 		fSerializer.SetTo(fBuffer, fRequest);
 
-	auto currentBytesWritten = fSerializer.Serialize(fBuffer, fSocket.get());
+	auto currentBytesWritten = fSerializer.Serialize(fBuffer, fConnection->Stream());
 
 	if (currentBytesWritten > 0) {
 		SendMessage(UrlEvent::UploadProgress, [this](BMessage& msg) {
@@ -832,30 +1367,43 @@ BHttpSession::Request::TransferRequest()
 /*!
 	\brief Transfer data from the socket and parse the result.
 
+	When \a fromBuffer is set, only the data that is already in the buffer of the connection is
+	parsed. This is used for pipelined responses that were read along with the previous response.
+
 	\returns \c true if the request is complete, or false if there is more.
 */
 bool
-BHttpSession::Request::ReceiveResult()
+BHttpSession::Request::ReceiveResult(bool fromBuffer)
 {
-	// First: stream data from the socket
-	auto bytesRead = fBuffer.ReadFrom(fSocket.get());
+	auto& buffer = fConnection->Buffer();
 
-	if (bytesRead == B_WOULD_BLOCK || bytesRead == B_INTERRUPTED)
-		return false;
+	// First: stream data from the socket
+	ssize_t bytesRead = 0;
+	if (!fromBuffer) {
+		bytesRead = buffer.ReadFrom(fConnection->Stream());
+		if (bytesRead == B_WOULD_BLOCK || bytesRead == B_INTERRUPTED)
+			return false;
+	}
 
-	auto readEnd = bytesRead == 0;
+	auto readEnd = !fromBuffer && bytesRead == 0;
+	if (readEnd) {
+		// The server closed the connection
+		fKeepAlive = false;
+	}
 
 	// Parse the content in the buffer
 	switch (fParser.State()) {
 		case HttpInputStreamState::StatusLine:
 		{
-			if (fBuffer.RemainingBytes() == static_cast<size_t>(bytesRead)) {
-				// In the initial run, the bytes in the buffer will match the bytes read to indicate
-				// the response has started.
+			if (!fResponseStarted && buffer.RemainingBytes() > 0) {
+				fResponseStarted = true;
 				SendMessage(UrlEvent::ResponseStarted);
 			}
 
-			if (fParser.ParseStatus(fBuffer, fStatus)) {
+			if (fParser.ParseStatus(buffer, fStatus)) {
+				// Only HTTP/1.1 servers keep the connection open by default
+				fKeepAlive = !readEnd && fStatus.text.StartsWith("HTTP/1.1 ");
+
 				// the status headers are now received, decide what to do next
 
 				// Determine if we can handle redirects; else notify of receiving status
@@ -884,6 +1432,8 @@ BHttpSession::Request::ReceiveResult()
 				if ((fStatus.StatusClass() == BHttpStatusClass::ClientError
 						|| fStatus.StatusClass() == BHttpStatusClass::ServerError)
 					&& fRequest.StopOnError()) {
+					// The rest of the response is not read, so the connection cannot be reused
+					fKeepAlive = false;
 					fRequestStatus = ContentReceived;
 					fResult->SetStatus(std::move(fStatus));
 					fResult->SetFields(BHttpFields());
@@ -911,7 +1461,7 @@ BHttpSession::Request::ReceiveResult()
 		}
 		case HttpInputStreamState::Fields:
 		{
-			if (!fParser.ParseFields(fBuffer, fFields)) {
+			if (!fParser.ParseFields(buffer, fFields)) {
 				// there may be more headers to receive, throw an error if there will be no more
 				if (readEnd) {
 					throw BNetworkRequestError(__PRETTY_FUNCTION__,
@@ -923,6 +1473,14 @@ BHttpSession::Request::ReceiveResult()
 
 			// The headers have been received, now set up the rest of the response handling
 
+			// The server may announce that it closes the connection after this response
+			if (auto connectionField = fFields.FindField("Connection"sv);
+				connectionField != fFields.end()) {
+				BString value((*connectionField).Value().data(), (*connectionField).Value().size());
+				if (value.IFindFirst("close") >= 0)
+					fKeepAlive = false;
+			}
+
 			// Handle redirects
 			if (fMightRedirect) {
 				auto redirectToGet = false;
@@ -991,7 +1549,7 @@ BHttpSession::Request::ReceiveResult()
 				// The bytesWrittenToBody may differ from the bytes parsed from the buffer when
 				// there is compression on the incoming stream.
 			bytesRead = fParser.ParseBody(
-				fBuffer,
+				buffer,
 				[this, &bytesWrittenToBody](const std::byte* buffer, size_t size) {
 					bytesWrittenToBody = fResult->WriteToBody(buffer, size);
 					return bytesWrittenToBody;
@@ -1033,16 +1591,6 @@ BHttpSession::Request::ReceiveResult()
 }
 
 
-/*!
-	\brief Disconnect the socket. Does not validate if it actually succeeded.
-*/
-void
-BHttpSession::Request::Disconnect() noexcept
-{
-	fSocket->Disconnect();
-}
-
-
 /*!
 	\brief Send a message to the observer, if one is present
 
@@ -1062,6 +1610,34 @@ BHttpSession::Request::SendMessage(uint32 what, std::function<void(BMessage&)> d
 }
 
 
+// #pragma mark -- BHttpSession::Connection
+
+
+BHttpSession::Connection::Connection(std::pair<BString, int> host, std::unique_ptr<BSocket> socket,
+	std::unique_ptr<int32, CounterDeleter> counter) noexcept
+	:
+	fHost(std::move(host)),
+	fSocket(std::move(socket)),
+	fConnectionCounter(std::move(counter))
+{
+}
+
+
+/*!
+	\brief Check whether an idle connection can still be used.
+
+	An idle connection should not have any data to read. If the server closed it, or sent
+	unexpected data, the connection cannot be used for another request.
+*/
+bool
+BHttpSession::Connection::IsAlive() const noexcept
+{
+	char byte;
+	auto result = recv(fSocket->Socket(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+	return result < 0 && (errno == EWOULDBLOCK || errno == EAGAIN);
+}
+
+
 // #pragma mark -- Message constants
 
 
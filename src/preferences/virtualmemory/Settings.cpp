@@ -49,6 +49,7 @@ Settings::Settings()
 	}
 
 	fDefaultSettings.volume = dev_for_path("/boot");
+	fDefaultSettings.compressed_size = 0;
 }
 
 
@@ -89,6 +90,15 @@ Settings::SetSwapVolume(dev_t volume, bool revertable)
 }
 
 
+void
+Settings::SetCompressedSwapSize(off_t size, bool revertable)
+{
+	fCurrentSettings.compressed_size = size;
+	if (!revertable)
+		fInitialSettings.compressed_size = size;
+}
+
+
 void
 Settings::SetWindowPosition(BPoint position)
 {
@@ -156,6 +166,8 @@ Settings::ReadSwapSettings()
 		"swap_volume_filesystem", NULL, NULL);
 	const char* capacity = get_driver_parameter(settings.Get(),
 		"swap_volume_capacity", NULL, NULL);
+	const char* compressedSize = get_driver_parameter(settings.Get(),
+		"compressed_swap_size", NULL, NULL);
 
 	if (enabled == NULL	|| automatic == NULL || size == NULL || device == NULL
 		|| volume == NULL || capacity == NULL || filesystem == NULL)
@@ -168,6 +180,8 @@ Settings::ReadSwapSettings()
 	SetSwapAutomatic(get_driver_boolean_parameter(settings.Get(),
 		"swap_auto", true, false));
 	SetSwapSize(atoll(size));
+	// older settings files don't have the compressed tier yet
+	SetCompressedSwapSize(compressedSize != NULL ? atoll(compressedSize) : 0);
 
 	int32 bestScore = -1;
 	dev_t bestVol = -1;
@@ -228,10 +242,11 @@ Settings::WriteSwapSettings()
 	char buffer[1024];
 	snprintf(buffer, sizeof(buffer), "vm %s\nswap_auto %s\nswap_size %"
 		B_PRIdOFF "\nswap_volume_name %s\nswap_volume_device %s\n"
-		"swap_volume_filesystem %s\nswap_volume_capacity %" B_PRIdOFF "\n",
+		"swap_volume_filesystem %s\nswap_volume_capacity %" B_PRIdOFF "\n"
+		"compressed_swap_size %" B_PRIdOFF "\n",
 		SwapEnabled() ? "on" : "off", SwapAutomatic() ? "yes" : "no",
 		SwapSize(), info.volume_name, info.device_name, info.fsh_name,
-		info.total_blocks * info.block_size);
+		info.total_blocks * info.block_size, CompressedSwapSize());
 
 	file.Write(buffer, strlen(buffer));
 	return B_OK;
@@ -244,7 +259,8 @@ Settings::IsRevertable()
 	return SwapEnabled() != fInitialSettings.enabled
 		|| SwapAutomatic() != fInitialSettings.automatic
 		|| SwapSize() != fInitialSettings.size
-		|| SwapVolume() != fInitialSettings.volume;
+		|| SwapVolume() != fInitialSettings.volume
+		|| CompressedSwapSize() != fInitialSettings.compressed_size;
 }
 
 
@@ -255,6 +271,7 @@ Settings::RevertSwapSettings()
 	SetSwapAutomatic(fInitialSettings.automatic);
 	SetSwapSize(fInitialSettings.size);
 	SetSwapVolume(fInitialSettings.volume);
+	SetCompressedSwapSize(fInitialSettings.compressed_size);
 }
 
 
@@ -264,7 +281,8 @@ Settings::IsDefaultable()
 	return SwapEnabled() != fDefaultSettings.enabled
 		|| SwapAutomatic() != fDefaultSettings.automatic
 		|| SwapSize() != fDefaultSettings.size
-		|| SwapVolume() != fDefaultSettings.volume;
+		|| SwapVolume() != fDefaultSettings.volume
+		|| CompressedSwapSize() != fDefaultSettings.compressed_size;
 }
 
 
@@ -275,6 +293,7 @@ Settings::DefaultSwapSettings(bool revertable)
 	SetSwapAutomatic(fDefaultSettings.automatic);
 	SetSwapSize(fDefaultSettings.size);
 	SetSwapVolume(fDefaultSettings.volume);
+	SetCompressedSwapSize(fDefaultSettings.compressed_size);
 	if (!revertable)
 		fInitialSettings = fDefaultSettings;
 }
@@ -34,6 +34,8 @@ public:
 								{ return fCurrentSettings.automatic; }
 			off_t			SwapSize() const { return fCurrentSettings.size; }
 			dev_t			SwapVolume() { return fCurrentSettings.volume; }
+			off_t			CompressedSwapSize() const
+								{ return fCurrentSettings.compressed_size; }
 			BPoint			WindowPosition() const { return fWindowPosition; }
 
 
@@ -44,6 +46,8 @@ public:
 			void			SetSwapSize(off_t size, bool revertable = true);
 			void			SetSwapVolume(dev_t volume,
 								bool revertable = true);
+			void			SetCompressedSwapSize(off_t size,
+								bool revertable = true);
 			void			SetWindowPosition(BPoint position);
 
 			status_t		ReadWindowSettings();
@@ -62,6 +66,7 @@ private:
 				bool automatic;
 				off_t size;
 				dev_t volume;
+				off_t compressed_size;
 			};
 
 			BPoint			fWindowPosition;
@@ -67,6 +67,9 @@ SizeSlider::SizeSlider(const char* name, const char* label,
 const char*
 SizeSlider::UpdateText() const
 {
+	if (Value() == 0)
+		return B_TRANSLATE("Off");
+
 	return string_for_size(Value() * kMegaByte, fText, sizeof(fText));
 }
 
@@ -124,6 +127,7 @@ SettingsWindow::SettingsWindow()
 	fSwapEnabledCheckBox(NULL),
 	fSwapAutomaticCheckBox(NULL),
 	fSizeSlider(NULL),
+	fCompressedSizeSlider(NULL),
 	fDefaultsButton(NULL),
 	fRevertButton(NULL),
 	fWarningStringView(NULL),
@@ -198,6 +202,11 @@ SettingsWindow::SettingsWindow()
 	fSizeSlider->SetViewColor(255, 0, 255);
 	fSizeSlider->SetExplicitAlignment(align);
 
+	fCompressedSizeSlider = new SizeSlider("compressed size slider",
+		B_TRANSLATE("Compressed swap in memory:"),
+		new BMessage(kMsgSliderUpdate),	0, 0, B_WILL_DRAW | B_FRAME_EVENTS);
+	fCompressedSizeSlider->SetExplicitAlignment(align);
+
 	fWarningStringView = new BStringView("warning",
 		B_TRANSLATE("Changes will take effect upon reboot."));
 
@@ -210,6 +219,7 @@ SettingsWindow::SettingsWindow()
 		.Add(fSwapAutomaticCheckBox)
 		.Add(fVolumeMenuField)
 		.Add(fSizeSlider)
+		.Add(fCompressedSizeSlider)
 		.Add(fWarningStringView)
 		.View());
 
@@ -419,6 +429,8 @@ SettingsWindow::_RecordChoices()
 	fSettings.SetSwapAutomatic(fSwapAutomaticCheckBox->Value());
 	fSettings.SetSwapEnabled(fSwapEnabledCheckBox->Value());
 	fSettings.SetSwapSize((off_t)fSizeSlider->Value() * kMegaByte);
+	fSettings.SetCompressedSwapSize(
+		(off_t)fCompressedSizeSlider->Value() * kMegaByte);
 	fSettings.SetSwapVolume(((VolumeMenuItem*)fVolumeMenuField
 		->Menu()->FindMarked())->Volume().Device());
 }
@@ -463,6 +475,19 @@ SettingsWindow::_Update()
 	} else
 		fSizeSlider->SetEnabled(false);
 
+	// The kernel never lets the compressed tier use more than half of the
+	// memory.
+	system_info info;
+	get_system_info(&info);
+	off_t maxCompressedSize = (off_t)info.max_pages * B_PAGE_SIZE / 2;
+	(maxCompressedSize >>= 20) <<= 20;
+
+	char sizeStr[16];
+	fCompressedSizeSlider->SetLimitLabels(B_TRANSLATE("Off"),
+		string_for_size(maxCompressedSize, sizeStr, sizeof(sizeStr)));
+	fCompressedSizeSlider->SetLimits(0, maxCompressedSize / kMegaByte);
+	fCompressedSizeSlider->SetValue(fSettings.CompressedSwapSize() / kMegaByte);
+
 	bool revertable = fSettings.IsRevertable();
 	if (revertable)
 		fWarningStringView->Show();
@@ -481,6 +506,9 @@ SettingsWindow::_Update()
 		&& !fSwapAutomaticCheckBox->Value());
 	fVolumeMenuField->SetEnabled(fSettings.SwapEnabled()
 		&& !fSwapAutomaticCheckBox->Value());
+
+	// The compressed tier only sits in front of the swap file
+	fCompressedSizeSlider->SetEnabled(fSettings.SwapEnabled());
 }
 
 
@@ -132,6 +132,11 @@ static profile sRedrawProcessingTime;
 #endif
 
 
+static const bigtime_t kMaxDrawingBatchTime = 2000;
+	// The drawing engine is not kept locked for longer than this, as moving
+	// the hardware cursor needs exclusive access to it.
+
+
 //	#pragma mark -
 
 
@@ -176,6 +181,8 @@ ServerWindow::ServerWindow(const char* title, ServerApp* app,
 	fCurrentView(NULL),
 	fCurrentDrawingRegion(),
 	fCurrentDrawingRegionValid(false),
+	fDrawingBatchEngine(NULL),
+	fDrawingBatchStart(0),
 
 	fIsDirectlyAccessing(false)
 {
@@ -2459,6 +2466,12 @@ fDesktop->LockSingleWindow();
 /*!	Dispatches all view drawing messages.
 	The desktop clipping must be read locked when entering this method.
 	Requires a valid fCurrentView.
+
+	The drawing engine is locked and clipped by the first message of a batch
+	only, and stays that way for the following drawing and draw state
+	messages, until _MessageLooper() ends the batch with _EndDrawingBatch().
+	Nothing can change the clipping in between, since the desktop clipping
+	stays read locked as well.
 */
 void
 ServerWindow::_DispatchViewDrawingMessage(int32 code,
@@ -2487,8 +2500,13 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 		return;
 	}
 
-	_UpdateCurrentDrawingRegion();
-	if (fCurrentDrawingRegion.CountRects() <= 0 && code != AS_VIEW_END_LAYER) {
+	if (fDrawingBatchEngine != drawingEngine) {
+		_EndDrawingBatch();
+		_UpdateCurrentDrawingRegion();
+	}
+
+	if (fDrawingBatchEngine == NULL && fCurrentDrawingRegion.CountRects() <= 0
+		&& code != AS_VIEW_END_LAYER) {
 			// If the command is AS_VIEW_END_LAYER, then we continue even if
 			// the clipping region is empty. The layer itself might set a valid
 			// clipping while its contents are drawn, and even if it doesn't,
@@ -2505,11 +2523,15 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 		return;
 	}
 
-	drawingEngine->LockParallelAccess();
-	// NOTE: the region is not copied, Painter keeps a pointer,
-	// that's why you need to use the clipping only for as long
-	// as you have it locked
-	drawingEngine->ConstrainClippingRegion(&fCurrentDrawingRegion);
+	if (fDrawingBatchEngine == NULL) {
+		drawingEngine->LockParallelAccess();
+		fDrawingBatchEngine = drawingEngine;
+		fDrawingBatchStart = system_time();
+		// NOTE: the region is not copied, Painter keeps a pointer,
+		// that's why you need to use the clipping only for as long
+		// as you have it locked
+		drawingEngine->ConstrainClippingRegion(&fCurrentDrawingRegion);
+	}
 
 	switch (code) {
 		case AS_STROKE_LINE:
@@ -3189,7 +3211,10 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 			break;
 	}
 
-	drawingEngine->UnlockParallelAccess();
+	// Pictures and layers change the clipping and the draw state as they are
+	// played back
+	if (!_MessageContinuesDrawingBatch(code))
+		_EndDrawingBatch();
 }
 
 
@@ -4170,6 +4195,11 @@ ServerWindow::_MessageLooper()
 		bool lockedDesktopSingleWindow = false;
 
 		while (true) {
+			if (!_MessageContinuesDrawingBatch(code)
+				|| system_time() - fDrawingBatchStart > kMaxDrawingBatchTime) {
+				_EndDrawingBatch();
+			}
+
 			if (code == AS_DELETE_WINDOW || code == kMsgQuitLooper) {
 				// this means the client has been killed
 				DTRACE(("ServerWindow %s received 'AS_DELETE_WINDOW' message "
@@ -4212,6 +4242,7 @@ ServerWindow::_MessageLooper()
 			}
 
 			if (atomic_and(&fRedrawRequested, 0) != 0) {
+				_EndDrawingBatch();
 #ifdef PROFILE_MESSAGE_LOOP
 				bigtime_t redrawStart = system_time();
 #endif
@@ -4255,6 +4286,7 @@ ServerWindow::_MessageLooper()
 			// Desktop locked), but don't hold the lock longer than 10 ms
 			if (!receiver.HasMessages() || ++messagesProcessed > 70
 				|| system_time() - processingStart > 10000) {
+				_EndDrawingBatch();
 				if (lockedDesktopSingleWindow)
 					fDesktop->UnlockSingleWindow();
 				break;
@@ -4265,6 +4297,7 @@ ServerWindow::_MessageLooper()
 			if (status != B_OK) {
 				// that shouldn't happen, it's our port
 				printf("Someone deleted our message port!\n");
+				_EndDrawingBatch();
 				if (lockedDesktopSingleWindow)
 					fDesktop->UnlockSingleWindow();
 
@@ -4449,6 +4482,77 @@ ServerWindow::_MessageNeedsAllWindowsLocked(uint32 code) const
 }
 
 
+/*!	Returns whether the drawing engine may stay locked and clipped for the
+	message \a code, see _DispatchViewDrawingMessage(). These are all drawing
+	messages except for pictures and layers, and those draw state changes that
+	do not affect the clipping.
+*/
+bool
+ServerWindow::_MessageContinuesDrawingBatch(uint32 code) const
+{
+	switch (code) {
+		case AS_STROKE_LINE:
+		case AS_VIEW_INVERT_RECT:
+		case AS_STROKE_RECT:
+		case AS_FILL_RECT:
+		case AS_FILL_RECT_GRADIENT:
+		case AS_VIEW_DRAW_BITMAP:
+		case AS_STROKE_ARC:
+		case AS_FILL_ARC:
+		case AS_FILL_ARC_GRADIENT:
+		case AS_STROKE_BEZIER:
+		case AS_FILL_BEZIER:
+		case AS_FILL_BEZIER_GRADIENT:
+		case AS_STROKE_ELLIPSE:
+		case AS_FILL_ELLIPSE:
+		case AS_FILL_ELLIPSE_GRADIENT:
+		case AS_STROKE_ROUNDRECT:
+		case AS_FILL_ROUNDRECT:
+		case AS_FILL_ROUNDRECT_GRADIENT:
+		case AS_STROKE_TRIANGLE:
+		case AS_FILL_TRIANGLE:
+		case AS_FILL_TRIANGLE_GRADIENT:
+		case AS_STROKE_POLYGON:
+		case AS_FILL_POLYGON:
+		case AS_FILL_POLYGON_GRADIENT:
+		case AS_STROKE_SHAPE:
+		case AS_FILL_SHAPE:
+		case AS_FILL_SHAPE_GRADIENT:
+		case AS_FILL_REGION:
+		case AS_FILL_REGION_GRADIENT:
+		case AS_STROKE_LINEARRAY:
+		case AS_DRAW_STRING:
+		case AS_DRAW_STRING_WITH_DELTA:
+		case AS_DRAW_STRING_WITH_OFFSETS:
+
+		case AS_VIEW_SET_HIGH_COLOR:
+		case AS_VIEW_SET_LOW_COLOR:
+		case AS_VIEW_SET_PEN_LOC:
+		case AS_VIEW_SET_PEN_SIZE:
+		case AS_VIEW_SET_DRAWING_MODE:
+		case AS_VIEW_SET_BLENDING_MODE:
+		case AS_VIEW_SET_PATTERN:
+		case AS_VIEW_SET_LINE_MODE:
+		case AS_VIEW_SET_FILL_RULE:
+		case AS_VIEW_SET_FONT_STATE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+
+void
+ServerWindow::_EndDrawingBatch()
+{
+	if (fDrawingBatchEngine == NULL)
+		return;
+
+	fDrawingBatchEngine->UnlockParallelAccess();
+	fDrawingBatchEngine = NULL;
+}
+
+
 void
 ServerWindow::_ResizeToFullScreen()
 {
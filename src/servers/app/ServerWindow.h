@@ -38,6 +38,7 @@ class BMessage;
 class Desktop;
 class ServerApp;
 class Decorator;
+class DrawingEngine;
 class Window;
 class Workspace;
 class View;
@@ -147,6 +148,9 @@ private:
 
 			bool				_MessageNeedsAllWindowsLocked(
 									uint32 code) const;
+			bool				_MessageContinuesDrawingBatch(
+									uint32 code) const;
+			void				_EndDrawingBatch();
 
 private:
 			char*				fTitle;
@@ -174,6 +178,10 @@ private:
 			View*				fCurrentView;
 			BRegion				fCurrentDrawingRegion;
 			bool				fCurrentDrawingRegionValid;
+			DrawingEngine*		fDrawingBatchEngine;
+				// locked, and clipped to fCurrentDrawingRegion, while a
+				// batch of drawing messages is being executed
+			bigtime_t			fDrawingBatchStart;
 
 			ObjectDeleter<DirectWindowInfo>
 								fDirectWindowInfo;
@@ -55,6 +55,7 @@
 #include "AlphaMask.h"
 #include "BitmapPainter.h"
 #include "DrawingMode.h"
+#include "DrawingModeSIMD.h"
 #include "GlobalSubpixelSettings.h"
 #include "PatternHandler.h"
 #include "RenderingBuffer.h"
@@ -64,6 +65,10 @@
 
 #include "AppServer.h"
 
+#if APPSERVER_SIMD_SPANS
+#	include <cpuid.h>
+#endif
+
 using std::nothrow;
 
 #undef TRACE
@@ -83,6 +88,252 @@ using std::nothrow;
 #endif
 
 
+// #pragma mark - band rendering
+
+
+/*!	Gives each band its own read position in a flattened path. */
+class PathReader {
+public:
+	PathReader(const agg::path_storage& path)
+		:
+		fPath(path),
+		fIndex(0)
+	{
+	}
+
+	void rewind(unsigned /*pathID*/)
+	{
+		fIndex = 0;
+	}
+
+	unsigned vertex(double* x, double* y)
+	{
+		if (fIndex >= fPath.total_vertices())
+			return agg::path_cmd_stop;
+
+		return fPath.vertex(fIndex++, x, y);
+	}
+
+private:
+	const agg::path_storage&	fPath;
+	unsigned					fIndex;
+};
+
+
+class FillRectJob : public TiledRenderer::Job {
+public:
+	FillRectJob(const BRect& rect, uint32 color)
+		:
+		fRect(rect),
+		fColor(color)
+	{
+	}
+
+	virtual void Render(PainterAggInterface& aggInterface, int32 /*top*/,
+		int32 /*bottom*/)
+	{
+		// the clipping boxes already limit this to the rows of the band
+		uint8* dst = aggInterface.fBuffer.row_ptr(0);
+		uint32 bpr = aggInterface.fBuffer.stride();
+		int32 left = (int32)fRect.left;
+		int32 top = (int32)fRect.top;
+		int32 right = (int32)fRect.right;
+		int32 bottom = (int32)fRect.bottom;
+
+		// fill rects, iterate over clipping boxes
+		renderer_base& baseRenderer = aggInterface.fBaseRenderer;
+		baseRenderer.first_clip_box();
+		do {
+			int32 x1 = max_c(baseRenderer.xmin(), left);
+			int32 x2 = min_c(baseRenderer.xmax(), right);
+			if (x1 <= x2) {
+				int32 y1 = max_c(baseRenderer.ymin(), top);
+				int32 y2 = min_c(baseRenderer.ymax(), bottom);
+				uint8* offset = dst + x1 * 4;
+				for (; y1 <= y2; y1++)
+					gfxset32(offset + y1 * bpr, fColor, (x2 - x1 + 1) * 4);
+			}
+		} while (baseRenderer.next_clip_box());
+	}
+
+private:
+	BRect	fRect;
+	uint32	fColor;
+};
+
+
+class FillRectVerticalGradientJob : public TiledRenderer::Job {
+public:
+	FillRectVerticalGradientJob(const BRect& rect, const uint32* colors)
+		:
+		fRect(rect),
+		fColors(colors)
+	{
+	}
+
+	virtual void Render(PainterAggInterface& aggInterface, int32 /*top*/,
+		int32 /*bottom*/)
+	{
+		uint8* dst = aggInterface.fBuffer.row_ptr(0);
+		uint32 bpr = aggInterface.fBuffer.stride();
+		int32 left = (int32)fRect.left;
+		int32 top = (int32)fRect.top;
+		int32 right = (int32)fRect.right;
+		int32 bottom = (int32)fRect.bottom;
+
+		// fill rects, iterate over clipping boxes
+		renderer_base& baseRenderer = aggInterface.fBaseRenderer;
+		baseRenderer.first_clip_box();
+		do {
+			int32 x1 = max_c(baseRenderer.xmin(), left);
+			int32 x2 = min_c(baseRenderer.xmax(), right);
+			if (x1 <= x2) {
+				int32 y1 = max_c(baseRenderer.ymin(), top);
+				int32 y2 = min_c(baseRenderer.ymax(), bottom);
+				uint8* offset = dst + x1 * 4;
+				for (; y1 <= y2; y1++) {
+					gfxset32(offset + y1 * bpr, fColors[y1 - top],
+						(x2 - x1 + 1) * 4);
+				}
+			}
+		} while (baseRenderer.next_clip_box());
+	}
+
+private:
+	BRect			fRect;
+	const uint32*	fColors;
+};
+
+
+class BlendRectJob : public TiledRenderer::Job {
+public:
+	BlendRectJob(const BRect& rect, const rgb_color& color)
+		:
+		fRect(rect),
+		fColor(color)
+	{
+	}
+
+	virtual void Render(PainterAggInterface& aggInterface, int32 /*top*/,
+		int32 /*bottom*/)
+	{
+		uint8* dst = aggInterface.fBuffer.row_ptr(0);
+		uint32 bpr = aggInterface.fBuffer.stride();
+		int32 left = (int32)fRect.left;
+		int32 top = (int32)fRect.top;
+		int32 right = (int32)fRect.right;
+		int32 bottom = (int32)fRect.bottom;
+
+		// fill rects, iterate over clipping boxes
+		renderer_base& baseRenderer = aggInterface.fBaseRenderer;
+		baseRenderer.first_clip_box();
+		do {
+			int32 x1 = max_c(baseRenderer.xmin(), left);
+			int32 x2 = min_c(baseRenderer.xmax(), right);
+			if (x1 <= x2) {
+				int32 y1 = max_c(baseRenderer.ymin(), top);
+				int32 y2 = min_c(baseRenderer.ymax(), bottom);
+
+				uint8* offset = dst + x1 * 4 + y1 * bpr;
+				for (; y1 <= y2; y1++) {
+					blend_line32(offset, x2 - x1 + 1, fColor.red, fColor.green,
+						fColor.blue, fColor.alpha);
+					offset += bpr;
+				}
+			}
+		} while (baseRenderer.next_clip_box());
+	}
+
+private:
+	BRect		fRect;
+	rgb_color	fColor;
+};
+
+
+class FillPathJob : public TiledRenderer::Job {
+public:
+	FillPathJob(const agg::path_storage& path, bool subpixel)
+		:
+		fPath(path),
+		fSubpixel(subpixel)
+	{
+	}
+
+	virtual void Render(PainterAggInterface& aggInterface, int32 top,
+		int32 bottom)
+	{
+		PathReader path(fPath);
+		if (fSubpixel) {
+			aggInterface.fSubpixRasterizer.reset();
+			aggInterface.fSubpixRasterizer.add_path(path);
+			render_scanlines_in_rows(aggInterface.fSubpixRasterizer,
+				aggInterface.fSubpixPackedScanline,
+				aggInterface.fSubpixRenderer, top, bottom);
+		} else {
+			aggInterface.fRasterizer.reset();
+			aggInterface.fRasterizer.add_path(path);
+			render_scanlines_in_rows(aggInterface.fRasterizer,
+				aggInterface.fPackedScanline, aggInterface.fRenderer, top,
+				bottom);
+		}
+	}
+
+private:
+	const agg::path_storage&	fPath;
+	bool						fSubpixel;
+};
+
+
+template<typename GradientFunction>
+class FillPathGradientJob : public TiledRenderer::Job {
+public:
+	typedef agg::span_interpolator_linear<> interpolator_type;
+	typedef agg::pod_auto_array<agg::rgba8, 256> color_array_type;
+	typedef agg::span_allocator<agg::rgba8> span_allocator_type;
+	typedef agg::span_gradient<agg::rgba8, interpolator_type,
+				GradientFunction, color_array_type> span_gradient_type;
+	typedef agg::renderer_scanline_aa<renderer_base, span_allocator_type,
+				span_gradient_type> renderer_gradient_type;
+
+	FillPathGradientJob(const agg::path_storage& path,
+		const GradientFunction& function,
+		const agg::trans_affine& gradientTransform,
+		const color_array_type& colors, int gradientStop)
+		:
+		fPath(path),
+		fFunction(function),
+		fTransform(gradientTransform),
+		fColors(colors),
+		fGradientStop(gradientStop)
+	{
+	}
+
+	virtual void Render(PainterAggInterface& aggInterface, int32 top,
+		int32 bottom)
+	{
+		interpolator_type spanInterpolator(fTransform);
+		span_allocator_type spanAllocator;
+		span_gradient_type spanGradient(spanInterpolator, fFunction, fColors,
+			0, fGradientStop);
+		renderer_gradient_type gradientRenderer(aggInterface.fBaseRenderer,
+			spanAllocator, spanGradient);
+
+		PathReader path(fPath);
+		aggInterface.fRasterizer.reset();
+		aggInterface.fRasterizer.add_path(path);
+		render_scanlines_in_rows(aggInterface.fRasterizer,
+			aggInterface.fUnpackedScanline, gradientRenderer, top, bottom);
+	}
+
+private:
+	const agg::path_storage&	fPath;
+	const GradientFunction&		fFunction;
+	const agg::trans_affine&	fTransform;
+	const color_array_type&		fColors;
+	int							fGradientStop;
+};
+
+
 #define CHECK_CLIPPING	if (!fValidClipping) return BRect(0, 0, -1, -1);
 #define CHECK_CLIPPING_NO_RETURN	if (!fValidClipping) return;
 
@@ -111,6 +362,32 @@ static uint32 detect_simd();
 uint32 gSIMDFlags = detect_simd();
 
 
+#if APPSERVER_SIMD_SPANS
+/*!	Returns whether the CPU supports AVX2, and the kernel saves the YMM
+	registers as well.
+*/
+static bool
+detect_avx2()
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+
+	__cpuid(1, eax, ebx, ecx, edx);
+	if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0)
+		return false;
+
+	uint32 xcr0Low, xcr0High;
+	__asm__ __volatile__("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+	if ((xcr0Low & 0x6) != 0x6)
+		return false;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & bit_AVX2) != 0;
+}
+#endif
+
+
 /*!	Detect SIMD flags for use in AppServer. Checks all CPUs in the system
 	and chooses the minimum supported set of instructions.
 */
@@ -162,14 +439,29 @@ detect_simd()
 				cpuSIMD |= APPSERVER_SIMD_MMX;
 			if (edx & (1 << 25))
 				cpuSIMD |= APPSERVER_SIMD_SSE;
+			if (edx & (1 << 26))
+				cpuSIMD |= APPSERVER_SIMD_SSE2;
 		} else {
 			// no flags can be identified
 			cpuSIMD = 0;
 		}
 		systemSIMD &= cpuSIMD;
 	}
+#if APPSERVER_SIMD_SPANS
+	if ((systemSIMD & APPSERVER_SIMD_SSE2) != 0 && detect_avx2())
+		systemSIMD |= APPSERVER_SIMD_AVX2;
+#endif
+	return systemSIMD;
+#elif __x86_64__
+	// SSE2 is part of the architecture. The MMX and SSE flags are left out,
+	// as they only select the assembly versions for x86.
+	uint32 systemSIMD = APPSERVER_SIMD_SSE2;
+#if APPSERVER_SIMD_SPANS
+	if (detect_avx2())
+		systemSIMD |= APPSERVER_SIMD_AVX2;
+#endif
 	return systemSIMD;
-#else	// !__i386__
+#else
 	return 0;
 #endif
 }
@@ -195,11 +487,16 @@ Painter::Painter()
 	fMiterLimit(B_DEFAULT_MITER_LIMIT),
 
 	fPatternHandler(),
+	fTiledRenderer(new(nothrow) TiledRenderer(fPatternHandler)),
 	fTextRenderer(fSubpixRenderer, fRenderer, fRendererBin, fUnpackedScanline,
 		fSubpixUnpackedScanline, fSubpixRasterizer, fMaskedUnpackedScanline,
 		fTransform)
 {
 	fPixelFormat.SetDrawingMode(fDrawingMode, fAlphaSrcMode, fAlphaFncMode);
+	if (fTiledRenderer != NULL) {
+		fTiledRenderer->SetDrawingMode(fDrawingMode, fAlphaSrcMode,
+			fAlphaFncMode);
+	}
 
 #if ALIASED_DRAWING
 	fRasterizer.gamma(agg::gamma_threshold(0.5));
@@ -211,6 +508,7 @@ Painter::Painter()
 // destructor
 Painter::~Painter()
 {
+	delete fTiledRenderer;
 }
 
 
@@ -431,6 +729,8 @@ Painter::SetFillRule(int32 fillRule)
 
 	fRasterizer.filling_rule(aggFillRule);
 	fSubpixRasterizer.filling_rule(aggFillRule);
+	if (fTiledRenderer != NULL)
+		fTiledRenderer->SetFillRule(aggFillRule);
 }
 
 
@@ -971,36 +1271,15 @@ Painter::FillRect(const BRect& r, const rgb_color& c) const
 	if (!fValidClipping)
 		return;
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
 	// get a 32 bit pixel ready with the color
 	pixel32 color;
 	color.data8[0] = c.blue;
 	color.data8[1] = c.green;
 	color.data8[2] = c.red;
 	color.data8[3] = c.alpha;
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-			uint8* offset = dst + x1 * 4;
-			for (; y1 <= y2; y1++) {
-//					uint32* handle = (uint32*)(offset + y1 * bpr);
-//					for (int32 x = x1; x <= x2; x++) {
-//						*handle++ = color.data32;
-//					}
-				gfxset32(offset + y1 * bpr, color.data32, (x2 - x1 + 1) * 4);
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+
+	FillRectJob job(r, color.data32);
+	_Render(r, job);
 }
 
 
@@ -1029,31 +1308,8 @@ Painter::FillRectVerticalGradient(BRect r,
 	_MakeGradient(gradient, colorCount, gradientArray,
 		gradientTop - (int32)r.top, gradientArraySize);
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-			uint8* offset = dst + x1 * 4;
-			for (; y1 <= y2; y1++) {
-//					uint32* handle = (uint32*)(offset + y1 * bpr);
-//					for (int32 x = x1; x <= x2; x++) {
-//						*handle++ = gradientArray[y1 - top];
-//					}
-				gfxset32(offset + y1 * bpr, gradientArray[y1 - top],
-					(x2 - x1 + 1) * 4);
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+	FillRectVerticalGradientJob job(r, gradientArray);
+	_Render(r, job);
 }
 
 
@@ -1571,6 +1827,10 @@ Painter::_UpdateDrawingMode()
 	// has to be called so that all internal colors in the renderes
 	// are up to date for use by the solid drawing mode version.
 	fPixelFormat.SetDrawingMode(fDrawingMode, fAlphaSrcMode, fAlphaFncMode);
+	if (fTiledRenderer != NULL) {
+		fTiledRenderer->SetDrawingMode(fDrawingMode, fAlphaSrcMode,
+			fAlphaFncMode);
+	}
 }
 
 
@@ -1708,31 +1968,36 @@ Painter::_BlendRect32(const BRect& r, const rgb_color& c) const
 	if (!fValidClipping)
 		return;
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
+	BlendRectJob job(r, c);
+	_Render(r, job);
+}
 
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
-
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-
-			uint8* offset = dst + x1 * 4 + y1 * bpr;
-			for (; y1 <= y2; y1++) {
-				blend_line32(offset, x2 - x1 + 1, c.red, c.green, c.blue,
-					c.alpha);
-				offset += bpr;
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+
+/*!	Returns whether drawing something that covers \a area may be split up
+	into bands that are rendered in parallel. Alpha masked drawing is never
+	split up, since the masked scanline cannot be shared between threads.
+*/
+bool
+Painter::_CanRenderTiled(const BRect& area) const
+{
+	return fValidClipping && fTiledRenderer != NULL
+		&& fMaskedUnpackedScanline == NULL
+		&& TiledRenderer::IsWorthwhile(area & fClippingRegion->Frame());
+}
+
+
+/*!	Renders \a job either in parallel bands, or directly if that is not
+	possible, or not worth it for the given \a area.
+*/
+void
+Painter::_Render(const BRect& area, TiledRenderer::Job& job) const
+{
+	if (_CanRenderTiled(area)
+		&& fTiledRenderer->Render(fInternal, *fClippingRegion, area, job))
+		return;
+
+	clipping_rect frame = fClippingRegion->FrameInt();
+	job.Render(fInternal, frame.top, frame.bottom);
 }
 
 
@@ -1836,6 +2101,19 @@ template<class VertexSource>
 BRect
 Painter::_RasterizePath(VertexSource& path) const
 {
+	BRect bounds = _BoundingBox(path);
+
+	if (_CanRenderTiled(bounds)) {
+		// the bands need a copy of the path that they can all read at once
+		agg::path_storage& flattenedPath = fTiledRenderer->Path();
+		flattenedPath.remove_all();
+		flattenedPath.concat_path(path);
+
+		FillPathJob job(flattenedPath, gSubpixelAntialiasing);
+		_Render(bounds, job);
+		return _Clipped(bounds);
+	}
+
 	if (fMaskedUnpackedScanline != NULL) {
 		// TODO: we can't do both alpha-masking and subpixel AA.
 		fRasterizer.reset();
@@ -1853,7 +2131,7 @@ Painter::_RasterizePath(VertexSource& path) const
 		agg::render_scanlines(fRasterizer, fPackedScanline, fRenderer);
 	}
 
-	return _Clipped(_BoundingBox(path));
+	return _Clipped(bounds);
 }
 
 
@@ -2093,6 +2371,28 @@ Painter::_RasterizePath(VertexSource& path, const BGradient& gradient,
 {
 	GTRACE("Painter::_RasterizePath\n");
 
+	// Only bother with the bounds of the path if the clipping is large
+	// enough for tiled rendering at all.
+	BRect bounds;
+	if (_CanRenderTiled(fClippingRegion->Frame()))
+		bounds = _BoundingBox(path);
+
+	if (_CanRenderTiled(bounds)) {
+		typedef FillPathGradientJob<GradientFunction> job_type;
+
+		agg::path_storage& flattenedPath = fTiledRenderer->Path();
+		flattenedPath.remove_all();
+		flattenedPath.concat_path(path);
+
+		typename job_type::color_array_type colorArray;
+		_MakeGradient(colorArray, gradient);
+
+		job_type job(flattenedPath, function, gradientTransform, colorArray,
+			gradientStop);
+		_Render(bounds, job);
+		return;
+	}
+
 	typedef agg::span_interpolator_linear<> interpolator_type;
 	typedef agg::pod_auto_array<agg::rgba8, 256> color_array_type;
 	typedef agg::span_allocator<agg::rgba8> span_allocator_type;
@@ -17,6 +17,7 @@
 #include "PainterAggInterface.h"
 #include "PatternHandler.h"
 #include "ServerFont.h"
+#include "TiledRenderer.h"
 #include "Transformable.h"
 
 #include "defines.h"
@@ -46,6 +47,8 @@ class ServerFont;
 // Defines for SIMD support.
 #define APPSERVER_SIMD_MMX	(1 << 0)
 #define APPSERVER_SIMD_SSE	(1 << 1)
+#define APPSERVER_SIMD_SSE2	(1 << 2)
+#define APPSERVER_SIMD_AVX2	(1 << 3)
 
 
 class Painter {
@@ -282,6 +285,10 @@ private:
 			void				_BlendRect32(const BRect& r,
 									const rgb_color& c) const;
 
+			bool				_CanRenderTiled(const BRect& area) const;
+			void				_Render(const BRect& area,
+									TiledRenderer::Job& job) const;
+
 
 			template<class VertexSource>
 			BRect				_BoundingBox(VertexSource& path) const;
@@ -350,6 +357,7 @@ private:
 			float				fMiterLimit;
 
 			PatternHandler		fPatternHandler;
+			TiledRenderer*		fTiledRenderer;
 
 	// a class handling rendering and caching of glyphs
 	// it is setup to load from a specific Freetype supported
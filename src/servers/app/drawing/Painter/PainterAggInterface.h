@@ -10,6 +10,7 @@
 
 #include "defines.h"
 
+#include <agg_conv_curve.h>
 #include <agg_path_storage.h>
 
 
@@ -0,0 +1,435 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Renders a single drawing operation in horizontal bands in parallel.
+	Every band has its own set of AGG rasterizers and renderers, and a
+	clipping region that only covers its rows of the frame buffer, so the
+	bands never touch the same pixels. The rasterizers are still clipped like
+	the ones of the Painter, and only the scanlines within a band are
+	rendered, so the result is identical to rendering the operation in one
+	go.
+*/
+
+
+#include "TiledRenderer.h"
+
+#include <new>
+
+#include <pthread.h>
+#include <string.h>
+
+#include <OS.h>
+
+
+static const int32 kMaxBands = 16;
+static const int32 kMinBandHeight = 32;
+static const int64 kMinTiledPixels = 256 * 256;
+	// below this, waking up the workers costs more than it gains
+
+
+class WorkerPool {
+public:
+	class Task {
+	public:
+		virtual					~Task() {}
+
+		virtual	void			Run(int32 index) = 0;
+	};
+
+	static	WorkerPool*			Default();
+
+			int32				CountWorkers() const
+									{ return fWorkerCount; }
+
+			bool				Run(Task& task, int32 count);
+
+private:
+								WorkerPool();
+								~WorkerPool();
+
+			status_t			_Init();
+			void				_RunTasks();
+
+	static	void				_CreateDefault();
+	static	status_t			_WorkerThread(void* self);
+
+private:
+			sem_id				fLock;
+			sem_id				fStartSem;
+			sem_id				fDoneSem;
+			int32				fWorkerCount;
+
+			Task*				fTask;
+			int32				fTaskCount;
+			int32				fNextIndex;
+
+	static	pthread_once_t		sDefaultInitOnce;
+	static	WorkerPool*			sDefault;
+};
+
+
+pthread_once_t WorkerPool::sDefaultInitOnce = PTHREAD_ONCE_INIT;
+WorkerPool* WorkerPool::sDefault = NULL;
+
+static bool sEnabled = true;
+
+
+WorkerPool::WorkerPool()
+	:
+	fLock(-1),
+	fStartSem(-1),
+	fDoneSem(-1),
+	fWorkerCount(0),
+	fTask(NULL),
+	fTaskCount(0),
+	fNextIndex(0)
+{
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	// only used when the initialization failed, there are no workers then
+	delete_sem(fLock);
+	delete_sem(fStartSem);
+	delete_sem(fDoneSem);
+}
+
+
+/*static*/ WorkerPool*
+WorkerPool::Default()
+{
+	pthread_once(&sDefaultInitOnce, &_CreateDefault);
+	return sDefault;
+}
+
+
+/*!	Runs \a task for all indices from 0 to \a count - 1, distributed over
+	the workers and the calling thread, and waits until all of them are done.
+	Returns \c false without running anything, if the pool is currently used
+	by someone else.
+*/
+bool
+WorkerPool::Run(Task& task, int32 count)
+{
+	// If another painter is using the workers right now, rendering on the
+	// calling thread is better than waiting for them.
+	if (acquire_sem_etc(fLock, 1, B_RELATIVE_TIMEOUT, 0) != B_OK)
+		return false;
+
+	fTask = &task;
+	fTaskCount = count;
+	fNextIndex = 0;
+
+	int32 helpers = min_c(fWorkerCount, count - 1);
+	if (helpers > 0)
+		release_sem_etc(fStartSem, helpers, B_DO_NOT_RESCHEDULE);
+
+	_RunTasks();
+
+	// Workers that wake up late will not find anything left to do, but we
+	// still have to wait for them before the task can go away.
+	if (helpers > 0) {
+		while (acquire_sem_etc(fDoneSem, helpers, 0, 0) == B_INTERRUPTED)
+			;
+	}
+
+	fTask = NULL;
+	release_sem(fLock);
+	return true;
+}
+
+
+status_t
+WorkerPool::_Init()
+{
+	system_info info;
+	if (get_system_info(&info) != B_OK || info.cpu_count < 2)
+		return B_NOT_SUPPORTED;
+
+	fLock = create_sem(1, "painter worker lock");
+	fStartSem = create_sem(0, "painter worker start");
+	fDoneSem = create_sem(0, "painter worker done");
+	if (fLock < 0 || fStartSem < 0 || fDoneSem < 0)
+		return B_NO_MORE_SEMS;
+
+	int32 count = min_c((int32)info.cpu_count - 1, kMaxBands - 1);
+	for (int32 i = 0; i < count; i++) {
+		thread_id thread = spawn_thread(&_WorkerThread, "painter worker",
+			B_DISPLAY_PRIORITY, this);
+		if (thread < 0 || resume_thread(thread) != B_OK)
+			break;
+
+		fWorkerCount++;
+	}
+
+	return fWorkerCount > 0 ? B_OK : B_NO_MORE_THREADS;
+}
+
+
+void
+WorkerPool::_RunTasks()
+{
+	int32 index;
+	while ((index = atomic_add(&fNextIndex, 1)) < fTaskCount)
+		fTask->Run(index);
+}
+
+
+/*static*/ void
+WorkerPool::_CreateDefault()
+{
+	WorkerPool* pool = new(std::nothrow) WorkerPool;
+	if (pool == NULL)
+		return;
+
+	if (pool->_Init() != B_OK) {
+		delete pool;
+		return;
+	}
+
+	// The pool lives as long as the app_server does.
+	sDefault = pool;
+}
+
+
+/*static*/ status_t
+WorkerPool::_WorkerThread(void* _self)
+{
+	WorkerPool* self = (WorkerPool*)_self;
+
+	while (true) {
+		status_t status = acquire_sem(self->fStartSem);
+		if (status == B_INTERRUPTED)
+			continue;
+		if (status != B_OK)
+			break;
+
+		self->_RunTasks();
+		release_sem(self->fDoneSem);
+	}
+
+	return B_OK;
+}
+
+
+// #pragma mark -
+
+
+TiledRenderer::Job::~Job()
+{
+}
+
+
+struct TiledRenderer::Band {
+	Band(PatternHandler& patternHandler)
+		:
+		aggInterface(patternHandler)
+	{
+#if ALIASED_DRAWING
+		aggInterface.fRasterizer.gamma(agg::gamma_threshold(0.5));
+		aggInterface.fSubpixRasterizer.gamma(agg::gamma_threshold(0.5));
+#endif
+	}
+
+	PainterAggInterface	aggInterface;
+	BRegion				clipping;
+	int32				top;
+	int32				bottom;
+};
+
+
+class TiledRenderer::BandJob : public WorkerPool::Task {
+public:
+	BandJob(Band** bands, Job& job)
+		:
+		fBands(bands),
+		fJob(job)
+	{
+	}
+
+	virtual void Run(int32 index)
+	{
+		Band* band = fBands[index];
+		fJob.Render(band->aggInterface, band->top, band->bottom);
+	}
+
+private:
+	Band**	fBands;
+	Job&	fJob;
+};
+
+
+TiledRenderer::TiledRenderer(PatternHandler& patternHandler)
+	:
+	fPatternHandler(patternHandler),
+	fBands(NULL),
+	fDrawingMode(B_OP_COPY),
+	fAlphaSrcMode(B_PIXEL_ALPHA),
+	fAlphaFncMode(B_ALPHA_OVERLAY),
+	fFillRule(agg::fill_non_zero)
+{
+}
+
+
+TiledRenderer::~TiledRenderer()
+{
+	if (fBands != NULL) {
+		for (int32 i = 0; i < kMaxBands; i++)
+			delete fBands[i];
+		delete[] fBands;
+	}
+}
+
+
+/*static*/ bool
+TiledRenderer::IsEnabled()
+{
+	return sEnabled && WorkerPool::Default() != NULL;
+}
+
+
+/*static*/ void
+TiledRenderer::SetEnabled(bool enabled)
+{
+	sEnabled = enabled;
+}
+
+
+/*!	Returns whether rendering something that covers \a area could benefit
+	from being split into bands at all.
+*/
+/*static*/ bool
+TiledRenderer::IsWorthwhile(BRect area)
+{
+	if (!area.IsValid() || !IsEnabled())
+		return false;
+
+	int64 width = area.IntegerWidth() + 1;
+	int64 height = area.IntegerHeight() + 1;
+	return height >= 2 * kMinBandHeight && width * height >= kMinTiledPixels;
+}
+
+
+void
+TiledRenderer::SetDrawingMode(drawing_mode mode, source_alpha alphaSrcMode,
+	alpha_function alphaFncMode)
+{
+	fDrawingMode = mode;
+	fAlphaSrcMode = alphaSrcMode;
+	fAlphaFncMode = alphaFncMode;
+}
+
+
+void
+TiledRenderer::SetFillRule(agg::filling_rule_e fillRule)
+{
+	fFillRule = fillRule;
+}
+
+
+/*!	Renders \a job into the buffer of \a source, limited to \a clipping,
+	in as many bands as there are CPUs. Only the rows covered by \a area
+	are split up. Returns \c false if nothing has been rendered, because
+	the area is too small, or no workers are available; the caller is then
+	expected to render the job itself.
+*/
+bool
+TiledRenderer::Render(PainterAggInterface& source, const BRegion& clipping,
+	BRect area, Job& job)
+{
+	area = area & clipping.Frame();
+	if (!IsWorthwhile(area))
+		return false;
+
+	WorkerPool* pool = WorkerPool::Default();
+
+	int32 top = (int32)floorf(area.top);
+	int32 height = (int32)ceilf(area.bottom) - top + 1;
+	int32 bandCount = min_c(pool->CountWorkers() + 1,
+		height / kMinBandHeight);
+	if (bandCount < 2)
+		return false;
+
+	clipping_rect frame = clipping.FrameInt();
+	for (int32 i = 0; i < bandCount; i++) {
+		Band* band = _BandAt(i);
+		if (band == NULL)
+			return false;
+
+		clipping_rect rect;
+		rect.left = frame.left;
+		rect.right = frame.right;
+		rect.top = top + height * i / bandCount;
+		rect.bottom = top + height * (i + 1) / bandCount - 1;
+		if (i == 0)
+			rect.top = frame.top;
+		if (i == bandCount - 1)
+			rect.bottom = frame.bottom;
+
+		_PrepareBand(*band, source, clipping, rect);
+	}
+
+	BandJob bandJob(fBands, job);
+	return pool->Run(bandJob, bandCount);
+}
+
+
+TiledRenderer::Band*
+TiledRenderer::_BandAt(int32 index)
+{
+	if (fBands == NULL) {
+		fBands = new(std::nothrow) Band*[kMaxBands];
+		if (fBands == NULL)
+			return NULL;
+
+		memset(fBands, 0, sizeof(Band*) * kMaxBands);
+	}
+
+	if (fBands[index] == NULL)
+		fBands[index] = new(std::nothrow) Band(fPatternHandler);
+
+	return fBands[index];
+}
+
+
+/*!	Sets up \a band to render into the same buffer, with the same colors,
+	offset, and rasterizer clipping as \a source, but only into the part of
+	\a clipping that is within \a rect.
+*/
+void
+TiledRenderer::_PrepareBand(Band& band, PainterAggInterface& source,
+	const BRegion& clipping, const clipping_rect& rect)
+{
+	PainterAggInterface& aggInterface = band.aggInterface;
+
+	aggInterface.fBuffer.attach(source.fBuffer.buf(), source.fBuffer.width(),
+		source.fBuffer.height(), source.fBuffer.stride());
+	aggInterface.fPixelFormat.SetDrawingMode(fDrawingMode, fAlphaSrcMode,
+		fAlphaFncMode);
+
+	aggInterface.fRenderer.color(source.fRenderer.color());
+	aggInterface.fRendererBin.color(source.fRendererBin.color());
+	aggInterface.fSubpixRenderer.color(source.fSubpixRenderer.color());
+
+	band.clipping.Set(rect);
+	band.clipping.IntersectWith(&clipping);
+	band.top = rect.top;
+	band.bottom = rect.bottom;
+
+	renderer_base& baseRenderer = aggInterface.fBaseRenderer;
+	baseRenderer.set_clipping_region(&band.clipping);
+	baseRenderer.set_offset(source.fBaseRenderer.offset_x(),
+		source.fBaseRenderer.offset_y());
+
+	clipping_rect frame = clipping.FrameInt();
+	aggInterface.fRasterizer.clip_box(frame.left, frame.top,
+		frame.right + 1, frame.bottom + 1);
+	aggInterface.fSubpixRasterizer.clip_box(frame.left, frame.top,
+		frame.right + 1, frame.bottom + 1);
+	aggInterface.fRasterizer.filling_rule(fFillRule);
+	aggInterface.fSubpixRasterizer.filling_rule(fFillRule);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef TILED_RENDERER_H
+#define TILED_RENDERER_H
+
+
+#include "PainterAggInterface.h"
+
+#include <GraphicsDefs.h>
+#include <Region.h>
+
+
+class PatternHandler;
+
+
+class TiledRenderer {
+public:
+	// A drawing operation that can be rendered in independent bands. It
+	// must only access the frame buffer through the given interface, and
+	// must not modify any state that is shared between the bands.
+	// The clipping of the interface is limited to the rows from top to
+	// bottom already, but its rasterizers are not, so that they produce
+	// the same coverage no matter how the bands are split up: only the
+	// scanlines within these rows need to be rendered.
+	class Job {
+	public:
+		virtual					~Job();
+
+		virtual	void			Render(PainterAggInterface& aggInterface,
+									int32 top, int32 bottom) = 0;
+	};
+
+								TiledRenderer(PatternHandler& patternHandler);
+								~TiledRenderer();
+
+	static	bool				IsEnabled();
+	static	void				SetEnabled(bool enabled);
+
+	static	bool				IsWorthwhile(BRect area);
+
+			void				SetDrawingMode(drawing_mode mode,
+									source_alpha alphaSrcMode,
+									alpha_function alphaFncMode);
+			void				SetFillRule(agg::filling_rule_e fillRule);
+
+			agg::path_storage&	Path()
+									{ return fPath; }
+
+			bool				Render(PainterAggInterface& source,
+									const BRegion& clipping, BRect area,
+									Job& job);
+
+private:
+			struct Band;
+			class BandJob;
+
+			Band*				_BandAt(int32 index);
+			void				_PrepareBand(Band& band,
+									PainterAggInterface& source,
+									const BRegion& clipping,
+									const clipping_rect& rect);
+
+private:
+			PatternHandler&		fPatternHandler;
+			Band**				fBands;
+
+			drawing_mode		fDrawingMode;
+			source_alpha		fAlphaSrcMode;
+			alpha_function		fAlphaFncMode;
+			agg::filling_rule_e	fFillRule;
+
+			agg::path_storage	fPath;
+				// flattened copy of the path that is being rendered
+};
+
+
+/*!	Like agg::render_scanlines(), but only renders the scanlines from \a top
+	to \a bottom, as a TiledRenderer::Job is supposed to.
+*/
+template<class Rasterizer, class Scanline, class Renderer>
+void
+render_scanlines_in_rows(Rasterizer& rasterizer, Scanline& scanline,
+	Renderer& renderer, int32 top, int32 bottom)
+{
+	if (!rasterizer.rewind_scanlines())
+		return;
+
+	top = max_c(top, rasterizer.min_y());
+	if (top > bottom || !rasterizer.navigate_scanline(top))
+		return;
+
+	scanline.reset(rasterizer.min_x(), rasterizer.max_x());
+	renderer.prepare();
+	while (rasterizer.sweep_scanline(scanline) && scanline.y() <= bottom)
+		renderer.render(scanline);
+}
+
+
+#endif // TILED_RENDERER_H
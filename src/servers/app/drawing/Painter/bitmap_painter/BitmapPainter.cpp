@@ -54,12 +54,29 @@ Painter::BitmapPainter::BitmapPainter(const Painter* painter,
 }
 
 
+class Painter::BitmapPainter::DrawJob : public TiledRenderer::Job {
+public:
+	DrawJob(BitmapPainter& bitmapPainter)
+		:
+		fBitmapPainter(bitmapPainter)
+	{
+	}
+
+	virtual void Render(PainterAggInterface& aggInterface, int32 top,
+		int32 bottom)
+	{
+		fBitmapPainter._Draw(aggInterface, top, bottom);
+	}
+
+private:
+	BitmapPainter&	fBitmapPainter;
+};
+
+
 void
 Painter::BitmapPainter::Draw(const BRect& sourceRect,
 	const BRect& destinationRect)
 {
-	using namespace BitmapPainterPrivate;
-
 	if (fStatus != B_OK)
 		return;
 
@@ -78,77 +95,70 @@ Painter::BitmapPainter::Draw(const BRect& sourceRect,
 	if (!success)
 		return;
 
+	ObjectDeleter<BBitmap> convertedBitmapDeleter;
+	fMethod = _DetermineMethod(convertedBitmapDeleter);
+
+	BRect area = fDestinationRect;
+	if (_HasAffineTransform())
+		area = fPainter->Transform().TransformBounds(area);
+
+	DrawJob job(*this);
+	fPainter->_Render(area, job);
+}
+
+
+// #pragma mark - private
+
+
+/*!	Chooses the most efficient way to draw the bitmap, and converts it to
+	B_RGBA32 if that is needed.
+*/
+Painter::BitmapPainter::draw_method
+Painter::BitmapPainter::_DetermineMethod(
+	ObjectDeleter<BBitmap>& convertedBitmapDeleter)
+{
 	if ((fOptions & B_TILE_BITMAP) == 0) {
 		// optimized version for no scale in CMAP8 or RGB32 OP_OVER
 		if (!_HasScale() && !_HasAffineTransform() && !_HasAlphaMask()) {
 			if (fColorSpace == B_CMAP8) {
-				if (fPainter->fDrawingMode == B_OP_COPY) {
-					DrawBitmapNoScale<CMap8Copy> drawNoScale;
-					drawNoScale.Draw(fPainter->fInternal, fBitmap, 1, fOffset,
-						fDestinationRect);
-					return;
-				}
-				if (fPainter->fDrawingMode == B_OP_OVER) {
-					DrawBitmapNoScale<CMap8Over> drawNoScale;
-					drawNoScale.Draw(fPainter->fInternal, fBitmap, 1, fOffset,
-						fDestinationRect);
-					return;
-				}
+				if (fPainter->fDrawingMode == B_OP_COPY)
+					return NO_SCALE_CMAP8_COPY;
+				if (fPainter->fDrawingMode == B_OP_OVER)
+					return NO_SCALE_CMAP8_OVER;
 			} else if (fColorSpace == B_RGB32) {
-				if (fPainter->fDrawingMode == B_OP_OVER) {
-					DrawBitmapNoScale<Bgr32Over> drawNoScale;
-					drawNoScale.Draw(fPainter->fInternal, fBitmap, 4, fOffset,
-						fDestinationRect);
-					return;
-				}
+				if (fPainter->fDrawingMode == B_OP_OVER)
+					return NO_SCALE_BGR32_OVER;
 			}
 		}
 	}
 
-	ObjectDeleter<BBitmap> convertedBitmapDeleter;
 	_ConvertColorSpace(convertedBitmapDeleter);
 
 	if ((fOptions & B_TILE_BITMAP) == 0) {
 		// optimized version if there is no scale
 		if (!_HasScale() && !_HasAffineTransform() && !_HasAlphaMask()) {
-			if (fPainter->fDrawingMode == B_OP_COPY) {
-				DrawBitmapNoScale<Bgr32Copy> drawNoScale;
-				drawNoScale.Draw(fPainter->fInternal, fBitmap, 4, fOffset,
-					fDestinationRect);
-				return;
-			}
+			if (fPainter->fDrawingMode == B_OP_COPY)
+				return NO_SCALE_BGR32_COPY;
 			if (fPainter->fDrawingMode == B_OP_OVER
 				|| (fPainter->fDrawingMode == B_OP_ALPHA
 					 && fPainter->fAlphaSrcMode == B_PIXEL_ALPHA
 					 && fPainter->fAlphaFncMode == B_ALPHA_OVERLAY)) {
-				DrawBitmapNoScale<Bgr32Alpha> drawNoScale;
-				drawNoScale.Draw(fPainter->fInternal, fBitmap, 4, fOffset,
-					fDestinationRect);
-				return;
+				return NO_SCALE_BGR32_ALPHA;
 			}
 		}
 
 		if (!_HasScale() && !_HasAffineTransform() && _HasAlphaMask()) {
-			if (fPainter->fDrawingMode == B_OP_COPY) {
-				DrawBitmapNoScale<Bgr32CopyMasked> drawNoScale;
-				drawNoScale.Draw(fPainter->fInternal, fBitmap, 4, fOffset,
-					fDestinationRect);
-				return;
-			}
+			if (fPainter->fDrawingMode == B_OP_COPY)
+				return NO_SCALE_BGR32_COPY_MASKED;
 		}
 
 		// bilinear and nearest-neighbor scaled, OP_COPY only
 		if (fPainter->fDrawingMode == B_OP_COPY
 			&& !_HasAffineTransform() && !_HasAlphaMask()) {
-			if ((fOptions & B_FILTER_BITMAP_BILINEAR) != 0) {
-				DrawBitmapBilinear<ColorTypeRgb, DrawModeCopy> drawBilinear;
-				drawBilinear.Draw(fPainter, fPainter->fInternal,
-					fBitmap, fOffset, fScaleX, fScaleY, fDestinationRect);
-			} else {
-				DrawBitmapNearestNeighborCopy::Draw(fPainter, fPainter->fInternal,
-					fBitmap, fOffset, fScaleX, fScaleY, fDestinationRect);
-			}
-			return;
+			if ((fOptions & B_FILTER_BITMAP_BILINEAR) != 0)
+				return BILINEAR_COPY;
+
+			return NEAREST_NEIGHBOR_COPY;
 		}
 
 		if (fPainter->fDrawingMode == B_OP_ALPHA
@@ -156,20 +166,108 @@ Painter::BitmapPainter::Draw(const BRect& sourceRect,
 			&& fPainter->fAlphaFncMode == B_ALPHA_OVERLAY
 			&& !_HasAffineTransform() && !_HasAlphaMask()
 			&& (fOptions & B_FILTER_BITMAP_BILINEAR) != 0) {
-			DrawBitmapBilinear<ColorTypeRgba, DrawModeAlphaOverlay> drawBilinear;
-			drawBilinear.Draw(fPainter, fPainter->fInternal,
-				fBitmap, fOffset, fScaleX, fScaleY, fDestinationRect);
-			return;
+			return BILINEAR_ALPHA_OVERLAY;
 		}
 	}
 
-	if ((fOptions & B_TILE_BITMAP) != 0) {
-		DrawBitmapGeneric<Tile>::Draw(fPainter, fPainter->fInternal, fBitmap,
-			fOffset, fScaleX, fScaleY, fDestinationRect, fOptions);
-	} else {
-		// for all other cases (non-optimized drawing mode or scaled drawing)
-		DrawBitmapGeneric<Fill>::Draw(fPainter, fPainter->fInternal, fBitmap,
-			fOffset, fScaleX, fScaleY, fDestinationRect, fOptions);
+	if ((fOptions & B_TILE_BITMAP) != 0)
+		return GENERIC_TILE;
+
+	// for all other cases (non-optimized drawing mode or scaled drawing)
+	return GENERIC_FILL;
+}
+
+
+/*!	Draws the bitmap with the method chosen by _DetermineMethod() into
+	\a aggInterface, which might only cover the rows from \a top to
+	\a bottom.
+*/
+void
+Painter::BitmapPainter::_Draw(PainterAggInterface& aggInterface, int32 top,
+	int32 bottom)
+{
+	using namespace BitmapPainterPrivate;
+
+	// The scaled methods only compute their filter weights for the part of
+	// the clipping within these rows.
+	BRect clippingFrame = fPainter->ClippingRegion()->Frame();
+	clippingFrame.top = max_c(clippingFrame.top, top);
+	clippingFrame.bottom = min_c(clippingFrame.bottom, bottom);
+	if (!clippingFrame.IsValid())
+		return;
+
+	switch (fMethod) {
+		case NO_SCALE_CMAP8_COPY:
+		{
+			DrawBitmapNoScale<CMap8Copy> drawNoScale;
+			drawNoScale.Draw(aggInterface, fBitmap, 1, fOffset,
+				fDestinationRect);
+			break;
+		}
+		case NO_SCALE_CMAP8_OVER:
+		{
+			DrawBitmapNoScale<CMap8Over> drawNoScale;
+			drawNoScale.Draw(aggInterface, fBitmap, 1, fOffset,
+				fDestinationRect);
+			break;
+		}
+		case NO_SCALE_BGR32_OVER:
+		{
+			DrawBitmapNoScale<Bgr32Over> drawNoScale;
+			drawNoScale.Draw(aggInterface, fBitmap, 4, fOffset,
+				fDestinationRect);
+			break;
+		}
+		case NO_SCALE_BGR32_COPY:
+		{
+			DrawBitmapNoScale<Bgr32Copy> drawNoScale;
+			drawNoScale.Draw(aggInterface, fBitmap, 4, fOffset,
+				fDestinationRect);
+			break;
+		}
+		case NO_SCALE_BGR32_ALPHA:
+		{
+			DrawBitmapNoScale<Bgr32Alpha> drawNoScale;
+			drawNoScale.Draw(aggInterface, fBitmap, 4, fOffset,
+				fDestinationRect);
+			break;
+		}
+		case NO_SCALE_BGR32_COPY_MASKED:
+		{
+			DrawBitmapNoScale<Bgr32CopyMasked> drawNoScale;
+			drawNoScale.Draw(aggInterface, fBitmap, 4, fOffset,
+				fDestinationRect);
+			break;
+		}
+		case BILINEAR_COPY:
+		{
+			DrawBitmapBilinear<ColorTypeRgb, DrawModeCopy> drawBilinear;
+			drawBilinear.Draw(clippingFrame, aggInterface, fBitmap, fOffset,
+				fScaleX, fScaleY, fDestinationRect);
+			break;
+		}
+		case NEAREST_NEIGHBOR_COPY:
+			DrawBitmapNearestNeighborCopy::Draw(clippingFrame, aggInterface,
+				fBitmap, fOffset, fScaleX, fScaleY, fDestinationRect);
+			break;
+		case BILINEAR_ALPHA_OVERLAY:
+		{
+			DrawBitmapBilinear<ColorTypeRgba, DrawModeAlphaOverlay>
+				drawBilinear;
+			drawBilinear.Draw(clippingFrame, aggInterface, fBitmap, fOffset,
+				fScaleX, fScaleY, fDestinationRect);
+			break;
+		}
+		case GENERIC_TILE:
+			DrawBitmapGeneric<Tile>::Draw(fPainter, aggInterface, fBitmap,
+				fOffset, fScaleX, fScaleY, fDestinationRect, fOptions, top,
+				bottom);
+			break;
+		case GENERIC_FILL:
+			DrawBitmapGeneric<Fill>::Draw(fPainter, aggInterface, fBitmap,
+				fOffset, fScaleX, fScaleY, fDestinationRect, fOptions, top,
+				bottom);
+			break;
 	}
 }
 
@@ -24,6 +24,23 @@ public:
 									const BRect& destinationRect);
 
 private:
+			enum draw_method {
+				NO_SCALE_CMAP8_COPY,
+				NO_SCALE_CMAP8_OVER,
+				NO_SCALE_BGR32_OVER,
+				NO_SCALE_BGR32_COPY,
+				NO_SCALE_BGR32_ALPHA,
+				NO_SCALE_BGR32_COPY_MASKED,
+				BILINEAR_COPY,
+				NEAREST_NEIGHBOR_COPY,
+				BILINEAR_ALPHA_OVERLAY,
+				GENERIC_TILE,
+				GENERIC_FILL
+			};
+
+			class DrawJob;
+			friend class DrawJob; // needed only for gcc2
+
 			bool				_DetermineTransform(
 									BRect sourceRect,
 									const BRect& destinationRect);
@@ -32,6 +49,11 @@ private:
 			bool				_HasAffineTransform();
 			bool				_HasAlphaMask();
 
+			draw_method			_DetermineMethod(ObjectDeleter<BBitmap>&
+									convertedBitmapDeleter);
+			void				_Draw(PainterAggInterface& aggInterface,
+									int32 top, int32 bottom);
+
 			void				_ConvertColorSpace(ObjectDeleter<BBitmap>&
 									convertedBitmapDeleter);
 
@@ -54,6 +76,7 @@ private:
 			double					fScaleX;
 			double					fScaleY;
 			BPoint					fOffset;
+			draw_method				fMethod;
 };
 
 
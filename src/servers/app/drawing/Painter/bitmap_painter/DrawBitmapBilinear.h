@@ -12,6 +12,8 @@
 
 #include <typeinfo>
 
+#include "DrawBitmapSIMD.h"
+
 
 // Prototypes for assembler routines
 extern "C" {
@@ -26,12 +28,6 @@ extern uint32 gSIMDFlags;
 namespace BitmapPainterPrivate {
 
 
-struct FilterInfo {
-	uint16 index;	// index into source bitmap row/column
-	uint16 weight;	// weight of the pixel at index [0..255]
-};
-
-
 struct FilterData {
 	FilterInfo* fWeightsX;
 	FilterInfo* fWeightsY;
@@ -190,6 +186,8 @@ struct ColorTypeRgba {
 
 
 struct DrawModeCopy {
+	static const int kSIMDMode = SIMD_BILINEAR_COPY;
+
 	static void
 	Blend(uint8*& d, uint32* t)
 	{
@@ -202,6 +200,8 @@ struct DrawModeCopy {
 
 
 struct DrawModeAlphaOverlay {
+	static const int kSIMDMode = SIMD_BILINEAR_ALPHA_OVERLAY;
+
 	static void
 	Blend(uint8*& d, uint32* t)
 	{
@@ -256,8 +256,19 @@ struct BilinearDefault :
 			// buffer handle for destination to be incremented per
 			// pixel
 			uint8* d = this->fDestination;
+			int32 x = xIndexL;
+
+			// The SIMD version always interpolates all four channels, but
+			// only writes those the scalar one would.
+			if (this->fSource->height() > 1) {
+				int32 done = bilinear_scale_row_simd(d, src,
+					this->fSourceBytesPerRow, this->fWeightsX + x,
+					xIndexMax - x + 1, wTop, DrawMode::kSIMDMode);
+				x += done;
+				d += done * 4;
+			}
 
-			for (int32 x = xIndexL; x <= xIndexMax; x++) {
+			for (; x <= xIndexMax; x++) {
 				const uint8* s = src + this->fWeightsX[x].index;
 
 				// calculate the weighted sum of all four
@@ -481,7 +492,7 @@ struct BilinearSimd : DrawBitmapBilinearOptimized<BilinearSimd> {
 template<class ColorType, class DrawMode>
 struct DrawBitmapBilinear {
 	void
-	Draw(const Painter* painter, PainterAggInterface& aggInterface,
+	Draw(const BRect& clippingFrame, PainterAggInterface& aggInterface,
 		agg::rendering_buffer& bitmap, BPoint offset,
 		double scaleX, double scaleY, BRect destinationRect)
 	{
@@ -493,23 +504,22 @@ struct DrawBitmapBilinear {
 
 		// Do not calculate more filter weights than necessary and also
 		// keep the stack based allocations reasonably sized
-		const BRegion& clippingRegion = *painter->ClippingRegion();
-		if (clippingRegion.Frame().IntegerWidth() + 1 < (int32)dstWidth)
-			dstWidth = clippingRegion.Frame().IntegerWidth() + 1;
-		if (clippingRegion.Frame().IntegerHeight() + 1 < (int32)dstHeight)
-			dstHeight = clippingRegion.Frame().IntegerHeight() + 1;
+		if (clippingFrame.IntegerWidth() + 1 < (int32)dstWidth)
+			dstWidth = clippingFrame.IntegerWidth() + 1;
+		if (clippingFrame.IntegerHeight() + 1 < (int32)dstHeight)
+			dstHeight = clippingFrame.IntegerHeight() + 1;
 
 		// When calculating less filter weights than specified by
 		// destinationRect, we need to compensate the offset.
 		FilterData filterData;
 		filterData.fIndexOffsetX = 0;
 		filterData.fIndexOffsetY = 0;
-		if (clippingRegion.Frame().left > destinationRect.left) {
-			filterData.fIndexOffsetX = (int32)(clippingRegion.Frame().left
+		if (clippingFrame.left > destinationRect.left) {
+			filterData.fIndexOffsetX = (int32)(clippingFrame.left
 				- destinationRect.left);
 		}
-		if (clippingRegion.Frame().top > destinationRect.top) {
-			filterData.fIndexOffsetY = (int32)(clippingRegion.Frame().top
+		if (clippingFrame.top > destinationRect.top) {
+			filterData.fIndexOffsetY = (int32)(clippingFrame.top
 				- destinationRect.top);
 		}
 
@@ -598,8 +608,13 @@ struct DrawBitmapBilinear {
 
 		if (typeid(ColorType) == typeid(ColorTypeRgb)
 			&& typeid(DrawMode) == typeid(DrawModeCopy)) {
+			// With SSE2, the default version scales most of each row with
+			// the functions of DrawBitmapSIMD.h, which is faster than both
+			// the assembler routine and the low filter ratio version.
 			uint32 neededSIMDFlags = APPSERVER_SIMD_MMX | APPSERVER_SIMD_SSE;
-			if ((gSIMDFlags & neededSIMDFlags) == neededSIMDFlags)
+			if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0)
+				codeSelect = kUseDefaultVersion;
+			else if ((gSIMDFlags & neededSIMDFlags) == neededSIMDFlags)
 				codeSelect = kUseSIMDVersion;
 			else {
 				if (scaleX == scaleY && (scaleX == 1.5 || scaleX == 2.0
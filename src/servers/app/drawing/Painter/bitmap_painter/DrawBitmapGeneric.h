@@ -34,7 +34,8 @@ struct DrawBitmapGeneric {
 	static void
 	Draw(const Painter* painter, PainterAggInterface& aggInterface,
 		agg::rendering_buffer& bitmap, BPoint offset,
-		double scaleX, double scaleY, BRect destinationRect, uint32 options)
+		double scaleX, double scaleY, BRect destinationRect, uint32 options,
+		int32 top, int32 bottom)
 	{
 		// pixel format attached to bitmap
 		typedef agg::pixfmt_bgra32 pixfmt_image;
@@ -60,7 +61,9 @@ struct DrawBitmapGeneric {
 		interpolator_type interpolator(imgMatrix);
 
 		// scanline allocator
-		agg::span_allocator<pixfmt_image::color_type> spanAllocator;
+		typedef agg::span_allocator<pixfmt_image::color_type>
+			span_allocator_type;
+		span_allocator_type spanAllocator;
 
 		// image accessor attached to pixel format of bitmap
 		typedef
@@ -104,9 +107,12 @@ struct DrawBitmapGeneric {
 					*aggInterface.fMaskedUnpackedScanline,
 					aggInterface.fBaseRenderer, spanAllocator, spanGenerator);
 			} else {
-				agg::render_scanlines_aa(rasterizer,
-					aggInterface.fUnpackedScanline,
-					aggInterface.fBaseRenderer, spanAllocator, spanGenerator);
+				agg::renderer_scanline_aa<renderer_base,
+					span_allocator_type, span_gen_type> renderer(
+						aggInterface.fBaseRenderer, spanAllocator,
+						spanGenerator);
+				render_scanlines_in_rows(rasterizer,
+					aggInterface.fUnpackedScanline, renderer, top, bottom);
 			}
 		} else {
 			// image filter (nearest neighbor)
@@ -120,9 +126,12 @@ struct DrawBitmapGeneric {
 					*aggInterface.fMaskedUnpackedScanline,
 					aggInterface.fBaseRenderer, spanAllocator, spanGenerator);
 			} else {
-				agg::render_scanlines_aa(rasterizer,
-					aggInterface.fUnpackedScanline,
-					aggInterface.fBaseRenderer, spanAllocator, spanGenerator);
+				agg::renderer_scanline_aa<renderer_base,
+					span_allocator_type, span_gen_type> renderer(
+						aggInterface.fBaseRenderer, spanAllocator,
+						spanGenerator);
+				render_scanlines_in_rows(rasterizer,
+					aggInterface.fUnpackedScanline, renderer, top, bottom);
 			}
 		}
 	}
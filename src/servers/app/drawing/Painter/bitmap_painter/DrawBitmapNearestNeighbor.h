@@ -10,10 +10,12 @@
 
 #include "Painter.h"
 
+#include "DrawBitmapSIMD.h"
+
 
 struct DrawBitmapNearestNeighborCopy {
 	static void
-	Draw(const Painter* painter, PainterAggInterface& aggInterface,
+	Draw(const BRect& clippingFrame, PainterAggInterface& aggInterface,
 		agg::rendering_buffer& bitmap, BPoint offset,
 		double scaleX, double scaleY, BRect destinationRect)
 	{
@@ -25,22 +27,21 @@ struct DrawBitmapNearestNeighborCopy {
 
 		// Do not calculate more filter weights than necessary and also
 		// keep the stack based allocations reasonably sized
-		const BRegion& clippingRegion = *painter->ClippingRegion();
-		if (clippingRegion.Frame().IntegerWidth() + 1 < (int32)dstWidth)
-			dstWidth = clippingRegion.Frame().IntegerWidth() + 1;
-		if (clippingRegion.Frame().IntegerHeight() + 1 < (int32)dstHeight)
-			dstHeight = clippingRegion.Frame().IntegerHeight() + 1;
+		if (clippingFrame.IntegerWidth() + 1 < (int32)dstWidth)
+			dstWidth = clippingFrame.IntegerWidth() + 1;
+		if (clippingFrame.IntegerHeight() + 1 < (int32)dstHeight)
+			dstHeight = clippingFrame.IntegerHeight() + 1;
 
 		// When calculating less filter weights than specified by
 		// destinationRect, we need to compensate the offset.
 		uint32 filterWeightXIndexOffset = 0;
 		uint32 filterWeightYIndexOffset = 0;
-		if (clippingRegion.Frame().left > destinationRect.left) {
-			filterWeightXIndexOffset = (int32)(clippingRegion.Frame().left
+		if (clippingFrame.left > destinationRect.left) {
+			filterWeightXIndexOffset = (int32)(clippingFrame.left
 				- destinationRect.left);
 		}
-		if (clippingRegion.Frame().top > destinationRect.top) {
-			filterWeightYIndexOffset = (int32)(clippingRegion.Frame().top
+		if (clippingFrame.top > destinationRect.top) {
+			filterWeightYIndexOffset = (int32)(clippingFrame.top
 				- destinationRect.top);
 		}
 
@@ -125,7 +126,13 @@ struct DrawBitmapNearestNeighborCopy {
 				// buffer handle for destination to be incremented per pixel
 				uint32* d = (uint32*)dst;
 
-				for (int32 x = xIndexL; x <= xIndexR; x++) {
+				int32 x = xIndexL;
+				int32 done = nearest_neighbor_scale_row_simd(d, src,
+					xIndices + x, xIndexR - x + 1);
+				x += done;
+				d += done;
+
+				for (; x <= xIndexR; x++) {
 					*d = *(uint32*)(src + xIndices[x]);
 					d++;
 				}
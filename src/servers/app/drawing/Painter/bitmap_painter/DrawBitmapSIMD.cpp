@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DrawBitmapSIMD.h"
+
+#if APPSERVER_SIMD_SPANS
+
+#include "DrawBitmapSIMDKernels.h"
+#include "Painter.h"
+
+
+// Rows shorter than this are scaled faster by the scalar versions.
+static const int32 kMinSIMDRowLength = 8;
+
+
+extern uint32 gSIMDFlags;
+
+
+int32
+bilinear_scale_row_simd(uint8* dest, const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weightsX, int32 count, uint16 wTop, int mode)
+{
+	if (count < kMinSIMDRowLength)
+		return 0;
+
+	bool alphaOverlay
+		= mode == BitmapPainterPrivate::SIMD_BILINEAR_ALPHA_OVERLAY;
+
+	if ((gSIMDFlags & APPSERVER_SIMD_AVX2) != 0) {
+		if (alphaOverlay) {
+			return bilinear_scale_row_alpha_overlay_avx2(dest, top,
+				bytesPerRow, weightsX, count, wTop);
+		}
+		return bilinear_scale_row_copy_avx2(dest, top, bytesPerRow, weightsX,
+			count, wTop);
+	}
+
+	if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0) {
+		if (alphaOverlay) {
+			return bilinear_scale_row_alpha_overlay_sse2(dest, top,
+				bytesPerRow, weightsX, count, wTop);
+		}
+		return bilinear_scale_row_copy_sse2(dest, top, bytesPerRow, weightsX,
+			count, wTop);
+	}
+
+	return 0;
+}
+
+
+int32
+nearest_neighbor_scale_row_simd(uint32* dest, const uint8* source,
+	const uint16* indices, int32 count)
+{
+	if (count < kMinSIMDRowLength || (gSIMDFlags & APPSERVER_SIMD_AVX2) == 0)
+		return 0;
+
+	return nearest_neighbor_scale_row_avx2(dest, source, indices, count);
+}
+
+
+#endif	// APPSERVER_SIMD_SPANS
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 and AVX2 versions of the inner loops of the bilinear and nearest
+ * neighbor bitmap scaling.
+ *
+ */
+#ifndef DRAW_BITMAP_SIMD_H
+#define DRAW_BITMAP_SIMD_H
+
+
+#include <SupportDefs.h>
+
+#include "DrawingModeSIMD.h"
+
+
+namespace BitmapPainterPrivate {
+
+
+struct FilterInfo {
+	uint16 index;	// index into source bitmap row/column
+	uint16 weight;	// weight of the pixel at index [0..255]
+};
+
+
+enum {
+	SIMD_BILINEAR_COPY,
+		// DrawModeCopy: only the color channels are written
+	SIMD_BILINEAR_ALPHA_OVERLAY
+		// DrawModeAlphaOverlay
+};
+
+
+}	// namespace BitmapPainterPrivate
+
+
+// These functions process as many pixels of a row as they can in whole
+// vectors, and return how many that were; the caller has to take care of
+// the rest. They return 0 if the CPU does not support them. The result is
+// exactly the same as that of the scalar loops they replace.
+
+#if APPSERVER_SIMD_SPANS
+
+// Interpolates \a count pixels between the rows \a top and
+// \a top + \a bytesPerRow, like BilinearDefault with ColorTypeRgba.
+int32 bilinear_scale_row_simd(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const BitmapPainterPrivate::FilterInfo* weightsX,
+	int32 count, uint16 wTop, int mode);
+
+// Copies the pixels at the byte offsets \a indices from \a source.
+int32 nearest_neighbor_scale_row_simd(uint32* dest, const uint8* source,
+	const uint16* indices, int32 count);
+
+#else	// !APPSERVER_SIMD_SPANS
+
+static inline int32
+bilinear_scale_row_simd(uint8*, const uint8*, uint32,
+	const BitmapPainterPrivate::FilterInfo*, int32, uint16, int)
+{
+	return 0;
+}
+
+
+static inline int32
+nearest_neighbor_scale_row_simd(uint32*, const uint8*, const uint16*, int32)
+{
+	return 0;
+}
+
+#endif	// !APPSERVER_SIMD_SPANS
+
+
+#endif	// DRAW_BITMAP_SIMD_H
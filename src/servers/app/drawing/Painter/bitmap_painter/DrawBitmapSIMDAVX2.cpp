@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DrawBitmapSIMD.h"
+
+#if APPSERVER_SIMD_SPANS
+
+// Everything following is compiled for AVX2. These functions are only called
+// once DrawBitmapSIMD.cpp has made sure that the CPU supports it.
+#pragma GCC target("avx2")
+
+#include "DrawBitmapSIMDKernels.h"
+#include "SIMDVectorAVX2.h"
+
+
+int32
+bilinear_scale_row_copy_avx2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop)
+{
+	return simd_bilinear_scale_row<AVX2Vector,
+		BitmapPainterPrivate::SIMD_BILINEAR_COPY>(dest, top, bytesPerRow,
+			weightsX, count, wTop);
+}
+
+
+int32
+bilinear_scale_row_alpha_overlay_avx2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop)
+{
+	return simd_bilinear_scale_row<AVX2Vector,
+		BitmapPainterPrivate::SIMD_BILINEAR_ALPHA_OVERLAY>(dest, top,
+			bytesPerRow, weightsX, count, wTop);
+}
+
+
+/*!	SSE2 has no gather instruction, so there is only an AVX2 version of this
+	one. The indices are byte offsets of up to 16 bit.
+*/
+int32
+nearest_neighbor_scale_row_avx2(uint32* dest, const uint8* source,
+	const uint16* indices, int32 count)
+{
+	int32 done = 0;
+	for (; done + 8 <= count; done += 8) {
+		__m256i offsets = _mm256_cvtepu16_epi32(
+			_mm_loadu_si128((const __m128i*)(indices + done)));
+		_mm256_storeu_si256((__m256i*)(dest + done),
+			_mm256_i32gather_epi32((const int*)source, offsets, 1));
+	}
+
+	return done;
+}
+
+
+#endif	// APPSERVER_SIMD_SPANS
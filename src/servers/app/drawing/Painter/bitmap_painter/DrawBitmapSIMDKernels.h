@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * The row functions of DrawBitmapSIMD.h, implemented once for a generic
+ * vector type, and instantiated for SSE2 and AVX2.
+ *
+ */
+#ifndef DRAW_BITMAP_SIMD_KERNELS_H
+#define DRAW_BITMAP_SIMD_KERNELS_H
+
+
+#include "DrawBitmapSIMD.h"
+#include "DrawingModeSIMDKernels.h"
+
+
+using BitmapPainterPrivate::FilterInfo;
+
+
+/*!	On top of what DrawingModeSIMDKernels.h needs, the vector type \c V has
+	to provide:
+	- \c kLanes, the number of 128 bit lanes; each pixel is interpolated in
+	  a lane of its own,
+	- LoadPairs(), which loads two neighbouring pixels from each of the
+	  \c kLanes addresses into the lower half of the respective lane,
+	- SetLanes32(), which sets all 32 bit values of each lane to one of the
+	  \c kLanes values,
+	- Add32() and MultiplyAdd16() (signed),
+	- PackPixels(), which packs 4 * \c kLanes pixels with one channel per
+	  32 bit value into one vector of pixels, in order.
+*/
+
+
+/*!	Interpolates \c V::kLanes pixels, leaving each channel in a 32 bit value,
+	exactly like ColorTypeRgba::Interpolate(). All products and sums are
+	exact, so the order in which they are computed does not matter; the
+	vertical interpolation comes first here, as it uses the same weights for
+	all pixels.
+*/
+template<typename V>
+static inline typename V::Type
+simd_interpolate_lanes(const uint8* const* tops, uint32 bytesPerRow,
+	const FilterInfo* weightsX, typename V::Type verticalWeights)
+{
+	typedef typename V::Type Type;
+
+	const uint8* bottoms[V::kLanes];
+	uint32 horizontalWeights[V::kLanes];
+	for (int32 i = 0; i < V::kLanes; i++) {
+		bottoms[i] = tops[i] + bytesPerRow;
+		horizontalWeights[i] = weightsX[i].weight
+			| ((uint32)(255 - weightsX[i].weight) << 16);
+	}
+
+	// Interleave the top and bottom row, so that each channel of the left
+	// and right pixel can be interpolated vertically with one multiply-add.
+	Type zero = V::Zero();
+	Type topBottom = V::UnpackLow8(V::LoadPairs(tops), V::LoadPairs(bottoms));
+	Type left = V::MultiplyAdd16(V::UnpackLow8(topBottom, zero),
+		verticalWeights);
+	Type right = V::MultiplyAdd16(V::UnpackHigh8(topBottom, zero),
+		verticalWeights);
+
+	// The results can have 16 bits, too many for a signed multiply-add, so
+	// the horizontal interpolation is done on the lower and upper 8 bits
+	// separately.
+	Type lowMask = V::Set32(0xff);
+	Type low = V::Or(V::And(left, lowMask),
+		V::ShiftLeft32(V::And(right, lowMask), 16));
+	Type high = V::Or(V::ShiftRight32(left, 8),
+		V::ShiftLeft32(V::ShiftRight32(right, 8), 16));
+
+	Type weights = V::SetLanes32(horizontalWeights);
+	Type sum = V::Add32(V::MultiplyAdd16(low, weights),
+		V::ShiftLeft32(V::MultiplyAdd16(high, weights), 8));
+	return V::ShiftRight32(sum, 16);
+}
+
+
+/*!	Interpolates and draws 4 * \c V::kLanes pixels at a time, and returns
+	how many pixels were drawn.
+*/
+template<typename V, int kMode>
+static inline int32
+simd_bilinear_scale_row(uint8* dest, const uint8* top, uint32 bytesPerRow,
+	const FilterInfo* weightsX, int32 count, uint16 wTop)
+{
+	typedef typename V::Type Type;
+
+	const int32 kGroupPixels = 4 * V::kLanes;
+	Type verticalWeights = V::Set32(wTop | ((uint32)(255 - wTop) << 16));
+	Type alphaMask = V::Set32(0xff000000);
+
+	int32 done = 0;
+	for (; done + kGroupPixels <= count; done += kGroupPixels) {
+		Type channels[4];
+		for (int32 i = 0; i < 4; i++) {
+			const FilterInfo* weights = weightsX + done + i * V::kLanes;
+			const uint8* tops[V::kLanes];
+			for (int32 j = 0; j < V::kLanes; j++)
+				tops[j] = top + weights[j].index;
+
+			channels[i] = simd_interpolate_lanes<V>(tops, bytesPerRow, weights,
+				verticalWeights);
+		}
+
+		Type source = V::PackPixels(channels);
+		Type destination = V::Load(dest);
+		Type result;
+		if (kMode == BitmapPainterPrivate::SIMD_BILINEAR_ALPHA_OVERLAY) {
+			// Like DrawModeAlphaOverlay: pixels with an alpha of 255 are
+			// copied, the others blended with their alpha.
+			Type alpha = V::ShiftRight32(source, 24);
+			Type opaque = V::Equal32(alpha, V::Set32(255));
+			if (V::MoveMask(opaque) == V::kAllMask)
+				result = source;
+			else {
+				result = simd_select<V>(opaque, source,
+					simd_blend_pixels<V>(destination, source,
+						V::ShiftLeft32(alpha, 8)));
+			}
+		} else
+			result = source;
+
+		// Neither mode touches the alpha channel of the destination
+		V::Store(dest, simd_select<V>(alphaMask, destination, result));
+		dest += kGroupPixels * 4;
+	}
+
+	return done;
+}
+
+
+// SSE2 versions
+int32 bilinear_scale_row_copy_sse2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop);
+int32 bilinear_scale_row_alpha_overlay_sse2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop);
+
+// AVX2 versions
+int32 bilinear_scale_row_copy_avx2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop);
+int32 bilinear_scale_row_alpha_overlay_avx2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop);
+int32 nearest_neighbor_scale_row_avx2(uint32* dest, const uint8* source,
+	const uint16* indices, int32 count);
+
+
+#endif	// DRAW_BITMAP_SIMD_KERNELS_H
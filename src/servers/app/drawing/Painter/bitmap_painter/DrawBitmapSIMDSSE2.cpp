@@ -0,0 +1,40 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DrawBitmapSIMD.h"
+
+#if APPSERVER_SIMD_SPANS
+
+// Everything following is compiled for SSE2, which is not a given on x86.
+// These functions are only called once DrawBitmapSIMD.cpp has made sure that
+// the CPU supports it.
+#pragma GCC target("sse2")
+
+#include "DrawBitmapSIMDKernels.h"
+#include "SIMDVectorSSE2.h"
+
+
+int32
+bilinear_scale_row_copy_sse2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop)
+{
+	return simd_bilinear_scale_row<SSE2Vector,
+		BitmapPainterPrivate::SIMD_BILINEAR_COPY>(dest, top, bytesPerRow,
+			weightsX, count, wTop);
+}
+
+
+int32
+bilinear_scale_row_alpha_overlay_sse2(uint8* dest, const uint8* top,
+	uint32 bytesPerRow, const FilterInfo* weightsX, int32 count, uint16 wTop)
+{
+	return simd_bilinear_scale_row<SSE2Vector,
+		BitmapPainterPrivate::SIMD_BILINEAR_ALPHA_OVERLAY>(dest, top,
+			bytesPerRow, weightsX, count, wTop);
+}
+
+
+#endif	// APPSERVER_SIMD_SPANS
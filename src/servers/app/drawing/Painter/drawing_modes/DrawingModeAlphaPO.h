@@ -10,6 +10,7 @@
 #define DRAWING_MODE_ALPHA_PO_H
 
 #include "DrawingMode.h"
+#include "DrawingModeSIMD.h"
 
 // BLEND_ALPHA_PO
 #define BLEND_ALPHA_PO(d, r, g, b, a) \
@@ -120,6 +121,9 @@ blend_color_hspan_alpha_po(int x, int y, unsigned len,
 						   agg_buffer* buffer, const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (blend_color_hspan_alpha_po_simd(p, len, colors, covers, cover))
+		return;
+
 	if (covers) {
 		// non-solid opacity
 		do {
@@ -69,6 +69,9 @@ blend_solid_hspan_alpha_po_solid(int x, int y, unsigned len,
 						 		 agg_buffer* buffer, const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (blend_solid_hspan_alpha_po_simd(p, len, c, covers))
+		return;
+
 	do {
 		uint16 alpha = c.a * *covers;
 		if (alpha) {
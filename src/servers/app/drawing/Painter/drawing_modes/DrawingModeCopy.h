@@ -10,6 +10,7 @@
 #define DRAWING_MODE_COPY_H
 
 #include "DrawingMode.h"
+#include "DrawingModeSIMD.h"
 
 // BLEND_COPY
 #define BLEND_COPY(d, r2, g2, b2, a, r1, g1, b1) \
@@ -167,6 +168,9 @@ blend_color_hspan_copy(int x, int y, unsigned len, const color_type* colors,
 	} else {
 		// solid full opcacity
 		if (cover == 255) {
+			if (copy_color_hspan_simd(p, len, colors))
+				return;
+
 			do {
 				ASSIGN_COPY(p, colors->r, colors->g, colors->b, colors->a);
 				p += 4;
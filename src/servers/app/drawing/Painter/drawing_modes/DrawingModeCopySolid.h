@@ -61,6 +61,9 @@ blend_solid_hspan_copy_solid(int x, int y, unsigned len,
 							 const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (blend_solid_hspan_over_simd(p, len, c, covers))
+		return;
+
 	do {
 		if (*covers) {
 			if (*covers == 255) {
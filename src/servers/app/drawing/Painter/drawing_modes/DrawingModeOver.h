@@ -10,6 +10,7 @@
 #define DRAWING_MODE_OVER_H
 
 #include "DrawingMode.h"
+#include "DrawingModeSIMD.h"
 
 // BLEND_OVER
 #define BLEND_OVER(d, r, g, b, a) \
@@ -135,6 +136,9 @@ blend_color_hspan_over(int x, int y, unsigned len,
 					   agg_buffer* buffer, const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (blend_color_hspan_over_simd(p, len, colors, covers, cover))
+		return;
+
 	if (covers) {
 		// non-solid opacity
 		do {
@@ -69,6 +69,9 @@ blend_solid_hspan_over_solid(int x, int y, unsigned len,
 		return;
 
 	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (blend_solid_hspan_over_simd(p, len, c, covers))
+		return;
+
 	do {
 		if (*covers) {
 			if (*covers == 255) {
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DrawingModeSIMD.h"
+
+#if APPSERVER_SIMD_SPANS
+
+#include "DrawingModeSIMDKernels.h"
+#include "Painter.h"
+
+
+// Spans shorter than this are blended faster by the scalar versions.
+static const unsigned kMinSIMDSpanLength = 8;
+
+
+extern uint32 gSIMDFlags;
+
+
+bool
+blend_color_hspan_alpha_po_simd(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover)
+{
+	if (len < kMinSIMDSpanLength)
+		return false;
+
+	if ((gSIMDFlags & APPSERVER_SIMD_AVX2) != 0)
+		blend_color_hspan_alpha_po_avx2(p, len, colors, covers, cover);
+	else if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0)
+		blend_color_hspan_alpha_po_sse2(p, len, colors, covers, cover);
+	else
+		return false;
+
+	return true;
+}
+
+
+bool
+blend_solid_hspan_alpha_po_simd(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	if (len < kMinSIMDSpanLength)
+		return false;
+
+	if ((gSIMDFlags & APPSERVER_SIMD_AVX2) != 0)
+		blend_solid_hspan_alpha_po_avx2(p, len, c, covers);
+	else if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0)
+		blend_solid_hspan_alpha_po_sse2(p, len, c, covers);
+	else
+		return false;
+
+	return true;
+}
+
+
+bool
+blend_color_hspan_over_simd(uint8* p, unsigned len, const color_type* colors,
+	const uint8* covers, uint8 cover)
+{
+	if (len < kMinSIMDSpanLength)
+		return false;
+
+	if ((gSIMDFlags & APPSERVER_SIMD_AVX2) != 0)
+		blend_color_hspan_over_avx2(p, len, colors, covers, cover);
+	else if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0)
+		blend_color_hspan_over_sse2(p, len, colors, covers, cover);
+	else
+		return false;
+
+	return true;
+}
+
+
+bool
+blend_solid_hspan_over_simd(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	if (len < kMinSIMDSpanLength)
+		return false;
+
+	if ((gSIMDFlags & APPSERVER_SIMD_AVX2) != 0)
+		blend_solid_hspan_over_avx2(p, len, c, covers);
+	else if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0)
+		blend_solid_hspan_over_sse2(p, len, c, covers);
+	else
+		return false;
+
+	return true;
+}
+
+
+bool
+copy_color_hspan_simd(uint8* p, unsigned len, const color_type* colors)
+{
+	if (len < kMinSIMDSpanLength)
+		return false;
+
+	if ((gSIMDFlags & APPSERVER_SIMD_AVX2) != 0)
+		copy_color_hspan_avx2(p, len, colors);
+	else if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0)
+		copy_color_hspan_sse2(p, len, colors);
+	else
+		return false;
+
+	return true;
+}
+
+
+#endif	// APPSERVER_SIMD_SPANS
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 and AVX2 versions of the span blending functions of the most common
+ * drawing modes on B_RGBA32.
+ *
+ */
+#ifndef DRAWING_MODE_SIMD_H
+#define DRAWING_MODE_SIMD_H
+
+
+#include "PixelFormat.h"
+
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5
+#	define APPSERVER_SIMD_SPANS 1
+#else
+#	define APPSERVER_SIMD_SPANS 0
+#endif
+
+
+// All of these functions produce exactly the same pixels as the scalar
+// versions in the DrawingMode*.h headers. They return false without touching
+// the buffer, if the CPU does not support them, or if the span is too short
+// to benefit; the caller has to blend the span itself then.
+
+#if APPSERVER_SIMD_SPANS
+
+// B_OP_ALPHA, B_PIXEL_ALPHA, B_ALPHA_OVERLAY
+bool blend_color_hspan_alpha_po_simd(uint8* p, unsigned len,
+	const PixelFormat::color_type* colors, const uint8* covers, uint8 cover);
+bool blend_solid_hspan_alpha_po_simd(uint8* p, unsigned len,
+	const PixelFormat::color_type& c, const uint8* covers);
+
+// B_OP_OVER, and the solid color B_OP_COPY
+bool blend_color_hspan_over_simd(uint8* p, unsigned len,
+	const PixelFormat::color_type* colors, const uint8* covers, uint8 cover);
+bool blend_solid_hspan_over_simd(uint8* p, unsigned len,
+	const PixelFormat::color_type& c, const uint8* covers);
+
+// B_OP_COPY at full opacity
+bool copy_color_hspan_simd(uint8* p, unsigned len,
+	const PixelFormat::color_type* colors);
+
+#else	// !APPSERVER_SIMD_SPANS
+
+static inline bool
+blend_color_hspan_alpha_po_simd(uint8*, unsigned,
+	const PixelFormat::color_type*, const uint8*, uint8)
+{
+	return false;
+}
+
+
+static inline bool
+blend_solid_hspan_alpha_po_simd(uint8*, unsigned,
+	const PixelFormat::color_type&, const uint8*)
+{
+	return false;
+}
+
+
+static inline bool
+blend_color_hspan_over_simd(uint8*, unsigned,
+	const PixelFormat::color_type*, const uint8*, uint8)
+{
+	return false;
+}
+
+
+static inline bool
+blend_solid_hspan_over_simd(uint8*, unsigned,
+	const PixelFormat::color_type&, const uint8*)
+{
+	return false;
+}
+
+
+static inline bool
+copy_color_hspan_simd(uint8*, unsigned, const PixelFormat::color_type*)
+{
+	return false;
+}
+
+#endif	// !APPSERVER_SIMD_SPANS
+
+
+#endif	// DRAWING_MODE_SIMD_H
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DrawingModeSIMD.h"
+
+#if APPSERVER_SIMD_SPANS
+
+// Everything following is compiled for AVX2. These functions are only called
+// once DrawingModeSIMD.cpp has made sure that the CPU and OS support AVX2.
+#pragma GCC target("avx2")
+
+#include "DrawingModeSIMDKernels.h"
+#include "SIMDVectorAVX2.h"
+
+
+void
+blend_color_hspan_alpha_po_avx2(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover)
+{
+	simd_blend_color_hspan_alpha_po<AVX2Vector>(p, len, colors, covers, cover);
+}
+
+
+void
+blend_solid_hspan_alpha_po_avx2(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	simd_blend_solid_hspan_alpha_po<AVX2Vector>(p, len, c, covers);
+}
+
+
+void
+blend_color_hspan_over_avx2(uint8* p, unsigned len, const color_type* colors,
+	const uint8* covers, uint8 cover)
+{
+	simd_blend_color_hspan_over<AVX2Vector>(p, len, colors, covers, cover);
+}
+
+
+void
+blend_solid_hspan_over_avx2(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	simd_blend_solid_hspan_over<AVX2Vector>(p, len, c, covers);
+}
+
+
+void
+copy_color_hspan_avx2(uint8* p, unsigned len, const color_type* colors)
+{
+	simd_copy_color_hspan<AVX2Vector>(p, len, colors);
+}
+
+
+#endif	// APPSERVER_SIMD_SPANS
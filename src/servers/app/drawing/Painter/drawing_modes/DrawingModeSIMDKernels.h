@@ -0,0 +1,333 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * The span blending functions of DrawingModeSIMD.h, implemented once for a
+ * generic vector type, and instantiated for SSE2 and AVX2.
+ *
+ */
+#ifndef DRAWING_MODE_SIMD_KERNELS_H
+#define DRAWING_MODE_SIMD_KERNELS_H
+
+
+#include <string.h>
+
+#include "DrawingModeSIMD.h"
+
+
+typedef PixelFormat::color_type color_type;
+
+
+/*!	A vector type \c V has to provide:
+	- \c Type and \c kPixels, the register type and how many 32 bit pixels
+	  fit into it,
+	- \c kAllMask, the result of MoveMask() if all bytes are set,
+	- Zero(), Set32(), Load() and Store() (both unaligned),
+	- LoadCovers(), which zero extends \c kPixels covers to 32 bit each,
+	- And(), AndNot() (which inverts its first argument), Or() and Xor(),
+	- Add16(), Sub16(), Greater16() (signed), Equal16() and Equal32(),
+	- MulHigh16() (unsigned) and MulLow16(),
+	- ShiftLeft32() and ShiftRight32(),
+	- UnpackLow8/High8() and UnpackLow32/High32(), which interleave the
+	  lower or upper halves of two vectors (of each 128 bit lane),
+	- Pack16(), which packs two vectors of 16 bit values into one of 8 bit
+	  values with unsigned saturation, undoing UnpackLow8/High8(),
+	- MoveMask(), which returns a bit mask of the most significant bits of
+	  all bytes.
+
+	The 8 and 16 bit alpha blending of the scalar versions rounds towards
+	negative infinity, which is reproduced exactly by blend_pixels().
+*/
+
+
+enum {
+	SIMD_BLEND_ALPHA_PO,
+		// BLEND16 with the alpha of the color times the cover
+	SIMD_BLEND_OVER
+		// BLEND with the cover, transparent colors are left out
+};
+
+
+template<typename V>
+static inline typename V::Type
+simd_select(typename V::Type mask, typename V::Type a, typename V::Type b)
+{
+	return V::Or(V::And(mask, a), V::AndNot(mask, b));
+}
+
+
+/*!	Converts agg::rgba8 colors to B_RGBA32 pixels by swapping red and blue.
+*/
+template<typename V>
+static inline typename V::Type
+simd_rgba_to_bgra(typename V::Type rgba)
+{
+	typename V::Type redBlue = V::Set32(0x00ff00ff);
+	typename V::Type swapped = V::And(V::Or(V::ShiftLeft32(rgba, 16),
+		V::ShiftRight32(rgba, 16)), redBlue);
+	return V::Or(V::AndNot(redBlue, rgba), swapped);
+}
+
+
+/*!	Blends 16 bit channel values: d + floor((s - d) * alpha / 65536).
+	The product is computed from the magnitude of the difference, so the
+	fractional part of a negative product has to round the magnitude up.
+*/
+template<typename V>
+static inline typename V::Type
+simd_blend_channels(typename V::Type d, typename V::Type s,
+	typename V::Type alpha)
+{
+	typedef typename V::Type Type;
+
+	Type zero = V::Zero();
+	Type difference = V::Sub16(s, d);
+	Type negative = V::Greater16(zero, difference);
+	Type magnitude = V::Sub16(V::Xor(difference, negative), negative);
+
+	Type product = V::MulHigh16(magnitude, alpha);
+	Type fraction = V::MulLow16(magnitude, alpha);
+	Type roundUp = V::AndNot(V::Equal16(fraction, zero), negative);
+	product = V::Sub16(product, roundUp);
+
+	return V::Add16(d, V::Sub16(V::Xor(product, negative), negative));
+}
+
+
+/*!	Blends \a source over \a dest with a 16 bit \a alpha per pixel, in the
+	lower half of each 32 bit lane, just like BLEND16. The 8 bit BLEND is
+	the same with the alpha shifted up by 8 bits.
+*/
+template<typename V>
+static inline typename V::Type
+simd_blend_pixels(typename V::Type dest, typename V::Type source,
+	typename V::Type alpha)
+{
+	typedef typename V::Type Type;
+
+	Type zero = V::Zero();
+	alpha = V::Or(alpha, V::ShiftLeft32(alpha, 16));
+
+	Type low = simd_blend_channels<V>(V::UnpackLow8(dest, zero),
+		V::UnpackLow8(source, zero), V::UnpackLow32(alpha, alpha));
+	Type high = simd_blend_channels<V>(V::UnpackHigh8(dest, zero),
+		V::UnpackHigh8(source, zero), V::UnpackHigh32(alpha, alpha));
+
+	return V::Or(V::Pack16(low, high), V::Set32(0xff000000));
+}
+
+
+/*!	Blends \c V::kPixels pixels with either one color, or an array of
+	colors, and either one cover, or an array of covers.
+	In SIMD_BLEND_ALPHA_PO mode, the alpha of the colors is only used when
+	there are covers as well; otherwise, the scalar version uses the alpha
+	passed in for the whole span, and so does this one.
+*/
+template<typename V, int kMode, bool kColors, bool kCovers>
+class SIMDSpanBlender {
+public:
+	typedef typename V::Type Type;
+
+	SIMDSpanBlender(const color_type& color, uint8 alpha, uint8 cover)
+		:
+		fColor(V::Set32(color.b | (color.g << 8) | (color.r << 16)
+			| ((uint32)color.a << 24))),
+		fAlpha(V::Set32(alpha)),
+		fCover(V::Set32(cover))
+	{
+	}
+
+	inline void Blend(uint8* p, const color_type* colors,
+		const uint8* covers) const
+	{
+		Type zero = V::Zero();
+		Type source = fColor;
+		Type colorAlpha = fAlpha;
+		if (kColors) {
+			Type rgba = V::Load(colors);
+			source = simd_rgba_to_bgra<V>(rgba);
+			if (kCovers || kMode == SIMD_BLEND_OVER)
+				colorAlpha = V::ShiftRight32(rgba, 24);
+		}
+		Type cover = kCovers ? V::LoadCovers(covers) : fCover;
+
+		Type alpha;
+		Type skip;
+		Type assign;
+		if (kMode == SIMD_BLEND_ALPHA_PO) {
+			alpha = V::MulLow16(colorAlpha, cover);
+			skip = V::Equal32(alpha, zero);
+			assign = V::Equal32(alpha, V::Set32(255 * 255));
+		} else {
+			alpha = V::ShiftLeft32(cover, 8);
+			skip = V::Equal32(cover, zero);
+			if (kColors)
+				skip = V::Or(skip, V::Equal32(colorAlpha, zero));
+			assign = V::Equal32(cover, V::Set32(255));
+		}
+
+		uint32 skipMask = V::MoveMask(skip);
+		if (skipMask == V::kAllMask)
+			return;
+
+		Type opaque = V::Or(source, V::Set32(0xff000000));
+		Type dest = V::Load(p);
+		Type result;
+		if (V::MoveMask(assign) == V::kAllMask)
+			result = opaque;
+		else {
+			result = simd_select<V>(assign, opaque,
+				simd_blend_pixels<V>(dest, source, alpha));
+		}
+		if (skipMask != 0)
+			result = simd_select<V>(skip, dest, result);
+
+		V::Store(p, result);
+	}
+
+private:
+	Type	fColor;
+	Type	fAlpha;
+	Type	fCover;
+};
+
+
+template<typename V, typename Blender>
+static inline void
+simd_blend_span(uint8* p, unsigned len, const color_type* colors,
+	const uint8* covers, const Blender& blender)
+{
+	for (; len >= V::kPixels; len -= V::kPixels) {
+		blender.Blend(p, colors, covers);
+		p += V::kPixels * 4;
+		if (colors != NULL)
+			colors += V::kPixels;
+		if (covers != NULL)
+			covers += V::kPixels;
+	}
+
+	if (len == 0)
+		return;
+
+	// Blend the rest in a temporary buffer, so that we never touch anything
+	// beyond the end of the span. Missing covers are zero, and leave the
+	// pixels alone.
+	uint32 dest[V::kPixels];
+	uint32 sourceColors[V::kPixels];
+	uint8 sourceCovers[V::kPixels];
+	memset(dest, 0, sizeof(dest));
+	memset(sourceColors, 0, sizeof(sourceColors));
+	memset(sourceCovers, 0, sizeof(sourceCovers));
+
+	memcpy(dest, p, len * 4);
+	if (colors != NULL)
+		memcpy(sourceColors, colors, len * sizeof(color_type));
+	if (covers != NULL)
+		memcpy(sourceCovers, covers, len);
+
+	blender.Blend((uint8*)dest,
+		colors != NULL ? (const color_type*)sourceColors : NULL,
+		covers != NULL ? sourceCovers : NULL);
+
+	memcpy(p, dest, len * 4);
+}
+
+
+template<typename V>
+static inline void
+simd_blend_color_hspan_alpha_po(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover)
+{
+	if (covers != NULL) {
+		SIMDSpanBlender<V, SIMD_BLEND_ALPHA_PO, true, true> blender(*colors,
+			0, 0);
+		simd_blend_span<V>(p, len, colors, covers, blender);
+	} else {
+		SIMDSpanBlender<V, SIMD_BLEND_ALPHA_PO, true, false> blender(*colors,
+			colors->a, cover);
+		simd_blend_span<V>(p, len, colors, NULL, blender);
+	}
+}
+
+
+template<typename V>
+static inline void
+simd_blend_solid_hspan_alpha_po(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	SIMDSpanBlender<V, SIMD_BLEND_ALPHA_PO, false, true> blender(c, c.a, 0);
+	simd_blend_span<V>(p, len, NULL, covers, blender);
+}
+
+
+template<typename V>
+static inline void
+simd_blend_color_hspan_over(uint8* p, unsigned len, const color_type* colors,
+	const uint8* covers, uint8 cover)
+{
+	if (covers != NULL) {
+		SIMDSpanBlender<V, SIMD_BLEND_OVER, true, true> blender(*colors, 0, 0);
+		simd_blend_span<V>(p, len, colors, covers, blender);
+	} else {
+		SIMDSpanBlender<V, SIMD_BLEND_OVER, true, false> blender(*colors, 0,
+			cover);
+		simd_blend_span<V>(p, len, colors, NULL, blender);
+	}
+}
+
+
+template<typename V>
+static inline void
+simd_blend_solid_hspan_over(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	SIMDSpanBlender<V, SIMD_BLEND_OVER, false, true> blender(c, 0, 0);
+	simd_blend_span<V>(p, len, NULL, covers, blender);
+}
+
+
+template<typename V>
+static inline void
+simd_copy_color_hspan(uint8* p, unsigned len, const color_type* colors)
+{
+	for (; len >= V::kPixels; len -= V::kPixels) {
+		V::Store(p, simd_rgba_to_bgra<V>(V::Load(colors)));
+		p += V::kPixels * 4;
+		colors += V::kPixels;
+	}
+
+	for (; len > 0; len--) {
+		p[0] = colors->b;
+		p[1] = colors->g;
+		p[2] = colors->r;
+		p[3] = colors->a;
+		p += 4;
+		colors++;
+	}
+}
+
+
+// SSE2 versions
+void blend_color_hspan_alpha_po_sse2(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover);
+void blend_solid_hspan_alpha_po_sse2(uint8* p, unsigned len,
+	const color_type& c, const uint8* covers);
+void blend_color_hspan_over_sse2(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover);
+void blend_solid_hspan_over_sse2(uint8* p, unsigned len,
+	const color_type& c, const uint8* covers);
+void copy_color_hspan_sse2(uint8* p, unsigned len, const color_type* colors);
+
+// AVX2 versions
+void blend_color_hspan_alpha_po_avx2(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover);
+void blend_solid_hspan_alpha_po_avx2(uint8* p, unsigned len,
+	const color_type& c, const uint8* covers);
+void blend_color_hspan_over_avx2(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover);
+void blend_solid_hspan_over_avx2(uint8* p, unsigned len,
+	const color_type& c, const uint8* covers);
+void copy_color_hspan_avx2(uint8* p, unsigned len, const color_type* colors);
+
+
+#endif	// DRAWING_MODE_SIMD_KERNELS_H
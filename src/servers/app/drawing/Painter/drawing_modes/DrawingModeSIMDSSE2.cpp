@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DrawingModeSIMD.h"
+
+#if APPSERVER_SIMD_SPANS
+
+// Everything following is compiled for SSE2, which is not a given on x86.
+// These functions are only called once DrawingModeSIMD.cpp has made sure that
+// the CPU supports it.
+#pragma GCC target("sse2")
+
+#include "DrawingModeSIMDKernels.h"
+#include "SIMDVectorSSE2.h"
+
+
+void
+blend_color_hspan_alpha_po_sse2(uint8* p, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover)
+{
+	simd_blend_color_hspan_alpha_po<SSE2Vector>(p, len, colors, covers, cover);
+}
+
+
+void
+blend_solid_hspan_alpha_po_sse2(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	simd_blend_solid_hspan_alpha_po<SSE2Vector>(p, len, c, covers);
+}
+
+
+void
+blend_color_hspan_over_sse2(uint8* p, unsigned len, const color_type* colors,
+	const uint8* covers, uint8 cover)
+{
+	simd_blend_color_hspan_over<SSE2Vector>(p, len, colors, covers, cover);
+}
+
+
+void
+blend_solid_hspan_over_sse2(uint8* p, unsigned len, const color_type& c,
+	const uint8* covers)
+{
+	simd_blend_solid_hspan_over<SSE2Vector>(p, len, c, covers);
+}
+
+
+void
+copy_color_hspan_sse2(uint8* p, unsigned len, const color_type* colors)
+{
+	simd_copy_color_hspan<SSE2Vector>(p, len, colors);
+}
+
+
+#endif	// APPSERVER_SIMD_SPANS
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SIMD_VECTOR_AVX2_H
+#define SIMD_VECTOR_AVX2_H
+
+
+/*!	The AVX2 vector type for the templates in DrawingModeSIMDKernels.h and
+	DrawBitmapSIMDKernels.h. It must only be included after
+	"#pragma GCC target(\"avx2\")".
+*/
+
+
+#include <string.h>
+
+#include <immintrin.h>
+
+#include <SupportDefs.h>
+
+
+struct AVX2Vector {
+	typedef __m256i Type;
+
+	static const unsigned kPixels = 8;
+	static const uint32 kAllMask = 0xffffffff;
+
+	static inline Type Zero()
+	{
+		return _mm256_setzero_si256();
+	}
+
+	static inline Type Set32(uint32 value)
+	{
+		return _mm256_set1_epi32(value);
+	}
+
+	static inline Type Load(const void* address)
+	{
+		return _mm256_loadu_si256((const __m256i*)address);
+	}
+
+	static inline void Store(void* address, Type value)
+	{
+		_mm256_storeu_si256((__m256i*)address, value);
+	}
+
+	static inline Type LoadCovers(const uint8* covers)
+	{
+		return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)covers));
+	}
+
+	static inline Type And(Type a, Type b)
+	{
+		return _mm256_and_si256(a, b);
+	}
+
+	static inline Type AndNot(Type a, Type b)
+	{
+		return _mm256_andnot_si256(a, b);
+	}
+
+	static inline Type Or(Type a, Type b)
+	{
+		return _mm256_or_si256(a, b);
+	}
+
+	static inline Type Xor(Type a, Type b)
+	{
+		return _mm256_xor_si256(a, b);
+	}
+
+	static inline Type Add16(Type a, Type b)
+	{
+		return _mm256_add_epi16(a, b);
+	}
+
+	static inline Type Sub16(Type a, Type b)
+	{
+		return _mm256_sub_epi16(a, b);
+	}
+
+	static inline Type Add32(Type a, Type b)
+	{
+		return _mm256_add_epi32(a, b);
+	}
+
+	static inline Type MultiplyAdd16(Type a, Type b)
+	{
+		return _mm256_madd_epi16(a, b);
+	}
+
+	static inline Type Greater16(Type a, Type b)
+	{
+		return _mm256_cmpgt_epi16(a, b);
+	}
+
+	static inline Type Equal16(Type a, Type b)
+	{
+		return _mm256_cmpeq_epi16(a, b);
+	}
+
+	static inline Type Equal32(Type a, Type b)
+	{
+		return _mm256_cmpeq_epi32(a, b);
+	}
+
+	static inline Type MulHigh16(Type a, Type b)
+	{
+		return _mm256_mulhi_epu16(a, b);
+	}
+
+	static inline Type MulLow16(Type a, Type b)
+	{
+		return _mm256_mullo_epi16(a, b);
+	}
+
+	static inline Type ShiftLeft32(Type a, int count)
+	{
+		return _mm256_slli_epi32(a, count);
+	}
+
+	static inline Type ShiftRight32(Type a, int count)
+	{
+		return _mm256_srli_epi32(a, count);
+	}
+
+	// The unpack and pack instructions work on each 128 bit lane separately,
+	// so they still undo each other.
+	static inline Type UnpackLow8(Type a, Type b)
+	{
+		return _mm256_unpacklo_epi8(a, b);
+	}
+
+	static inline Type UnpackHigh8(Type a, Type b)
+	{
+		return _mm256_unpackhi_epi8(a, b);
+	}
+
+	static inline Type UnpackLow32(Type a, Type b)
+	{
+		return _mm256_unpacklo_epi32(a, b);
+	}
+
+	static inline Type UnpackHigh32(Type a, Type b)
+	{
+		return _mm256_unpackhi_epi32(a, b);
+	}
+
+	static inline Type Pack16(Type a, Type b)
+	{
+		return _mm256_packus_epi16(a, b);
+	}
+
+	static inline uint32 MoveMask(Type a)
+	{
+		return (uint32)_mm256_movemask_epi8(a);
+	}
+
+	// Each pixel of the bitmap scaling uses a 128 bit lane on its own.
+	static const int32 kLanes = 2;
+
+	static inline Type LoadPairs(const uint8* const* addresses)
+	{
+		return _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadl_epi64((const __m128i*)addresses[0])),
+			_mm_loadl_epi64((const __m128i*)addresses[1]), 1);
+	}
+
+	static inline Type SetLanes32(const uint32* values)
+	{
+		return _mm256_inserti128_si256(_mm256_castsi128_si256(
+			_mm_set1_epi32(values[0])), _mm_set1_epi32(values[1]), 1);
+	}
+
+	// Packs the channels of 4 * kLanes pixels in 32 bit each into pixels.
+	// Packing works within each 128 bit lane, so the pixels end up
+	// interleaved, and have to be put back into order.
+	static inline Type PackPixels(const Type* lanes)
+	{
+		Type packed = _mm256_packus_epi16(
+			_mm256_packs_epi32(lanes[0], lanes[1]),
+			_mm256_packs_epi32(lanes[2], lanes[3]));
+		return _mm256_permutevar8x32_epi32(packed,
+			_mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+	}
+};
+
+
+#endif	// SIMD_VECTOR_AVX2_H
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SIMD_VECTOR_SSE2_H
+#define SIMD_VECTOR_SSE2_H
+
+
+/*!	The SSE2 vector type for the templates in DrawingModeSIMDKernels.h and
+	DrawBitmapSIMDKernels.h. It must only be included after
+	"#pragma GCC target(\"sse2\")".
+*/
+
+
+#include <string.h>
+
+#include <emmintrin.h>
+
+#include <SupportDefs.h>
+
+
+struct SSE2Vector {
+	typedef __m128i Type;
+
+	static const unsigned kPixels = 4;
+	static const uint32 kAllMask = 0xffff;
+
+	static inline Type Zero()
+	{
+		return _mm_setzero_si128();
+	}
+
+	static inline Type Set32(uint32 value)
+	{
+		return _mm_set1_epi32(value);
+	}
+
+	static inline Type Load(const void* address)
+	{
+		return _mm_loadu_si128((const __m128i*)address);
+	}
+
+	static inline void Store(void* address, Type value)
+	{
+		_mm_storeu_si128((__m128i*)address, value);
+	}
+
+	static inline Type LoadCovers(const uint8* covers)
+	{
+		uint32 value;
+		memcpy(&value, covers, sizeof(value));
+
+		Type zero = _mm_setzero_si128();
+		Type result = _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero);
+		return _mm_unpacklo_epi16(result, zero);
+	}
+
+	static inline Type And(Type a, Type b)
+	{
+		return _mm_and_si128(a, b);
+	}
+
+	static inline Type AndNot(Type a, Type b)
+	{
+		return _mm_andnot_si128(a, b);
+	}
+
+	static inline Type Or(Type a, Type b)
+	{
+		return _mm_or_si128(a, b);
+	}
+
+	static inline Type Xor(Type a, Type b)
+	{
+		return _mm_xor_si128(a, b);
+	}
+
+	static inline Type Add16(Type a, Type b)
+	{
+		return _mm_add_epi16(a, b);
+	}
+
+	static inline Type Sub16(Type a, Type b)
+	{
+		return _mm_sub_epi16(a, b);
+	}
+
+	static inline Type Add32(Type a, Type b)
+	{
+		return _mm_add_epi32(a, b);
+	}
+
+	static inline Type MultiplyAdd16(Type a, Type b)
+	{
+		return _mm_madd_epi16(a, b);
+	}
+
+	static inline Type Greater16(Type a, Type b)
+	{
+		return _mm_cmpgt_epi16(a, b);
+	}
+
+	static inline Type Equal16(Type a, Type b)
+	{
+		return _mm_cmpeq_epi16(a, b);
+	}
+
+	static inline Type Equal32(Type a, Type b)
+	{
+		return _mm_cmpeq_epi32(a, b);
+	}
+
+	static inline Type MulHigh16(Type a, Type b)
+	{
+		return _mm_mulhi_epu16(a, b);
+	}
+
+	static inline Type MulLow16(Type a, Type b)
+	{
+		return _mm_mullo_epi16(a, b);
+	}
+
+	static inline Type ShiftLeft32(Type a, int count)
+	{
+		return _mm_slli_epi32(a, count);
+	}
+
+	static inline Type ShiftRight32(Type a, int count)
+	{
+		return _mm_srli_epi32(a, count);
+	}
+
+	static inline Type UnpackLow8(Type a, Type b)
+	{
+		return _mm_unpacklo_epi8(a, b);
+	}
+
+	static inline Type UnpackHigh8(Type a, Type b)
+	{
+		return _mm_unpackhi_epi8(a, b);
+	}
+
+	static inline Type UnpackLow32(Type a, Type b)
+	{
+		return _mm_unpacklo_epi32(a, b);
+	}
+
+	static inline Type UnpackHigh32(Type a, Type b)
+	{
+		return _mm_unpackhi_epi32(a, b);
+	}
+
+	static inline Type Pack16(Type a, Type b)
+	{
+		return _mm_packus_epi16(a, b);
+	}
+
+	static inline uint32 MoveMask(Type a)
+	{
+		return (uint32)_mm_movemask_epi8(a);
+	}
+
+	// Each pixel of the bitmap scaling uses a 128 bit lane on its own.
+	static const int32 kLanes = 1;
+
+	static inline Type LoadPairs(const uint8* const* addresses)
+	{
+		return _mm_loadl_epi64((const __m128i*)addresses[0]);
+	}
+
+	static inline Type SetLanes32(const uint32* values)
+	{
+		return _mm_set1_epi32(values[0]);
+	}
+
+	// Packs the channels of 4 * kLanes pixels in 32 bit each into pixels.
+	static inline Type PackPixels(const Type* lanes)
+	{
+		return _mm_packus_epi16(_mm_packs_epi32(lanes[0], lanes[1]),
+			_mm_packs_epi32(lanes[2], lanes[3]));
+	}
+};
+
+
+#endif	// SIMD_VECTOR_SSE2_H
@@ -141,10 +141,10 @@ Services::Services(const BMessage& services)
 	:
 	fListener(-1),
 	fUpdate(0),
-	fMaxSocket(0)
+	fEventQueue(-1)
 {
 	// setup pipe to communicate with the listener thread - as the listener
-	// blocks on select(), we need a mechanism to interrupt it
+	// blocks on the event queue, we need a mechanism to interrupt it
 	if (pipe(&fReadPipe) < 0) {
 		fReadPipe = -1;
 		return;
@@ -153,12 +153,15 @@ Services::Services(const BMessage& services)
 	fcntl(fReadPipe, F_SETFD, FD_CLOEXEC);
 	fcntl(fWritePipe, F_SETFD, FD_CLOEXEC);
 
-	FD_ZERO(&fSet);
-	FD_SET(fReadPipe, &fSet);
-
-	fMinSocket = fWritePipe + 1;
-	fMaxSocket = fWritePipe + 1;
+	// The sockets stay selected in the event queue, so that the listener
+	// doesn't have to go through all of them whenever one becomes ready.
+	fEventQueue = create_event_queue(O_CLOEXEC);
+	if (fEventQueue < 0) {
+		fListener = fEventQueue;
+		return;
+	}
 
+	_SelectSocket(fReadPipe);
 	_Update(services);
 
 	fListener = spawn_thread(_Listener, "services listener", B_NORMAL_PRIORITY,
@@ -174,6 +177,7 @@ Services::~Services()
 
 	close(fReadPipe);
 	close(fWritePipe);
+	close(fEventQueue);
 
 	// stop all services
 
@@ -224,13 +228,16 @@ Services::_NotifyListener(bool quit)
 }
 
 
-void
-Services::_UpdateMinMaxSocket(int socket)
+status_t
+Services::_SelectSocket(int socket)
 {
-	if (socket >= fMaxSocket)
-		fMaxSocket = socket + 1;
-	if (socket < fMinSocket)
-		fMinSocket = socket;
+	event_wait_info info;
+	info.object = socket;
+	info.type = B_OBJECT_TYPE_FD;
+	info.events = B_EVENT_READ;
+	info.user_data = NULL;
+
+	return event_queue_select(fEventQueue, &info);
 }
 
 
@@ -286,11 +293,9 @@ Services::_StartService(struct service& service)
 		service_connection& connection = *iterator;
 
 		fSocketMap[connection.socket] = &connection;
-		_UpdateMinMaxSocket(connection.socket);
-		FD_SET(connection.socket, &fSet);
+		_SelectSocket(connection.socket);
 	}
 
-	_NotifyListener();
 	printf("Starting service '%s'\n", service.name.c_str());
 	return B_OK;
 }
@@ -318,8 +323,9 @@ Services::_StopService(struct service* service)
 			if (socketIterator != fSocketMap.end())
 				fSocketMap.erase(socketIterator);
 
+			event_queue_deselect(fEventQueue, connection.socket,
+				B_OBJECT_TYPE_FD);
 			close(connection.socket);
-			FD_CLR(connection.socket, &fSet);
 		}
 	}
 
@@ -478,52 +484,50 @@ Services::_LaunchService(struct service& service, int socket)
 status_t
 Services::_Listener()
 {
-	while (true) {
-		fLock.Lock();
-		fd_set set = fSet;
-		fLock.Unlock();
+	event_wait_info events[16];
 
-		if (select(fMaxSocket, &set, NULL, NULL, NULL) < 0) {
-			if (errno == EINTR)
+	while (true) {
+		ssize_t count = event_queue_wait(fEventQueue, events, 16, 0, 0);
+		if (count < 0) {
+			if (count == B_INTERRUPTED)
 				continue;
 			// sleep a bit before trying again
 			snooze(1000000LL);
-		}
-
-		if (FD_ISSET(fReadPipe, &set)) {
-			char command;
-			if (read(fReadPipe, &command, 1) == 1 && command == 'q')
-				break;
+			continue;
 		}
 
 		BAutolock locker(fLock);
 
-		for (int i = fMinSocket; i < fMaxSocket; i++) {
-			if (!FD_ISSET(i, &set))
+		for (ssize_t i = 0; i < count; i++) {
+			int socket = events[i].object;
+
+			if (socket == fReadPipe) {
+				char command;
+				if (read(fReadPipe, &command, 1) == 1 && command == 'q')
+					return B_OK;
 				continue;
+			}
 
-			ServiceSocketMap::iterator iterator = fSocketMap.find(i);
+			ServiceSocketMap::iterator iterator = fSocketMap.find(socket);
 			if (iterator == fSocketMap.end())
 				continue;
 
 			struct service_connection& connection = *iterator->second;
-			int socket;
 
 			if (connection.Type() == SOCK_STREAM) {
 				// accept incoming connection
 				int value = 1;
-				ioctl(i, FIONBIO, &value, sizeof(value));
+				ioctl(connection.socket, FIONBIO, &value, sizeof(value));
 					// make sure we don't wait for the connection
 
 				socket = accept(connection.socket, NULL, NULL);
 
 				value = 0;
-				ioctl(i, FIONBIO, &value, sizeof(value));
+				ioctl(connection.socket, FIONBIO, &value, sizeof(value));
 
 				if (socket < 0)
 					continue;
-			} else
-				socket = connection.socket;
+			}
 
 			// launch this service's handler
 
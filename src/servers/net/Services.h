@@ -14,7 +14,6 @@
 
 #include <map>
 #include <string>
-#include <sys/select.h>
 
 
 struct service;
@@ -34,7 +33,7 @@ public:
 
 private:
 			void				_NotifyListener(bool quit = false);
-			void				_UpdateMinMaxSocket(int socket);
+			status_t			_SelectSocket(int socket);
 			status_t			_StartService(struct service& service);
 			status_t			_StopService(struct service* service);
 			status_t			_ToService(const BMessage& message,
@@ -53,9 +52,7 @@ private:
 			uint32				fUpdate;
 			int					fReadPipe;
 			int					fWritePipe;
-			int					fMinSocket;
-			int					fMaxSocket;
-			fd_set				fSet;
+			int					fEventQueue;
 };
 
 
@@ -149,6 +149,40 @@ x86_next_page_directory(Thread* from, Thread* to)
 }
 
 
+/*!	Makes the paging structures of \a addressSpace the active ones on the CPU
+	\a cpuData, if they aren't already.
+	Interrupts must be disabled.
+*/
+void
+x86_activate_address_space(cpu_ent* cpuData, VMAddressSpace* addressSpace)
+{
+	X86PagingStructures* activePagingStructures
+		= cpuData->arch.active_paging_structures;
+	X86PagingStructures* toPagingStructures
+		= static_cast<X86VMTranslationMap*>(addressSpace->TranslationMap())
+			->PagingStructures();
+	if (toPagingStructures == activePagingStructures)
+		return;
+
+	// update on which CPUs the address space is used
+	int cpu = cpuData->cpu_num;
+	activePagingStructures->active_on_cpus.ClearBitAtomic(cpu);
+	toPagingStructures->active_on_cpus.SetBitAtomic(cpu);
+
+	// assign the new paging structures to the CPU
+	toPagingStructures->AddReference();
+	cpuData->arch.active_paging_structures = toPagingStructures;
+
+	// set the page directory, if it changes
+	addr_t newPageDirectory = toPagingStructures->pgdir_phys;
+	if (newPageDirectory != activePagingStructures->pgdir_phys)
+		x86_swap_pgdir(newPageDirectory);
+
+	// This CPU no longer uses the previous paging structures.
+	activePagingStructures->RemoveReference();
+}
+
+
 /*!	Returns to the userland environment given by \a frame for a thread not
 	having been userland before.
 
@@ -220,32 +254,9 @@ arch_thread_context_switch(Thread* from, Thread* to)
 	if (to->user_local_storage != 0)
 		x86_set_tls_context(to);
 
-	X86PagingStructures* activePagingStructures
-		= cpuData->arch.active_paging_structures;
 	VMAddressSpace* toAddressSpace = to->team->address_space;
-
-	X86PagingStructures* toPagingStructures;
-	if (toAddressSpace != NULL
-		&& (toPagingStructures = static_cast<X86VMTranslationMap*>(
-				toAddressSpace->TranslationMap())->PagingStructures())
-					!= activePagingStructures) {
-		// update on which CPUs the address space is used
-		int cpu = cpuData->cpu_num;
-		activePagingStructures->active_on_cpus.ClearBitAtomic(cpu);
-		toPagingStructures->active_on_cpus.SetBitAtomic(cpu);
-
-		// assign the new paging structures to the CPU
-		toPagingStructures->AddReference();
-		cpuData->arch.active_paging_structures = toPagingStructures;
-
-		// set the page directory, if it changes
-		addr_t newPageDirectory = toPagingStructures->pgdir_phys;
-		if (newPageDirectory != activePagingStructures->pgdir_phys)
-			x86_swap_pgdir(newPageDirectory);
-
-		// This CPU no longer uses the previous paging structures.
-		activePagingStructures->RemoveReference();
-	}
+	if (toAddressSpace != NULL)
+		x86_activate_address_space(cpuData, toAddressSpace);
 
 #ifndef __x86_64__
 	gX86SwapFPUFunc(from->arch_info.fpu_state, to->arch_info.fpu_state);
@@ -18,6 +18,7 @@
 #include <KernelExport.h>
 
 #include <boot/kernel_args.h>
+#include <cpu.h>
 #include <smp.h>
 #include <util/AutoLock.h>
 #include <vm/vm.h>
@@ -29,6 +30,7 @@
 #include <arch/vm.h>
 #include <arch/int.h>
 #include <arch/cpu.h>
+#include <arch/thread.h>
 
 #include <arch/x86/bios.h>
 
@@ -709,14 +711,20 @@ arch_vm_init_post_modules(kernel_args *args)
 void
 arch_vm_aspace_swap(struct VMAddressSpace *from, struct VMAddressSpace *to)
 {
-	// This functions is only invoked when a userland thread is in the process
-	// of dying. It switches to the kernel team and does whatever cleanup is
-	// necessary (in case it is the team's main thread, it will delete the
-	// team).
+	// When switching to the kernel, this function is invoked by a userland
+	// thread in the process of dying. It switches to the kernel team and does
+	// whatever cleanup is necessary (in case it is the team's main thread, it
+	// will delete the team).
 	// It is however not necessary to change the page directory. Userland team's
 	// page directories include all kernel mappings as well. Furthermore our
 	// arch specific translation map data objects are ref-counted, so they won't
 	// go away as long as they are still used on any CPU.
+	if (to == VMAddressSpace::Kernel())
+		return;
+
+	// A vfork()ed team that exec()s moves from its parent's address space into
+	// one of its own and keeps running, so that one has to become active now.
+	x86_activate_address_space(get_cpu_struct(), to);
 }
 
 
@@ -377,8 +377,9 @@ X86PagingMethod64Bit::PageTableForAddress(uint64* virtualPMLTop,
 		mapCount++;
 	}
 
-	// No proper large page support at the moment, but they are used for the
-	// physical map area. Ensure that nothing tries to treat that as normal
+	// Large pages are used for the physical map area and for promoted user
+	// ranges. The translation map splits the latter up before looking up their
+	// page table, so ensure that nothing tries to treat the former as normal
 	// address space.
 	ASSERT(!(*pde & X86_64_PDE_LARGE_PAGE));
 
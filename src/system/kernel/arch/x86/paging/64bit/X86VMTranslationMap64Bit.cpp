@@ -39,7 +39,9 @@
 X86VMTranslationMap64Bit::X86VMTranslationMap64Bit(bool la57)
 	:
 	fPagingStructures(NULL),
-	fLA57(la57)
+	fLA57(la57),
+	fLargePageCount(0),
+	fSparePageTables(0)
 {
 }
 
@@ -73,6 +75,11 @@ X86VMTranslationMap64Bit::~X86VMTranslationMap64Bit()
 					if ((virtualPageDir[k] & X86_64_PDE_PRESENT) == 0)
 						continue;
 
+					// A large page belongs to its cache, its page table is
+					// on the spare list.
+					if ((virtualPageDir[k] & X86_64_PDE_LARGE_PAGE) != 0)
+						continue;
+
 					address = virtualPageDir[k] & X86_64_PDE_ADDRESS_MASK;
 					page = vm_lookup_page(address / B_PAGE_SIZE);
 					if (page == NULL) {
@@ -106,6 +113,22 @@ X86VMTranslationMap64Bit::~X86VMTranslationMap64Bit()
 			vm_page_set_state(page, PAGE_STATE_FREE);
 		}
 
+		// Free the page tables of ranges that were still promoted.
+		while (fSparePageTables != 0) {
+			address = fSparePageTables;
+			fSparePageTables
+				= ((uint64*)fPageMapper->GetPageTableAt(address))[0];
+
+			page = vm_lookup_page(address / B_PAGE_SIZE);
+			if (page == NULL) {
+				panic("spare page table on invalid page %#" B_PRIxPHYSADDR
+					"\n", address);
+			}
+
+			DEBUG_PAGE_ACCESS_START(page);
+			vm_page_set_state(page, PAGE_STATE_FREE);
+		}
+
 		fPageMapper->Delete();
 	}
 
@@ -207,9 +230,8 @@ X86VMTranslationMap64Bit::Map(addr_t virtualAddress, phys_addr_t physicalAddress
 
 	// Look up the page table for the virtual address, allocating new tables
 	// if required. Shouldn't fail.
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), virtualAddress, fIsKernelMap,
-		true, reservation, fPageMapper, fMapCount);
+	uint64* entry = _PageTableEntryForAddress(virtualAddress, true,
+		reservation);
 	ASSERT(entry != NULL);
 
 	// The entry should not already exist.
@@ -243,9 +265,7 @@ X86VMTranslationMap64Bit::Unmap(addr_t start, addr_t end)
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
-			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
-			NULL, fPageMapper, fMapCount);
+		uint64* pageTable = _PageTableForAddress(start, false, NULL);
 		if (pageTable == NULL) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
@@ -293,9 +313,7 @@ X86VMTranslationMap64Bit::DebugMarkRangePresent(addr_t start, addr_t end,
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
-			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
-			NULL, fPageMapper, fMapCount);
+		uint64* pageTable = _PageTableForAddress(start, false, NULL);
 		if (pageTable == NULL) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
@@ -343,9 +361,7 @@ X86VMTranslationMap64Bit::UnmapPage(VMArea* area, addr_t address,
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	// Look up the page table for the virtual address.
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap,
-		false, NULL, fPageMapper, fMapCount);
+	uint64* entry = _PageTableEntryForAddress(address, false, NULL);
 	if (entry == NULL)
 		return B_ENTRY_NOT_FOUND;
 
@@ -410,9 +426,7 @@ X86VMTranslationMap64Bit::UnmapPages(VMArea* area, addr_t base, size_t size,
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
-			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
-			NULL, fPageMapper, fMapCount);
+		uint64* pageTable = _PageTableForAddress(start, false, NULL);
 		if (pageTable == NULL) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
@@ -543,9 +557,7 @@ X86VMTranslationMap64Bit::UnmapArea(VMArea* area, bool deletingAddressSpace,
 			addr_t address = area->Base()
 				+ ((page->cache_offset * B_PAGE_SIZE) - area->cache_offset);
 
-			uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-				fPagingStructures->VirtualPMLTop(), address, fIsKernelMap,
-				false, NULL, fPageMapper, fMapCount);
+			uint64* entry = _PageTableEntryForAddress(address, false, NULL);
 			if (entry == NULL) {
 				panic("page %p has mapping for area %p (%#" B_PRIxADDR "), but "
 					"has no page table", page, area, address);
@@ -691,9 +703,7 @@ X86VMTranslationMap64Bit::Protect(addr_t start, addr_t end, uint32 attributes,
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
-			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
-			NULL, fPageMapper, fMapCount);
+		uint64* pageTable = _PageTableForAddress(start, false, NULL);
 		if (pageTable == NULL) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
@@ -748,9 +758,7 @@ X86VMTranslationMap64Bit::ClearFlags(addr_t address, uint32 flags)
 
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap,
-		false, NULL, fPageMapper, fMapCount);
+	uint64* entry = _PageTableEntryForAddress(address, false, NULL);
 	if (entry == NULL)
 		return B_OK;
 
@@ -779,9 +787,32 @@ X86VMTranslationMap64Bit::ClearAccessedAndModified(VMArea* area, addr_t address,
 	RecursiveLocker locker(fLock);
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap,
-		false, NULL, fPageMapper, fMapCount);
+	if (fLargePageCount > 0) {
+		uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
+			fPagingStructures->VirtualPMLTop(), address, fIsKernelMap, false,
+			NULL, fPageMapper, fMapCount);
+		uint64 largeEntry = pde != NULL ? *pde : 0;
+		if ((largeEntry & X86_64_PDE_LARGE_PAGE) != 0
+			&& ((largeEntry & X86_64_PDE_ACCESSED) != 0
+				|| !unmapIfUnaccessed)) {
+			// The large page only has a single accessed flag for all of its
+			// pages. We clear it only when visiting the first page, so that
+			// the range ages as a whole and is split up (when unaccessed)
+			// only on the next pass.
+			if ((largeEntry & X86_64_PDE_ACCESSED) != 0
+				&& address % k64BitPageTableRange == 0) {
+				X86PagingMethod64Bit::ClearTableEntryFlags(pde,
+					X86_64_PDE_ACCESSED);
+				InvalidatePage(address);
+				Flush();
+			}
+
+			_modified = (largeEntry & X86_64_PDE_DIRTY) != 0;
+			return (largeEntry & X86_64_PDE_ACCESSED) != 0;
+		}
+	}
+
+	uint64* entry = _PageTableEntryForAddress(address, false, NULL);
 	if (entry == NULL)
 		return false;
 
@@ -851,3 +882,180 @@ X86VMTranslationMap64Bit::PagingStructures() const
 {
 	return fPagingStructures;
 }
+
+
+size_t
+X86VMTranslationMap64Bit::LargePageSize() const
+{
+	// The kernel map uses large pages for the physical map area only.
+	return fIsKernelMap ? 0 : k64BitPageTableRange;
+}
+
+
+status_t
+X86VMTranslationMap64Bit::PromoteLargePage(addr_t virtualAddress)
+{
+	ASSERT(virtualAddress % k64BitPageTableRange == 0);
+
+	TRACE("X86VMTranslationMap64Bit::PromoteLargePage(%#" B_PRIxADDR ")\n",
+		virtualAddress);
+
+	if (fIsKernelMap)
+		return B_NOT_SUPPORTED;
+
+	RecursiveLocker locker(fLock);
+	ThreadCPUPinner pinner(thread_get_current_thread());
+
+	uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
+		fPagingStructures->VirtualPMLTop(), virtualAddress, fIsKernelMap,
+		false, NULL, fPageMapper, fMapCount);
+	if (pde == NULL || (*pde & X86_64_PDE_PRESENT) == 0)
+		return B_ENTRY_NOT_FOUND;
+	if ((*pde & X86_64_PDE_LARGE_PAGE) != 0)
+		return B_OK;
+
+	phys_addr_t physicalPageTable = *pde & X86_64_PDE_ADDRESS_MASK;
+	uint64* pageTable = (uint64*)fPageMapper->GetPageTableAt(
+		physicalPageTable);
+
+	// All entries must be present, map the aligned physical run in order, and
+	// must not differ in anything but their accessed and dirty flags.
+	const uint64 kAttributeMask = ~(X86_64_PTE_ADDRESS_MASK
+		| X86_64_PTE_ACCESSED | X86_64_PTE_DIRTY);
+	uint64 firstEntry = pageTable[0];
+	phys_addr_t physicalBase = firstEntry & X86_64_PTE_ADDRESS_MASK;
+	if ((firstEntry & X86_64_PTE_PRESENT) == 0
+		|| physicalBase % k64BitPageTableRange != 0) {
+		return B_BAD_VALUE;
+	}
+
+	for (uint32 i = 0; i < k64BitTableEntryCount; i++) {
+		uint64 entry = pageTable[i];
+		if ((entry & X86_64_PTE_ADDRESS_MASK)
+				!= physicalBase + i * B_PAGE_SIZE
+			|| (entry & kAttributeMask) != (firstEntry & kAttributeMask)) {
+			return B_BAD_VALUE;
+		}
+	}
+
+	// The CPUs may still set the accessed and dirty flags in the page table
+	// until the TLBs are flushed, so we set them conservatively.
+	uint64 largeEntry = physicalBase | (firstEntry & kAttributeMask)
+		| X86_64_PDE_LARGE_PAGE | X86_64_PDE_ACCESSED;
+	if ((firstEntry & X86_64_PTE_WRITABLE) != 0)
+		largeEntry |= X86_64_PDE_DIRTY;
+
+	X86PagingMethod64Bit::SetTableEntry(pde, largeEntry);
+
+	for (uint32 i = 0; i < k64BitTableEntryCount; i++)
+		InvalidatePage(virtualAddress + i * B_PAGE_SIZE);
+	Flush();
+
+	// No CPU can walk the page table anymore, keep it for a later demotion.
+	pageTable[0] = fSparePageTables;
+	fSparePageTables = physicalPageTable;
+
+	fLargePageCount++;
+	atomic_add(&gLargePageRangesPromoted, 1);
+
+	return B_OK;
+}
+
+
+/*!	Returns the page table for \a virtualAddress, splitting up a large page
+	covering the address first, if necessary.
+	The caller must have pinned the thread to its CPU.
+*/
+uint64*
+X86VMTranslationMap64Bit::_PageTableForAddress(addr_t virtualAddress,
+	bool allocateTables, vm_page_reservation* reservation)
+{
+	if (fLargePageCount > 0) {
+		uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
+			fPagingStructures->VirtualPMLTop(), virtualAddress, fIsKernelMap,
+			false, NULL, fPageMapper, fMapCount);
+		if (pde != NULL && (*pde & X86_64_PDE_LARGE_PAGE) != 0)
+			_DemoteLargePage(pde, virtualAddress);
+	}
+
+	return X86PagingMethod64Bit::PageTableForAddress(
+		fPagingStructures->VirtualPMLTop(), virtualAddress, fIsKernelMap,
+		allocateTables, reservation, fPageMapper, fMapCount);
+}
+
+
+uint64*
+X86VMTranslationMap64Bit::_PageTableEntryForAddress(addr_t virtualAddress,
+	bool allocateTables, vm_page_reservation* reservation)
+{
+	uint64* pageTable = _PageTableForAddress(virtualAddress, allocateTables,
+		reservation);
+	if (pageTable == NULL)
+		return NULL;
+
+	return &pageTable[VADDR_TO_PTE(virtualAddress)];
+}
+
+
+/*!	Splits up the large page mapped by \a pde into a page table with
+	equivalent entries. The caller must have pinned the thread to its CPU.
+*/
+void
+X86VMTranslationMap64Bit::_DemoteLargePage(uint64* pde, addr_t virtualAddress)
+{
+	RecursiveLocker locker(fLock);
+
+	uint64 largeEntry = *pde;
+	if ((largeEntry & X86_64_PDE_LARGE_PAGE) == 0)
+		return;
+
+	TRACE("X86VMTranslationMap64Bit::_DemoteLargePage(%#" B_PRIxADDR ")\n",
+		virtualAddress);
+
+	// Every promoted range has left a page table on the spare list.
+	phys_addr_t physicalPageTable = fSparePageTables;
+	ASSERT(physicalPageTable != 0);
+	uint64* pageTable = (uint64*)fPageMapper->GetPageTableAt(
+		physicalPageTable);
+	fSparePageTables = pageTable[0];
+
+	const uint64 kAttributeMask = X86_64_PTE_PRESENT | X86_64_PTE_WRITABLE
+		| X86_64_PTE_USER | X86_64_PTE_WRITE_THROUGH
+		| X86_64_PTE_CACHING_DISABLED | X86_64_PTE_ACCESSED
+		| X86_64_PTE_DIRTY | X86_64_PTE_NOT_EXECUTABLE;
+
+	while (true) {
+		// Other CPUs may set the dirty flag of the large entry via a stale TLB
+		// entry even after we have replaced it, so writable pages are marked
+		// dirty conservatively.
+		uint64 attributes = largeEntry & kAttributeMask;
+		if ((attributes & X86_64_PTE_WRITABLE) != 0)
+			attributes |= X86_64_PTE_DIRTY;
+
+		phys_addr_t physicalBase = largeEntry & X86_64_PDE_ADDRESS_MASK;
+		for (uint32 i = 0; i < k64BitTableEntryCount; i++) {
+			X86PagingMethod64Bit::SetTableEntry(&pageTable[i],
+				(physicalBase + i * B_PAGE_SIZE) | attributes);
+		}
+
+		uint64 oldEntry = X86PagingMethod64Bit::TestAndSetTableEntry(pde,
+			(physicalPageTable & X86_64_PDE_ADDRESS_MASK)
+				| X86_64_PDE_PRESENT
+				| X86_64_PDE_WRITABLE
+				| X86_64_PDE_USER,
+			largeEntry);
+		if (oldEntry == largeEntry)
+			break;
+
+		// the accessed or dirty flag has been set in the meantime
+		largeEntry = oldEntry;
+	}
+
+	// The translations haven't changed, but the large TLB entries of other
+	// CPUs must not outlive the large page.
+	InvalidatePage(ROUNDDOWN(virtualAddress, k64BitPageTableRange));
+	Flush();
+
+	fLargePageCount--;
+	atomic_add(&gLargePageRangesDemoted, 1);
+}
@@ -57,13 +57,31 @@ struct X86VMTranslationMap64Bit final : X86VMTranslationMap {
 									bool unmapIfUnaccessed,
 									bool& _modified);
 
+	virtual	size_t				LargePageSize() const;
+	virtual	status_t			PromoteLargePage(addr_t virtualAddress);
+
 	virtual	X86PagingStructures* PagingStructures() const;
 	inline	X86PagingStructures64Bit* PagingStructures64Bit() const
 									{ return fPagingStructures; }
 
+private:
+			uint64*				_PageTableForAddress(addr_t virtualAddress,
+									bool allocateTables,
+									vm_page_reservation* reservation);
+			uint64*				_PageTableEntryForAddress(
+									addr_t virtualAddress,
+									bool allocateTables,
+									vm_page_reservation* reservation);
+			void				_DemoteLargePage(uint64* pde,
+									addr_t virtualAddress);
+
 private:
 			X86PagingStructures64Bit* fPagingStructures;
 			bool				fLA57;
+			int32				fLargePageCount;
+			phys_addr_t			fSparePageTables;
+									// page tables of promoted ranges, linked
+									// through their first entry
 };
 
 
@@ -446,6 +446,7 @@ read_into_cache(file_cache_ref* ref, void* cookie, off_t offset,
 
 	// make the pages accessible in the cache
 	for (int32 i = pageIndex; i-- > 0;) {
+		vm_page_check_refault(cache, pages[i]);
 		DEBUG_PAGE_ACCESS_END(pages[i]);
 
 		cache->MarkPageUnbusy(pages[i]);
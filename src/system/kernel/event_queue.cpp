@@ -0,0 +1,692 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Event queues keep a set of objects selected across calls, unlike
+	select(), poll(), and wait_for_objects(), which have to select and
+	deselect every object each time they are called. The objects notify the
+	queue through their select_info, which is then put on the queue's list of
+	pending events; waiting only needs to look at that list.
+
+	Level-triggered events are implemented by deselecting and reselecting the
+	object after its events have been reported: if the condition still holds,
+	the object will report it again right away.
+*/
+
+
+#include <fcntl.h>
+
+#include <new>
+
+#include <OS.h>
+
+#include <AutoDeleterDrivers.h>
+#include <StackOrHeapArray.h>
+
+#include <condition_variable.h>
+#include <fs/fd.h>
+#include <lock.h>
+#include <syscall_restart.h>
+#include <util/AutoLock.h>
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+#include <vfs.h>
+#include <wait_for_objects.h>
+
+
+//#define TRACE_EVENT_QUEUE
+#ifdef TRACE_EVENT_QUEUE
+#	define TRACE(x) dprintf x
+#else
+#	define TRACE(x) ;
+#endif
+
+
+static const uint16 kAlwaysSelectedEvents
+	= B_EVENT_ERROR | B_EVENT_DISCONNECTED | B_EVENT_INVALID;
+static const int32 kBehaviorFlags = B_EVENT_EDGE_TRIGGERED | B_EVENT_ONE_SHOT;
+static const int kMaxUserWaitInfos = 1024;
+	// userland cannot have the kernel hold more than this during a wait
+
+
+struct select_event : select_info, DoublyLinkedListLinkImpl<select_event> {
+	int32				object;
+	uint16				type;
+	uint16				requested_events;
+	int32				behavior;
+	void*				user_data;
+	io_context*			context;
+		// the I/O context a file descriptor has been selected in
+	bool				queued;
+	bool				removed;
+		// no longer part of the queue, but the object still has to notify
+		// it with B_EVENT_INVALID before it can be freed
+	select_event*		hash_next;
+};
+
+
+static inline uint64
+event_key(int32 object, uint16 type)
+{
+	return ((uint64)type << 32) | (uint32)object;
+}
+
+
+struct EventHashDefinition {
+	typedef uint64			KeyType;
+	typedef select_event	ValueType;
+
+	size_t HashKey(uint64 key) const
+	{
+		return (size_t)(key ^ (key >> 29));
+	}
+
+	size_t Hash(select_event* value) const
+	{
+		return HashKey(event_key(value->object, value->type));
+	}
+
+	bool Compare(uint64 key, select_event* value) const
+	{
+		return event_key(value->object, value->type) == key;
+	}
+
+	select_event*& GetLink(select_event* value) const
+	{
+		return value->hash_next;
+	}
+};
+
+typedef BOpenHashTable<EventHashDefinition> EventTable;
+typedef DoublyLinkedList<select_event> EventList;
+
+
+class EventQueue : public select_sync {
+public:
+								EventQueue(bool kernel);
+	virtual						~EventQueue();
+
+			status_t			Init();
+			void				Closed();
+
+			status_t			Select(int32 object, uint16 type, int32 events,
+									void* userData);
+			status_t			Deselect(int32 object, uint16 type);
+			ssize_t				Wait(event_wait_info* infos, int numInfos,
+									uint32 flags, bigtime_t timeout);
+
+	virtual	status_t			Notify(select_info* info, uint16 events);
+
+private:
+			status_t			_SelectEvent(select_event* event);
+			status_t			_DeselectEvent(select_event* event);
+			void				_ReleaseEvent(select_event* event);
+			int					_ReportEvents(EventList& events,
+									event_wait_info* infos);
+
+private:
+			mutex				fLock;
+				// protects fEvents, and the selection of the events
+			spinlock			fQueueLock;
+				// protects fQueue, fClosed, and the events' "events",
+				// "queued", and "removed" fields
+			EventTable			fEvents;
+			EventList			fQueue;
+			ConditionVariable	fQueueCondition;
+			bool				fKernel;
+			bool				fClosed;
+};
+
+
+EventQueue::EventQueue(bool kernel)
+	:
+	fKernel(kernel),
+	fClosed(false)
+{
+	mutex_init(&fLock, "event queue");
+	B_INITIALIZE_SPINLOCK(&fQueueLock);
+	fQueueCondition.Init(this, "event queue");
+}
+
+
+EventQueue::~EventQueue()
+{
+	// All objects have given up their references by now, so the removed
+	// events have all been notified with B_EVENT_INVALID, and are queued.
+	while (select_event* event = fQueue.RemoveHead()) {
+		if (event->removed)
+			delete event;
+	}
+
+	select_event* event = fEvents.Clear(true);
+	while (event != NULL) {
+		select_event* next = event->hash_next;
+		delete event;
+		event = next;
+	}
+
+	mutex_destroy(&fLock);
+}
+
+
+status_t
+EventQueue::Init()
+{
+	return fEvents.Init();
+}
+
+
+void
+EventQueue::Closed()
+{
+	MutexLocker locker(fLock);
+
+	InterruptsSpinLocker queueLocker(fQueueLock);
+	fClosed = true;
+	fQueueCondition.NotifyAll(B_FILE_ERROR);
+	queueLocker.Unlock();
+
+	select_event* event = fEvents.Clear(true);
+	while (event != NULL) {
+		select_event* next = event->hash_next;
+		_ReleaseEvent(event);
+		event = next;
+	}
+}
+
+
+status_t
+EventQueue::Select(int32 object, uint16 type, int32 events, void* userData)
+{
+	TRACE(("EventQueue::Select(%p, %" B_PRId32 ", %u, %#" B_PRIx32 ")\n", this,
+		object, type, events));
+
+	MutexLocker locker(fLock);
+	if (fClosed)
+		return B_FILE_ERROR;
+
+	// Changing an existing event is done by replacing it, so that its
+	// current state is checked again.
+	select_event* event = fEvents.Lookup(event_key(object, type));
+	if (event != NULL) {
+		fEvents.RemoveUnchecked(event);
+		_ReleaseEvent(event);
+	}
+
+	event = new(std::nothrow) select_event;
+	if (event == NULL)
+		return B_NO_MEMORY;
+
+	event->next = NULL;
+	event->sync = this;
+	event->events = 0;
+	event->object = object;
+	event->type = type;
+	event->requested_events = (uint16)events | kAlwaysSelectedEvents;
+	event->behavior = events & kBehaviorFlags;
+	event->user_data = userData;
+	event->context = type == B_OBJECT_TYPE_FD
+		? get_current_io_context(fKernel) : NULL;
+	event->queued = false;
+	event->removed = false;
+
+	status_t status = fEvents.Insert(event);
+	if (status != B_OK) {
+		delete event;
+		return status;
+	}
+
+	status = _SelectEvent(event);
+	if (status != B_OK) {
+		fEvents.RemoveUnchecked(event);
+
+		// the object might have reported B_EVENT_INVALID in the meantime
+		InterruptsSpinLocker queueLocker(fQueueLock);
+		if (event->queued)
+			fQueue.Remove(event);
+		queueLocker.Unlock();
+
+		delete event;
+		return status;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+EventQueue::Deselect(int32 object, uint16 type)
+{
+	MutexLocker locker(fLock);
+
+	select_event* event = fEvents.Lookup(event_key(object, type));
+	if (event == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	fEvents.RemoveUnchecked(event);
+	_ReleaseEvent(event);
+	return B_OK;
+}
+
+
+ssize_t
+EventQueue::Wait(event_wait_info* infos, int numInfos, uint32 flags,
+	bigtime_t timeout)
+{
+	if ((flags & B_RELATIVE_TIMEOUT) != 0 && timeout > 0) {
+		// we might have to wait more than once
+		bigtime_t now = system_time();
+		timeout = now + timeout < now ? B_INFINITE_TIMEOUT : now + timeout;
+		flags = (flags & ~B_RELATIVE_TIMEOUT) | B_ABSOLUTE_TIMEOUT;
+	}
+
+	while (true) {
+		MutexLocker locker(fLock);
+		InterruptsSpinLocker queueLocker(fQueueLock);
+
+		if (fClosed)
+			return B_FILE_ERROR;
+
+		if (fQueue.IsEmpty()) {
+			if ((flags & B_RELATIVE_TIMEOUT) != 0 && timeout <= 0)
+				return B_WOULD_BLOCK;
+
+			ConditionVariableEntry entry;
+			fQueueCondition.Add(&entry);
+
+			queueLocker.Unlock();
+			locker.Unlock();
+
+			status_t status = entry.Wait(flags | B_CAN_INTERRUPT, timeout);
+			if (status != B_OK)
+				return status;
+
+			continue;
+		}
+
+		// Take the events off the queue before reporting them, so that
+		// level-triggered events that are queued again when reselected are
+		// only reported once per call.
+		EventList events;
+		for (int i = 0; i < numInfos; i++) {
+			select_event* event = fQueue.RemoveHead();
+			if (event == NULL)
+				break;
+			events.Add(event);
+		}
+
+		queueLocker.Unlock();
+
+		int count = _ReportEvents(events, infos);
+		if (count > 0)
+			return count;
+	}
+}
+
+
+status_t
+EventQueue::Notify(select_info* info, uint16 events)
+{
+	select_event* event = static_cast<select_event*>(info);
+
+	// Once B_EVENT_INVALID has been delivered, the event may be freed; it
+	// must only be accessed with the lock held.
+	InterruptsSpinLocker locker(fQueueLock);
+
+	event->events |= events;
+	if ((events & event->selected_events) == 0 || event->queued)
+		return B_OK;
+
+	event->queued = true;
+	fQueue.Add(event);
+	fQueueCondition.NotifyOne();
+
+	return B_OK;
+}
+
+
+status_t
+EventQueue::_SelectEvent(select_event* event)
+{
+	event->next = NULL;
+	event->selected_events = event->requested_events;
+
+	return select_object(event->type, event->object, event, fKernel);
+}
+
+
+status_t
+EventQueue::_DeselectEvent(select_event* event)
+{
+	// We can only reach file descriptors in the I/O context they were
+	// selected in; the others stay selected until they are closed.
+	if (event->context != NULL
+		&& event->context != get_current_io_context(fKernel)) {
+		return B_NOT_ALLOWED;
+	}
+
+	return deselect_object(event->type, event->object, event, fKernel);
+}
+
+
+/*!	Deselects an event that has already been removed from fEvents, and frees
+	it. If the object could not be deselected because it is just going away,
+	the event is freed when the object has notified it with B_EVENT_INVALID.
+*/
+void
+EventQueue::_ReleaseEvent(select_event* event)
+{
+	status_t status = _DeselectEvent(event);
+
+	InterruptsSpinLocker queueLocker(fQueueLock);
+
+	if (status != B_OK && (event->events & B_EVENT_INVALID) == 0) {
+		event->removed = true;
+		return;
+	}
+
+	if (event->queued)
+		fQueue.Remove(event);
+
+	queueLocker.Unlock();
+
+	delete event;
+}
+
+
+int
+EventQueue::_ReportEvents(EventList& events, event_wait_info* infos)
+{
+	int count = 0;
+
+	while (select_event* event = events.RemoveHead()) {
+		InterruptsSpinLocker queueLocker(fQueueLock);
+
+		int32 occurred = event->events & event->selected_events;
+		event->events = 0;
+		event->queued = false;
+		bool removed = event->removed;
+
+		queueLocker.Unlock();
+
+		if (removed) {
+			if ((occurred & B_EVENT_INVALID) != 0)
+				delete event;
+			continue;
+		}
+
+		if (occurred == 0)
+			continue;
+
+		infos[count].object = event->object;
+		infos[count].type = event->type;
+		infos[count].events = occurred;
+		infos[count].user_data = event->user_data;
+		count++;
+
+		if ((occurred & B_EVENT_INVALID) != 0) {
+			// the object is already done with it
+			fEvents.RemoveUnchecked(event);
+			delete event;
+		} else if ((event->behavior & B_EVENT_ONE_SHOT) != 0) {
+			fEvents.RemoveUnchecked(event);
+			_ReleaseEvent(event);
+		} else if ((event->behavior & B_EVENT_EDGE_TRIGGERED) == 0) {
+			// If deselecting fails, the object is going away, and will
+			// report that soon.
+			if (_DeselectEvent(event) == B_OK && _SelectEvent(event) != B_OK)
+				Notify(event, B_EVENT_INVALID);
+		}
+	}
+
+	return count;
+}
+
+
+//	#pragma mark - file descriptor
+
+
+static status_t
+event_queue_close(file_descriptor* descriptor)
+{
+	EventQueue* queue = (EventQueue*)descriptor->cookie;
+	queue->Closed();
+	return B_OK;
+}
+
+
+static void
+event_queue_free(file_descriptor* descriptor)
+{
+	put_select_sync((EventQueue*)descriptor->cookie);
+}
+
+
+static struct fd_ops sEventQueueFDOps = {
+	NULL,	// fd_read
+	NULL,	// fd_write
+	NULL,	// fd_seek
+	NULL,	// fd_ioctl
+	NULL,	// fd_set_flags
+	NULL,	// fd_select
+	NULL,	// fd_deselect
+	NULL,	// fd_read_dir
+	NULL,	// fd_rewind_dir
+	NULL,	// fd_read_stat
+	NULL,	// fd_write_stat
+	&event_queue_close,
+	&event_queue_free
+};
+
+
+static status_t
+get_event_queue(int fd, bool kernel, DescriptorPutter& descriptorPutter,
+	EventQueue*& _queue)
+{
+	file_descriptor* descriptor = get_fd(get_current_io_context(kernel), fd);
+	if (descriptor == NULL)
+		return B_FILE_ERROR;
+
+	descriptorPutter.SetTo(descriptor);
+
+	if (descriptor->type != FDTYPE_EVENT_QUEUE)
+		return B_BAD_VALUE;
+
+	_queue = (EventQueue*)descriptor->cookie;
+	return B_OK;
+}
+
+
+//	#pragma mark - common implementation
+
+
+static int
+common_create_event_queue(int openFlags, bool kernel)
+{
+	if ((openFlags & ~O_CLOEXEC) != 0)
+		return B_BAD_VALUE;
+
+	EventQueue* queue = new(std::nothrow) EventQueue(kernel);
+	if (queue == NULL)
+		return B_NO_MEMORY;
+
+	status_t status = queue->Init();
+	if (status != B_OK) {
+		put_select_sync(queue);
+		return status;
+	}
+
+	file_descriptor* descriptor = alloc_fd();
+	if (descriptor == NULL) {
+		put_select_sync(queue);
+		return B_NO_MEMORY;
+	}
+
+	descriptor->type = FDTYPE_EVENT_QUEUE;
+	descriptor->ops = &sEventQueueFDOps;
+	descriptor->cookie = queue;
+	descriptor->open_mode = O_RDWR;
+
+	io_context* context = get_current_io_context(kernel);
+	int fd = new_fd(context, descriptor);
+	if (fd < 0) {
+		descriptor->ops = NULL;
+		put_fd(descriptor);
+		put_select_sync(queue);
+		return B_NO_MORE_FDS;
+	}
+
+	mutex_lock(&context->io_mutex);
+	fd_set_close_on_exec(context, fd, (openFlags & O_CLOEXEC) != 0);
+	mutex_unlock(&context->io_mutex);
+
+	return fd;
+}
+
+
+static status_t
+common_event_queue_select(int queueFD, const event_wait_info& info,
+	bool kernel)
+{
+	if (info.type == B_OBJECT_TYPE_FD && info.object == queueFD)
+		return B_BAD_VALUE;
+
+	DescriptorPutter descriptorPutter;
+	EventQueue* queue;
+	status_t status = get_event_queue(queueFD, kernel, descriptorPutter, queue);
+	if (status != B_OK)
+		return status;
+
+	return queue->Select(info.object, info.type, info.events, info.user_data);
+}
+
+
+static status_t
+common_event_queue_deselect(int queueFD, int32 object, uint16 type,
+	bool kernel)
+{
+	DescriptorPutter descriptorPutter;
+	EventQueue* queue;
+	status_t status = get_event_queue(queueFD, kernel, descriptorPutter, queue);
+	if (status != B_OK)
+		return status;
+
+	return queue->Deselect(object, type);
+}
+
+
+static ssize_t
+common_event_queue_wait(int queueFD, event_wait_info* infos, int numInfos,
+	uint32 flags, bigtime_t timeout, bool kernel)
+{
+	DescriptorPutter descriptorPutter;
+	EventQueue* queue;
+	status_t status = get_event_queue(queueFD, kernel, descriptorPutter, queue);
+	if (status != B_OK)
+		return status;
+
+	return queue->Wait(infos, numInfos, flags, timeout);
+}
+
+
+//	#pragma mark - kernel private
+
+
+int
+_kern_create_event_queue(int openFlags)
+{
+	return common_create_event_queue(openFlags, true);
+}
+
+
+status_t
+_kern_event_queue_select(int queue, const event_wait_info* info)
+{
+	if (info == NULL)
+		return B_BAD_VALUE;
+
+	return common_event_queue_select(queue, *info, true);
+}
+
+
+status_t
+_kern_event_queue_deselect(int queue, int32 object, uint16 type)
+{
+	return common_event_queue_deselect(queue, object, type, true);
+}
+
+
+ssize_t
+_kern_event_queue_wait(int queue, event_wait_info* infos, int numInfos,
+	uint32 flags, bigtime_t timeout)
+{
+	if (infos == NULL || numInfos <= 0)
+		return B_BAD_VALUE;
+
+	return common_event_queue_wait(queue, infos, numInfos, flags, timeout,
+		true);
+}
+
+
+//	#pragma mark - syscalls
+
+
+int
+_user_create_event_queue(int openFlags)
+{
+	return common_create_event_queue(openFlags, false);
+}
+
+
+status_t
+_user_event_queue_select(int queue, const event_wait_info* userInfo)
+{
+	event_wait_info info;
+	if (userInfo == NULL || !IS_USER_ADDRESS(userInfo)
+		|| user_memcpy(&info, userInfo, sizeof(info)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return common_event_queue_select(queue, info, false);
+}
+
+
+status_t
+_user_event_queue_deselect(int queue, int32 object, uint16 type)
+{
+	return common_event_queue_deselect(queue, object, type, false);
+}
+
+
+ssize_t
+_user_event_queue_wait(int queue, event_wait_info* userInfos, int numInfos,
+	uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	if (numInfos <= 0)
+		return B_BAD_VALUE;
+	if (numInfos > kMaxUserWaitInfos)
+		numInfos = kMaxUserWaitInfos;
+
+	if (userInfos == NULL || !IS_USER_ADDRESS(userInfos))
+		return B_BAD_ADDRESS;
+
+	BStackOrHeapArray<event_wait_info, 16> infos(numInfos);
+	if (!infos.IsValid())
+		return B_NO_MEMORY;
+
+	ssize_t result = common_event_queue_wait(queue, infos, numInfos, flags,
+		timeout, false);
+	if (result < 0)
+		return syscall_restart_handle_timeout_post(result, timeout);
+
+	if (user_memcpy(userInfos, infos, sizeof(event_wait_info) * result)
+			!= B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return result;
+}
@@ -46,8 +46,6 @@ extern object_cache* sFileDescriptorCache;
 static struct file_descriptor* get_fd_locked(struct io_context* context,
 	int fd);
 static struct file_descriptor* remove_fd(struct io_context* context, int fd);
-static void deselect_select_infos(file_descriptor* descriptor,
-	select_info* infos, bool putSyncObjects);
 
 
 struct FDGetterLocking {
@@ -535,7 +533,11 @@ fd_ioctl(bool kernelFD, int fd, uint32 op, void* buffer, size_t length)
 }
 
 
-static void
+/*!	Deselects all events of the given list of select infos from the
+	descriptor, and notifies them with B_EVENT_INVALID. The list must already
+	have been removed from the I/O context.
+*/
+void
 deselect_select_infos(file_descriptor* descriptor, select_info* infos,
 	bool putSyncObjects)
 {
@@ -544,6 +546,7 @@ deselect_select_infos(file_descriptor* descriptor, select_info* infos,
 	select_info* info = infos;
 	while (info != NULL) {
 		select_sync* sync = info->sync;
+		select_info* next = info->next;
 
 		// deselect the selected events
 		uint16 eventsToDeselect = info->selected_events & ~B_EVENT_INVALID;
@@ -556,8 +559,9 @@ deselect_select_infos(file_descriptor* descriptor, select_info* infos,
 			}
 		}
 
+		// the info must not be accessed after this anymore
 		notify_select_events(info, B_EVENT_INVALID);
-		info = info->next;
+		info = next;
 
 		if (putSyncObjects)
 			put_select_sync(sync);
@@ -668,7 +672,7 @@ deselect_fd(int32 fd, struct select_info* info, bool kernel)
 
 	// If not found, someone else beat us to it.
 	if (*infoLocation != info)
-		return B_OK;
+		return B_ENTRY_NOT_FOUND;
 
 	*infoLocation = info->next;
 
@@ -9,6 +9,8 @@
 
 #include <errno.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
 
 #include <module.h>
 
@@ -23,6 +25,9 @@
 #include <util/AutoLock.h>
 #include <util/iovec_support.h>
 #include <vfs.h>
+#include <vm/vm.h>
+#include <vm/vm_page.h>
+#include <vm/VMAddressSpace.h>
 
 #include <net_stack_interface.h>
 #include <net_stat.h>
@@ -31,6 +36,10 @@
 #define MAX_SOCKET_ADDRESS_LENGTH	(sizeof(sockaddr_storage))
 #define MAX_SOCKET_OPTION_LENGTH	128
 #define MAX_ANCILLARY_DATA_LENGTH	1024
+#define SENDFILE_MAPPING_SIZE		(1024 * 1024)
+#define SENDFILE_COPY_SIZE			(64 * 1024)
+#define SENDFILE_MAX_WIRED_PAGES	(64 * 1024 * 1024 / B_PAGE_SIZE)
+	// system-wide limit, further limited to a part of the memory
 
 #define GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor)	\
 	do {												\
@@ -43,6 +52,7 @@
 static net_stack_interface_module_info* sStackInterface = NULL;
 static vint32 sStackInterfaceInitialized = 0;
 static mutex sLock = MUTEX_INITIALIZER("stack interface");
+static int32 sSendfileWiredPages = 0;
 
 
 struct FDPutter {
@@ -533,6 +543,207 @@ common_sendmsg(int fd, const struct msghdr *message, int flags, bool kernel)
 }
 
 
+/*!	A wired mapping of a part of a file, that is referenced by the buffers of
+	the network stack until the data has been sent.
+*/
+struct sendfile_mapping {
+	area_id		area;
+	void*		address;
+	size_t		size;
+};
+
+
+/*!	Reserves \a pageCount pages of the system-wide budget for wired sendfile
+	mappings. Since the pages stay wired until the peer has acknowledged the
+	data, slow receivers could otherwise pin an arbitrary amount of memory.
+*/
+static bool
+get_sendfile_pages(int32 pageCount)
+{
+	int32 maxPages = min_c((page_num_t)SENDFILE_MAX_WIRED_PAGES,
+		vm_page_num_pages() / 16);
+
+	if (atomic_add(&sSendfileWiredPages, pageCount) + pageCount > maxPages) {
+		atomic_add(&sSendfileWiredPages, -pageCount);
+		return false;
+	}
+
+	return true;
+}
+
+
+static void
+put_sendfile_pages(int32 pageCount)
+{
+	atomic_add(&sSendfileWiredPages, -pageCount);
+}
+
+
+static void
+put_sendfile_mapping(void* _mapping)
+{
+	sendfile_mapping* mapping = (sendfile_mapping*)_mapping;
+
+	unlock_memory_etc(VMAddressSpace::KernelID(), mapping->address,
+		mapping->size, 0);
+	delete_area(mapping->area);
+	put_sendfile_pages(mapping->size / B_PAGE_SIZE);
+	free(mapping);
+}
+
+
+/*!	Maps \a size bytes at \a offset of the file referred to by \a fd into
+	the kernel, and wires them, so that they can be accessed from any context.
+	This fails for files whose file system does not use the file cache, and
+	with \c B_BUSY, if too much memory is already wired for sendfile().
+*/
+static status_t
+get_sendfile_mapping(int fd, off_t offset, size_t size, bool kernel,
+	sendfile_mapping** _mapping, const void** _data)
+{
+	off_t mapOffset = ROUNDDOWN(offset, B_PAGE_SIZE);
+	size_t mapSize = PAGE_ALIGN(size + (offset - mapOffset));
+
+	if (!get_sendfile_pages(mapSize / B_PAGE_SIZE))
+		return B_BUSY;
+
+	sendfile_mapping* mapping
+		= (sendfile_mapping*)malloc(sizeof(sendfile_mapping));
+	if (mapping == NULL) {
+		put_sendfile_pages(mapSize / B_PAGE_SIZE);
+		return B_NO_MEMORY;
+	}
+
+	mapping->size = mapSize;
+	mapping->area = vm_map_file_into_kernel("sendfile mapping",
+		&mapping->address, mapSize, fd, mapOffset, kernel);
+	if (mapping->area < 0) {
+		status_t status = mapping->area;
+		put_sendfile_pages(mapSize / B_PAGE_SIZE);
+		free(mapping);
+		return status;
+	}
+
+	status_t status = lock_memory_etc(VMAddressSpace::KernelID(),
+		mapping->address, mapSize, 0);
+	if (status != B_OK) {
+		delete_area(mapping->area);
+		put_sendfile_pages(mapSize / B_PAGE_SIZE);
+		free(mapping);
+		return status;
+	}
+
+	*_mapping = mapping;
+	*_data = (uint8*)mapping->address + (offset - mapOffset);
+	return B_OK;
+}
+
+
+/*!	Sends up to \a count bytes from the file \a fd, starting at \a _offset,
+	or the current file position, if \a _offset is \c NULL, over the
+	\a socket. The pages of the file cache are passed to the network stack
+	directly, if possible; otherwise, the data is copied.
+*/
+static ssize_t
+common_sendfile(int socket, int fd, off_t* _offset, size_t count, bool kernel)
+{
+	file_descriptor* descriptor;
+	GET_SOCKET_FD_OR_RETURN(socket, kernel, descriptor);
+	FDPutter _(descriptor);
+
+	file_descriptor* file = get_fd(get_current_io_context(kernel), fd);
+	if (file == NULL)
+		return B_FILE_ERROR;
+	FDPutter filePutter(file);
+
+	if (file->type != FDTYPE_FILE || (file->open_mode & O_RWMASK) == O_WRONLY
+		|| file->ops->fd_read == NULL || file->ops->fd_read_stat == NULL)
+		return B_BAD_VALUE;
+
+	struct stat stat;
+	status_t status = file->ops->fd_read_stat(file, &stat);
+	if (status != B_OK)
+		return status;
+	if (!S_ISREG(stat.st_mode))
+		return B_BAD_VALUE;
+
+	off_t offset = _offset != NULL ? *_offset : file->pos;
+	if (offset < 0)
+		return B_BAD_VALUE;
+	if (offset >= stat.st_size)
+		return 0;
+
+	if ((off_t)count > stat.st_size - offset)
+		count = stat.st_size - offset;
+	if (count > SSIZE_MAX)
+		count = SSIZE_MAX;
+
+	void* copyBuffer = NULL;
+	MemoryDeleter copyBufferDeleter;
+	bool mapFile = true;
+	size_t bytesSent = 0;
+
+	while (bytesSent < count) {
+		size_t size = min_c(count - bytesSent, SENDFILE_MAPPING_SIZE);
+		ssize_t sent;
+
+		sendfile_mapping* mapping;
+		const void* data;
+		status_t mapStatus = B_ERROR;
+		if (mapFile) {
+			mapStatus = get_sendfile_mapping(fd, offset + bytesSent, size,
+				kernel, &mapping, &data);
+		}
+		if (mapStatus == B_OK) {
+			sent = sStackInterface->send_external(descriptor->u.socket, data,
+				size, 0, &put_sendfile_mapping, mapping);
+		} else {
+			// fall back to copying the data; if only the budget for wired
+			// mappings is used up, try mapping the file again next time
+			if (mapStatus != B_BUSY)
+				mapFile = false;
+
+			if (copyBuffer == NULL) {
+				copyBuffer = malloc(SENDFILE_COPY_SIZE);
+				if (copyBuffer == NULL) {
+					status = B_NO_MEMORY;
+					break;
+				}
+				copyBufferDeleter.SetTo(copyBuffer);
+			}
+
+			size = min_c(size, SENDFILE_COPY_SIZE);
+			status = file->ops->fd_read(file, offset + bytesSent, copyBuffer,
+				&size);
+			if (status != B_OK || size == 0)
+				break;
+
+			sent = sStackInterface->send(descriptor->u.socket, copyBuffer,
+				size, 0);
+		}
+
+		if (sent < 0) {
+			status = sent;
+			break;
+		}
+
+		bytesSent += sent;
+		if ((size_t)sent < size)
+			break;
+	}
+
+	if (bytesSent == 0 && status != B_OK)
+		return status;
+
+	if (_offset != NULL)
+		*_offset = offset + bytesSent;
+	else
+		file->pos = offset + bytesSent;
+
+	return bytesSent;
+}
+
+
 static status_t
 common_getsockopt(int fd, int level, int option, void *value,
 	socklen_t *_length, bool kernel)
@@ -1099,6 +1310,30 @@ _user_sendmsg(int socket, const struct msghdr *userMessage, int flags)
 }
 
 
+ssize_t
+_user_sendfile(int socket, int fd, off_t *userOffset, size_t count)
+{
+	off_t offset;
+	if (userOffset != NULL) {
+		if (!IS_USER_ADDRESS(userOffset)
+			|| user_memcpy(&offset, userOffset, sizeof(off_t)) != B_OK) {
+			return B_BAD_ADDRESS;
+		}
+	}
+
+	SyscallRestartWrapper<ssize_t> result;
+	result = common_sendfile(socket, fd, userOffset != NULL ? &offset : NULL,
+		count, false);
+
+	if (result >= 0 && userOffset != NULL
+		&& user_memcpy(userOffset, &offset, sizeof(off_t)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return result;
+}
+
+
 status_t
 _user_getsockopt(int socket, int level, int option, void *userValue,
 	socklen_t *_length)
@@ -3669,6 +3669,17 @@ free_io_context(io_context* context)
 
 	mutex_lock(&context->io_mutex);
 
+	// Event queues may still have the descriptors selected; deselect them
+	// first, so that no event queue is left with infos that point into this
+	// context.
+	for (i = 0; i < context->table_size; i++) {
+		struct file_descriptor* descriptor = context->fds[i];
+		if (descriptor != NULL && context->select_infos[i] != NULL) {
+			deselect_select_infos(descriptor, context->select_infos[i], true);
+			context->select_infos[i] = NULL;
+		}
+	}
+
 	for (i = 0; i < context->table_size; i++) {
 		if (struct file_descriptor* descriptor = context->fds[i]) {
 			close_fd(context, descriptor);
@@ -4952,18 +4963,25 @@ vfs_exec_io_context(io_context* context)
 		mutex_lock(&context->io_mutex);
 
 		struct file_descriptor* descriptor = context->fds[i];
+		select_info* selectInfos = NULL;
 		bool remove = false;
 
 		if (descriptor != NULL && fd_close_on_exec(context, i)) {
 			context->fds[i] = NULL;
 			context->num_used_fds--;
 
+			selectInfos = context->select_infos[i];
+			context->select_infos[i] = NULL;
+
 			remove = true;
 		}
 
 		mutex_unlock(&context->io_mutex);
 
 		if (remove) {
+			if (selectInfos != NULL)
+				deselect_select_infos(descriptor, selectInfos, true);
+
 			close_fd(context, descriptor);
 			put_fd(descriptor);
 		}
@@ -1935,6 +1935,37 @@ err1:
 }
 
 
+/*!	Moves the current team, which has been vfork()ed and still runs in the
+	address space of its parent, into \a addressSpace and lets the parent
+	continue.
+	The current thread must no longer refer to its parent's user_thread.
+*/
+static void
+leave_vfork_address_space(Team* team, VMAddressSpace* addressSpace)
+{
+	VMAddressSpace* sharedAddressSpace = team->address_space;
+
+	cpu_status state = disable_interrupts();
+	team->address_space = addressSpace;
+	vm_swap_address_space(sharedAddressSpace, addressSpace);
+	restore_interrupts(state);
+
+	atomic_and(&team->flags, ~TEAM_FLAG_VFORKED);
+	sharedAddressSpace->Put();
+
+	// wake up the parent waiting in fork_team()
+	TeamLocker teamLocker(team);
+
+	if (team->loading_info != NULL) {
+		struct team_loading_info* loadingInfo = team->loading_info;
+		team->loading_info = NULL;
+
+		loadingInfo->result = B_OK;
+		loadingInfo->condition.NotifyAll();
+	}
+}
+
+
 /*!	Almost shuts down the current team and loads a new image into it.
 	If successful, this function does not return and will takeover ownership of
 	the arguments provided.
@@ -2000,6 +2031,18 @@ exec_team(const char* path, char**& _flatArgs, size_t flatArgsSize,
 	_flatArgs = NULL;
 		// args are owned by the team_arg structure now
 
+	// A vfork()ed team still runs in its parent's address space, which it must
+	// leave intact. It gets an address space of its own instead.
+	VMAddressSpace* addressSpace = NULL;
+	if ((atomic_get(&team->flags) & TEAM_FLAG_VFORKED) != 0) {
+		status = VMAddressSpace::Create(team->id, USER_BASE, USER_SIZE, false,
+			&addressSpace);
+		if (status != B_OK) {
+			free_team_arg(teamArgs);
+			return status;
+		}
+	}
+
 	// TODO: remove team resources if there are any left
 	// thread_atkernel_exit() might not be called at all
 
@@ -2007,6 +2050,9 @@ exec_team(const char* path, char**& _flatArgs, size_t flatArgsSize,
 
 	user_debug_prepare_for_exec();
 
+	if (addressSpace != NULL)
+		leave_vfork_address_space(team, addressSpace);
+
 	delete_team_user_data(team);
 	vm_delete_areas(team->address_space, false);
 	xsi_sem_undo(team);
@@ -2083,24 +2129,104 @@ exec_team(const char* path, char**& _flatArgs, size_t flatArgsSize,
 }
 
 
+/*!	Copies all areas of the current team \a parentTeam into the address space
+	of the new \a team, for fork_team(). The team's user data area is not
+	copied, but recreated at the same address.
+*/
+static status_t
+copy_team_areas(Team* parentTeam, Thread* parentThread, Team* team,
+	Thread* thread)
+{
+	// TODO: should be able to handle stack areas differently (ie. don't have
+	// them copy-on-write)
+
+	struct area_info info;
+	ssize_t areaCookie = 0;
+	while (get_next_area_info(B_CURRENT_TEAM, &areaCookie, &info) == B_OK) {
+		if (info.area == parentTeam->user_data_area) {
+			// don't clone the user area; just create a new one
+			status_t status = create_team_user_data(team, info.address);
+			if (status != B_OK)
+				return status;
+
+			thread->user_thread = team_allocate_user_thread(team);
+		} else {
+			void* address;
+			area_id area = vm_copy_area(team->address_space->ID(), info.name,
+				&address, B_CLONE_ADDRESS, info.area);
+			if (area < B_OK)
+				return area;
+
+			if (info.area == parentThread->user_stack_area)
+				thread->user_stack_area = area;
+		}
+	}
+
+	if (thread->user_thread == NULL) {
+#if KDEBUG
+		panic("user data area not found, parent area is %" B_PRId32,
+			parentTeam->user_data_area);
+#endif
+		return B_ERROR;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Called when the parent of a vfork()ed \a team is killed while it waits
+	for the child. The child still runs on the stack of the parent, so it is
+	killed as well, and the parent waits until it has let go of it.
+*/
+static void
+kill_vfork_child(Team* team, Team* parentTeam,
+	struct team_loading_info& vforkInfo)
+{
+	ConditionVariableEntry waitEntry;
+
+	TeamLocker teamLocker(team);
+	if (team->loading_info != &vforkInfo)
+		return;
+
+	vforkInfo.condition.Add(&waitEntry);
+	teamLocker.Unlock();
+
+	Signal signal(SIGKILL, SI_USER, B_OK, parentTeam->id);
+	send_signal_to_team(team, signal, 0);
+
+	waitEntry.Wait();
+}
+
+
+/*!	Creates a copy of the current team.
+	If \a shareAddressSpace is \c true, the child team is created vfork() style:
+	instead of getting a copy-on-write copy of the parent's areas, it borrows
+	the parent's address space, and the calling thread's user stack, TLS, and
+	user_thread, until it either exec()s or exits. The calling thread is
+	blocked until then.
+*/
 static thread_id
-fork_team(void)
+fork_team(bool shareAddressSpace)
 {
 	Thread* parentThread = thread_get_current_thread();
 	Team* parentTeam = parentThread->team;
 	Team* team;
 	arch_fork_arg* forkArgs;
-	struct area_info info;
 	thread_id threadID;
 	status_t status;
-	ssize_t areaCookie;
 	bool teamLimitReached = false;
+	struct team_loading_info vforkInfo;
+	ConditionVariableEntry vforkWaitEntry;
 
 	TRACE(("fork_team(): team %" B_PRId32 "\n", parentTeam->id));
 
 	if (parentTeam == team_get_kernel_team())
 		return B_NOT_ALLOWED;
 
+	// a vfork()ed team doesn't have any areas of its own to copy
+	if ((atomic_get(&parentTeam->flags) & TEAM_FLAG_VFORKED) != 0)
+		return B_NOT_ALLOWED;
+
 	// create a new team
 	// TODO: this is very similar to load_image_internal() - maybe we can do
 	// something about it :)
@@ -2161,49 +2287,29 @@ fork_team(void)
 		}
 	}
 
-	// create an address space for this team
-	status = VMAddressSpace::Create(team->id, USER_BASE, USER_SIZE, false,
-		&team->address_space);
-	if (status < B_OK)
-		goto err3;
-
-	// copy all areas of the team
-	// TODO: should be able to handle stack areas differently (ie. don't have
-	// them copy-on-write)
-
-	areaCookie = 0;
-	while (get_next_area_info(B_CURRENT_TEAM, &areaCookie, &info) == B_OK) {
-		if (info.area == parentTeam->user_data_area) {
-			// don't clone the user area; just create a new one
-			status = create_team_user_data(team, info.address);
-			if (status != B_OK)
-				break;
-
-			thread->user_thread = team_allocate_user_thread(team);
-		} else {
-			void* address;
-			area_id area = vm_copy_area(team->address_space->ID(), info.name,
-				&address, B_CLONE_ADDRESS, info.area);
-			if (area < B_OK) {
-				status = area;
-				break;
-			}
-
-			if (info.area == parentThread->user_stack_area)
-				thread->user_stack_area = area;
-		}
-	}
+	if (shareAddressSpace) {
+		// Use our address space and user_thread. Since the child runs on our
+		// stack, we have to wait until it doesn't need them anymore.
+		vforkInfo.condition.Init(team, "vfork");
+		vforkInfo.condition.Add(&vforkWaitEntry);
+		vforkInfo.result = B_ERROR;
+		team->loading_info = &vforkInfo;
 
-	if (status < B_OK)
-		goto err4;
+		team->address_space = parentTeam->address_space;
+		team->address_space->Get();
+		atomic_or(&team->flags, TEAM_FLAG_VFORKED);
 
-	if (thread->user_thread == NULL) {
-#if KDEBUG
-		panic("user data area not found, parent area is %" B_PRId32,
-			parentTeam->user_data_area);
-#endif
-		status = B_ERROR;
-		goto err4;
+		thread->user_thread = parentThread->user_thread;
+	} else {
+		// create an address space for this team
+		status = VMAddressSpace::Create(team->id, USER_BASE, USER_SIZE, false,
+			&team->address_space);
+		if (status < B_OK)
+			goto err3;
+
+		status = copy_team_areas(parentTeam, parentThread, team, thread);
+		if (status != B_OK)
+			goto err4;
 	}
 
 	thread->user_stack_base = parentThread->user_stack_base;
@@ -2265,7 +2371,21 @@ fork_team(void)
 
 	T(TeamForked(threadID));
 
-	resume_thread(threadID);
+	{
+		// the team may be gone as soon as its thread runs
+		BReference<Team> teamReference(team);
+
+		resume_thread(threadID);
+
+		if (shareAddressSpace) {
+			// Wait until the child has exec()ed or is gone. Since it runs on
+			// our stack, we must not return to userland before that, so only
+			// a kill signal may interrupt the wait.
+			if (vforkWaitEntry.Wait(B_KILL_CAN_INTERRUPT) == B_INTERRUPTED)
+				kill_vfork_child(team, parentTeam, vforkInfo);
+		}
+	}
+
 	return threadID;
 
 err6:
@@ -2291,7 +2411,10 @@ err6:
 err5:
 	remove_images(team);
 err4:
-	team->address_space->RemoveAndPut();
+	if (shareAddressSpace)
+		team->address_space->Put();
+	else
+		team->address_space->RemoveAndPut();
 err3:
 	delete_realtime_sem_context(team->realtime_sem_context);
 err2:
@@ -3321,7 +3444,11 @@ team_delete_team(Team* team, port_id debuggerPort)
 	delete_realtime_sem_context(team->realtime_sem_context);
 	xsi_sem_undo(team);
 	remove_images(team);
-	team->address_space->RemoveAndPut();
+	if ((team->flags & TEAM_FLAG_VFORKED) != 0) {
+		// the address space belongs to the team that vfork()ed this one
+		team->address_space->Put();
+	} else
+		team->address_space->RemoveAndPut();
 
 	team->ReleaseReference();
 
@@ -4006,7 +4133,18 @@ _user_exec(const char* userPath, const char* const* userFlatArgs,
 thread_id
 _user_fork(void)
 {
-	return fork_team();
+	return fork_team(false);
+}
+
+
+thread_id
+_user_vfork(void)
+{
+#ifdef VFORK_SHARES_ADDRESS_SPACE
+	return fork_team(true);
+#else
+	return fork_team(false);
+#endif
 }
 
 
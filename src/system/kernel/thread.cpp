@@ -638,26 +638,35 @@ remove_thread_from_team(Team *team, Thread *thread)
 static status_t
 enter_userspace(Thread* thread, UserThreadEntryArguments* args)
 {
-	status_t error = arch_thread_init_tls(thread);
-	if (error != B_OK) {
-		dprintf("Failed to init TLS for new userland thread \"%s\" (%" B_PRId32
-			")\n", thread->name, thread->id);
-		free(args->forkArgs);
-		return error;
+	// The main thread of a vfork()ed team uses the TLS and user_thread of the
+	// thread that created it, which must be left alone.
+	bool vforked = args->forkArgs != NULL
+		&& (atomic_get(&thread->team->flags) & TEAM_FLAG_VFORKED) != 0;
+
+	if (!vforked) {
+		status_t error = arch_thread_init_tls(thread);
+		if (error != B_OK) {
+			dprintf("Failed to init TLS for new userland thread \"%s\" (%"
+				B_PRId32 ")\n", thread->name, thread->id);
+			free(args->forkArgs);
+			return error;
+		}
 	}
 
 	user_debug_update_new_thread_flags(thread);
 
-	// init the thread's user_thread
-	user_thread* userThread = thread->user_thread;
-	set_ac();
-	userThread->pthread = args->pthread;
-	userThread->flags = 0;
-	userThread->wait_status = B_OK;
-	userThread->defer_signals
-		= (args->flags & THREAD_CREATION_FLAG_DEFER_SIGNALS) != 0 ? 1 : 0;
-	userThread->pending_signals = 0;
-	clear_ac();
+	if (!vforked) {
+		// init the thread's user_thread
+		user_thread* userThread = thread->user_thread;
+		set_ac();
+		userThread->pthread = args->pthread;
+		userThread->flags = 0;
+		userThread->wait_status = B_OK;
+		userThread->defer_signals
+			= (args->flags & THREAD_CREATION_FLAG_DEFER_SIGNALS) != 0 ? 1 : 0;
+		userThread->pending_signals = 0;
+		clear_ac();
+	}
 
 	if (args->forkArgs != NULL) {
 		// This is a fork()ed thread. Copy the fork args onto the stack and
@@ -2206,9 +2215,10 @@ thread_exit(void)
 	select_info* info = selectInfos;
 	while (info != NULL) {
 		select_sync* sync = info->sync;
+		select_info* next = info->next;
 
 		notify_select_events(info, B_EVENT_INVALID);
-		info = info->next;
+		info = next;
 		put_select_sync(sync);
 	}
 
@@ -2607,7 +2617,7 @@ deselect_thread(int32 id, struct select_info* info, bool kernel)
 		infoLocation = &(*infoLocation)->next;
 
 	if (*infoLocation != info)
-		return B_OK;
+		return B_ENTRY_NOT_FOUND;
 
 	*infoLocation = info->next;
 
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "lz_compression.h"
+
+#include <string.h>
+
+
+/*!	A small LZ77 block codec in the spirit of LZ4. It is meant for data that
+	has to be (de)compressed quickly and repeatedly, like the pages in the
+	compressed swap tier, and trades compression ratio for speed.
+
+	A compressed block is a sequence of records. Each record consists of a
+	token byte, a run of literals and a back reference into the data decoded
+	so far. The high nibble of the token holds the literal count, the low
+	nibble the match length minus LZ_MIN_MATCH; a nibble value of 15 is
+	followed by extension bytes which are added up until one of them is
+	smaller than 255. The back reference is a little endian 16 bit offset.
+	The last record of a block may consist of the token and literals only.
+
+	Neither function uses any locking or allocates memory, the caller has to
+	provide the work memory for the compressor.
+*/
+
+
+#define LZ_MIN_MATCH		4
+#define LZ_RUN_MASK			15
+#define LZ_HASH_BITS		12
+	// 1 << LZ_HASH_BITS == LZ_HASH_TABLE_SIZE
+#define LZ_SKIP_TRIGGER		6
+
+
+static inline uint32
+read32(const uint8* data)
+{
+	uint32 value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+
+static inline uint32
+hash_sequence(uint32 sequence)
+{
+	return (sequence * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+
+static inline bool
+write_length(uint8*& out, const uint8* outEnd, size_t length)
+{
+	// the first LZ_RUN_MASK are already part of the token
+	for (length -= LZ_RUN_MASK; out < outEnd; length -= 255) {
+		if (length < 255) {
+			*out++ = length;
+			return true;
+		}
+		*out++ = 255;
+	}
+
+	return false;
+}
+
+
+static inline bool
+read_length(const uint8*& in, const uint8* inEnd, size_t& length)
+{
+	uint8 byte;
+	do {
+		if (in == inEnd)
+			return false;
+
+		byte = *in++;
+		length += byte;
+	} while (byte == 255);
+
+	return true;
+}
+
+
+static bool
+write_record(uint8*& out, const uint8* outEnd, const uint8* literals,
+	size_t literalLength, size_t offset, size_t matchLength)
+{
+	if (out == outEnd)
+		return false;
+
+	uint8* token = out++;
+	*token = (literalLength < LZ_RUN_MASK ? literalLength : LZ_RUN_MASK) << 4;
+	if (literalLength >= LZ_RUN_MASK
+		&& !write_length(out, outEnd, literalLength)) {
+		return false;
+	}
+
+	if ((size_t)(outEnd - out) < literalLength)
+		return false;
+
+	memcpy(out, literals, literalLength);
+	out += literalLength;
+
+	if (matchLength == 0)
+		return true;
+
+	if (outEnd - out < 2)
+		return false;
+
+	*out++ = offset & 0xff;
+	*out++ = offset >> 8;
+
+	matchLength -= LZ_MIN_MATCH;
+	*token |= matchLength < LZ_RUN_MASK ? matchLength : LZ_RUN_MASK;
+	if (matchLength >= LZ_RUN_MASK)
+		return write_length(out, outEnd, matchLength);
+
+	return true;
+}
+
+
+//	#pragma mark -
+
+
+/*!	Compresses \a sourceLength bytes from \a source into \a dest.
+	\a hashTable must point to LZ_HASH_TABLE_SIZE entries of work memory.
+	Returns the size of the compressed data, or \c 0 if it would not fit into
+	\a destLength bytes.
+*/
+size_t
+lz_compress(const void* _source, size_t sourceLength, void* _dest,
+	size_t destLength, uint16* hashTable)
+{
+	if (sourceLength > LZ_MAX_INPUT_SIZE)
+		return 0;
+
+	const uint8* source = (const uint8*)_source;
+	uint8* dest = (uint8*)_dest;
+	uint8* out = dest;
+	const uint8* outEnd = dest + destLength;
+
+	memset(hashTable, 0, LZ_HASH_TABLE_SIZE * sizeof(uint16));
+
+	size_t position = 0;
+	size_t anchor = 0;
+	size_t misses = 0;
+
+	while (position + LZ_MIN_MATCH <= sourceLength) {
+		uint32 sequence = read32(source + position);
+		uint32 hash = hash_sequence(sequence);
+		size_t candidate = hashTable[hash];
+		hashTable[hash] = position;
+
+		if (candidate >= position || read32(source + candidate) != sequence) {
+			// step over incompressible data faster the longer it gets
+			position += 1 + (misses++ >> LZ_SKIP_TRIGGER);
+			continue;
+		}
+
+		misses = 0;
+
+		size_t matchLength = LZ_MIN_MATCH;
+		while (position + matchLength < sourceLength
+			&& source[position + matchLength]
+				== source[candidate + matchLength]) {
+			matchLength++;
+		}
+
+		if (!write_record(out, outEnd, source + anchor, position - anchor,
+				position - candidate, matchLength)) {
+			return 0;
+		}
+
+		position += matchLength;
+		anchor = position;
+	}
+
+	if (anchor < sourceLength && !write_record(out, outEnd, source + anchor,
+			sourceLength - anchor, 0, 0)) {
+		return 0;
+	}
+
+	return out - dest;
+}
+
+
+/*!	Decompresses the block created by lz_compress() from \a source into
+	\a dest. Returns the size of the decompressed data, or \c B_BAD_DATA if
+	the block is corrupt or would not fit into \a destLength bytes.
+*/
+ssize_t
+lz_decompress(const void* _source, size_t sourceLength, void* _dest,
+	size_t destLength)
+{
+	const uint8* in = (const uint8*)_source;
+	const uint8* inEnd = in + sourceLength;
+	uint8* dest = (uint8*)_dest;
+	uint8* out = dest;
+	const uint8* outEnd = dest + destLength;
+
+	while (in < inEnd) {
+		uint8 token = *in++;
+
+		size_t length = token >> 4;
+		if (length == LZ_RUN_MASK && !read_length(in, inEnd, length))
+			return B_BAD_DATA;
+		if (length > (size_t)(inEnd - in) || length > (size_t)(outEnd - out))
+			return B_BAD_DATA;
+
+		memcpy(out, in, length);
+		in += length;
+		out += length;
+
+		if (in == inEnd)
+			break;
+		if (inEnd - in < 2)
+			return B_BAD_DATA;
+
+		size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+		if (offset == 0 || offset > (size_t)(out - dest))
+			return B_BAD_DATA;
+
+		length = token & LZ_RUN_MASK;
+		if (length == LZ_RUN_MASK && !read_length(in, inEnd, length))
+			return B_BAD_DATA;
+		length += LZ_MIN_MATCH;
+		if (length > (size_t)(outEnd - out))
+			return B_BAD_DATA;
+
+		// the match may overlap the bytes it produces, so copy bytewise
+		const uint8* match = out - offset;
+		for (size_t i = 0; i < length; i++)
+			out[i] = match[i];
+		out += length;
+	}
+
+	return out - dest;
+}
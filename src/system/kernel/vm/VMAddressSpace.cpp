@@ -238,7 +238,7 @@ VMAddressSpace::CurrentID()
 	Thread* thread = thread_get_current_thread();
 
 	if (thread != NULL && thread->team->address_space != NULL)
-		return thread->team->id;
+		return thread->team->address_space->ID();
 
 	return B_ERROR;
 }
@@ -30,6 +30,7 @@
 
 #include <arch_config.h>
 #include <boot_device.h>
+#include <compressed_swap.h>
 #include <disk_device_manager/KDiskDevice.h>
 #include <disk_device_manager/KDiskDeviceManager.h>
 #include <disk_device_manager/KDiskSystem.h>
@@ -39,6 +40,7 @@
 #include <fs/KPath.h>
 #include <fs_info.h>
 #include <fs_interface.h>
+#include <generic_syscall.h>
 #include <heap.h>
 #include <kernel_daemon.h>
 #include <slab/Slab.h>
@@ -49,6 +51,7 @@
 #include <util/AutoLock.h>
 #include <util/Bitmap.h>
 #include <util/DoublyLinkedList.h>
+#include <util/lz_compression.h>
 #include <util/OpenHashTable.h>
 #include <util/RadixBitmap.h>
 #include <vfs.h>
@@ -85,6 +88,15 @@
 #define SWAP_BLOCK_SHIFT 5		/* 1 << SWAP_BLOCK_SHIFT == SWAP_BLOCK_PAGES */
 #define SWAP_BLOCK_MASK  (SWAP_BLOCK_PAGES - 1)
 
+// swap slots from here on refer to the compressed in-memory tier
+#define COMPRESSED_SWAP_SLOT_BASE	0x80000000
+
+// pages that don't shrink to this size are left to the swap file
+#define MAX_COMPRESSED_PAGE_SIZE	(B_PAGE_SIZE * 3 / 4)
+
+// the compression ratio assumed when sizing the compressed tier's slot table
+#define COMPRESSED_SWAP_SLOTS_PER_PAGE	4
+
 
 static const char* const kDefaultSwapPath = "/var/swap";
 
@@ -142,6 +154,12 @@ struct SwapHashTableDefinition {
 	}
 };
 
+// A page stored in the compressed tier
+struct compressed_page {
+	uint16			size;
+	uint8			data[0];
+};
+
 typedef BOpenHashTable<SwapHashTableDefinition> SwapHashTable;
 typedef DoublyLinkedList<swap_file> SwapFileList;
 
@@ -158,6 +176,15 @@ static mutex sAvailSwapSpaceLock;
 
 static object_cache* sSwapBlockCache;
 
+static mutex sCompressedSwapLock = MUTEX_INITIALIZER("compressed swap");
+static compressed_page** sCompressedPages = NULL;
+static radix_bitmap* sCompressedSlotMap = NULL;
+static uint32 sCompressedSlotCount = 0;
+static uint16* sCompressionHashTable = NULL;
+static uint8* sCompressionPage = NULL;
+static uint8* sCompressionBuffer = NULL;
+static compressed_swap_info sCompressedSwapInfo;
+
 
 #if SWAP_TRACING
 namespace SwapTracing {
@@ -257,10 +284,238 @@ dump_swap_info(int argc, char** argv)
 	kprintf("used:      %9" B_PRIu32 "\n", totalSwapPages - freeSwapPages);
 	kprintf("free:      %9" B_PRIu32 "\n", freeSwapPages);
 
+	if (sCompressedSwapInfo.max_size > 0) {
+		kprintf("\n");
+		kprintf("compressed swap:\n");
+		kprintf("max size:  %9" B_PRIu64 "\n", sCompressedSwapInfo.max_size);
+		kprintf("used size: %9" B_PRIu64 "\n", sCompressedSwapInfo.used_size);
+		kprintf("pages:     %9" B_PRIu64 "\n",
+			sCompressedSwapInfo.stored_pages);
+		kprintf("stores:    %9" B_PRIu64 "\n", sCompressedSwapInfo.stores);
+		kprintf("loads:     %9" B_PRIu64 "\n", sCompressedSwapInfo.loads);
+		kprintf("rejects:   %9" B_PRIu64 "\n", sCompressedSwapInfo.rejects);
+		kprintf("overflows: %9" B_PRIu64 "\n", sCompressedSwapInfo.overflows);
+	}
+
 	return 0;
 }
 
 
+// #pragma mark - compressed swap
+
+
+/*!	The compressed swap tier keeps swapped out pages compressed in kernel
+	memory. Its slots are numbered from COMPRESSED_SWAP_SLOT_BASE on and are
+	handed out alongside the swap file slots, so that the swap blocks don't
+	need to know where a page lives. The tier does not add to the available
+	swap space: it merely saves a page the trip to the swap file, which still
+	backs all commitments.
+*/
+
+
+static inline bool
+is_compressed_swap_slot(swap_addr_t slotIndex)
+{
+	return slotIndex != SWAP_SLOT_NONE
+		&& slotIndex >= COMPRESSED_SWAP_SLOT_BASE;
+}
+
+
+static inline bool
+compressed_swap_enabled()
+{
+	return sCompressedSwapInfo.max_size > 0;
+}
+
+
+static void
+compressed_swap_init(off_t maxSize)
+{
+	// never let the pool take more than half of the memory
+	maxSize = min_c(maxSize, (off_t)vm_page_num_pages() * B_PAGE_SIZE / 2);
+	if (maxSize < B_PAGE_SIZE)
+		return;
+
+	uint32 slotCount = min_c(maxSize / B_PAGE_SIZE
+			* COMPRESSED_SWAP_SLOTS_PER_PAGE,
+		(off_t)COMPRESSED_SWAP_SLOT_BASE - 1);
+
+	sCompressedPages = (compressed_page**)calloc(slotCount,
+		sizeof(compressed_page*));
+	sCompressedSlotMap = radix_bitmap_create(slotCount);
+	sCompressionHashTable
+		= (uint16*)malloc(LZ_HASH_TABLE_SIZE * sizeof(uint16));
+	sCompressionPage = (uint8*)malloc(B_PAGE_SIZE);
+	sCompressionBuffer = (uint8*)malloc(MAX_COMPRESSED_PAGE_SIZE);
+
+	if (sCompressedPages == NULL || sCompressedSlotMap == NULL
+		|| sCompressionHashTable == NULL || sCompressionPage == NULL
+		|| sCompressionBuffer == NULL) {
+		dprintf("%s: Failed to allocate the compressed swap tier\n",
+			__func__);
+		free(sCompressedPages);
+		if (sCompressedSlotMap != NULL)
+			radix_bitmap_destroy(sCompressedSlotMap);
+		free(sCompressionHashTable);
+		free(sCompressionPage);
+		free(sCompressionBuffer);
+		return;
+	}
+
+	MutexLocker locker(sCompressedSwapLock);
+	sCompressedSlotCount = slotCount;
+	sCompressedSwapInfo.max_size = maxSize;
+
+	dprintf("%s: using up to %" B_PRIdOFF " bytes for compressed swap\n",
+		__func__, maxSize);
+}
+
+
+/*!	Compresses the page described by \a vec into the compressed tier.
+	Returns the new swap slot, or \c SWAP_SLOT_NONE if the page doesn't
+	compress well enough or the tier is full.
+*/
+static swap_addr_t
+compressed_swap_store(const generic_io_vec& vec, uint32 flags)
+{
+	if (!compressed_swap_enabled() || vec.length > B_PAGE_SIZE)
+		return SWAP_SLOT_NONE;
+
+	MutexLocker locker(sCompressedSwapLock);
+
+	if ((flags & B_PHYSICAL_IO_REQUEST) != 0) {
+		if (vm_memcpy_from_physical(sCompressionPage, vec.base, vec.length,
+				false) != B_OK) {
+			return SWAP_SLOT_NONE;
+		}
+	} else
+		memcpy(sCompressionPage, (void*)(addr_t)vec.base, vec.length);
+
+	memset(sCompressionPage + vec.length, 0, B_PAGE_SIZE - vec.length);
+
+	size_t size = lz_compress(sCompressionPage, B_PAGE_SIZE,
+		sCompressionBuffer, MAX_COMPRESSED_PAGE_SIZE, sCompressionHashTable);
+	if (size == 0) {
+		sCompressedSwapInfo.rejects++;
+		return SWAP_SLOT_NONE;
+	}
+
+	size_t allocationSize = sizeof(compressed_page) + size;
+	if (sCompressedSwapInfo.used_size + allocationSize
+			> sCompressedSwapInfo.max_size) {
+		sCompressedSwapInfo.overflows++;
+		return SWAP_SLOT_NONE;
+	}
+
+	swap_addr_t slotIndex = radix_bitmap_alloc(sCompressedSlotMap, 1);
+	if (slotIndex == SWAP_SLOT_NONE) {
+		sCompressedSwapInfo.overflows++;
+		return SWAP_SLOT_NONE;
+	}
+
+	compressed_page* page = (compressed_page*)malloc_etc(allocationSize,
+		HEAP_DONT_WAIT_FOR_MEMORY | HEAP_DONT_LOCK_KERNEL_SPACE);
+	if (page == NULL) {
+		radix_bitmap_dealloc(sCompressedSlotMap, slotIndex, 1);
+		sCompressedSwapInfo.overflows++;
+		return SWAP_SLOT_NONE;
+	}
+
+	page->size = size;
+	memcpy(page->data, sCompressionBuffer, size);
+	sCompressedPages[slotIndex] = page;
+
+	sCompressedSwapInfo.used_size += allocationSize;
+	sCompressedSwapInfo.stored_pages++;
+	sCompressedSwapInfo.stores++;
+
+	return COMPRESSED_SWAP_SLOT_BASE + slotIndex;
+}
+
+
+static status_t
+compressed_swap_load(swap_addr_t slotIndex, const generic_io_vec& vec,
+	uint32 flags)
+{
+	MutexLocker locker(sCompressedSwapLock);
+
+	slotIndex -= COMPRESSED_SWAP_SLOT_BASE;
+	compressed_page* page = slotIndex < sCompressedSlotCount
+		? sCompressedPages[slotIndex] : NULL;
+	if (page == NULL) {
+		panic("compressed_swap_load(): no page at slot %" B_PRIu32 "\n",
+			slotIndex);
+		return B_ERROR;
+	}
+
+	ssize_t length = lz_decompress(page->data, page->size, sCompressionPage,
+		B_PAGE_SIZE);
+	if (length != B_PAGE_SIZE) {
+		dprintf("compressed_swap_load(): page at slot %" B_PRIu32 " is "
+			"corrupt\n", slotIndex);
+		return B_BAD_DATA;
+	}
+
+	sCompressedSwapInfo.loads++;
+
+	generic_size_t toCopy = min_c(vec.length, B_PAGE_SIZE);
+	if ((flags & B_PHYSICAL_IO_REQUEST) != 0)
+		return vm_memcpy_to_physical(vec.base, sCompressionPage, toCopy, false);
+
+	memcpy((void*)(addr_t)vec.base, sCompressionPage, toCopy);
+	return B_OK;
+}
+
+
+static void
+compressed_swap_free(swap_addr_t slotIndex, uint32 count)
+{
+	MutexLocker locker(sCompressedSwapLock);
+
+	slotIndex -= COMPRESSED_SWAP_SLOT_BASE;
+	for (uint32 i = 0; i < count && slotIndex + i < sCompressedSlotCount;
+			i++) {
+		compressed_page* page = sCompressedPages[slotIndex + i];
+		if (page == NULL)
+			continue;
+
+		sCompressedSwapInfo.used_size -= sizeof(compressed_page) + page->size;
+		sCompressedSwapInfo.stored_pages--;
+
+		sCompressedPages[slotIndex + i] = NULL;
+		radix_bitmap_dealloc(sCompressedSlotMap, slotIndex + i, 1);
+		free_etc(page, HEAP_DONT_WAIT_FOR_MEMORY | HEAP_DONT_LOCK_KERNEL_SPACE);
+	}
+}
+
+
+static status_t
+compressed_swap_control(const char* subsystem, uint32 function, void* buffer,
+	size_t bufferSize)
+{
+	if (function != GET_COMPRESSED_SWAP_INFO)
+		return B_BAD_VALUE;
+
+	if (bufferSize < sizeof(compressed_swap_info))
+		return B_BAD_VALUE;
+
+	MutexLocker locker(sCompressedSwapLock);
+	compressed_swap_info info = sCompressedSwapInfo;
+	locker.Unlock();
+
+	if (!IS_USER_ADDRESS(buffer)
+		|| user_memcpy(buffer, &info, sizeof(info)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return B_OK;
+}
+
+
+// #pragma mark -
+
+
+
 static swap_addr_t
 swap_slot_alloc(uint32 count)
 {
@@ -336,6 +591,11 @@ swap_slot_dealloc(swap_addr_t slotIndex, uint32 count)
 	if (slotIndex == SWAP_SLOT_NONE)
 		return;
 
+	if (is_compressed_swap_slot(slotIndex)) {
+		compressed_swap_free(slotIndex, count);
+		return;
+	}
+
 	mutex_lock(&sSwapFileListLock);
 	swap_file* swapFile = find_swap_file(slotIndex);
 	slotIndex -= swapFile->first_slot;
@@ -766,9 +1026,23 @@ VMAnonymousCache::Read(off_t offset, const generic_io_vec* vecs, size_t count,
 	uint32 flags, generic_size_t* _numBytes)
 {
 	off_t pageIndex = offset >> PAGE_SHIFT;
+	generic_size_t totalBytes = 0;
 
 	for (uint32 i = 0, j = 0; i < count; i = j) {
 		swap_addr_t startSlotIndex = _SwapBlockGetAddress(pageIndex + i);
+		if (is_compressed_swap_slot(startSlotIndex)) {
+			T(ReadPage(this, pageIndex + i, startSlotIndex));
+
+			status_t status = compressed_swap_load(startSlotIndex, vecs[i],
+				flags);
+			if (status != B_OK)
+				return status;
+
+			totalBytes += vecs[i].length;
+			j = i + 1;
+			continue;
+		}
+
 		for (j = i + 1; j < count; j++) {
 			swap_addr_t slotIndex = _SwapBlockGetAddress(pageIndex + j);
 			if (slotIndex != startSlotIndex + j - i)
@@ -783,12 +1057,22 @@ VMAnonymousCache::Read(off_t offset, const generic_io_vec* vecs, size_t count,
 		off_t pos = (off_t)(startSlotIndex - swapFile->first_slot)
 			* B_PAGE_SIZE;
 
+		generic_size_t requestedBytes = 0;
+		for (uint32 k = i; k < j; k++)
+			requestedBytes += vecs[k].length;
+
+		generic_size_t bytesRead = requestedBytes;
 		status_t status = vfs_read_pages(swapFile->vnode, swapFile->cookie, pos,
-			vecs + i, j - i, flags, _numBytes);
+			vecs + i, j - i, flags, &bytesRead);
 		if (status != B_OK)
 			return status;
+
+		totalBytes += bytesRead;
+		if (bytesRead < requestedBytes)
+			break;
 	}
 
+	*_numBytes = totalBytes;
 	return B_OK;
 }
 
@@ -827,6 +1111,18 @@ VMAnonymousCache::Write(off_t offset, const generic_io_vec* vecs, size_t count,
 	for (uint32 i = 0; i < count; i++) {
 		page_num_t pageCount = (vecs[i].length + B_PAGE_SIZE - 1) >> PAGE_SHIFT;
 
+		if (pageCount == 1) {
+			swap_addr_t slotIndex = compressed_swap_store(vecs[i], flags);
+			if (slotIndex != SWAP_SLOT_NONE) {
+				T(WritePage(this, pageIndex + totalPages, slotIndex));
+
+				_SwapBlockBuild(pageIndex + totalPages, slotIndex, 1);
+				pagesLeft--;
+				totalPages++;
+				continue;
+			}
+		}
+
 		generic_addr_t vectorBase = vecs[i].base;
 		generic_size_t vectorLength = vecs[i].length;
 		page_num_t n = pageCount;
@@ -892,6 +1188,15 @@ VMAnonymousCache::WriteAsync(off_t offset, const generic_io_vec* vecs,
 	ASSERT(numBytes <= B_PAGE_SIZE);
 
 	page_num_t pageIndex = offset >> PAGE_SHIFT;
+
+	// The compressed tier doesn't need to do any I/O, so it's done right away.
+	generic_io_vec vec = vecs[0];
+	vec.length = numBytes;
+	if (_WriteCompressed(pageIndex, vec, flags) == B_OK) {
+		_callback->IOFinished(B_OK, false, numBytes);
+		return B_OK;
+	}
+
 	swap_addr_t slotIndex = _SwapBlockGetAddress(pageIndex);
 	bool newSlot = slotIndex == SWAP_SLOT_NONE;
 
@@ -1048,6 +1353,56 @@ VMAnonymousCache::DeleteObject()
 }
 
 
+/*!	Tries to move the page into the compressed swap tier, replacing its
+	previous swap slot, if any. If that fails, a previous compressed copy is
+	dropped, as it is stale now, while a swap file slot is left in place to be
+	reused.
+*/
+status_t
+VMAnonymousCache::_WriteCompressed(page_num_t pageIndex,
+	const generic_io_vec& vec, uint32 flags)
+{
+	if (!compressed_swap_enabled())
+		return B_NOT_SUPPORTED;
+
+	swap_addr_t oldSlotIndex = _SwapBlockGetAddress(pageIndex);
+	if (oldSlotIndex == SWAP_SLOT_NONE) {
+		AutoLocker<VMCache> locker(this);
+		if (fAllocatedSwapSize + B_PAGE_SIZE > fCommittedSwapSize)
+			return B_ERROR;
+
+		fAllocatedSwapSize += B_PAGE_SIZE;
+	}
+
+	swap_addr_t slotIndex = compressed_swap_store(vec, flags);
+	if (slotIndex == SWAP_SLOT_NONE) {
+		if (oldSlotIndex != SWAP_SLOT_NONE
+			&& !is_compressed_swap_slot(oldSlotIndex)) {
+			return B_NO_MEMORY;
+		}
+
+		if (oldSlotIndex != SWAP_SLOT_NONE) {
+			swap_slot_dealloc(oldSlotIndex, 1);
+			_SwapBlockFree(pageIndex, 1);
+		}
+
+		AutoLocker<VMCache> locker(this);
+		fAllocatedSwapSize -= B_PAGE_SIZE;
+		return B_NO_MEMORY;
+	}
+
+	T(WritePage(this, pageIndex, slotIndex));
+
+	if (oldSlotIndex != SWAP_SLOT_NONE) {
+		swap_slot_dealloc(oldSlotIndex, 1);
+		_SwapBlockFree(pageIndex, 1);
+	}
+
+	_SwapBlockBuild(pageIndex, slotIndex, 1);
+	return B_OK;
+}
+
+
 void
 VMAnonymousCache::_SwapBlockBuild(off_t startPageIndex,
 	swap_addr_t startSlotIndex, uint32 count)
@@ -1580,6 +1935,9 @@ swap_init(void)
 		"Print infos about the swap usage",
 		"\n"
 		"Print infos about the swap usage.\n", 0);
+
+	register_generic_syscall(COMPRESSED_SWAP_SYSCALLS, compressed_swap_control,
+		1, 0);
 }
 
 
@@ -1594,6 +1952,7 @@ swap_init_post_modules()
 	bool swapEnabled = true;
 	bool swapAutomatic = true;
 	off_t swapSize = 0;
+	off_t compressedSwapSize = 0;
 
 	dev_t swapDeviceID = -1;
 	VolumeInfo selectedVolume = {};
@@ -1607,6 +1966,11 @@ swap_init_post_modules()
 		// TODO: Some kind of BFS uuid would be great here :)
 		const char* enabled = get_driver_parameter(settings, "vm", NULL, NULL);
 
+		const char* compressedSize = get_driver_parameter(settings,
+			"compressed_swap_size", NULL, NULL);
+		if (compressedSize != NULL)
+			compressedSwapSize = atoll(compressedSize);
+
 		if (enabled != NULL) {
 			swapEnabled = get_driver_boolean_parameter(settings, "vm",
 				true, false);
@@ -1757,7 +2121,11 @@ swap_init_post_modules()
 	if (error != B_OK) {
 		dprintf("%s: Failed to add swap file %s: %s\n", __func__, swapPath,
 			strerror(error));
+		return;
 	}
+
+	// The compressed tier sits in front of the swap file.
+	compressed_swap_init(compressedSwapSize);
 }
 
 
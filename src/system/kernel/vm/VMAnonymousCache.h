@@ -83,6 +83,9 @@ private:
 			class WriteCallback;
 			friend class WriteCallback;
 
+			status_t			_WriteCompressed(page_num_t pageIndex,
+									const generic_io_vec& vec, uint32 flags);
+
 			void				_SwapBlockBuild(off_t pageIndex,
 									swap_addr_t slotIndex, uint32 count);
 			void				_SwapBlockFree(off_t pageIndex, uint32 count);
@@ -660,6 +660,9 @@ VMCache::Init(uint32 cacheType, uint32 allocationFlags)
 	page_count = 0;
 	fWiredPagesCount = 0;
 	type = cacheType;
+	evicted_pages = 0;
+	refaulted_pages = 0;
+	working_set_refaults = 0;
 	fPageEventWaiters = NULL;
 
 #if DEBUG_CACHE_LIST
@@ -1455,6 +1458,9 @@ VMCache::Dump(bool showPages) const
 	kprintf("  virtual_base: 0x%" B_PRIx64 "\n", virtual_base);
 	kprintf("  virtual_end:  0x%" B_PRIx64 "\n", virtual_end);
 	kprintf("  temporary:    %" B_PRIu32 "\n", uint32(temporary));
+	kprintf("  evicted:      %" B_PRIu32 "\n", evicted_pages);
+	kprintf("  refaulted:    %" B_PRIu32 " (%" B_PRIu32 " in working set)\n",
+		refaulted_pages, working_set_refaults);
 	kprintf("  lock:         %p\n", &fLock);
 #if KDEBUG
 	kprintf("  lock.holder:  %" B_PRId32 "\n", fLock.holder);
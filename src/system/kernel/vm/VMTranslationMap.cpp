@@ -14,6 +14,10 @@
 #include <vm/VMCache.h>
 
 
+int32 gLargePageRangesPromoted = 0;
+int32 gLargePageRangesDemoted = 0;
+
+
 // #pragma mark - VMTranslationMap
 
 
@@ -39,6 +43,35 @@ VMTranslationMap::DebugMarkRangePresent(addr_t start, addr_t end,
 }
 
 
+/*!	Returns the size of the large pages the map can use to back aligned
+	ranges, or \c 0, if large pages are not supported.
+	The default implementation returns \c 0.
+*/
+size_t
+VMTranslationMap::LargePageSize() const
+{
+	return 0;
+}
+
+
+/*!	Replaces the individual mappings of the LargePageSize() aligned range
+	starting at \a virtualAddress with a single large page mapping.
+
+	All pages of the range must be mapped with the same attributes to a
+	physically contiguous, equally aligned run of pages. The mappings remain
+	valid from the VM's point of view; whenever a single page of the range is
+	accessed through the map (unmapped, protected, etc.), the implementation
+	transparently splits the large page up again.
+
+	The default implementation returns \c B_NOT_SUPPORTED.
+*/
+status_t
+VMTranslationMap::PromoteLargePage(addr_t virtualAddress)
+{
+	return B_NOT_SUPPORTED;
+}
+
+
 /*!	Unmaps a range of pages of an area.
 
 	The default implementation just iterates over all virtual pages of the
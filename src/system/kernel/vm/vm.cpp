@@ -20,6 +20,7 @@
 
 #include <OS.h>
 #include <KernelExport.h>
+#include <driver_settings.h>
 
 #include <AutoDeleterDrivers.h>
 
@@ -254,6 +255,16 @@ static uint32 sPageFaults;
 
 static VMPhysicalPageMapper* sPhysicalPageMapper;
 
+static const uint32 kMaxFaultAroundPages = 64;
+static uint32 sFaultAroundPages = 16;
+static int32 sFaultAroundCount;
+static int32 sFaultAroundMappedPages;
+
+static const bigtime_t kLargePagePromotionInterval = 5000000;
+static const int32 kMaxLargePageAreasPerPass = 32;
+static const uint32 kMaxLargePageCollapsesPerPass = 16;
+static area_id sLargePagePromotionCursor;
+
 #if DEBUG_CACHE_LIST
 
 struct cache_info {
@@ -279,6 +290,7 @@ static status_t map_backing_store(VMAddressSpace* addressSpace,
 	const virtual_address_restrictions* addressRestrictions, bool kernel,
 	VMArea** _area, void** _virtualAddress);
 static void fix_protection(uint32* protection);
+static status_t large_page_promoter(void*);
 
 
 //	#pragma mark -
@@ -2166,6 +2178,22 @@ vm_map_file(team_id aid, const char* name, void** address, uint32 addressSpec,
 }
 
 
+/*!	Maps the file specified by the \a fd of the current team (or the kernel,
+	if \a kernel is \c true) read-only into the kernel address space. The
+	mapping shares the pages of the file cache. \a offset and \a size have
+	to be page aligned.
+*/
+area_id
+vm_map_file_into_kernel(const char* name, void** _address, addr_t size,
+	int fd, off_t offset, bool kernel)
+{
+	*_address = NULL;
+	return _vm_map_file(VMAddressSpace::KernelID(), name, _address,
+		B_ANY_KERNEL_ADDRESS, size, B_KERNEL_READ_AREA, REGION_NO_PRIVATE_MAP,
+		false, fd, offset, kernel);
+}
+
+
 VMCache*
 vm_area_get_locked_cache(VMArea* area)
 {
@@ -2526,10 +2554,12 @@ vm_copy_on_write_area(VMCache* lowerCache,
 				}
 			}
 		}
-	} else {
+	} else if (lowerCache->page_count > 0) {
 		ASSERT(lowerCache->WiredPagesCount() == 0);
 
-		// just change the protection of all areas
+		// Just change the protection of all areas. Without any pages in the
+		// cache, there's nothing to do: pages of caches further down are only
+		// ever mapped read-only, so the first write access faults anyway.
 		for (VMArea* tempArea = upperCache->areas; tempArea != NULL;
 				tempArea = tempArea->cache_next) {
 			if (tempArea->page_protections != NULL) {
@@ -3618,6 +3648,11 @@ dump_available_memory(int argc, char** argv)
 {
 	kprintf("Available memory: %" B_PRIdOFF "/%" B_PRIuPHYSADDR " bytes\n",
 		sAvailableMemory, (phys_addr_t)vm_page_num_pages() * B_PAGE_SIZE);
+	kprintf("Fault-around: %" B_PRId32 " faults mapped %" B_PRId32
+		" additional pages (window: %" B_PRIu32 " pages)\n", sFaultAroundCount,
+		sFaultAroundMappedPages, sFaultAroundPages);
+	kprintf("Large page ranges: %" B_PRId32 " promoted, %" B_PRId32
+		" demoted\n", gLargePageRangesPromoted, gLargePageRangesDemoted);
 	return 0;
 }
 
@@ -4354,6 +4389,17 @@ vm_init_post_sem(kernel_args* args)
 	heap_init_post_sem();
 #endif
 
+	if (void* handle = load_driver_settings("kernel")) {
+		const char* value = get_driver_parameter(handle, "fault_around_pages",
+			NULL, NULL);
+		if (value != NULL) {
+			sFaultAroundPages = std::min((uint32)strtoul(value, NULL, 0),
+				kMaxFaultAroundPages);
+		}
+
+		unload_driver_settings(handle);
+	}
+
 	return B_OK;
 }
 
@@ -4363,6 +4409,21 @@ vm_init_post_thread(kernel_args* args)
 {
 	vm_page_init_post_thread(args);
 	slab_init_post_thread();
+
+	// the promoter is only needed if user maps support large pages
+	VMTranslationMap* map;
+	if (arch_vm_translation_map_create_map(false, &map) == B_OK) {
+		bool largePagesSupported = map->LargePageSize() != 0;
+		delete map;
+
+		if (largePagesSupported) {
+			thread_id thread = spawn_kernel_thread(&large_page_promoter,
+				"large page promoter", B_LOWEST_ACTIVE_PRIORITY, NULL);
+			if (thread >= 0)
+				resume_thread(thread);
+		}
+	}
+
 	return heap_init_post_thread();
 }
 
@@ -4633,6 +4694,7 @@ fault_get_page(PageFaultContext& context)
 			}
 
 			// mark the page unbusy again
+			vm_page_check_refault(cache, page);
 			cache->MarkPageUnbusy(page);
 
 			DEBUG_PAGE_ACCESS_END(page);
@@ -4697,6 +4759,82 @@ fault_get_page(PageFaultContext& context)
 }
 
 
+/*!	Maps the resident pages surrounding the faulting \a address into the
+	area, so that sequential accesses to them don't fault as well.
+	Only pages from the cache the faulting page lives in are considered. The
+	address space and all caches from the top cache to that cache must be
+	locked.
+*/
+static void
+fault_around(PageFaultContext& context, VMArea* area, addr_t address)
+{
+	VMCache* pageCache = context.page->Cache();
+	size_t windowSize = sFaultAroundPages * B_PAGE_SIZE;
+	addr_t windowBase = ROUNDDOWN(address, windowSize);
+	addr_t start = std::max(windowBase, area->Base());
+	addr_t end = std::min(windowBase + (windowSize - 1),
+		area->Base() + (area->Size() - 1));
+
+	int32 mappedPages = 0;
+	for (addr_t pageAddress = start; pageAddress < end;
+			pageAddress += B_PAGE_SIZE) {
+		if (pageAddress == address)
+			continue;
+
+		uint32 protection = get_area_page_protection(area, pageAddress);
+		if ((protection & (B_READ_AREA | B_KERNEL_READ_AREA)) == 0)
+			continue;
+
+		// The page must not be shadowed by a page of a cache above -- be it
+		// resident or swapped out.
+		off_t cacheOffset = pageAddress - area->Base() + area->cache_offset;
+		bool shadowed = false;
+		for (VMCache* cache = context.topCache; cache != pageCache;
+				cache = cache->source) {
+			if (cache->LookupPage(cacheOffset) != NULL
+				|| cache->HasPage(cacheOffset)) {
+				shadowed = true;
+				break;
+			}
+		}
+		if (shadowed)
+			continue;
+
+		vm_page* page = pageCache->LookupPage(cacheOffset);
+		if (page == NULL || page->busy)
+			continue;
+
+		context.map->Lock();
+		phys_addr_t physicalAddress;
+		uint32 flags;
+		bool isMapped = context.map->Query(pageAddress, &physicalAddress,
+				&flags) == B_OK
+			&& (flags & PAGE_PRESENT) != 0;
+		context.map->Unlock();
+		if (isMapped)
+			continue;
+
+		// as in vm_soft_fault(), pages of lower caches are mapped read-only
+		if (pageCache != context.topCache)
+			protection &= ~(B_WRITE_AREA | B_KERNEL_WRITE_AREA);
+
+		DEBUG_PAGE_ACCESS_START(page);
+		status_t status = map_page(area, page, pageAddress, protection,
+			&context.reservation);
+		DEBUG_PAGE_ACCESS_END(page);
+		if (status != B_OK)
+			break;
+
+		mappedPages++;
+	}
+
+	if (mappedPages > 0) {
+		atomic_add(&sFaultAroundCount, 1);
+		atomic_add(&sFaultAroundMappedPages, mappedPages);
+	}
+}
+
+
 /*!	Makes sure the address in the given address space is mapped.
 
 	\param addressSpace The address space.
@@ -4723,11 +4861,19 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 
 	addressSpace->IncrementFaultCount();
 
-	// We may need up to 2 pages plus pages needed for mapping them -- reserving
-	// the pages upfront makes sure we don't have any cache locked, so that the
-	// page daemon/thief can do their job without problems.
-	size_t reservePages = 2 + context.map->MaxPagesNeededToMap(originalAddress,
-		originalAddress);
+	// We may need up to 2 pages plus pages needed for mapping them (and the
+	// pages fault_around() may map) -- reserving the pages upfront makes sure
+	// we don't have any cache locked, so that the page daemon/thief can do
+	// their job without problems.
+	addr_t mapStart = originalAddress;
+	addr_t mapEnd = originalAddress;
+	if (!isWrite && sFaultAroundPages > 1) {
+		size_t windowSize = sFaultAroundPages * B_PAGE_SIZE;
+		mapStart = ROUNDDOWN(originalAddress, windowSize);
+		mapEnd = mapStart + (windowSize - 1);
+	}
+	size_t reservePages = 2 + context.map->MaxPagesNeededToMap(mapStart,
+		mapEnd);
 	context.addressSpaceLocker.Unlock();
 	vm_page_reserve_pages(&context.reservation, reservePages,
 		addressSpace == VMAddressSpace::Kernel()
@@ -4932,6 +5078,12 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 
 		DEBUG_PAGE_ACCESS_END(context.page);
 
+		if (!isWrite && wirePage == NULL && sFaultAroundPages > 1
+			&& area->cache_type == CACHE_TYPE_VNODE
+			&& area->wiring == B_NO_LOCK) {
+			fault_around(context, area, address);
+		}
+
 		break;
 	}
 
@@ -4939,6 +5091,284 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 }
 
 
+// #pragma mark - large pages
+
+
+/*!	Checks whether the \a size bytes large range at \a base of the given area
+	consists of pages of the area's own cache that are mapped by the area only
+	and can thus be promoted to a large page. \a _contiguous is set to whether
+	the pages already form a suitably aligned physical run.
+	The area's address space and cache must be locked.
+*/
+static bool
+is_large_page_range_promotable(VMArea* area, VMCache* cache, addr_t base,
+	size_t size, bool& _contiguous)
+{
+	if (area->IsWired(base, size))
+		return false;
+
+	page_num_t pageCount = size / B_PAGE_SIZE;
+	off_t offset = base - area->Base() + area->cache_offset;
+	page_num_t firstPageNumber = 0;
+	_contiguous = true;
+
+	for (page_num_t i = 0; i < pageCount; i++) {
+		vm_page* page = cache->LookupPage(offset + i * B_PAGE_SIZE);
+		if (page == NULL || page->busy || page->WiredCount() != 0)
+			return false;
+
+		vm_page_mapping* mapping = page->mappings.Head();
+		if (mapping == NULL || mapping->area != area
+			|| page->mappings.GetNext(mapping) != NULL) {
+			return false;
+		}
+
+		if (i == 0) {
+			firstPageNumber = page->physical_page_number;
+			if (firstPageNumber % pageCount != 0)
+				_contiguous = false;
+		} else if (page->physical_page_number != firstPageNumber + i)
+			_contiguous = false;
+	}
+
+	return true;
+}
+
+
+/*!	Replaces the pages of the given range of the area with the pages of the
+	physical page run starting at \a run, copying their contents.
+	The area's address space and cache must be locked.
+*/
+static void
+collapse_large_page_range(VMArea* area, VMCache* cache, addr_t base,
+	size_t size, vm_page* run, vm_page_reservation* reservation)
+{
+	// Unmap the range first, so that nobody can change the pages while we're
+	// copying them. Page faults will block on the cache lock we're holding.
+	area->address_space->TranslationMap()->UnmapPages(area, base, size,
+		false);
+
+	off_t offset = base - area->Base() + area->cache_offset;
+	for (size_t i = 0; i < size / B_PAGE_SIZE; i++) {
+		vm_page* oldPage = cache->LookupPage(offset + i * B_PAGE_SIZE);
+		vm_page* newPage = vm_lookup_page(run->physical_page_number + i);
+
+		vm_memcpy_physical_page(
+			newPage->physical_page_number * B_PAGE_SIZE,
+			oldPage->physical_page_number * B_PAGE_SIZE);
+		newPage->modified = oldPage->modified;
+		newPage->accessed = oldPage->accessed;
+		newPage->usage_count = oldPage->usage_count;
+
+		DEBUG_PAGE_ACCESS_START(oldPage);
+		cache->RemovePage(oldPage);
+		vm_page_free(cache, oldPage);
+
+		cache->InsertPage(newPage, offset + i * B_PAGE_SIZE);
+		map_page(area, newPage, base + i * B_PAGE_SIZE, area->protection,
+			reservation);
+
+		DEBUG_PAGE_ACCESS_END(newPage);
+	}
+}
+
+
+/*!	Tries to back the large page sized range at \a base of the given area
+	with a large page. If the range's pages aren't physically contiguous yet,
+	they are copied into a freshly allocated page run first, in which case
+	\a _collapsed is set to \c true.
+	Returns \c B_OK, if the range is backed by a large page now.
+*/
+static status_t
+promote_large_page_range(area_id areaID, addr_t base, bool& _collapsed)
+{
+	_collapsed = false;
+
+	vm_page* run = NULL;
+	page_num_t runLength = 0;
+	vm_page_reservation reservation;
+	bool reserved = false;
+	status_t status;
+
+	while (true) {
+		AddressSpaceReadLocker locker;
+		VMArea* area;
+		status = locker.SetFromArea(areaID, area);
+		if (status != B_OK)
+			break;
+
+		VMTranslationMap* map = locker.AddressSpace()->TranslationMap();
+		size_t size = map->LargePageSize();
+		if (size == 0 || base < area->Base()
+			|| base - area->Base() + size > area->Size()) {
+			status = B_BAD_VALUE;
+			break;
+		}
+
+		VMCache* cache = vm_area_get_locked_cache(area);
+
+		bool contiguous;
+		if (!cache->temporary || cache->areas != area
+			|| area->cache_next != NULL || !cache->consumers.IsEmpty()
+			|| !is_large_page_range_promotable(area, cache, base, size,
+				contiguous)) {
+			vm_area_put_locked_cache(cache);
+			status = B_BUSY;
+			break;
+		}
+
+		if (!contiguous && run == NULL) {
+			// Allocating the run may take a while -- don't hold any locks in
+			// the meantime and check everything again afterwards.
+			size_t reservePages = map->MaxPagesNeededToMap(base,
+				base + size - 1);
+			vm_area_put_locked_cache(cache);
+			locker.Unset();
+
+			runLength = size / B_PAGE_SIZE;
+			if (vm_page_num_free_pages() < 4 * runLength) {
+				status = B_NO_MEMORY;
+				break;
+			}
+
+			if (!vm_page_try_reserve_pages(&reservation, reservePages,
+					VM_PRIORITY_USER)) {
+				status = B_NO_MEMORY;
+				break;
+			}
+			reserved = true;
+
+			physical_address_restrictions restrictions = {};
+			restrictions.alignment = size;
+			run = vm_page_allocate_page_run(PAGE_STATE_ACTIVE, runLength,
+				&restrictions, VM_PRIORITY_USER);
+			if (run == NULL) {
+				status = B_NO_MEMORY;
+				break;
+			}
+
+			continue;
+		}
+
+		if (!contiguous) {
+			collapse_large_page_range(area, cache, base, size, run,
+				&reservation);
+			run = NULL;
+			_collapsed = true;
+		}
+
+		status = map->PromoteLargePage(base);
+		vm_area_put_locked_cache(cache);
+		break;
+	}
+
+	if (run != NULL) {
+		// the range has changed while we were allocating the run
+		for (page_num_t i = 0; i < runLength; i++) {
+			vm_page_set_state(vm_lookup_page(run->physical_page_number + i),
+				PAGE_STATE_FREE);
+		}
+	}
+
+	if (reserved)
+		vm_page_unreserve_pages(&reservation);
+
+	return status;
+}
+
+
+/*!	Collects the IDs of up to \a maxCount areas with the
+	\c B_LARGE_PAGES_AREA flag, continuing where the previous pass stopped.
+*/
+static int32
+collect_large_page_areas(area_id* areas, int32 maxCount)
+{
+	int32 count = 0;
+
+	VMAreaHash::ReadLock();
+
+	for (VMAreaHashTable::Iterator it = VMAreaHash::GetIterator();
+			VMArea* area = it.Next();) {
+		if ((area->protection & B_LARGE_PAGES_AREA) == 0
+			|| area->wiring != B_NO_LOCK
+			|| area->page_protections != NULL
+			|| area->id <= sLargePagePromotionCursor) {
+			continue;
+		}
+
+		// keep the areas with the lowest IDs, sorted ascendingly
+		int32 index = count;
+		while (index > 0 && areas[index - 1] > area->id)
+			index--;
+		if (index == maxCount)
+			continue;
+
+		if (count < maxCount)
+			count++;
+		memmove(areas + index + 1, areas + index,
+			(count - index - 1) * sizeof(area_id));
+		areas[index] = area->id;
+	}
+
+	VMAreaHash::ReadUnlock();
+
+	sLargePagePromotionCursor = count == maxCount ? areas[count - 1] : 0;
+	return count;
+}
+
+
+static status_t
+large_page_promoter(void* /*unused*/)
+{
+	area_id areas[kMaxLargePageAreasPerPass];
+
+	while (true) {
+		snooze(kLargePagePromotionInterval);
+
+		int32 areaCount = collect_large_page_areas(areas,
+			kMaxLargePageAreasPerPass);
+		uint32 collapsed = 0;
+
+		for (int32 i = 0; i < areaCount
+				&& collapsed < kMaxLargePageCollapsesPerPass; i++) {
+			addr_t start;
+			addr_t end;
+			size_t size;
+			{
+				AddressSpaceReadLocker locker;
+				VMArea* area;
+				if (locker.SetFromArea(areas[i], area) != B_OK)
+					continue;
+
+				size = locker.AddressSpace()->TranslationMap()
+					->LargePageSize();
+				if (size == 0)
+					continue;
+
+				start = ROUNDUP(area->Base(), size);
+				end = ROUNDDOWN(area->Base() + area->Size(), size);
+			}
+
+			// Only collapsing a range is expensive, ranges that are already
+			// contiguous (or promoted) don't count against the limit.
+			for (addr_t base = start; base < end
+					&& collapsed < kMaxLargePageCollapsesPerPass;
+					base += size) {
+				bool rangeCollapsed;
+				status_t status = promote_large_page_range(areas[i], base,
+					rangeCollapsed);
+				if (rangeCollapsed)
+					collapsed++;
+				if (status == B_NO_MEMORY)
+					break;
+			}
+		}
+	}
+
+	return B_OK;
+}
+
+
 status_t
 vm_get_physical_page(phys_addr_t paddr, addr_t* _vaddr, void** _handle)
 {
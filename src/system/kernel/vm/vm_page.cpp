@@ -24,6 +24,7 @@
 #include <boot/kernel_args.h>
 #include <condition_variable.h>
 #include <elf.h>
+#include <generic_syscall.h>
 #include <heap.h>
 #include <kernel.h>
 #include <low_resource_manager.h>
@@ -37,6 +38,7 @@
 #include <vm/VMAddressSpace.h>
 #include <vm/VMArea.h>
 #include <vm/VMCache.h>
+#include <working_set.h>
 
 #include "IORequest.h"
 #include "PageCacheLocker.h"
@@ -100,6 +102,15 @@ static const int32 kPageUsageAdvance = 3;
 // vm_page::usage_count debuff an unaccessed page receives in a scan.
 static const int32 kPageUsageDecline = 1;
 
+// Number of evictions after which the working set counters of a cache are
+// halved, so that they reflect its recent behaviour.
+static const uint32 kWorkingSetDecayThreshold = 4096;
+// Minimum number of evictions before a cache is considered to be streaming.
+static const uint32 kStreamingMinEvictions = 256;
+// Limits for the number of entries of the eviction shadow table.
+static const uint32 kMinShadowTableEntries = 1024;
+static const uint32 kMaxShadowTableEntries = 1 << 20;
+
 int32 gMappedPagesCount;
 
 static VMPageQueue sPageQueues[PAGE_STATE_COUNT];
@@ -123,6 +134,17 @@ static int32 sUnreservedFreePages;
 static int32 sUnsatisfiedPageReservations;
 static int32 sModifiedTemporaryPages;
 
+// The shadow table remembers when pages were evicted from the cached queue.
+// Each entry holds a tag identifying the cache page in the upper and the
+// value of sEvictionClock at the time of the eviction in the lower 32 bits.
+static int64* sShadowTable;
+static uint32 sShadowTableMask;
+static int32 sEvictionClock;
+static int64 sEvictedPages;
+static int64 sRefaultedPages;
+static int64 sWorkingSetRefaults;
+static int64 sStreamingPages;
+
 static ConditionVariable sFreePageCondition;
 static mutex sPageDeficitLock = MUTEX_INITIALIZER("page deficit");
 
@@ -1154,6 +1176,9 @@ dump_page_stats(int argc, char **argv)
 	kprintf("unsatisfied page reservations: %" B_PRId32 "\n",
 		sUnsatisfiedPageReservations);
 	kprintf("mapped pages: %" B_PRId32 "\n", gMappedPagesCount);
+	kprintf("evicted pages: %" B_PRId64 ", refaults: %" B_PRId64 " (%" B_PRId64
+		" in working set), streaming: %" B_PRId64 "\n", sEvictedPages,
+		sRefaultedPages, sWorkingSetRefaults, sStreamingPages);
 	kprintf("longest free pages run: %" B_PRIuPHYSADDR " pages (at %"
 		B_PRIuPHYSADDR ")\n", longestFreeRun.Length(),
 		sPages[longestFreeRun.start].physical_page_number);
@@ -2547,6 +2572,124 @@ free_page_swap_space(int32 index)
 #endif	// 0
 
 
+// #pragma mark - working set estimation
+
+
+static inline uint64
+shadow_key(VMCache* cache, page_num_t cacheOffset)
+{
+	uint64 key = (uint64)(addr_t)cache * 0x9e3779b97f4a7c15ULL
+		^ (uint64)cacheOffset * 0xc2b2ae3d27d4eb4fULL;
+	return key ^ (key >> 31);
+}
+
+
+static inline uint32
+shadow_tag(uint64 key)
+{
+	// a tag is never 0, so that empty entries never match
+	return (uint32)(key >> 32) | 1;
+}
+
+
+/*!	Returns whether the pages of \a cache are mostly used only once, that is
+	they are rarely read in again after they have been evicted. This is
+	typically the case for files that are read sequentially.
+	The cache must be locked.
+*/
+static inline bool
+cache_is_streaming(VMCache* cache)
+{
+	return !cache->temporary
+		&& cache->evicted_pages >= kStreamingMinEvictions
+		&& cache->working_set_refaults * 8 < cache->evicted_pages;
+}
+
+
+static inline int32
+page_usage_decline(VMCache* cache)
+{
+	// there is no point in keeping pages of streaming caches around
+	return cache_is_streaming(cache) ? kPageUsageMax : kPageUsageDecline;
+}
+
+
+/*!	Records the eviction of \a page from \a cache in the shadow table.
+	The cache must be locked.
+*/
+static void
+record_page_eviction(VMCache* cache, vm_page* page)
+{
+	uint32 clock = (uint32)atomic_add(&sEvictionClock, 1) + 1;
+	atomic_add64(&sEvictedPages, 1);
+
+	if (sShadowTable != NULL) {
+		uint64 key = shadow_key(cache, page->cache_offset);
+		atomic_set64(&sShadowTable[key & sShadowTableMask],
+			(int64)((uint64)shadow_tag(key) << 32 | clock));
+	}
+
+	if (++cache->evicted_pages >= kWorkingSetDecayThreshold) {
+		cache->evicted_pages /= 2;
+		cache->refaulted_pages /= 2;
+		cache->working_set_refaults /= 2;
+	}
+}
+
+
+static status_t
+working_set_control(const char* subsystem, uint32 function, void* buffer,
+	size_t bufferSize)
+{
+	if (function != GET_WORKING_SET_INFO)
+		return B_BAD_VALUE;
+
+	if (bufferSize < sizeof(working_set_info))
+		return B_BAD_VALUE;
+
+	working_set_info info;
+	info.shadow_entries = sShadowTable != NULL ? sShadowTableMask + 1 : 0;
+	info.evicted_pages = atomic_get64(&sEvictedPages);
+	info.refaults = atomic_get64(&sRefaultedPages);
+	info.activations = atomic_get64(&sWorkingSetRefaults);
+	info.streaming_pages = atomic_get64(&sStreamingPages);
+
+	if (!IS_USER_ADDRESS(buffer)
+		|| user_memcpy(buffer, &info, sizeof(info)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return B_OK;
+}
+
+
+static void
+init_working_set_estimation()
+{
+	uint32 entries = kMinShadowTableEntries;
+	while (entries < sNumPages / 8 && entries < kMaxShadowTableEntries)
+		entries *= 2;
+
+	void* address;
+	area_id area = create_area("page shadow table", &address,
+		B_ANY_KERNEL_ADDRESS, PAGE_ALIGN(entries * sizeof(int64)), B_FULL_LOCK,
+		B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (area < 0) {
+		dprintf("vm_page: failed to create the page shadow table: %s\n",
+			strerror(area));
+	} else {
+		// the memory is cleared already
+		sShadowTableMask = entries - 1;
+		sShadowTable = (int64*)address;
+	}
+
+	register_generic_syscall(WORKING_SET_SYSCALLS, working_set_control, 1, 0);
+}
+
+
+// #pragma mark -
+
+
 static vm_page *
 find_cached_page_candidate(struct vm_page &marker)
 {
@@ -2607,6 +2750,7 @@ free_cached_page(vm_page *page, bool dontWait)
 
 	// we can now steal this page
 
+	record_page_eviction(cache, page);
 	cache->RemovePage(page);
 		// Now the page doesn't have cache anymore, so no one else (e.g.
 		// vm_page_allocate_page_run() can pick it up), since they would be
@@ -2710,7 +2854,7 @@ idle_scan_active_pages(page_stats& pageStats)
 				usageCount = kPageUsageMax;
 // TODO: This would probably also be the place to reclaim swap space.
 		} else {
-			usageCount += page->usage_count - (int32)kPageUsageDecline;
+			usageCount += page->usage_count - page_usage_decline(cache);
 			if (usageCount < 0) {
 				usageCount = 0;
 				set_page_state(page, PAGE_STATE_INACTIVE);
@@ -2801,7 +2945,7 @@ full_scan_inactive_pages(page_stats& pageStats, int32 despairLevel)
 			if (usageCount > kPageUsageMax)
 				usageCount = kPageUsageMax;
 		} else {
-			usageCount += page->usage_count - (int32)kPageUsageDecline;
+			usageCount += page->usage_count - page_usage_decline(cache);
 			if (usageCount < 0)
 				usageCount = 0;
 		}
@@ -2925,7 +3069,7 @@ full_scan_active_pages(page_stats& pageStats, int32 despairLevel)
 			pagesAccessed++;
 // TODO: This would probably also be the place to reclaim swap space.
 		} else {
-			usageCount += page->usage_count - (int32)kPageUsageDecline;
+			usageCount += page->usage_count - page_usage_decline(cache);
 			if (usageCount <= 0) {
 				usageCount = 0;
 				set_page_state(page, PAGE_STATE_INACTIVE);
@@ -3489,6 +3633,8 @@ vm_page_init_post_thread(kernel_args *args)
 		B_NORMAL_PRIORITY, NULL);
 	resume_thread(thread);
 
+	init_working_set_estimation();
+
 	return B_OK;
 }
 
@@ -4091,6 +4237,54 @@ vm_page_requeue(struct vm_page *page, bool tail)
 }
 
 
+/*!	Must be called when \a page has just been read into \a cache from its
+	backing store, before it is marked unbusy.
+	If the page has been evicted before, the distance between its eviction and
+	this refault tells whether it would have stayed in memory had the active
+	pages been reclaimed instead: only as many pages as are currently active
+	have been evicted since. Such pages are part of the working set and are
+	activated right away. Pages of caches that almost never refault within the
+	working set (i.e. streaming file data) are put where they will be
+	reclaimed first.
+	The cache must be locked.
+*/
+void
+vm_page_check_refault(VMCache* cache, vm_page* page)
+{
+	cache->AssertLocked();
+	DEBUG_PAGE_ACCESS_CHECK(page);
+
+	if (sShadowTable != NULL) {
+		uint64 key = shadow_key(cache, page->cache_offset);
+		int64* entry = &sShadowTable[key & sShadowTableMask];
+		int64 shadow = atomic_get64(entry);
+		if (shadow != 0 && (uint32)((uint64)shadow >> 32) == shadow_tag(key)
+			&& atomic_test_and_set64(entry, 0, shadow) == shadow) {
+			atomic_add64(&sRefaultedPages, 1);
+			cache->refaulted_pages++;
+
+			uint32 distance = (uint32)atomic_get(&sEvictionClock)
+				- (uint32)shadow;
+			if (distance <= sActivePageQueue.Count()) {
+				atomic_add64(&sWorkingSetRefaults, 1);
+				cache->working_set_refaults++;
+
+				if (page->State() == PAGE_STATE_CACHED)
+					set_page_state(page, PAGE_STATE_ACTIVE);
+				if (page->usage_count < kPageUsageAdvance)
+					page->usage_count = kPageUsageAdvance;
+			}
+			return;
+		}
+	}
+
+	if (page->State() == PAGE_STATE_CACHED && cache_is_streaming(cache)) {
+		vm_page_requeue(page, false);
+		atomic_add64(&sStreamingPages, 1);
+	}
+}
+
+
 page_num_t
 vm_page_num_pages(void)
 {
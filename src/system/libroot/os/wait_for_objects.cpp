@@ -7,7 +7,6 @@
 #include <syscalls.h>
 
 
-
 ssize_t
 wait_for_objects(object_wait_info* infos, int numInfos)
 {
@@ -21,3 +20,32 @@ wait_for_objects_etc(object_wait_info* infos, int numInfos, uint32 flags,
 {
 	return _kern_wait_for_objects(infos, numInfos, flags, timeout);
 }
+
+
+int
+create_event_queue(int openFlags)
+{
+	return _kern_create_event_queue(openFlags);
+}
+
+
+status_t
+event_queue_select(int queue, const event_wait_info* info)
+{
+	return _kern_event_queue_select(queue, info);
+}
+
+
+status_t
+event_queue_deselect(int queue, int32 object, uint16 type)
+{
+	return _kern_event_queue_deselect(queue, object, type);
+}
+
+
+ssize_t
+event_queue_wait(int queue, event_wait_info* infos, int numInfos,
+	uint32 flags, bigtime_t timeout)
+{
+	return _kern_event_queue_wait(queue, infos, numInfos, flags, timeout);
+}
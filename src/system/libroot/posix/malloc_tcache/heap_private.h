@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef MALLOC_TCACHE_HEAP_PRIVATE_H
+#define MALLOC_TCACHE_HEAP_PRIVATE_H
+
+
+#include <OS.h>
+
+
+/*!	The heap consists of segments, naturally aligned regions of kSegmentSize
+	bytes. The first slab of a segment holds the Segment header, the others
+	are handed out as spans of one or more slabs.
+	A span either holds the objects of a single size class, or a single large
+	allocation. Allocations that don't fit into a segment get a region of
+	their own, which starts with a Segment header as well (marked as huge).
+
+	Every allocation lies within kSegmentSize bytes after the start of its
+	region, so segment_for() finds the header of any allocated address.
+*/
+
+
+namespace BPrivate {
+namespace TCache {
+
+
+#if B_HAIKU_64_BIT
+static const uint32 kSegmentShift = 22;
+#else
+static const uint32 kSegmentShift = 20;
+#endif
+static const size_t kSegmentSize = (size_t)1 << kSegmentShift;
+
+static const uint32 kSlabShift = 14;
+static const size_t kSlabSize = (size_t)1 << kSlabShift;
+static const uint32 kSlabsPerSegment = kSegmentSize / kSlabSize;
+static const uint32 kMaxSpanSlabs = kSlabsPerSegment - 1;
+	// the first slab is used for the segment header
+
+static const size_t kAlignment = 16;
+
+
+struct Slab {
+	Slab*		next;
+	Slab*		previous;
+	void*		free_list;
+	addr_t		unused;
+		// start of the part of the span that has never been handed out
+	uint16		first;
+		// index of the first slab of the span this slab belongs to
+	uint16		count;
+	uint16		used;
+	uint16		capacity;
+	uint8		size_class;
+		// 0 for large allocations
+};
+
+
+struct Segment {
+	Segment*	next;
+	Segment*	previous;
+	size_t		size;
+	bool		huge;
+	uint16		free_slabs;
+	uint32		free_map[kSlabsPerSegment / 32];
+	uint32		dirty_map[kSlabsPerSegment / 32];
+		// free slabs that may still have memory committed
+	Slab		slabs[kSlabsPerSegment];
+};
+
+
+// the segment header must fit into the first slab
+typedef char SegmentHeaderSizeCheck[sizeof(Segment) <= kSlabSize ? 1 : -1];
+
+
+static inline Segment*
+segment_for(const void* address)
+{
+	return (Segment*)(((addr_t)address - 1) & ~(kSegmentSize - 1));
+}
+
+
+static inline Segment*
+segment_for(const Slab* slab)
+{
+	return (Segment*)((addr_t)slab & ~(kSegmentSize - 1));
+}
+
+
+static inline Slab*
+slab_for(Segment* segment, const void* address)
+{
+	uint32 index = ((addr_t)address - (addr_t)segment) >> kSlabShift;
+	return &segment->slabs[segment->slabs[index].first];
+}
+
+
+static inline addr_t
+slab_address(const Slab* slab)
+{
+	Segment* segment = segment_for(slab);
+	return (addr_t)segment + ((addr_t)(slab - segment->slabs) << kSlabShift);
+}
+
+
+status_t	page_heap_init();
+Slab*		page_heap_allocate_span(uint32 slabCount);
+void		page_heap_free_span(Slab* slab);
+void*		page_heap_allocate_huge(size_t size, size_t alignment);
+void		page_heap_free_huge(Segment* segment);
+
+void		page_heap_lock();
+void		page_heap_unlock();
+void		page_heap_reinit_after_fork();
+
+void		page_heap_get_stats(size_t& regionBytes, size_t& spanBytes,
+				uint32& spanCount);
+
+
+}	// namespace TCache
+}	// namespace BPrivate
+
+
+#endif	// MALLOC_TCACHE_HEAP_PRIVATE_H
@@ -0,0 +1,461 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "heap_private.h"
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include <locks.h>
+#include <libroot_private.h>
+#include <syscalls.h>
+
+
+namespace BPrivate {
+namespace TCache {
+
+
+#if B_HAIKU_64_BIT
+static const addr_t kHeapReservationBase = 0x100100000000;
+static const size_t kHeapReservationSize = 0x1000000000;
+#else
+static const addr_t kHeapReservationBase = 0x18000000;
+static const size_t kHeapReservationSize = 0x48000000;
+#endif
+
+static const uint32 kMaxRegions = kHeapReservationSize >> kSegmentShift;
+
+static const uint32 kMaxEmptySegments = 1;
+	// completely free segments that are kept around
+static const uint32 kMinDirtySlabs = (4 * 1024 * 1024) >> kSlabShift;
+	// free slabs whose memory is always kept before it is returned to the
+	// system; beyond that, up to a quarter of the memory in use is kept
+
+
+static mutex sPageLock = MUTEX_INITIALIZER("heap pages");
+
+static Segment* sSegments;
+static uint32 sEmptySegments;
+static uint32 sDirtySlabs;
+
+static size_t sRegionBytes;
+static size_t sSpanBytes;
+static uint32 sSpanCount;
+
+// The address range reserved for the heap, divided into regions of
+// kSegmentSize bytes each.
+static addr_t sReservationBase;
+static uint32 sRegionCount;
+static uint32 sRegionMap[kMaxRegions / 32];
+
+
+static inline bool
+test_bit(const uint32* map, uint32 index)
+{
+	return (map[index / 32] & (1UL << (index % 32))) != 0;
+}
+
+
+static inline void
+set_bit(uint32* map, uint32 index)
+{
+	map[index / 32] |= 1UL << (index % 32);
+}
+
+
+static inline void
+clear_bit(uint32* map, uint32 index)
+{
+	map[index / 32] &= ~(1UL << (index % 32));
+}
+
+
+static uint32
+area_protection()
+{
+	uint32 protection = B_READ_AREA | B_WRITE_AREA;
+	if (__gABIVersion < B_HAIKU_ABI_GCC_2_HAIKU)
+		protection |= B_EXECUTE_AREA;
+	return protection;
+}
+
+
+static bool
+is_reserved_region(addr_t base)
+{
+	return sReservationBase != 0 && base >= sReservationBase
+		&& base < sReservationBase + ((addr_t)sRegionCount << kSegmentShift);
+}
+
+
+/*!	Creates an area of \a size bytes starting at a segment aligned address
+	for which \a base + \a offset is aligned to \a alignment.
+	\a alignment must be a multiple of kSegmentSize, and \a offset either 0 or
+	kSegmentSize.
+*/
+static addr_t
+region_allocate(size_t size, size_t alignment, size_t offset)
+{
+	uint32 count = size >> kSegmentShift;
+
+	for (uint32 start = 0; sReservationBase != 0
+			&& start + count <= sRegionCount; start++) {
+		addr_t base = sReservationBase + ((addr_t)start << kSegmentShift);
+		if (((base + offset) & (alignment - 1)) != 0)
+			continue;
+
+		bool available = true;
+		for (uint32 i = start; i < start + count; i++) {
+			if (test_bit(sRegionMap, i)) {
+				available = false;
+				start = i;
+				break;
+			}
+		}
+		if (!available)
+			continue;
+
+		void* address = (void*)base;
+		area_id area = create_area("heap", &address, B_EXACT_ADDRESS, size,
+			B_NO_LOCK, area_protection());
+		if (area == B_NO_MEMORY)
+			return 0;
+
+		// If something else has been mapped there, the range stays marked as
+		// used and we try the next one.
+		for (uint32 i = start; i < start + count; i++)
+			set_bit(sRegionMap, i);
+
+		if (area >= 0)
+			return base;
+	}
+
+	// The reserved range is exhausted (or couldn't be reserved at all), create
+	// an area anywhere large enough to contain an aligned region.
+	if (size + alignment < size)
+		return 0;
+
+	void* address;
+	area_id area = create_area("heap", &address, B_RANDOMIZED_BASE_ADDRESS,
+		size + alignment, B_NO_LOCK, area_protection());
+	if (area < 0)
+		return 0;
+
+	return (((addr_t)address + offset + alignment - 1) & ~(alignment - 1))
+		- offset;
+}
+
+
+static void
+region_free(addr_t base, size_t size)
+{
+	delete_area(area_for((void*)base));
+
+	if (!is_reserved_region(base))
+		return;
+
+	// reserve the range again, so that it can be reused
+	addr_t address = base;
+	if (_kern_reserve_address_range(&address, B_EXACT_ADDRESS, size) != B_OK)
+		return;
+
+	uint32 start = (base - sReservationBase) >> kSegmentShift;
+	for (uint32 i = 0; i < (size >> kSegmentShift); i++)
+		clear_bit(sRegionMap, start + i);
+}
+
+
+static Segment*
+segment_create()
+{
+	addr_t base = region_allocate(kSegmentSize, kSegmentSize, 0);
+	if (base == 0)
+		return NULL;
+
+	// the area is zeroed
+	Segment* segment = (Segment*)base;
+	segment->size = kSegmentSize;
+	segment->huge = false;
+	segment->free_slabs = kMaxSpanSlabs;
+	for (uint32 i = 1; i < kSlabsPerSegment; i++)
+		set_bit(segment->free_map, i);
+
+	segment->next = sSegments;
+	if (sSegments != NULL)
+		sSegments->previous = segment;
+	sSegments = segment;
+
+	sRegionBytes += kSegmentSize;
+	sEmptySegments++;
+	return segment;
+}
+
+
+static void
+segment_delete(Segment* segment)
+{
+	if (segment->previous != NULL)
+		segment->previous->next = segment->next;
+	else
+		sSegments = segment->next;
+	if (segment->next != NULL)
+		segment->next->previous = segment->previous;
+
+	for (uint32 i = 1; i < kSlabsPerSegment; i++) {
+		if (test_bit(segment->dirty_map, i))
+			sDirtySlabs--;
+	}
+
+	sRegionBytes -= kSegmentSize;
+	region_free((addr_t)segment, kSegmentSize);
+}
+
+
+static int32
+segment_find_free_run(Segment* segment, uint32 count)
+{
+	uint32 runLength = 0;
+	for (uint32 i = 1; i < kSlabsPerSegment; i++) {
+		if (!test_bit(segment->free_map, i)) {
+			runLength = 0;
+			continue;
+		}
+
+		if (++runLength == count)
+			return i + 1 - count;
+	}
+
+	return -1;
+}
+
+
+/*!	Returns the memory of all free slabs to the system. It will be zeroed
+	when it's touched again.
+*/
+static void
+purge_dirty_slabs()
+{
+	for (Segment* segment = sSegments; segment != NULL;
+			segment = segment->next) {
+		uint32 i = 1;
+		while (i < kSlabsPerSegment) {
+			if (!test_bit(segment->dirty_map, i)) {
+				i++;
+				continue;
+			}
+
+			uint32 start = i;
+			while (i < kSlabsPerSegment && test_bit(segment->dirty_map, i)) {
+				clear_bit(segment->dirty_map, i);
+				i++;
+			}
+
+			_kern_memory_advice(
+				(void*)((addr_t)segment + ((addr_t)start << kSlabShift)),
+				(size_t)(i - start) << kSlabShift, MADV_FREE);
+		}
+	}
+
+	sDirtySlabs = 0;
+}
+
+
+//	#pragma mark -
+
+
+status_t
+page_heap_init()
+{
+	// Reserve a range of the address space for the heap, so that it can
+	// grow without running into other areas.
+	addr_t base = kHeapReservationBase;
+	status_t status = _kern_reserve_address_range(&base,
+		B_RANDOMIZED_BASE_ADDRESS, kHeapReservationSize);
+	if (status != B_OK)
+		return B_OK;
+
+	sReservationBase = (base + kSegmentSize - 1) & ~(kSegmentSize - 1);
+	sRegionCount = (base + kHeapReservationSize - sReservationBase)
+		>> kSegmentShift;
+	return B_OK;
+}
+
+
+Slab*
+page_heap_allocate_span(uint32 count)
+{
+	mutex_lock(&sPageLock);
+
+	Segment* segment = sSegments;
+	int32 index = -1;
+	for (; segment != NULL; segment = segment->next) {
+		if (segment->free_slabs < count)
+			continue;
+
+		index = segment_find_free_run(segment, count);
+		if (index >= 0)
+			break;
+	}
+
+	if (segment == NULL) {
+		segment = segment_create();
+		if (segment == NULL) {
+			mutex_unlock(&sPageLock);
+			return NULL;
+		}
+		index = 1;
+	}
+
+	if (segment->free_slabs == kMaxSpanSlabs)
+		sEmptySegments--;
+	segment->free_slabs -= count;
+
+	for (uint32 i = index; i < index + count; i++) {
+		clear_bit(segment->free_map, i);
+		if (test_bit(segment->dirty_map, i)) {
+			clear_bit(segment->dirty_map, i);
+			sDirtySlabs--;
+		}
+		segment->slabs[i].first = index;
+	}
+
+	sSpanBytes += (size_t)count << kSlabShift;
+	sSpanCount++;
+
+	mutex_unlock(&sPageLock);
+
+	Slab* slab = &segment->slabs[index];
+	slab->next = slab->previous = NULL;
+	slab->free_list = NULL;
+	slab->unused = slab_address(slab);
+	slab->count = count;
+	slab->used = 0;
+	slab->capacity = 0;
+	slab->size_class = 0;
+	return slab;
+}
+
+
+void
+page_heap_free_span(Slab* slab)
+{
+	Segment* segment = segment_for(slab);
+	uint32 index = slab - segment->slabs;
+	uint32 count = slab->count;
+
+	mutex_lock(&sPageLock);
+
+	for (uint32 i = index; i < index + count; i++) {
+		set_bit(segment->free_map, i);
+		set_bit(segment->dirty_map, i);
+	}
+	segment->free_slabs += count;
+	sDirtySlabs += count;
+
+	sSpanBytes -= (size_t)count << kSlabShift;
+	sSpanCount--;
+
+	if (segment->free_slabs == kMaxSpanSlabs) {
+		if (sEmptySegments >= kMaxEmptySegments) {
+			// give the whole segment back
+			segment_delete(segment);
+			mutex_unlock(&sPageLock);
+			return;
+		}
+		sEmptySegments++;
+	}
+
+	if (sDirtySlabs > kMinDirtySlabs
+		&& sDirtySlabs > (sSpanBytes >> kSlabShift) / 4) {
+		purge_dirty_slabs();
+	}
+
+	mutex_unlock(&sPageLock);
+}
+
+
+void*
+page_heap_allocate_huge(size_t size, size_t alignment)
+{
+	// The allocation has to start within kSegmentSize bytes of the region
+	// start, see segment_for().
+	size_t offset = kSlabSize;
+	size_t regionAlignment = kSegmentSize;
+	size_t regionOffset = 0;
+	if (alignment > kSlabSize) {
+		if (alignment <= kSegmentSize)
+			offset = alignment;
+		else {
+			offset = kSegmentSize;
+			regionAlignment = alignment;
+			regionOffset = kSegmentSize;
+		}
+	}
+
+	if (size > ~(size_t)0 / 2 - offset)
+		return NULL;
+
+	size_t regionSize = (offset + size + kSegmentSize - 1)
+		& ~(kSegmentSize - 1);
+
+	mutex_lock(&sPageLock);
+	addr_t base = region_allocate(regionSize, regionAlignment, regionOffset);
+	if (base != 0)
+		sRegionBytes += regionSize;
+	mutex_unlock(&sPageLock);
+
+	if (base == 0)
+		return NULL;
+
+	Segment* segment = (Segment*)base;
+	segment->size = regionSize;
+	segment->huge = true;
+	return (void*)(base + offset);
+}
+
+
+void
+page_heap_free_huge(Segment* segment)
+{
+	mutex_lock(&sPageLock);
+	sRegionBytes -= segment->size;
+	region_free((addr_t)segment, segment->size);
+	mutex_unlock(&sPageLock);
+}
+
+
+void
+page_heap_lock()
+{
+	mutex_lock(&sPageLock);
+}
+
+
+void
+page_heap_unlock()
+{
+	mutex_unlock(&sPageLock);
+}
+
+
+void
+page_heap_reinit_after_fork()
+{
+	mutex_init(&sPageLock, "heap pages");
+}
+
+
+void
+page_heap_get_stats(size_t& regionBytes, size_t& spanBytes, uint32& spanCount)
+{
+	regionBytes = sRegionBytes;
+	spanBytes = sSpanBytes;
+	spanCount = sSpanCount;
+}
+
+
+}	// namespace TCache
+}	// namespace BPrivate
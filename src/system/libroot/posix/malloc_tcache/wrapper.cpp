@@ -0,0 +1,697 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	A thread-caching allocator.
+
+	Small allocations are rounded up to one of kClassCount size classes. Each
+	thread keeps a list of free objects per size class, so most malloc() and
+	free() calls don't need any locking. Those lists are refilled from and
+	flushed back to the central lists of the size class in batches.
+	The central lists hand out objects from spans of slabs that are managed
+	by the page heap, which returns the memory of free slabs to the system.
+*/
+
+
+#include "heap_private.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <TLS.h>
+
+#include <errno_private.h>
+#include <libroot_private.h>
+#include <locks.h>
+#include <user_thread.h>
+
+
+using namespace BPrivate::TCache;
+
+
+static const size_t kMaxSmallSize = 32 * 1024;
+static const uint32 kClassCount = 41;
+	// class 0 is not used, 1 - 8 are spaced 16 bytes apart, the others have
+	// four classes per power of two
+
+static const size_t kThreadCacheClassBytes = 32 * 1024;
+static const size_t kMaxThreadCacheSize = 512 * 1024;
+
+
+struct SizeClass {
+	mutex		lock;
+	Slab*		partial;
+		// spans that still have free objects
+	uint32		size;
+	uint16		slabs_per_span;
+	uint16		objects_per_span;
+	uint32		cache_limit;
+	uint32		batch_size;
+};
+
+
+struct FreeList {
+	void*		head;
+	uint32		count;
+};
+
+
+struct ThreadCache {
+	size_t		size;
+	FreeList	lists[kClassCount];
+};
+
+
+static SizeClass sSizeClasses[kClassCount];
+static bool sSizeClassesInitialized = false;
+static int32 sThreadCacheSlot = -1;
+
+
+static inline uint32
+size_to_class(size_t size)
+{
+	if (size <= 128)
+		return size == 0 ? 1 : (size + 15) >> 4;
+
+	uint32 log = 31 - __builtin_clz((uint32)(size - 1));
+	uint32 step = 1 << (log - 2);
+	return 9 + (log - 7) * 4 + (size - 1 - (1 << log)) / step;
+}
+
+
+static inline uint32
+class_size(uint32 sizeClass)
+{
+	if (sizeClass <= 8)
+		return sizeClass * 16;
+
+	uint32 index = sizeClass - 9;
+	uint32 log = 7 + index / 4;
+	return (1 << log) + (index % 4 + 1) * (1 << (log - 2));
+}
+
+
+static void
+init_size_classes()
+{
+	for (uint32 i = 1; i < kClassCount; i++) {
+		SizeClass& sizeClass = sSizeClasses[i];
+		mutex_init_etc(&sizeClass.lock, "heap size class",
+			MUTEX_FLAG_ADAPTIVE);
+		sizeClass.partial = NULL;
+		sizeClass.size = class_size(i);
+
+		// use as few slabs per span as possible without wasting more than
+		// an eighth of them
+		uint32 slabs = 1;
+		while (slabs < 8 && ((slabs * kSlabSize) % sizeClass.size) * 8
+				> slabs * kSlabSize) {
+			slabs++;
+		}
+		sizeClass.slabs_per_span = slabs;
+		sizeClass.objects_per_span = slabs * kSlabSize / sizeClass.size;
+
+		uint32 limit = kThreadCacheClassBytes / sizeClass.size;
+		if (limit < 2)
+			limit = 2;
+		else if (limit > 256)
+			limit = 256;
+		sizeClass.cache_limit = limit;
+		sizeClass.batch_size = limit / 2;
+	}
+
+	sSizeClassesInitialized = true;
+}
+
+
+//	#pragma mark - central lists
+
+
+static inline void
+add_partial(SizeClass& sizeClass, Slab* slab)
+{
+	slab->previous = NULL;
+	slab->next = sizeClass.partial;
+	if (sizeClass.partial != NULL)
+		sizeClass.partial->previous = slab;
+	sizeClass.partial = slab;
+}
+
+
+static inline void
+remove_partial(SizeClass& sizeClass, Slab* slab)
+{
+	if (slab->previous != NULL)
+		slab->previous->next = slab->next;
+	else
+		sizeClass.partial = slab->next;
+	if (slab->next != NULL)
+		slab->next->previous = slab->previous;
+	slab->next = slab->previous = NULL;
+}
+
+
+/*!	Allocates up to \a count objects of the given size class, and returns
+	them as a NULL terminated list.
+*/
+static uint32
+central_allocate(uint32 index, uint32 count, void** _list)
+{
+	if (!sSizeClassesInitialized)
+		init_size_classes();
+
+	SizeClass& sizeClass = sSizeClasses[index];
+	void* list = NULL;
+	uint32 allocated = 0;
+
+	mutex_lock(&sizeClass.lock);
+
+	while (allocated < count) {
+		Slab* slab = sizeClass.partial;
+		if (slab == NULL) {
+			slab = page_heap_allocate_span(sizeClass.slabs_per_span);
+			if (slab == NULL)
+				break;
+
+			slab->size_class = index;
+			slab->capacity = sizeClass.objects_per_span;
+			add_partial(sizeClass, slab);
+		}
+
+		while (allocated < count && slab->used < slab->capacity) {
+			void* object = slab->free_list;
+			if (object != NULL)
+				slab->free_list = *(void**)object;
+			else {
+				// carve a new object out of the untouched part of the span
+				object = (void*)slab->unused;
+				slab->unused += sizeClass.size;
+			}
+
+			*(void**)object = list;
+			list = object;
+			slab->used++;
+			allocated++;
+		}
+
+		if (slab->used == slab->capacity)
+			remove_partial(sizeClass, slab);
+	}
+
+	mutex_unlock(&sizeClass.lock);
+
+	*_list = list;
+	return allocated;
+}
+
+
+/*!	Returns a NULL terminated list of objects of the given size class to
+	their spans.
+*/
+static void
+central_free(uint32 index, void* list)
+{
+	SizeClass& sizeClass = sSizeClasses[index];
+
+	mutex_lock(&sizeClass.lock);
+
+	while (list != NULL) {
+		void* object = list;
+		list = *(void**)object;
+
+		Slab* slab = slab_for(segment_for(object), object);
+		if (slab->used == slab->capacity)
+			add_partial(sizeClass, slab);
+
+		*(void**)object = slab->free_list;
+		slab->free_list = object;
+
+		if (--slab->used == 0
+			&& (sizeClass.partial != slab || slab->next != NULL)) {
+			// The span is empty and not the only one left, give it back.
+			remove_partial(sizeClass, slab);
+			page_heap_free_span(slab);
+		}
+	}
+
+	mutex_unlock(&sizeClass.lock);
+}
+
+
+//	#pragma mark - thread caches
+
+
+static ThreadCache*
+create_thread_cache()
+{
+	void* cache;
+	if (central_allocate(size_to_class(sizeof(ThreadCache)), 1, &cache) == 0)
+		return NULL;
+
+	memset(cache, 0, sizeof(ThreadCache));
+	tls_set(sThreadCacheSlot, cache);
+	return (ThreadCache*)cache;
+}
+
+
+static inline ThreadCache*
+get_thread_cache()
+{
+	if (sThreadCacheSlot < 0)
+		return NULL;
+
+	ThreadCache* cache = (ThreadCache*)tls_get(sThreadCacheSlot);
+	if (cache == NULL)
+		cache = create_thread_cache();
+	return cache;
+}
+
+
+static void
+flush_thread_cache_list(ThreadCache* cache, uint32 index, uint32 count)
+{
+	FreeList& freeList = cache->lists[index];
+	if (count > freeList.count)
+		count = freeList.count;
+	if (count == 0)
+		return;
+
+	void* list = freeList.head;
+	void* last = list;
+	for (uint32 i = 1; i < count; i++)
+		last = *(void**)last;
+
+	freeList.head = *(void**)last;
+	freeList.count -= count;
+	cache->size -= count * sSizeClasses[index].size;
+
+	*(void**)last = NULL;
+	central_free(index, list);
+}
+
+
+static void
+scavenge_thread_cache(ThreadCache* cache)
+{
+	for (uint32 i = 1; i < kClassCount; i++)
+		flush_thread_cache_list(cache, i, (cache->lists[i].count + 1) / 2);
+}
+
+
+static void
+delete_thread_cache(ThreadCache* cache)
+{
+	for (uint32 i = 1; i < kClassCount; i++)
+		flush_thread_cache_list(cache, i, cache->lists[i].count);
+
+	tls_set(sThreadCacheSlot, NULL);
+
+	*(void**)cache = NULL;
+	central_free(size_to_class(sizeof(ThreadCache)), cache);
+}
+
+
+//	#pragma mark - allocation
+
+
+static void*
+allocate_small(uint32 index)
+{
+	ThreadCache* cache = get_thread_cache();
+	if (cache == NULL) {
+		void* object;
+		if (central_allocate(index, 1, &object) == 0)
+			return NULL;
+		return object;
+	}
+
+	FreeList& freeList = cache->lists[index];
+	if (freeList.head == NULL) {
+		freeList.count = central_allocate(index, sSizeClasses[index].batch_size,
+			&freeList.head);
+		if (freeList.count == 0)
+			return NULL;
+		cache->size += freeList.count * sSizeClasses[index].size;
+	}
+
+	void* object = freeList.head;
+	freeList.head = *(void**)object;
+	freeList.count--;
+	cache->size -= sSizeClasses[index].size;
+	return object;
+}
+
+
+static void*
+allocate_large(size_t size, size_t alignment)
+{
+	if (alignment < kSlabSize)
+		alignment = kSlabSize;
+
+	size_t spanSize = size + alignment - kSlabSize;
+	if (spanSize < size || spanSize > (size_t)kMaxSpanSlabs * kSlabSize)
+		return page_heap_allocate_huge(size, alignment);
+
+	Slab* slab = page_heap_allocate_span(
+		(spanSize + kSlabSize - 1) >> kSlabShift);
+	if (slab == NULL)
+		return NULL;
+
+	return (void*)((slab_address(slab) + alignment - 1) & ~(alignment - 1));
+}
+
+
+static void*
+allocate(size_t size)
+{
+	if (size > kMaxSmallSize)
+		return allocate_large(size, kSlabSize);
+
+	return allocate_small(size_to_class(size));
+}
+
+
+static void*
+allocate_aligned(size_t alignment, size_t size)
+{
+	if (alignment <= kAlignment)
+		return allocate(size);
+
+	if (size <= kMaxSmallSize && alignment <= kSlabSize) {
+		// Spans start slab aligned, so all objects of a size class whose
+		// size is a multiple of the alignment are aligned, too. There is
+		// such a class for every power of two.
+		size_t alignedSize = (size + alignment - 1) & ~(alignment - 1);
+		if (alignedSize == 0)
+			alignedSize = alignment;
+
+		for (uint32 i = size_to_class(alignedSize); i < kClassCount; i++) {
+			if (class_size(i) % alignment == 0)
+				return allocate_small(i);
+		}
+	}
+
+	return allocate_large(size, alignment);
+}
+
+
+static void
+deallocate(void* address)
+{
+	Segment* segment = segment_for(address);
+	if (segment->huge) {
+		page_heap_free_huge(segment);
+		return;
+	}
+
+	Slab* slab = slab_for(segment, address);
+	uint32 index = slab->size_class;
+	if (index == 0) {
+		page_heap_free_span(slab);
+		return;
+	}
+
+	ThreadCache* cache = get_thread_cache();
+	if (cache == NULL) {
+		*(void**)address = NULL;
+		central_free(index, address);
+		return;
+	}
+
+	FreeList& freeList = cache->lists[index];
+	*(void**)address = freeList.head;
+	freeList.head = address;
+	freeList.count++;
+	cache->size += sSizeClasses[index].size;
+
+	if (freeList.count > sSizeClasses[index].cache_limit)
+		flush_thread_cache_list(cache, index, sSizeClasses[index].batch_size);
+	if (cache->size > kMaxThreadCacheSize)
+		scavenge_thread_cache(cache);
+}
+
+
+static size_t
+usable_size(void* address)
+{
+	Segment* segment = segment_for(address);
+	if (segment->huge)
+		return (addr_t)segment + segment->size - (addr_t)address;
+
+	Slab* slab = slab_for(segment, address);
+	if (slab->size_class == 0) {
+		return slab_address(slab) + ((size_t)slab->count << kSlabShift)
+			- (addr_t)address;
+	}
+
+	return sSizeClasses[slab->size_class].size;
+}
+
+
+//	#pragma mark - libroot hooks
+
+
+extern "C" status_t
+__init_heap(void)
+{
+	if (!sSizeClassesInitialized)
+		init_size_classes();
+
+	status_t status = page_heap_init();
+	if (status != B_OK)
+		return status;
+
+	sThreadCacheSlot = tls_allocate();
+	return B_OK;
+}
+
+
+extern "C" void
+__heap_terminate_after()
+{
+}
+
+
+extern "C" void
+__heap_before_fork(void)
+{
+	for (uint32 i = 1; i < kClassCount; i++)
+		mutex_lock(&sSizeClasses[i].lock);
+	page_heap_lock();
+}
+
+
+extern "C" void
+__heap_after_fork_child(void)
+{
+	// Only the calling thread survives; the caches of all other threads are
+	// lost together with the objects in them.
+	for (uint32 i = 1; i < kClassCount; i++)
+		mutex_init_etc(&sSizeClasses[i].lock, "heap size class",
+			MUTEX_FLAG_ADAPTIVE);
+	page_heap_reinit_after_fork();
+}
+
+
+extern "C" void
+__heap_after_fork_parent(void)
+{
+	page_heap_unlock();
+	for (uint32 i = 1; i < kClassCount; i++)
+		mutex_unlock(&sSizeClasses[i].lock);
+}
+
+
+extern "C" void
+__heap_thread_init(void)
+{
+	// the cache is created on first use
+}
+
+
+extern "C" void
+__heap_thread_exit(void)
+{
+	if (sThreadCacheSlot < 0)
+		return;
+
+	defer_signals();
+
+	ThreadCache* cache = (ThreadCache*)tls_get(sThreadCacheSlot);
+	if (cache != NULL)
+		delete_thread_cache(cache);
+
+	undefer_signals();
+}
+
+
+//	#pragma mark - public functions
+
+
+extern "C" void*
+malloc(size_t size)
+{
+	defer_signals();
+	void* address = allocate(size);
+	undefer_signals();
+
+	if (address == NULL)
+		__set_errno(B_NO_MEMORY);
+	return address;
+}
+
+
+extern "C" void*
+calloc(size_t elementCount, size_t elementSize)
+{
+	size_t size = elementCount * elementSize;
+	if (elementCount != 0 && size / elementCount != elementSize) {
+		__set_errno(B_NO_MEMORY);
+		return NULL;
+	}
+
+	void* address = malloc(size);
+	if (address != NULL)
+		memset(address, 0, size);
+	return address;
+}
+
+
+extern "C" void
+free(void* address)
+{
+	if (address == NULL)
+		return;
+
+	defer_signals();
+	deallocate(address);
+	undefer_signals();
+}
+
+
+extern "C" void*
+memalign(size_t alignment, size_t size)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		__set_errno(B_BAD_VALUE);
+		return NULL;
+	}
+
+	defer_signals();
+	void* address = allocate_aligned(alignment, size);
+	undefer_signals();
+
+	if (address == NULL)
+		__set_errno(B_NO_MEMORY);
+	return address;
+}
+
+
+extern "C" void*
+aligned_alloc(size_t alignment, size_t size)
+{
+	if (alignment == 0 || size % alignment != 0) {
+		__set_errno(B_BAD_VALUE);
+		return NULL;
+	}
+	return memalign(alignment, size);
+}
+
+
+extern "C" int
+posix_memalign(void** _pointer, size_t alignment, size_t size)
+{
+	if ((alignment & (sizeof(void*) - 1)) != 0
+		|| (alignment & (alignment - 1)) != 0 || _pointer == NULL)
+		return B_BAD_VALUE;
+
+	defer_signals();
+	void* pointer = allocate_aligned(alignment, size);
+	undefer_signals();
+
+	if (pointer == NULL)
+		return B_NO_MEMORY;
+
+	*_pointer = pointer;
+	return 0;
+}
+
+
+extern "C" void*
+valloc(size_t size)
+{
+	return memalign(B_PAGE_SIZE, size);
+}
+
+
+extern "C" void*
+realloc(void* address, size_t size)
+{
+	if (address == NULL)
+		return malloc(size);
+
+	if (size == 0) {
+		free(address);
+		return NULL;
+	}
+
+	// keep the allocation if it is large enough, but don't waste more than
+	// half of a large one
+	size_t oldSize = usable_size(address);
+	if (size <= oldSize && (oldSize <= kMaxSmallSize || size >= oldSize / 2))
+		return address;
+
+	void* newAddress = malloc(size);
+	if (newAddress == NULL)
+		return NULL;
+
+	memcpy(newAddress, address, oldSize < size ? oldSize : size);
+	free(address);
+	return newAddress;
+}
+
+
+extern "C" size_t
+malloc_usable_size(void* address)
+{
+	if (address == NULL)
+		return 0;
+	return usable_size(address);
+}
+
+
+//	#pragma mark - BeOS specific extensions
+
+
+struct mstats {
+	size_t bytes_total;
+	size_t chunks_used;
+	size_t bytes_used;
+	size_t chunks_free;
+	size_t bytes_free;
+};
+
+
+extern "C" struct mstats mstats(void);
+
+extern "C" struct mstats
+mstats(void)
+{
+	// Objects that are cached by threads or free within a span are counted
+	// as used, like spans in the hoard allocator.
+	static struct mstats stats;
+
+	size_t regionBytes, spanBytes;
+	uint32 spanCount;
+	page_heap_get_stats(regionBytes, spanBytes, spanCount);
+
+	stats.bytes_total = regionBytes;
+	stats.chunks_used = spanCount;
+	stats.bytes_used = spanBytes;
+	stats.chunks_free = 0;
+	stats.bytes_free = regionBytes - spanBytes;
+
+	return stats;
+}
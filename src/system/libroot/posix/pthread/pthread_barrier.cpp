@@ -18,12 +18,30 @@
 
 #define BARRIER_FLAG_SHARED	0x80000000
 
+#define BARRIER_PHASE		0x80000000
+#define BARRIER_COUNT_MASK	0x7fffffff
+
+
+/*!	Arriving threads only increment the waiter count. Waiting is done on one
+	of two user mutexes, the "lock" for even and the "mutex" for odd phases,
+	which the last thread to arrive opens by setting B_USER_MUTEX_DISABLED.
+	The other one is closed again before, so that the threads of the next
+	phase can't run through.
+*/
+
 
 static const pthread_barrierattr pthread_barrierattr_default = {
 	/* .process_shared = */ false
 };
 
 
+static inline int32*
+barrier_gate(pthread_barrier_t* barrier, int32 phase)
+{
+	return phase == 0 ? (int32*)&barrier->lock : (int32*)&barrier->mutex;
+}
+
+
 int
 pthread_barrier_init(pthread_barrier_t* barrier,
 	const pthread_barrierattr_t* _attr, unsigned count)
@@ -31,12 +49,14 @@ pthread_barrier_init(pthread_barrier_t* barrier,
 	const pthread_barrierattr* attr = _attr != NULL
 		? *_attr : &pthread_barrierattr_default;
 
-	if (barrier == NULL || attr == NULL || count < 1)
+	if (barrier == NULL || attr == NULL || count < 1
+		|| count > BARRIER_COUNT_MASK) {
 		return B_BAD_VALUE;
+	}
 
 	barrier->flags = attr->process_shared ? BARRIER_FLAG_SHARED : 0;
-	barrier->lock = 0;
-	barrier->mutex = 0;
+	barrier->lock = B_USER_MUTEX_LOCKED;
+	barrier->mutex = B_USER_MUTEX_LOCKED;
 	barrier->waiter_count = 0;
 	barrier->waiter_max = count;
 
@@ -50,46 +70,36 @@ pthread_barrier_wait(pthread_barrier_t* barrier)
 	if (barrier == NULL)
 		return B_BAD_VALUE;
 
-	// Enter critical region: lock the mutex
-	int32 status = atomic_or((int32*)&barrier->mutex, B_USER_MUTEX_LOCKED);
-
-	// If already locked, call the kernel
-	if (status & (B_USER_MUTEX_LOCKED | B_USER_MUTEX_WAITING)) {
-		do {
-			status = _kern_mutex_lock((int32*)&barrier->mutex, NULL, 0, 0);
-		} while (status == B_INTERRUPTED);
-
-		if (status != B_OK)
-			return status;
-	}
-
-	barrier->waiter_count++;
+	int32 value = atomic_add((int32*)&barrier->waiter_count, 1) + 1;
+	int32 phase = value & BARRIER_PHASE;
+	int32* gate = barrier_gate(barrier, phase);
 
 	// If this thread is the last to arrive
-	if (barrier->waiter_count == barrier->waiter_max) {
-		// Let other threads exit the do...while loop
-		barrier->waiter_count = 0;
-
-		// Wake up everyone trying to acquire the barrier lock
-		_kern_mutex_unlock((int32*)&barrier->lock, B_USER_MUTEX_UNBLOCK_ALL);
+	if ((value & BARRIER_COUNT_MASK) == barrier->waiter_max) {
+		// Close the gate for the next phase. All threads that have waited on
+		// it in the previous phase are gone, since they have arrived here.
+		int32 nextPhase = phase ^ BARRIER_PHASE;
+		atomic_set(barrier_gate(barrier, nextPhase), B_USER_MUTEX_LOCKED);
 
-		// Exit critical region: unlock the mutex
-		int32 status = atomic_and((int32*)&barrier->mutex,
-				~(int32)B_USER_MUTEX_LOCKED);
+		// No one else can touch the count until the gate is opened
+		atomic_set((int32*)&barrier->waiter_count, nextPhase);
 
-		if (status & B_USER_MUTEX_WAITING)
-			_kern_mutex_unlock((int32*)&barrier->mutex, 0);
+		// Open the gate, and wake up everyone who is already waiting
+		int32 oldValue = atomic_or(gate, B_USER_MUTEX_DISABLED);
+		if ((oldValue & B_USER_MUTEX_WAITING) != 0)
+			_kern_mutex_unlock(gate, B_USER_MUTEX_UNBLOCK_ALL);
 
 		// Inform the calling thread that it arrived last
 		return PTHREAD_BARRIER_SERIAL_THREAD;
 	}
 
-	do {
-		// Wait indefinitely trying to acquire the barrier lock.
-		// Other threads may now enter (mutex is unlocked).
-		_kern_mutex_switch_lock((int32*)&barrier->mutex,
-				(int32*)&barrier->lock, "barrier wait", 0, 0);
-	} while (barrier->waiter_count != 0);
+	// Wait until the gate has been opened. The kernel returns immediately
+	// once it is disabled.
+	while ((atomic_get(gate) & B_USER_MUTEX_DISABLED) == 0) {
+		status_t status = _kern_mutex_lock(gate, "barrier wait", 0, 0);
+		if (status != B_OK && status != B_INTERRUPTED)
+			return status;
+	}
 
 	// This thread did not arrive last
 	return 0;
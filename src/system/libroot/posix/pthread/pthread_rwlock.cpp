@@ -1,113 +1,60 @@
 /*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
  * Copyright 2008, Ingo Weinhold, ingo_weinhold@gmx.de.
  * Distributed under the terms of the MIT License.
  */
 
 #include <pthread.h>
 
-#include <new>
-
 #include <Debug.h>
 
 #include <AutoLocker.h>
 #include <syscalls.h>
 #include <user_mutex_defs.h>
-#include <user_thread.h>
-#include <util/DoublyLinkedList.h>
 
 #include "pthread_private.h"
 
 #define MAX_READER_COUNT	1000000
 
-#define RWLOCK_FLAG_SHARED	0x01
-
-
-struct Waiter : DoublyLinkedListLinkImpl<Waiter> {
-	Waiter(bool writer)
-		:
-		userThread(get_user_thread()),
-		thread(find_thread(NULL)),
-		writer(writer),
-		queued(false)
-	{
-	}
-
-	user_thread*	userThread;
-	thread_id		thread;
-	status_t		status;
-	bool			writer;
-	bool			queued;
-};
-
-typedef DoublyLinkedList<Waiter> WaiterList;
-
-
-struct SharedRWLock {
-	uint32_t	flags;
-	int32_t		owner;
-	int32_t		sem;
-
-	status_t Init()
-	{
-		flags = RWLOCK_FLAG_SHARED;
-		owner = -1;
-		sem = create_sem(MAX_READER_COUNT, "pthread rwlock");
-
-		return sem >= 0 ? B_OK : EAGAIN;
-	}
-
-	status_t Destroy()
-	{
-		if (sem < 0)
-			return B_BAD_VALUE;
-		return delete_sem(sem) == B_OK ? B_OK : B_BAD_VALUE;
-	}
-
-	status_t ReadLock(uint32 flags, bigtime_t timeout)
-	{
-		return acquire_sem_etc(sem, 1, flags, timeout);
-	}
-
-	status_t WriteLock(uint32 flags, bigtime_t timeout)
-	{
-		status_t error = acquire_sem_etc(sem, MAX_READER_COUNT,
-			flags, timeout);
-		if (error == B_OK)
-			owner = find_thread(NULL);
-		return error;
-	}
-
-	status_t Unlock()
-	{
-		if (find_thread(NULL) == owner) {
-			owner = -1;
-			return release_sem_etc(sem, MAX_READER_COUNT, 0);
-		} else
-			return release_sem(sem);
-	}
-};
-
-
-struct LocalRWLock {
+#define RWLOCK_FLAG_SHARED			0x01
+#define RWLOCK_FLAG_PREFER_READER	0x02
+
+// lock word
+#define RWLOCK_WRITE_LOCKED		((int32)0x80000000)
+#define RWLOCK_CONTENDED		0x40000000
+	// there are waiters, or a slow path operation is in progress
+#define RWLOCK_READER_MASK		0x3fffffff
+
+
+/*!	The lock state lives in a single word, so that uncontended read and
+	write locking and unlocking only need a single atomic operation.
+	As soon as a thread has to wait, it sets RWLOCK_CONTENDED, which forces
+	everyone into the slow path. That one is serialized by a user mutex, and
+	waiters block on one of two further user mutexes used as wait queues, in
+	the same way pthread_cond_wait() does.
+	Since the kernel identifies user mutexes by their physical address, this
+	works for process-shared locks as well.
+*/
+struct RWLock {
 	uint32_t	flags;
 	int32_t		owner;
 	int32_t		mutex;
-	int32_t		unused;
-	int32_t		reader_count;
-	int32_t		writer_count;
-		// Note, that reader_count and writer_count are not used the same way.
-		// writer_count includes the write lock owner as well as waiting
-		// writers. reader_count includes read lock owners only.
-	WaiterList	waiters;
-
-	status_t Init()
+	int32_t		state;
+	int32_t		read_queue;
+	int32_t		write_queue;
+	int32_t		waiting_readers;
+	int32_t		waiting_writers;
+
+	status_t Init(uint32 attrFlags)
 	{
-		flags = 0;
+		flags = attrFlags;
 		owner = -1;
 		mutex = 0;
-		reader_count = 0;
-		writer_count = 0;
-		new(&waiters) WaiterList;
+		state = 0;
+		read_queue = 0;
+		write_queue = 0;
+		waiting_readers = 0;
+		waiting_writers = 0;
 
 		return B_OK;
 	}
@@ -115,8 +62,10 @@ struct LocalRWLock {
 	status_t Destroy()
 	{
 		Locker locker(this);
-		if (reader_count > 0 || waiters.Head() != NULL || writer_count > 0)
+		if ((atomic_get((int32*)&state) & ~RWLOCK_CONTENDED) != 0
+			|| waiting_readers > 0 || waiting_writers > 0) {
 			return EBUSY;
+		}
 		return B_OK;
 	}
 
@@ -149,145 +98,220 @@ struct LocalRWLock {
 
 	status_t ReadLock(uint32 flags, bigtime_t timeout)
 	{
-		Locker locker(this);
-
-		if (writer_count == 0) {
-			reader_count++;
+		// Readers may only take the fast path if no one is waiting, unless
+		// they are preferred anyway.
+		int32 blockingState = RWLOCK_WRITE_LOCKED;
+		if (!_PrefersReaders())
+			blockingState |= RWLOCK_CONTENDED;
+
+		int32 oldState = atomic_get((int32*)&state);
+		if ((oldState & blockingState) == 0
+			&& (oldState & RWLOCK_READER_MASK) < MAX_READER_COUNT
+			&& atomic_test_and_set((int32*)&state, oldState + 1, oldState)
+				== oldState) {
 			return B_OK;
 		}
 
-		return _Wait(false, flags, timeout);
+		return _Lock(false, flags, timeout);
 	}
 
 	status_t WriteLock(uint32 flags, bigtime_t timeout)
 	{
-		Locker locker(this);
-
-		if (reader_count == 0 && writer_count == 0) {
-			writer_count++;
+		if (atomic_test_and_set((int32*)&state, RWLOCK_WRITE_LOCKED, 0) == 0) {
 			owner = find_thread(NULL);
 			return B_OK;
 		}
 
-		return _Wait(true, flags, timeout);
+		return _Lock(true, flags, timeout);
 	}
 
 	status_t Unlock()
 	{
-		Locker locker(this);
-
 		if (find_thread(NULL) == owner) {
-			writer_count--;
 			owner = -1;
-		} else
-			reader_count--;
+			if (atomic_test_and_set((int32*)&state, 0, RWLOCK_WRITE_LOCKED)
+					== RWLOCK_WRITE_LOCKED) {
+				return B_OK;
+			}
+			return _Unlock(true);
+		}
 
-		_Unblock();
+		int32 oldState = atomic_get((int32*)&state);
+		while ((oldState & RWLOCK_CONTENDED) == 0) {
+			if ((oldState & RWLOCK_READER_MASK) == 0)
+				return EPERM;
 
-		return B_OK;
+			int32 value = atomic_test_and_set((int32*)&state, oldState - 1,
+				oldState);
+			if (value == oldState)
+				return B_OK;
+			oldState = value;
+		}
+
+		return _Unlock(false);
 	}
 
 private:
-	status_t _Wait(bool writer, uint32 flags, bigtime_t timeout)
+	bool _PrefersReaders() const
 	{
-		if (timeout == 0)
-			return B_TIMED_OUT;
+		return (flags & RWLOCK_FLAG_PREFER_READER) != 0;
+	}
 
-		Waiter waiter(writer);
-		waiters.Add(&waiter);
-		waiter.queued = true;
-		waiter.userThread->wait_status = 1;
+	status_t _Lock(bool writer, uint32 flags, bigtime_t timeout)
+	{
+		Locker locker(this);
 
-		if (writer)
-			writer_count++;
+		while (true) {
+			status_t error = _TryLock(writer);
+			if (error != B_WOULD_BLOCK) {
+				_UpdateContended();
+				return error;
+			}
 
-		StructureUnlock();
-		status_t error = _kern_block_thread(flags, timeout);
-		StructureLock();
+			if (timeout == 0) {
+				_UpdateContended();
+				return B_TIMED_OUT;
+			}
 
-		if (!waiter.queued)
-			return waiter.status;
+			error = _Wait(writer, flags, timeout);
+			if (error != B_OK && error != B_INTERRUPTED) {
+				// We may have been the writer blocking the readers.
+				_Unblock(atomic_get((int32*)&state));
+				_UpdateContended();
+				return error;
+			}
+		}
+	}
+
+	/*!	Must be called with the structure lock held. */
+	status_t _TryLock(bool writer)
+	{
+		// With the flag set, the state can only change under the structure
+		// lock (or by readers entering a lock that prefers them), so no
+		// unlock can be missed.
+		int32 oldState = atomic_or((int32*)&state, RWLOCK_CONTENDED)
+			| RWLOCK_CONTENDED;
+
+		while (true) {
+			int32 newState;
+			if (writer) {
+				if ((oldState & (RWLOCK_WRITE_LOCKED | RWLOCK_READER_MASK))
+						!= 0) {
+					return B_WOULD_BLOCK;
+				}
+				newState = oldState | RWLOCK_WRITE_LOCKED;
+			} else {
+				if ((oldState & RWLOCK_WRITE_LOCKED) != 0
+					|| (waiting_writers > 0 && !_PrefersReaders())) {
+					return B_WOULD_BLOCK;
+				}
+				if ((oldState & RWLOCK_READER_MASK) >= MAX_READER_COUNT)
+					return EAGAIN;
+				newState = oldState + 1;
+			}
 
-		// we're still queued, which means an error (timeout, interrupt)
-		// occurred
-		waiters.Remove(&waiter);
+			int32 value = atomic_test_and_set((int32*)&state, newState,
+				oldState);
+			if (value == oldState)
+				break;
+			oldState = value;
+		}
 
 		if (writer)
-			writer_count--;
+			owner = find_thread(NULL);
+		return B_OK;
+	}
+
+	status_t _Unlock(bool writer)
+	{
+		Locker locker(this);
 
-		_Unblock();
+		int32 newState;
+		if (writer) {
+			newState = atomic_and((int32*)&state, ~RWLOCK_WRITE_LOCKED)
+				& ~RWLOCK_WRITE_LOCKED;
+		} else {
+			if ((atomic_get((int32*)&state) & RWLOCK_READER_MASK) == 0)
+				return EPERM;
+			newState = atomic_add((int32*)&state, -1) - 1;
+		}
 
-		return error;
+		_Unblock(newState);
+		_UpdateContended();
+		return B_OK;
 	}
 
-	void _Unblock()
+	/*!	Must be called with the structure lock held. Unlocks it while
+		waiting.
+	*/
+	status_t _Wait(bool writer, uint32 flags, bigtime_t timeout)
 	{
-		// Check whether there any waiting threads at all and whether anyone
-		// has the write lock
-		Waiter* waiter = waiters.Head();
-		if (waiter == NULL || owner >= 0)
-			return;
+		int32* queue = (int32*)(writer ? &write_queue : &read_queue);
+		int32_t& waiting = writer ? waiting_writers : waiting_readers;
 
-		// writer at head of queue?
-		if (waiter->writer) {
-			if (reader_count == 0) {
-				waiter->status = B_OK;
-				waiter->queued = false;
-				waiters.Remove(waiter);
-				owner = waiter->thread;
+		waiting++;
 
-				if (waiter->userThread->wait_status > 0)
-					_kern_unblock_thread(waiter->thread, B_OK);
-			}
+		// make sure the user mutex we use for blocking is locked
+		atomic_or(queue, B_USER_MUTEX_LOCKED);
+
+		// atomically unlock the structure and start waiting
+		status_t error = _kern_mutex_switch_lock((int32*)&mutex, queue,
+			writer ? "pthread rwlock write" : "pthread rwlock read", flags,
+			timeout);
+
+		StructureLock();
+		waiting--;
+
+		return error;
+	}
+
+	/*!	Wakes up the waiters that might be able to get the lock now.
+		Since the lock is not handed over, they will have to compete for it
+		again.
+	*/
+	void _Unblock(int32 state)
+	{
+		if ((state & RWLOCK_WRITE_LOCKED) != 0)
 			return;
-		}
 
-		// wake up one or more readers -- we unblock more than one reader at
-		// a time to save trips to the kernel
-		while (!waiters.IsEmpty() && !waiters.Head()->writer) {
-			static const int kMaxReaderUnblockCount = 128;
-			thread_id readers[kMaxReaderUnblockCount];
-			int readerCount = 0;
-
-			while (readerCount < kMaxReaderUnblockCount
-					&& (waiter = waiters.Head()) != NULL
-					&& !waiter->writer) {
-				waiter->status = B_OK;
-				waiter->queued = false;
-				waiters.Remove(waiter);
-
-				if (waiter->userThread->wait_status > 0) {
-					readers[readerCount++] = waiter->thread;
-					reader_count++;
-				}
-			}
+		bool wakeReaders = waiting_readers > 0
+			&& (waiting_writers == 0 || _PrefersReaders());
 
-			if (readerCount > 0)
-				_kern_unblock_threads(readers, readerCount, B_OK);
+		if (!wakeReaders && waiting_writers > 0
+			&& (state & RWLOCK_READER_MASK) == 0) {
+			_kern_mutex_unlock((int32*)&write_queue, 0);
+		} else if (wakeReaders) {
+			_kern_mutex_unlock((int32*)&read_queue,
+				B_USER_MUTEX_UNBLOCK_ALL);
 		}
 	}
 
+	void _UpdateContended()
+	{
+		if (waiting_readers == 0 && waiting_writers == 0)
+			atomic_and((int32*)&state, ~RWLOCK_CONTENDED);
+	}
+
 
 	struct Locking {
-		inline bool Lock(LocalRWLock* lockable)
+		inline bool Lock(RWLock* lockable)
 		{
 			return lockable->StructureLock();
 		}
 
-		inline void Unlock(LocalRWLock* lockable)
+		inline void Unlock(RWLock* lockable)
 		{
 			lockable->StructureUnlock();
 		}
 	};
-	typedef AutoLocker<LocalRWLock, Locking> Locker;
+	typedef AutoLocker<RWLock, Locking> Locker;
 };
 
 
 static void inline
 assert_dummy()
 {
-	STATIC_ASSERT(sizeof(pthread_rwlock_t) >= sizeof(SharedRWLock));
-	STATIC_ASSERT(sizeof(pthread_rwlock_t) >= sizeof(LocalRWLock));
+	STATIC_ASSERT(sizeof(pthread_rwlock_t) >= sizeof(RWLock));
 }
 
 
@@ -298,43 +322,30 @@ int
 pthread_rwlock_init(pthread_rwlock_t* lock, const pthread_rwlockattr_t* _attr)
 {
 	pthread_rwlockattr* attr = _attr != NULL ? *_attr : NULL;
-	bool shared = attr != NULL && (attr->flags & RWLOCK_FLAG_SHARED) != 0;
 
-	if (shared)
-		return ((SharedRWLock*)lock)->Init();
-	else
-		return ((LocalRWLock*)lock)->Init();
+	return ((RWLock*)lock)->Init(attr != NULL ? attr->flags : 0);
 }
 
 
 int
 pthread_rwlock_destroy(pthread_rwlock_t* lock)
 {
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		return ((SharedRWLock*)lock)->Destroy();
-	else
-		return ((LocalRWLock*)lock)->Destroy();
+	return ((RWLock*)lock)->Destroy();
 }
 
 
 int
 pthread_rwlock_rdlock(pthread_rwlock_t* lock)
 {
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		return ((SharedRWLock*)lock)->ReadLock(0, B_INFINITE_TIMEOUT);
-	else
-		return ((LocalRWLock*)lock)->ReadLock(0, B_INFINITE_TIMEOUT);
+	return ((RWLock*)lock)->ReadLock(0, B_INFINITE_TIMEOUT);
 }
 
 
 int
 pthread_rwlock_tryrdlock(pthread_rwlock_t* lock)
 {
-	status_t error;
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		error = ((SharedRWLock*)lock)->ReadLock(B_ABSOLUTE_REAL_TIME_TIMEOUT, 0);
-	else
-		error = ((LocalRWLock*)lock)->ReadLock(B_ABSOLUTE_REAL_TIME_TIMEOUT, 0);
+	status_t error = ((RWLock*)lock)->ReadLock(B_ABSOLUTE_REAL_TIME_TIMEOUT,
+		0);
 
 	return error == B_TIMED_OUT ? EBUSY : error;
 }
@@ -360,11 +371,7 @@ pthread_rwlock_clockrdlock(pthread_rwlock_t* lock, clockid_t clock_id,
 		}
 	}
 
-	status_t error;
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		error = ((SharedRWLock*)lock)->ReadLock(flags, timeout);
-	else
-		error = ((LocalRWLock*)lock)->ReadLock(flags, timeout);
+	status_t error = ((RWLock*)lock)->ReadLock(flags, timeout);
 
 	return error == B_TIMED_OUT ? EBUSY : error;
 }
@@ -381,21 +388,15 @@ pthread_rwlock_timedrdlock(pthread_rwlock_t* lock,
 int
 pthread_rwlock_wrlock(pthread_rwlock_t* lock)
 {
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		return ((SharedRWLock*)lock)->WriteLock(0, B_INFINITE_TIMEOUT);
-	else
-		return ((LocalRWLock*)lock)->WriteLock(0, B_INFINITE_TIMEOUT);
+	return ((RWLock*)lock)->WriteLock(0, B_INFINITE_TIMEOUT);
 }
 
 
 int
 pthread_rwlock_trywrlock(pthread_rwlock_t* lock)
 {
-	status_t error;
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		error = ((SharedRWLock*)lock)->WriteLock(B_ABSOLUTE_REAL_TIME_TIMEOUT, 0);
-	else
-		error = ((LocalRWLock*)lock)->WriteLock(B_ABSOLUTE_REAL_TIME_TIMEOUT, 0);
+	status_t error = ((RWLock*)lock)->WriteLock(B_ABSOLUTE_REAL_TIME_TIMEOUT,
+		0);
 
 	return error == B_TIMED_OUT ? EBUSY : error;
 }
@@ -421,11 +422,7 @@ pthread_rwlock_clockwrlock (pthread_rwlock_t* lock, clockid_t clock_id,
 		}
 	}
 
-	status_t error;
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		error = ((SharedRWLock*)lock)->WriteLock(flags, timeout);
-	else
-		error = ((LocalRWLock*)lock)->WriteLock(flags, timeout);
+	status_t error = ((RWLock*)lock)->WriteLock(flags, timeout);
 
 	return error == B_TIMED_OUT ? EBUSY : error;
 }
@@ -442,10 +439,7 @@ pthread_rwlock_timedwrlock(pthread_rwlock_t* lock,
 int
 pthread_rwlock_unlock(pthread_rwlock_t* lock)
 {
-	if ((lock->flags & RWLOCK_FLAG_SHARED) != 0)
-		return ((SharedRWLock*)lock)->Unlock();
-	else
-		return ((LocalRWLock*)lock)->Unlock();
+	return ((RWLock*)lock)->Unlock();
 }
 
 
@@ -501,3 +495,41 @@ pthread_rwlockattr_setpshared(pthread_rwlockattr_t* _attr, int shared)
 	return 0;
 }
 
+
+int
+__pthread_rwlockattr_getkind_np(const pthread_rwlockattr_t* _attr, int* kind)
+{
+	pthread_rwlockattr* attr = *_attr;
+
+	*kind = (attr->flags & RWLOCK_FLAG_PREFER_READER) != 0
+		? PTHREAD_RWLOCK_PREFER_READER_NP
+		: PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP;
+	return 0;
+}
+
+
+int
+__pthread_rwlockattr_setkind_np(pthread_rwlockattr_t* _attr, int kind)
+{
+	pthread_rwlockattr* attr = *_attr;
+
+	switch (kind) {
+		case PTHREAD_RWLOCK_PREFER_READER_NP:
+			attr->flags |= RWLOCK_FLAG_PREFER_READER;
+			break;
+		case PTHREAD_RWLOCK_PREFER_WRITER_NP:
+		case PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP:
+			attr->flags &= ~RWLOCK_FLAG_PREFER_READER;
+			break;
+		default:
+			return EINVAL;
+	}
+
+	return 0;
+}
+
+
+B_DEFINE_WEAK_ALIAS(__pthread_rwlockattr_getkind_np,
+	pthread_rwlockattr_getkind_np);
+B_DEFINE_WEAK_ALIAS(__pthread_rwlockattr_setkind_np,
+	pthread_rwlockattr_setkind_np);
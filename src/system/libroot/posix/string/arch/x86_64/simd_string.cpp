@@ -0,0 +1,274 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <string.h>
+#include <strings.h>
+
+#include <cpuid.h>
+#include <emmintrin.h>
+
+#include "simd_string.h"
+
+
+namespace {
+
+
+struct SSE2Vector {
+	typedef __m128i Type;
+
+	static const size_t kSize = 16;
+	static const uint32_t kAllMask = 0xffff;
+
+	static inline Type Load(const void* address)
+	{
+		return _mm_load_si128((const __m128i*)address);
+	}
+
+	static inline Type LoadUnaligned(const void* address)
+	{
+		return _mm_loadu_si128((const __m128i*)address);
+	}
+
+	static inline Type Broadcast(char c)
+	{
+		return _mm_set1_epi8(c);
+	}
+
+	static inline Type Zero()
+	{
+		return _mm_setzero_si128();
+	}
+
+	static inline uint32_t Equal(Type a, Type b)
+	{
+		return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+	}
+};
+
+
+}	// namespace
+
+
+size_t
+strlen_sse2(const char* string)
+{
+	return simd_strlen<SSE2Vector>(string);
+}
+
+
+size_t
+strnlen_sse2(const char* string, size_t count)
+{
+	return simd_strnlen<SSE2Vector>(string, count);
+}
+
+
+void*
+memchr_sse2(const void* buffer, int c, size_t count)
+{
+	return simd_memchr<SSE2Vector>(buffer, c, count);
+}
+
+
+char*
+strchr_sse2(const char* string, int c)
+{
+	return simd_strchr<SSE2Vector>(string, c);
+}
+
+
+int
+memcmp_sse2(const void* a, const void* b, size_t count)
+{
+	return simd_memcmp<SSE2Vector>(a, b, count);
+}
+
+
+int
+strcmp_sse2(const char* a, const char* b)
+{
+	return simd_strcmp<SSE2Vector>(a, b);
+}
+
+
+//	#pragma mark - dispatching
+
+
+namespace {
+
+
+typedef size_t (*strlen_function)(const char*);
+typedef size_t (*strnlen_function)(const char*, size_t);
+typedef void* (*memchr_function)(const void*, int, size_t);
+typedef char* (*strchr_function)(const char*, int);
+typedef int (*memcmp_function)(const void*, const void*, size_t);
+typedef int (*strcmp_function)(const char*, const char*);
+
+
+size_t strlen_select(const char* string);
+size_t strnlen_select(const char* string, size_t count);
+void* memchr_select(const void* buffer, int c, size_t count);
+char* strchr_select(const char* string, int c);
+int memcmp_select(const void* a, const void* b, size_t count);
+int strcmp_select(const char* a, const char* b);
+
+
+// Like an ifunc, each function pointer initially points to a function that
+// selects the implementation best suited for the CPU on its first use.
+strlen_function sStrlen = strlen_select;
+strnlen_function sStrnlen = strnlen_select;
+memchr_function sMemchr = memchr_select;
+strchr_function sStrchr = strchr_select;
+memcmp_function sMemcmp = memcmp_select;
+strcmp_function sStrcmp = strcmp_select;
+
+
+bool
+cpu_supports_avx2()
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+
+	// The kernel has to save the YMM registers as well
+	__cpuid(1, eax, ebx, ecx, edx);
+	if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0)
+		return false;
+
+	uint32_t xcr0Low, xcr0High;
+	__asm__ __volatile__("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+	if ((xcr0Low & 0x6) != 0x6)
+		return false;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & bit_AVX2) != 0;
+}
+
+
+void
+select_string_functions()
+{
+	// Several threads may get here at the same time, but they will all
+	// come to the same conclusion.
+	if (cpu_supports_avx2()) {
+		sStrlen = strlen_avx2;
+		sStrnlen = strnlen_avx2;
+		sMemchr = memchr_avx2;
+		sStrchr = strchr_avx2;
+		sMemcmp = memcmp_avx2;
+		sStrcmp = strcmp_avx2;
+	} else {
+		sStrlen = strlen_sse2;
+		sStrnlen = strnlen_sse2;
+		sMemchr = memchr_sse2;
+		sStrchr = strchr_sse2;
+		sMemcmp = memcmp_sse2;
+		sStrcmp = strcmp_sse2;
+	}
+}
+
+
+size_t
+strlen_select(const char* string)
+{
+	select_string_functions();
+	return sStrlen(string);
+}
+
+
+size_t
+strnlen_select(const char* string, size_t count)
+{
+	select_string_functions();
+	return sStrnlen(string, count);
+}
+
+
+void*
+memchr_select(const void* buffer, int c, size_t count)
+{
+	select_string_functions();
+	return sMemchr(buffer, c, count);
+}
+
+
+char*
+strchr_select(const char* string, int c)
+{
+	select_string_functions();
+	return sStrchr(string, c);
+}
+
+
+int
+memcmp_select(const void* a, const void* b, size_t count)
+{
+	select_string_functions();
+	return sMemcmp(a, b, count);
+}
+
+
+int
+strcmp_select(const char* a, const char* b)
+{
+	select_string_functions();
+	return sStrcmp(a, b);
+}
+
+
+}	// namespace
+
+
+//	#pragma mark - public API
+
+
+extern "C" size_t
+strlen(const char* string)
+{
+	return sStrlen(string);
+}
+
+
+extern "C" size_t
+strnlen(const char* string, size_t count)
+{
+	return sStrnlen(string, count);
+}
+
+
+extern "C" void*
+memchr(const void* buffer, int c, size_t count)
+{
+	return sMemchr(buffer, c, count);
+}
+
+
+extern "C" char*
+strchr(const char* string, int c)
+{
+	return sStrchr(string, c);
+}
+
+
+extern "C" char*
+index(const char* string, int c)
+{
+	return sStrchr(string, c);
+}
+
+
+extern "C" int
+memcmp(const void* a, const void* b, size_t count)
+{
+	return sMemcmp(a, b, count);
+}
+
+
+extern "C" int
+strcmp(const char* a, const char* b)
+{
+	return sStrcmp(a, b);
+}
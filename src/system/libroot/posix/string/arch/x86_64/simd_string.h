@@ -0,0 +1,226 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SIMD_STRING_H
+#define SIMD_STRING_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*!	The string functions are implemented once for a generic vector type, and
+	instantiated for SSE2 and AVX2. A vector type \c V has to provide:
+	- \c Type and \c kSize, the register type and its size in bytes,
+	- \c kAllMask, the mask returned by Equal() if all bytes compared equal,
+	- Load() (aligned), LoadUnaligned(), Broadcast() and Zero(),
+	- Equal(), which returns a bit mask with one bit per matching byte.
+
+	Aligned loads never cross a page boundary, so the string functions may
+	read past the end of a string as long as they start at an aligned address
+	at or before it.
+*/
+
+
+#define SIMD_PAGE_SIZE	4096
+
+
+template<typename V>
+static inline size_t
+simd_strlen(const char* string)
+{
+	const typename V::Type zero = V::Zero();
+	size_t offset = (uintptr_t)string & (V::kSize - 1);
+	const char* block = string - offset;
+
+	uint32_t mask = V::Equal(V::Load(block), zero) >> offset;
+	if (mask != 0)
+		return __builtin_ctz(mask);
+
+	while (true) {
+		block += V::kSize;
+		mask = V::Equal(V::Load(block), zero);
+		if (mask != 0)
+			return block - string + __builtin_ctz(mask);
+	}
+}
+
+
+template<typename V>
+static inline size_t
+simd_strnlen(const char* string, size_t count)
+{
+	if (count == 0)
+		return 0;
+
+	const typename V::Type zero = V::Zero();
+	size_t offset = (uintptr_t)string & (V::kSize - 1);
+	const char* block = string - offset;
+
+	uint32_t mask = V::Equal(V::Load(block), zero) >> offset;
+	size_t length = V::kSize - offset;
+	if (mask != 0)
+		length = __builtin_ctz(mask);
+
+	while (length < count && mask == 0) {
+		block += V::kSize;
+		mask = V::Equal(V::Load(block), zero);
+		if (mask != 0)
+			length += __builtin_ctz(mask);
+		else
+			length += V::kSize;
+	}
+
+	return length < count ? length : count;
+}
+
+
+template<typename V>
+static inline void*
+simd_memchr(const void* buffer, int c, size_t count)
+{
+	if (count == 0)
+		return NULL;
+
+	const typename V::Type value = V::Broadcast((char)c);
+	const char* start = (const char*)buffer;
+	size_t offset = (uintptr_t)start & (V::kSize - 1);
+	const char* block = start - offset;
+
+	uint32_t mask = V::Equal(V::Load(block), value) >> offset;
+	size_t position = V::kSize - offset;
+	if (mask != 0)
+		position = __builtin_ctz(mask);
+
+	while (position < count && mask == 0) {
+		block += V::kSize;
+		mask = V::Equal(V::Load(block), value);
+		if (mask != 0)
+			position += __builtin_ctz(mask);
+		else
+			position += V::kSize;
+	}
+
+	return position < count ? (void*)(start + position) : NULL;
+}
+
+
+template<typename V>
+static inline char*
+simd_strchr(const char* string, int c)
+{
+	const typename V::Type zero = V::Zero();
+	const typename V::Type value = V::Broadcast((char)c);
+	size_t offset = (uintptr_t)string & (V::kSize - 1);
+	const char* block = string - offset;
+
+	typename V::Type data = V::Load(block);
+	uint32_t mask = (V::Equal(data, value) | V::Equal(data, zero)) >> offset;
+	if (mask != 0)
+		block = string;
+
+	while (mask == 0) {
+		block += V::kSize;
+		data = V::Load(block);
+		mask = V::Equal(data, value) | V::Equal(data, zero);
+	}
+
+	// the terminating null byte is matched, too, if c is '\0'
+	const char* found = block + __builtin_ctz(mask);
+	return *found == (char)c ? (char*)found : NULL;
+}
+
+
+template<typename V>
+static inline int
+simd_memcmp(const void* _a, const void* _b, size_t count)
+{
+	const unsigned char* a = (const unsigned char*)_a;
+	const unsigned char* b = (const unsigned char*)_b;
+
+	while (count >= V::kSize) {
+		uint32_t mask = V::Equal(V::LoadUnaligned(a), V::LoadUnaligned(b));
+		if (mask != V::kAllMask) {
+			size_t index = __builtin_ctz(~mask);
+			return a[index] - b[index];
+		}
+
+		a += V::kSize;
+		b += V::kSize;
+		count -= V::kSize;
+	}
+
+	while (count-- > 0) {
+		int cmp = *a++ - *b++;
+		if (cmp != 0)
+			return cmp;
+	}
+
+	return 0;
+}
+
+
+template<typename V>
+static inline bool
+simd_can_load(const void* address)
+{
+	return ((uintptr_t)address & (SIMD_PAGE_SIZE - 1))
+		<= SIMD_PAGE_SIZE - V::kSize;
+}
+
+
+template<typename V>
+static inline int
+simd_strcmp(const char* _a, const char* _b)
+{
+	const unsigned char* a = (const unsigned char*)_a;
+	const unsigned char* b = (const unsigned char*)_b;
+	const typename V::Type zero = V::Zero();
+
+	while (true) {
+		// The strings are usually not aligned the same way, so we use
+		// unaligned loads, and fall back to single bytes whenever one of
+		// them could cross into the next page.
+		if (!simd_can_load<V>(a) || !simd_can_load<V>(b)) {
+			int cmp = *a - *b;
+			if (cmp != 0 || *a == '\0')
+				return cmp;
+
+			a++;
+			b++;
+			continue;
+		}
+
+		typename V::Type dataA = V::LoadUnaligned(a);
+		uint32_t mask = (~V::Equal(dataA, V::LoadUnaligned(b)) & V::kAllMask)
+			| V::Equal(dataA, zero);
+		if (mask != 0) {
+			size_t index = __builtin_ctz(mask);
+			return a[index] - b[index];
+		}
+
+		a += V::kSize;
+		b += V::kSize;
+	}
+}
+
+
+// SSE2 versions, always available on x86_64
+size_t strlen_sse2(const char* string);
+size_t strnlen_sse2(const char* string, size_t count);
+void* memchr_sse2(const void* buffer, int c, size_t count);
+char* strchr_sse2(const char* string, int c);
+int memcmp_sse2(const void* a, const void* b, size_t count);
+int strcmp_sse2(const char* a, const char* b);
+
+// AVX2 versions
+size_t strlen_avx2(const char* string);
+size_t strnlen_avx2(const char* string, size_t count);
+void* memchr_avx2(const void* buffer, int c, size_t count);
+char* strchr_avx2(const char* string, int c);
+int memcmp_avx2(const void* a, const void* b, size_t count);
+int strcmp_avx2(const char* a, const char* b);
+
+
+#endif	// SIMD_STRING_H
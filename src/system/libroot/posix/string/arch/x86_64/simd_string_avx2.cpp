@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <immintrin.h>
+
+// Everything following is compiled for AVX2. These functions are only called
+// once simd_string.cpp has made sure that the CPU and OS support AVX2.
+#pragma GCC target("avx2")
+
+#include "simd_string.h"
+
+
+namespace {
+
+
+struct AVX2Vector {
+	typedef __m256i Type;
+
+	static const size_t kSize = 32;
+	static const uint32_t kAllMask = 0xffffffff;
+
+	static inline Type Load(const void* address)
+	{
+		return _mm256_load_si256((const __m256i*)address);
+	}
+
+	static inline Type LoadUnaligned(const void* address)
+	{
+		return _mm256_loadu_si256((const __m256i*)address);
+	}
+
+	static inline Type Broadcast(char c)
+	{
+		return _mm256_set1_epi8(c);
+	}
+
+	static inline Type Zero()
+	{
+		return _mm256_setzero_si256();
+	}
+
+	static inline uint32_t Equal(Type a, Type b)
+	{
+		return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+	}
+};
+
+
+}	// namespace
+
+
+size_t
+strlen_avx2(const char* string)
+{
+	return simd_strlen<AVX2Vector>(string);
+}
+
+
+size_t
+strnlen_avx2(const char* string, size_t count)
+{
+	return simd_strnlen<AVX2Vector>(string, count);
+}
+
+
+void*
+memchr_avx2(const void* buffer, int c, size_t count)
+{
+	return simd_memchr<AVX2Vector>(buffer, c, count);
+}
+
+
+char*
+strchr_avx2(const char* string, int c)
+{
+	return simd_strchr<AVX2Vector>(string, c);
+}
+
+
+int
+memcmp_avx2(const void* a, const void* b, size_t count)
+{
+	return simd_memcmp<AVX2Vector>(a, b, count);
+}
+
+
+int
+strcmp_avx2(const char* a, const char* b)
+{
+	return simd_strcmp<AVX2Vector>(a, b);
+}
@@ -20,6 +20,10 @@
 #include <errno_private.h>
 
 
+static const size_t kMaxStackArgsSize = 16 * 1024;
+	// flattened arguments up to this size are passed to the kernel on the stack
+
+
 static int
 count_arguments(va_list list, const char* arg, char*** _env)
 {
@@ -110,12 +114,28 @@ do_exec(const char* path, char* const args[], char* const environment[],
 	status = __flatten_process_args(newArgs ? newArgs : args, argCount,
 		environment, &envCount, path, &flatArgs, &flatArgsSize);
 
+	if (status == B_OK && flatArgsSize <= kMaxStackArgsSize) {
+		// After a vfork() the heap still belongs to the parent, and a
+		// successful exec*() would leak the buffer there. Move the arguments
+		// to the stack instead, if they are reasonably small.
+		char** stackArgs = (char**)alloca(flatArgsSize);
+		memcpy(stackArgs, flatArgs, flatArgsSize);
+		for (int32 i = 0; i < argCount + envCount + 2; i++) {
+			if (stackArgs[i] != NULL)
+				stackArgs[i] += (char*)stackArgs - (char*)flatArgs;
+		}
+
+		free(flatArgs);
+		flatArgs = stackArgs;
+	}
+
 	if (status == B_OK) {
 		__set_errno(_kern_exec(path, flatArgs, flatArgsSize, argCount, envCount,
 			__gUmask));
 			// if this call returns, something definitely went wrong
 
-		free(flatArgs);
+		if (flatArgsSize > kMaxStackArgsSize)
+			free(flatArgs);
 	} else
 		__set_errno(status);
 
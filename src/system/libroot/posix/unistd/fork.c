@@ -186,9 +186,13 @@ fork(void)
 }
 
 
+#ifndef __x86_64__
+// x86_64 has a real vfork() implemented in assembly, which shares the address
+// space with the child.
 pid_t
 vfork(void)
 {
 	return fork();
 }
+#endif
 
@@ -729,6 +729,8 @@ void __pthread_getattr_np() {}
 void __pthread_getname_np() {}
 void __pthread_init_creation_attributes() {}
 void __pthread_key_call_destructors() {}
+void __pthread_rwlockattr_getkind_np() {}
+void __pthread_rwlockattr_setkind_np() {}
 void __pthread_mutex_lock__FP14_pthread_mutexUlx() {}
 void __pthread_set_default_priority() {}
 void __pthread_setname_np() {}
@@ -1021,6 +1023,7 @@ void _kern_create_area() {}
 void _kern_create_child_partition() {}
 void _kern_create_dir() {}
 void _kern_create_dir_entry_ref() {}
+void _kern_create_event_queue() {}
 void _kern_create_fifo() {}
 void _kern_create_index() {}
 void _kern_create_link() {}
@@ -1043,6 +1046,9 @@ void _kern_dup() {}
 void _kern_dup2() {}
 void _kern_entry_ref_to_path() {}
 void _kern_estimate_max_scheduling_latency() {}
+void _kern_event_queue_deselect() {}
+void _kern_event_queue_select() {}
+void _kern_event_queue_wait() {}
 void _kern_exec() {}
 void _kern_exit_team() {}
 void _kern_exit_thread() {}
@@ -1189,6 +1195,7 @@ void _kern_select() {}
 void _kern_send() {}
 void _kern_send_data() {}
 void _kern_send_signal() {}
+void _kern_sendfile() {}
 void _kern_sendmsg() {}
 void _kern_sendto() {}
 void _kern_set_area_protection() {}
@@ -1514,6 +1521,7 @@ void crealf() {}
 void creall() {}
 void creat() {}
 void create_area() {}
+void create_event_queue() {}
 void create_port() {}
 void create_sem() {}
 void crypt() {}
@@ -1586,6 +1594,9 @@ void erfcl() {}
 void erff() {}
 void erfl() {}
 void estimate_max_scheduling_latency() {}
+void event_queue_deselect() {}
+void event_queue_select() {}
+void event_queue_wait() {}
 void execl() {}
 void execle() {}
 void execlp() {}
@@ -2246,8 +2257,10 @@ void pthread_rwlock_trywrlock() {}
 void pthread_rwlock_unlock() {}
 void pthread_rwlock_wrlock() {}
 void pthread_rwlockattr_destroy() {}
+void pthread_rwlockattr_getkind_np() {}
 void pthread_rwlockattr_getpshared() {}
 void pthread_rwlockattr_init() {}
+void pthread_rwlockattr_setkind_np() {}
 void pthread_rwlockattr_setpshared() {}
 void pthread_self() {}
 void pthread_setcancelstate() {}
@@ -12,6 +12,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <syscalls.h>
+
+
+extern "C" void x86_64_lazy_bind_trampoline(void);
+
 
 static status_t
 relocate_rela(image_t* rootImage, image_t* image, Elf64_Rela* rel,
@@ -80,6 +85,56 @@ relocate_rela(image_t* rootImage, image_t* image, Elf64_Rela* rel,
 }
 
 
+static status_t
+prepare_lazy_binding(image_t* rootImage, image_t* image, Elf64_Rela* rel,
+	size_t relLength, SymbolLookupCache* cache)
+{
+	// PLT0 pushes GOT[1] and jumps to GOT[2]
+	image->pltgot[1] = (addr_t)image;
+	image->pltgot[2] = (addr_t)&x86_64_lazy_bind_trampoline;
+
+	addr_t delta = image->regions[0].delta;
+	for (size_t i = 0; i < relLength / sizeof(Elf64_Rela); i++) {
+		if (ELF64_R_TYPE(rel[i].r_info) != R_X86_64_JUMP_SLOT) {
+			status_t status = relocate_rela(rootImage, image, &rel[i],
+				sizeof(Elf64_Rela), cache);
+			if (status != B_OK)
+				return status;
+			continue;
+		}
+
+		// The slot initially points back into the PLT entry, which pushes
+		// the relocation index and enters the trampoline.
+		*(Elf64_Addr*)(delta + rel[i].r_offset) += delta;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Called from x86_64_lazy_bind_trampoline with the arguments pushed by the
+	PLT. Binds the function and returns its address.
+*/
+extern "C" addr_t
+x86_64_bind_lazy_symbol(image_t* image, uint64 relocationIndex)
+{
+	Elf64_Rela* rel = (Elf64_Rela*)image->pltrel + relocationIndex;
+	Elf64_Sym* sym = SYMBOL(image, ELF64_R_SYM(rel->r_info));
+
+	addr_t address;
+	status_t status = resolve_lazy_symbol(image, sym, &address);
+	if (status != B_OK) {
+		FATAL("%s: lazy binding of symbol \"%s\" failed\n", image->path,
+			SYMNAME(image, sym));
+		_kern_exit_team(status);
+	}
+
+	address += rel->r_addend;
+	*(Elf64_Addr*)(image->regions[0].delta + rel->r_offset) = address;
+	return address;
+}
+
+
 status_t
 arch_relocate_image(image_t* rootImage, image_t* image,
 	SymbolLookupCache* cache)
@@ -98,8 +153,13 @@ arch_relocate_image(image_t* rootImage, image_t* image,
 
 	// PLT relocations (they are RELA on x86_64).
 	if (image->pltrel) {
-		status = relocate_rela(rootImage, image, (Elf64_Rela*)image->pltrel,
-			image->pltrel_len, cache);
+		if (image->pltgot != NULL && lazy_binding_enabled(rootImage, image)) {
+			status = prepare_lazy_binding(rootImage, image,
+				(Elf64_Rela*)image->pltrel, image->pltrel_len, cache);
+		} else {
+			status = relocate_rela(rootImage, image,
+				(Elf64_Rela*)image->pltrel, image->pltrel_len, cache);
+		}
 		if (status != B_OK)
 			return status;
 	}
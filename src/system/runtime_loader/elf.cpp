@@ -25,6 +25,7 @@
 
 #include "add_ons.h"
 #include "elf_load_image.h"
+#include "elf_relocation_cache.h"
 #include "elf_symbol_lookup.h"
 #include "elf_tls.h"
 #include "elf_versioning.h"
@@ -52,6 +53,8 @@ static uint32 sPreloadedAddonCount = 0;
 
 static recursive_lock sLock = RECURSIVE_LOCK_INITIALIZER(kLockName);
 
+static bool sLazyBinding = false;
+
 
 static const char *
 find_dt_rpath(image_t *image)
@@ -264,9 +267,10 @@ load_dependencies(image_t* image, bool preload = false)
 
 
 static status_t
-relocate_image(image_t *rootImage, image_t *image)
+relocate_image(image_t *rootImage, image_t *image, SymbolLookupMemo* memo,
+	RelocationCache* relocationCache)
 {
-	SymbolLookupCache cache(image);
+	SymbolLookupCache cache(image, memo, relocationCache);
 
 	status_t status = arch_relocate_image(rootImage, image, &cache);
 	if (status < B_OK) {
@@ -281,7 +285,7 @@ relocate_image(image_t *rootImage, image_t *image)
 
 
 static status_t
-relocate_dependencies(image_t *image)
+relocate_dependencies(image_t *image, RelocationCache* relocationCache = NULL)
 {
 	// get the images that still have to be relocated
 	image_t **list;
@@ -289,9 +293,11 @@ relocate_dependencies(image_t *image)
 	if (count < B_OK)
 		return count;
 
-	// relocate
+	// relocate, sharing the lookups of symbols referenced by several images
+	SymbolLookupMemo memo(image);
 	for (ssize_t i = 0; i < count; i++) {
-		status_t status = relocate_image(image, list[i]);
+		status_t status = relocate_image(image, list[i], &memo,
+			relocationCache);
 		if (status < B_OK) {
 			free(list);
 			return status;
@@ -517,6 +523,35 @@ preload_addons()
 }
 
 
+//	#pragma mark - lazy binding
+
+
+/*!	Returns whether the PLT relocations of \a image may be deferred until
+	the respective function is called for the first time.
+	Lazy binding is opt-in via LD_BIND_LAZY and only used for the images
+	loaded together with the program; LD_BIND_NOW and images linked with
+	"-z now" always get bound immediately.
+*/
+bool
+lazy_binding_enabled(image_t* rootImage, image_t* image)
+{
+	return sLazyBinding && rootImage == gProgramImage
+		&& (image->flags & RFLAG_BIND_NOW) == 0;
+}
+
+
+/*!	Called by the architecture specific PLT trampoline when a lazily bound
+	function is called for the first time.
+*/
+status_t
+resolve_lazy_symbol(image_t* image, elf_sym* symbol, addr_t* _address)
+{
+	RecursiveLocker _(sLock);
+
+	return resolve_symbol(gProgramImage, image, symbol, NULL, _address);
+}
+
+
 //	#pragma mark - libroot.so exported functions
 
 
@@ -525,6 +560,7 @@ load_program(char const *path, void **_entry)
 {
 	status_t status;
 	image_t *image;
+	RelocationCache relocationCache;
 
 	KTRACE("rld: load_program(\"%s\")", path);
 
@@ -550,10 +586,20 @@ load_program(char const *path, void **_entry)
 	// This results in the desired symbol resolution for dlopen()ed libraries.
 	set_image_flags_recursively(gProgramImage, RTLD_GLOBAL);
 
-	status = relocate_dependencies(gProgramImage);
+	sLazyBinding = getenv("LD_BIND_LAZY") != NULL
+		&& getenv("LD_BIND_NOW") == NULL;
+
+	// With the same set of images the symbols will be found in the same
+	// places as during the last start, so we can reuse those results.
+	if (relocationCache.Init() == B_OK)
+		status = relocate_dependencies(gProgramImage, &relocationCache);
+	else
+		status = relocate_dependencies(gProgramImage);
 	if (status < B_OK)
 		goto err;
 
+	relocationCache.Save();
+
 	inject_runtime_loader_api(gProgramImage);
 
 	remap_images();
@@ -258,6 +258,7 @@ parse_dynamic_segment(image_t* image)
 	int sonameOffset = -1;
 
 	image->symhash = 0;
+	image->gnu_hash = NULL;
 	image->syms = 0;
 	image->strtab = 0;
 
@@ -274,6 +275,10 @@ parse_dynamic_segment(image_t* image)
 				image->symhash
 					= (uint32*)(d[i].d_un.d_ptr + image->regions[0].delta);
 				break;
+			case DT_GNU_HASH:
+				image->gnu_hash
+					= (uint32*)(d[i].d_un.d_ptr + image->regions[0].delta);
+				break;
 			case DT_STRTAB:
 				image->strtab
 					= (char*)(d[i].d_un.d_ptr + image->regions[0].delta);
@@ -304,6 +309,10 @@ parse_dynamic_segment(image_t* image)
 			case DT_PLTRELSZ:
 				image->pltrel_len = d[i].d_un.d_val;
 				break;
+			case DT_PLTGOT:
+				image->pltgot = (addr_t*)
+					(d[i].d_un.d_ptr + image->regions[0].delta);
+				break;
 			case DT_INIT:
 				image->init_routine
 					= (d[i].d_un.d_ptr + image->regions[0].delta);
@@ -336,17 +345,26 @@ parse_dynamic_segment(image_t* image)
 			case DT_SYMBOLIC:
 				image->flags |= RFLAG_SYMBOLIC;
 				break;
+			case DT_BIND_NOW:
+				image->flags |= RFLAG_BIND_NOW;
+				break;
 			case DT_FLAGS:
 			{
 				uint32 flags = d[i].d_un.d_val;
 				if ((flags & DF_SYMBOLIC) != 0)
 					image->flags |= RFLAG_SYMBOLIC;
+				if ((flags & DF_BIND_NOW) != 0)
+					image->flags |= RFLAG_BIND_NOW;
 				if ((flags & DF_STATIC_TLS) != 0) {
 					FATAL("Static TLS model is not supported.\n");
 					return false;
 				}
 				break;
 			}
+			case DT_FLAGS_1:
+				if ((d[i].d_un.d_val & DF_1_NOW) != 0)
+					image->flags |= RFLAG_BIND_NOW;
+				break;
 			case DT_INIT_ARRAY:
 				// array of pointers to initialization functions
 				image->init_array = (addr_t*)
@@ -382,7 +400,6 @@ parse_dynamic_segment(image_t* image)
 			// DT_RELAENT: The size of a DT_RELA entry.
 			// DT_SYMENT: The size of a symbol table entry.
 			// DT_PLTREL: The type of the PLT relocation entries (DT_JMPREL).
-			// DT_BIND_NOW/DF_BIND_NOW: No lazy binding allowed.
 			// DT_RUNPATH: Library search path (supersedes DT_RPATH).
 			// DT_TEXTREL/DF_TEXTREL: Indicates whether text relocations are
 			//		required (for optimization purposes only).
@@ -393,6 +410,15 @@ parse_dynamic_segment(image_t* image)
 	if (!image->symhash || !image->syms || !image->strtab)
 		return false;
 
+	// the GNU hash table is only an optimization, ignore it if it is unusable
+	if (image->gnu_hash != NULL) {
+		uint32 bloomSize = image->gnu_hash[2];
+		if (image->gnu_hash[0] == 0 || bloomSize == 0
+			|| (bloomSize & (bloomSize - 1)) != 0) {
+			image->gnu_hash = NULL;
+		}
+	}
+
 	if (sonameOffset >= 0)
 		strlcpy(image->name, STRING(image, sonameOffset), sizeof(image->name));
 
@@ -0,0 +1,572 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "elf_relocation_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <find_directory_private.h>
+#include <syscalls.h>
+
+#include "images.h"
+
+
+/*!	The relocation cache remembers where the undefined symbols of a program
+	and its libraries have been found, so that the next start of the same
+	program doesn't have to search for them again.
+
+	The cache file is named after a hash over the path of the program, and a
+	hash over the identities (node, size and modification time) of all images
+	loaded at the time the program is relocated, and it repeats those
+	identities for verification. If any of the images changes, the program
+	gets another cache file, and the files of the program for other sets of
+	images are removed when it is written. Since a
+	binding refers to the defining image and the index of the symbol in its
+	symbol table, the bindings stay valid no matter where the images are
+	mapped. Before a cached binding is used, the name and version of the
+	symbol it points to are compared with the ones looked up; if they differ,
+	or the file is damaged in any other way, the file is removed and all
+	symbols are looked up the regular way.
+
+	The cache lives in the user's cache directory, so it is never used for
+	set-user-ID or set-group-ID programs.
+*/
+
+
+static const uint32 kRelocationCacheMagic = 'rlcc';
+static const uint16 kRelocationCacheVersion = 1;
+static const uint32 kMaxBindings = 1 << 22;
+static const uint32 kSymbolNotFound = 0xffffffff;
+static const char* const kRelocationCacheDirectory = "runtime_loader";
+
+
+struct RelocationCache::FileHeader {
+	uint32	magic;
+	uint16	version;
+	uint16	pointer_size;
+	uint32	image_count;
+	uint32	binding_count;
+	uint32	checksum;
+	uint32	reserved;
+};
+
+struct RelocationCache::ImageRecord {
+	int64	node;
+	int64	modification_time;
+	int64	size;
+	int32	device;
+	uint32	symbol_count;
+	uint32	first_binding;
+	uint32	binding_count;
+};
+
+struct RelocationCache::Binding {
+	uint32	symbol;
+		// index in the symbol table of the requesting image
+	uint32	image;
+		// index of the defining image, or kSymbolNotFound
+	uint32	target;
+		// index in the symbol table of the defining image
+};
+
+
+static uint32
+checksum(uint32 hash, const void* _data, size_t size)
+{
+	const uint8* data = (const uint8*)_data;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 16777619;
+
+	return hash;
+}
+
+
+/*!	Returns whether the symbol \a symbolIndex of \a image would have been
+	found for a reference to \a version, following the rules of
+	find_symbol(). Since the images are exactly the ones the binding was
+	recorded with, a symbol that is accepted here is also the only one
+	find_symbol() could have returned.
+*/
+static bool
+symbol_version_matches(image_t* image, uint32 symbolIndex,
+	const elf_version_info* version)
+{
+	if (image->symbol_versions == NULL) {
+		if (version == NULL || version->file_name == NULL)
+			return true;
+
+		// an older version of the dependency the version refers to
+		const char* lastSlash = strrchr(version->file_name, '/');
+		return strcmp(image->name,
+			lastSlash != NULL ? lastSlash + 1 : version->file_name) != 0;
+	}
+
+	uint32 versionID = image->symbol_versions[symbolIndex];
+	uint32 versionIndex = VER_NDX(versionID);
+	if (versionIndex == VER_NDX_LOCAL)
+		return false;
+
+	if (version == NULL) {
+		return versionIndex == VER_NDX_GLOBAL
+			|| versionIndex == VER_NDX_INITIAL
+			|| (versionID & VER_NDX_FLAG_HIDDEN) == 0;
+	}
+
+	const elf_version_info& symbolVersion = image->versions[versionIndex];
+	if (symbolVersion.hash == version->hash
+		&& strcmp(symbolVersion.name, version->name) == 0) {
+		return true;
+	}
+
+	return versionIndex == VER_NDX_GLOBAL
+		&& (versionID & VER_NDX_FLAG_HIDDEN) == 0;
+}
+
+
+static bool
+read_fully(int fd, off_t offset, void* buffer, size_t size)
+{
+	return _kern_read(fd, offset, buffer, size) == (ssize_t)size;
+}
+
+
+static bool
+write_fully(int fd, off_t offset, const void* buffer, size_t size)
+{
+	return _kern_write(fd, offset, buffer, size) == (ssize_t)size;
+}
+
+
+// #pragma mark -
+
+
+RelocationCache::RelocationCache()
+	:
+	fImages(NULL),
+	fRecords(NULL),
+	fImageCount(0),
+	fBindings(NULL),
+	fBindingCount(0),
+	fBindingCapacity(0),
+	fValid(false),
+	fRecording(false),
+	fCurrentImage(NULL),
+	fCurrentBindings(NULL),
+	fCurrentSymbolCount(0),
+	fNameOffset(0)
+{
+	fPath[0] = '\0';
+}
+
+
+RelocationCache::~RelocationCache()
+{
+	free(fCurrentBindings);
+	free(fBindings);
+	free(fRecords);
+	free(fImages);
+}
+
+
+/*!	Identifies the currently loaded images and reads the matching cache file,
+	if there is one. If there is none, the following Add() calls record the
+	bindings for Save().
+*/
+status_t
+RelocationCache::Init()
+{
+	// runtime loader add-ons may change how symbols are resolved
+	if (getenv("LD_PRELOAD_ADDONS") != NULL)
+		return B_NOT_SUPPORTED;
+
+	// the cache directory is under the control of the user
+	if (_kern_getuid(false) != _kern_getuid(true)
+		|| _kern_getgid(false) != _kern_getgid(true)) {
+		return B_NOT_ALLOWED;
+	}
+
+	fImageCount = count_loaded_images();
+	fImages = (image_t**)malloc(fImageCount * sizeof(image_t*));
+	fRecords = (ImageRecord*)malloc(fImageCount * sizeof(ImageRecord));
+	if (fImages == NULL || fRecords == NULL)
+		return B_NO_MEMORY;
+
+	memset(fRecords, 0, fImageCount * sizeof(ImageRecord));
+
+	if (gProgramImage == NULL)
+		return B_ERROR;
+
+	uint32 programHash = checksum(2166136261U, gProgramImage->path,
+		strlen(gProgramImage->path));
+
+	uint32 hash = 2166136261U;
+	uint32 index = 0;
+	for (image_t* image = get_loaded_images().head; image != NULL;
+			image = image->next) {
+		if (index == fImageCount)
+			return B_ERROR;
+
+		struct stat st;
+		status_t status = _kern_read_stat(-1, image->path, true, &st,
+			sizeof(st));
+		if (status != B_OK)
+			return status;
+		if ((st.st_mode & (S_ISUID | S_ISGID)) != 0)
+			return B_NOT_ALLOWED;
+
+		ImageRecord& record = fRecords[index];
+		record.node = st.st_ino;
+		record.modification_time = (int64)st.st_mtim.tv_sec * 1000000000LL
+			+ st.st_mtim.tv_nsec;
+		record.size = st.st_size;
+		record.device = st.st_dev;
+		record.symbol_count = image->symhash != NULL ? image->symhash[1] : 0;
+
+		hash = checksum(hash, &record, sizeof(record));
+		fImages[index++] = image;
+	}
+
+	if (index != fImageCount)
+		return B_ERROR;
+
+	status_t status = __find_directory(B_USER_CACHE_DIRECTORY, -1, true,
+		fPath, sizeof(fPath));
+	if (status != B_OK)
+		return status;
+
+	size_t length = strlen(fPath);
+	snprintf(fPath + length, sizeof(fPath) - length, "/%s",
+		kRelocationCacheDirectory);
+
+	status = _kern_create_dir(-1, fPath, 0755);
+	if (status != B_OK && status != B_FILE_EXISTS)
+		return status;
+
+	length = strlen(fPath);
+	fNameOffset = length + 1;
+	if (snprintf(fPath + length, sizeof(fPath) - length, "/%08" B_PRIx32
+			"-%08" B_PRIx32 "-%" B_PRIu32, programHash, hash, fImageCount)
+			>= (int)(sizeof(fPath) - length)) {
+		return B_NAME_TOO_LONG;
+	}
+
+	if (_Read())
+		fValid = true;
+	else
+		fRecording = true;
+
+	return B_OK;
+}
+
+
+/*!	Returns the cached binding of symbol \a symbolIndex of \a image, if there
+	is one. \a name and \a version are the name and the requested version of
+	the symbol, they are used to verify the binding.
+*/
+bool
+RelocationCache::Lookup(image_t* image, uint32 symbolIndex, const char* name,
+	const elf_version_info* version, elf_sym** _symbol,
+	image_t** _foundInImage)
+{
+	if (!fValid)
+		return false;
+
+	if (image != fCurrentImage) {
+		// map the symbol indices of the image to its bindings
+		int32 index = _ImageIndex(image);
+		if (index < 0) {
+			_Invalidate();
+			return false;
+		}
+
+		const ImageRecord& record = fRecords[index];
+		uint32* bindings = (uint32*)realloc(fCurrentBindings,
+			(record.symbol_count + 1) * sizeof(uint32));
+		if (bindings == NULL) {
+			fValid = false;
+			return false;
+		}
+		fCurrentBindings = bindings;
+
+		memset(bindings, 0, record.symbol_count * sizeof(uint32));
+		for (uint32 i = 0; i < record.binding_count; i++) {
+			uint32 bindingIndex = record.first_binding + i;
+			uint32 symbol = fBindings[bindingIndex].symbol;
+			if (symbol >= record.symbol_count) {
+				_Invalidate();
+				return false;
+			}
+			bindings[symbol] = bindingIndex + 1;
+		}
+
+		fCurrentImage = image;
+		fCurrentSymbolCount = record.symbol_count;
+	}
+
+	uint32 bindingIndex = symbolIndex < fCurrentSymbolCount
+		? fCurrentBindings[symbolIndex] : 0;
+	if (bindingIndex == 0) {
+		// the same set of images should always need the same symbols
+		_Invalidate();
+		return false;
+	}
+
+	const Binding& binding = fBindings[bindingIndex - 1];
+	if (binding.image == kSymbolNotFound) {
+		*_symbol = NULL;
+		*_foundInImage = NULL;
+		return true;
+	}
+
+	if (binding.image >= fImageCount
+		|| binding.target >= fRecords[binding.image].symbol_count) {
+		_Invalidate();
+		return false;
+	}
+
+	image_t* foundInImage = fImages[binding.image];
+	elf_sym* symbol = &foundInImage->syms[binding.target];
+	if (strcmp(SYMNAME(foundInImage, symbol), name) != 0
+		|| !symbol_version_matches(foundInImage, binding.target, version)) {
+		_Invalidate();
+		return false;
+	}
+
+	*_symbol = symbol;
+	*_foundInImage = foundInImage;
+	return true;
+}
+
+
+/*!	Records the result of an undefined symbol lookup. The bindings of an image
+	have to be added in one go, as it happens when relocating it.
+*/
+void
+RelocationCache::Add(image_t* image, uint32 symbolIndex, elf_sym* symbol,
+	image_t* foundInImage)
+{
+	if (!fRecording)
+		return;
+
+	int32 index = _ImageIndex(image);
+	int32 foundIndex = symbol != NULL ? _ImageIndex(foundInImage) : 0;
+	if (index < 0 || foundIndex < 0 || fBindingCount == kMaxBindings) {
+		fRecording = false;
+		return;
+	}
+
+	ImageRecord& record = fRecords[index];
+	if (record.binding_count == 0)
+		record.first_binding = fBindingCount;
+	else if (record.first_binding + record.binding_count != fBindingCount) {
+		fRecording = false;
+		return;
+	}
+
+	if (fBindingCount == fBindingCapacity) {
+		uint32 capacity = fBindingCapacity > 0 ? fBindingCapacity * 2 : 1024;
+		Binding* bindings = (Binding*)realloc(fBindings,
+			capacity * sizeof(Binding));
+		if (bindings == NULL) {
+			fRecording = false;
+			return;
+		}
+
+		fBindings = bindings;
+		fBindingCapacity = capacity;
+	}
+
+	Binding& binding = fBindings[fBindingCount++];
+	binding.symbol = symbolIndex;
+	if (symbol != NULL) {
+		binding.image = foundIndex;
+		binding.target = symbol - foundInImage->syms;
+	} else {
+		binding.image = kSymbolNotFound;
+		binding.target = 0;
+	}
+	record.binding_count++;
+}
+
+
+/*!	Writes the recorded bindings to the cache file. The file is written under
+	a temporary name first, so that no other team can ever see it only
+	partially written. The temporary file must not exist yet, so that
+	nothing can be redirected to another file.
+*/
+void
+RelocationCache::Save()
+{
+	if (!fRecording || fBindingCount == 0)
+		return;
+
+	size_t recordsSize = fImageCount * sizeof(ImageRecord);
+	size_t bindingsSize = fBindingCount * sizeof(Binding);
+
+	FileHeader header;
+	header.magic = kRelocationCacheMagic;
+	header.version = kRelocationCacheVersion;
+	header.pointer_size = sizeof(addr_t);
+	header.image_count = fImageCount;
+	header.binding_count = fBindingCount;
+	header.checksum = checksum(checksum(2166136261U, fRecords, recordsSize),
+		fBindings, bindingsSize);
+	header.reserved = 0;
+
+	char path[B_PATH_NAME_LENGTH];
+	snprintf(path, sizeof(path), "%s.%" B_PRId32, fPath, find_thread(NULL));
+
+	int fd = _kern_open(-1, path, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW,
+		0644);
+	if (fd < 0)
+		return;
+
+	bool success = write_fully(fd, 0, &header, sizeof(header))
+		&& write_fully(fd, sizeof(header), fRecords, recordsSize)
+		&& write_fully(fd, sizeof(header) + recordsSize, fBindings,
+			bindingsSize);
+	_kern_close(fd);
+
+	if (!success || _kern_rename(-1, path, -1, fPath) != B_OK) {
+		_kern_unlink(-1, path);
+		return;
+	}
+
+	_RemoveStaleFiles();
+}
+
+
+/*!	Removes the cache files of the program for other sets of images, as
+	they were most likely left behind by updates of the program or its
+	libraries. Temporary files of other teams are left alone.
+*/
+void
+RelocationCache::_RemoveStaleFiles()
+{
+	char directory[B_PATH_NAME_LENGTH];
+	strlcpy(directory, fPath, fNameOffset);
+
+	int fd = _kern_open_dir(-1, directory);
+	if (fd < 0)
+		return;
+
+	const char* name = fPath + fNameOffset;
+	const char* hash = strchr(name, '-');
+	size_t prefixLength = hash - name + 1;
+
+	char buffer[sizeof(dirent) + B_FILE_NAME_LENGTH];
+	dirent* entry = (dirent*)buffer;
+	while (_kern_read_dir(fd, entry, sizeof(buffer), 1) == 1) {
+		if (strncmp(entry->d_name, name, prefixLength) != 0
+			|| strcmp(entry->d_name, name) == 0
+			|| strchr(entry->d_name, '.') != NULL) {
+			continue;
+		}
+
+		_kern_unlink(fd, entry->d_name);
+	}
+
+	_kern_close(fd);
+}
+
+
+int32
+RelocationCache::_ImageIndex(image_t* image)
+{
+	for (uint32 i = 0; i < fImageCount; i++) {
+		if (fImages[i] == image)
+			return i;
+	}
+
+	return -1;
+}
+
+
+bool
+RelocationCache::_Read()
+{
+	int fd = _kern_open(-1, fPath, O_RDONLY | O_NOFOLLOW, 0);
+	if (fd < 0)
+		return false;
+
+	FileHeader header;
+	ImageRecord* records = NULL;
+	bool success = false;
+
+	if (!read_fully(fd, 0, &header, sizeof(header))
+		|| header.magic != kRelocationCacheMagic
+		|| header.version != kRelocationCacheVersion
+		|| header.pointer_size != sizeof(addr_t)
+		|| header.image_count != fImageCount
+		|| header.binding_count == 0
+		|| header.binding_count > kMaxBindings) {
+		goto out;
+	}
+
+	{
+		size_t recordsSize = fImageCount * sizeof(ImageRecord);
+		size_t bindingsSize = header.binding_count * sizeof(Binding);
+
+		records = (ImageRecord*)malloc(recordsSize);
+		fBindings = (Binding*)malloc(bindingsSize);
+		if (records == NULL || fBindings == NULL
+			|| !read_fully(fd, sizeof(header), records, recordsSize)
+			|| !read_fully(fd, sizeof(header) + recordsSize, fBindings,
+				bindingsSize)
+			|| checksum(checksum(2166136261U, records, recordsSize), fBindings,
+				bindingsSize) != header.checksum) {
+			goto out;
+		}
+
+		// the images must be exactly the ones we have loaded
+		for (uint32 i = 0; i < fImageCount; i++) {
+			const ImageRecord& record = records[i];
+			const ImageRecord& loaded = fRecords[i];
+			if (record.node != loaded.node
+				|| record.modification_time != loaded.modification_time
+				|| record.size != loaded.size
+				|| record.device != loaded.device
+				|| record.symbol_count != loaded.symbol_count
+				|| record.first_binding > header.binding_count
+				|| record.binding_count
+					> header.binding_count - record.first_binding) {
+				goto out;
+			}
+		}
+
+		memcpy(fRecords, records, recordsSize);
+		fBindingCount = header.binding_count;
+		fBindingCapacity = header.binding_count;
+		success = true;
+	}
+
+out:
+	_kern_close(fd);
+	free(records);
+
+	if (!success) {
+		free(fBindings);
+		fBindings = NULL;
+		_kern_unlink(-1, fPath);
+	}
+
+	return success;
+}
+
+
+void
+RelocationCache::_Invalidate()
+{
+	TRACE(("rld: relocation cache %s is out of date, ignoring it\n",
+		fPath));
+
+	fValid = false;
+	_kern_unlink(-1, fPath);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef ELF_RELOCATION_CACHE_H
+#define ELF_RELOCATION_CACHE_H
+
+
+#include "runtime_loader_private.h"
+
+
+class RelocationCache {
+public:
+								RelocationCache();
+								~RelocationCache();
+
+			status_t			Init();
+
+			bool				Lookup(image_t* image, uint32 symbolIndex,
+									const char* name,
+									const elf_version_info* version,
+									elf_sym** _symbol,
+									image_t** _foundInImage);
+			void				Add(image_t* image, uint32 symbolIndex,
+									elf_sym* symbol, image_t* foundInImage);
+
+			void				Save();
+
+private:
+			struct FileHeader;
+			struct ImageRecord;
+			struct Binding;
+
+			int32				_ImageIndex(image_t* image);
+			bool				_Read();
+			void				_Invalidate();
+			void				_RemoveStaleFiles();
+
+private:
+			image_t**			fImages;
+			ImageRecord*		fRecords;
+			uint32				fImageCount;
+			Binding*			fBindings;
+			uint32				fBindingCount;
+			uint32				fBindingCapacity;
+			bool				fValid;
+			bool				fRecording;
+
+			// maps the symbol indices of fCurrentImage to fBindings
+			image_t*			fCurrentImage;
+			uint32*				fCurrentBindings;
+			uint32				fCurrentSymbolCount;
+
+			char				fPath[B_PATH_NAME_LENGTH];
+			size_t				fNameOffset;
+				// of the file name in fPath
+};
+
+
+#endif	// ELF_RELOCATION_CACHE_H
@@ -15,6 +15,7 @@
 #include <string.h>
 
 #include "add_ons.h"
+#include "elf_relocation_cache.h"
 #include "errors.h"
 #include "images.h"
 #include "runtime_loader_private.h"
@@ -41,6 +42,102 @@ equals_image_name(image_t* image, const char* name)
 }
 
 
+static bool
+equals_version(const elf_version_info* a, const elf_version_info* b)
+{
+	if (a == NULL || b == NULL)
+		return a == b;
+
+	if (a->hash != b->hash || strcmp(a->name, b->name) != 0)
+		return false;
+
+	if (a->file_name == NULL || b->file_name == NULL)
+		return a->file_name == b->file_name;
+
+	return strcmp(a->file_name, b->file_name) == 0;
+}
+
+
+/*!	Iterates through the symbols of an image that might match a symbol
+	lookup. If the image has a GNU hash table, it is used in favor of the SysV
+	one: its Bloom filter rejects most lookups for symbols the image doesn't
+	define without touching the hash chains at all, and the hash values
+	stored in the chains spare us most of the string comparisons.
+	The GNU hash table doesn't contain the symbols below its symbol offset,
+	which are usually the local ones, so lookups that allow local symbols
+	always use the SysV hash table.
+*/
+class SymbolHashIterator {
+public:
+	SymbolHashIterator(image_t* image, const SymbolLookupInfo& lookupInfo,
+		bool allowLocal)
+		:
+		fImage(image),
+		fHash(lookupInfo.gnuHash),
+		fIndex(STN_UNDEF),
+		fChain(NULL),
+		fUseGnuHash(image->gnu_hash != NULL && !allowLocal)
+	{
+		const uint32* table = image->gnu_hash;
+		if (!fUseGnuHash) {
+			fIndex = HASHBUCKETS(image)[lookupInfo.hash % HASHTABSIZE(image)];
+			return;
+		}
+
+		uint32 bucketCount = table[0];
+		uint32 symbolOffset = table[1];
+		uint32 bloomSize = table[2];
+		uint32 bloomShift = table[3];
+		const addr_t* bloom = (const addr_t*)(table + 4);
+		const uint32* buckets = (const uint32*)(bloom + bloomSize);
+
+		const uint32 kBloomWordBits = sizeof(addr_t) * 8;
+		addr_t bloomWord = bloom[(fHash / kBloomWordBits) & (bloomSize - 1)];
+		addr_t bloomMask = ((addr_t)1 << (fHash % kBloomWordBits))
+			| ((addr_t)1 << ((fHash >> bloomShift) % kBloomWordBits));
+		if ((bloomWord & bloomMask) != bloomMask)
+			return;
+
+		uint32 index = buckets[fHash % bucketCount];
+		if (index < symbolOffset)
+			return;
+
+		fIndex = index;
+		fChain = buckets + bucketCount - symbolOffset;
+	}
+
+	uint32 Next()
+	{
+		if (!fUseGnuHash) {
+			uint32 index = fIndex;
+			if (index != STN_UNDEF)
+				fIndex = HASHCHAINS(fImage)[index];
+			return index;
+		}
+
+		while (fIndex != STN_UNDEF) {
+			uint32 index = fIndex;
+			uint32 chainHash = fChain[index];
+
+			// the lowest bit marks the end of the chain
+			fIndex = (chainHash & 1) != 0 ? STN_UNDEF : index + 1;
+
+			if (((chainHash ^ fHash) >> 1) == 0)
+				return index;
+		}
+
+		return STN_UNDEF;
+	}
+
+private:
+	image_t*		fImage;
+	uint32			fHash;
+	uint32			fIndex;
+	const uint32*	fChain;
+	bool			fUseGnuHash;
+};
+
+
 // #pragma mark -
 
 
@@ -63,6 +160,19 @@ elf_hash(const char* _name)
 }
 
 
+uint32
+elf_gnu_hash(const char* _name)
+{
+	const uint8* name = (const uint8*)_name;
+
+	uint32 hash = 5381;
+	while (*name)
+		hash = hash * 33 + *name++;
+
+	return hash;
+}
+
+
 void
 patch_defined_symbol(image_t* image, const char* name, void** symbol,
 	int32* type)
@@ -113,10 +223,9 @@ find_symbol(image_t* image, const SymbolLookupInfo& lookupInfo, bool allowLocal)
 	elf_sym* versionedSymbol = NULL;
 	uint32 versionedSymbolCount = 0;
 
-	uint32 bucket = lookupInfo.hash % HASHTABSIZE(image);
+	SymbolHashIterator iterator(image, lookupInfo, allowLocal);
 
-	for (uint32 i = HASHBUCKETS(image)[bucket]; i != STN_UNDEF;
-			i = HASHCHAINS(image)[i]) {
+	for (uint32 i = iterator.Next(); i != STN_UNDEF; i = iterator.Next()) {
 		elf_sym* symbol = &image->syms[i];
 
 		if (symbol->st_shndx != SHN_UNDEF
@@ -475,14 +584,118 @@ find_undefined_symbol_add_on(image_t* rootImage, image_t* image,
 }
 
 
+// #pragma mark - SymbolLookupMemo
+
+
+/*!	Returns whether the result of an undefined symbol lookup on behalf of
+	\a image is the same for all other images that qualify as well. That is
+	the case for the global and the add-on lookup order, as long as the
+	requesting image isn't linked symbolically and isn't the add-on itself.
+*/
+bool
+SymbolLookupMemo::IsMemoizable(image_t* image) const
+{
+	if ((image->flags & RFLAG_SYMBOLIC) != 0)
+		return false;
+
+	if (fRootImage->find_undefined_symbol == find_undefined_symbol_global)
+		return true;
+
+	return fRootImage->find_undefined_symbol == find_undefined_symbol_add_on
+		&& image != fRootImage;
+}
+
+
+bool
+SymbolLookupMemo::Lookup(image_t* image, const SymbolLookupInfo& lookupInfo,
+	elf_sym** _symbol, image_t** _foundInImage) const
+{
+	if (fCount == 0 || !IsMemoizable(image))
+		return false;
+
+	uint32 mask = fTableSize - 1;
+	for (uint32 i = lookupInfo.gnuHash & mask; fEntries[i].name != NULL;
+			i = (i + 1) & mask) {
+		const Entry& entry = fEntries[i];
+		if (entry.hash == lookupInfo.gnuHash && entry.type == lookupInfo.type
+			&& equals_version(entry.version, lookupInfo.version)
+			&& strcmp(entry.name, lookupInfo.name) == 0) {
+			*_symbol = entry.symbol;
+			*_foundInImage = entry.image;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void
+SymbolLookupMemo::Add(image_t* image, const SymbolLookupInfo& lookupInfo,
+	elf_sym* symbol, image_t* foundInImage)
+{
+	if (!IsMemoizable(image))
+		return;
+
+	// keep the load factor below 3/4
+	if ((fCount + 1) * 4 > fTableSize * 3 && !Resize())
+		return;
+
+	uint32 mask = fTableSize - 1;
+	uint32 i = lookupInfo.gnuHash & mask;
+	while (fEntries[i].name != NULL)
+		i = (i + 1) & mask;
+
+	Entry& entry = fEntries[i];
+	entry.name = lookupInfo.name;
+	entry.hash = lookupInfo.gnuHash;
+	entry.type = lookupInfo.type;
+	entry.version = lookupInfo.version;
+	entry.symbol = symbol;
+	entry.image = symbol != NULL ? foundInImage : NULL;
+	fCount++;
+}
+
+
+bool
+SymbolLookupMemo::Resize()
+{
+	uint32 tableSize = fTableSize > 0 ? fTableSize * 2 : 256;
+	Entry* entries = (Entry*)malloc(tableSize * sizeof(Entry));
+	if (entries == NULL)
+		return false;
+
+	memset(entries, 0, tableSize * sizeof(Entry));
+
+	uint32 mask = tableSize - 1;
+	for (uint32 i = 0; i < fTableSize; i++) {
+		if (fEntries[i].name == NULL)
+			continue;
+
+		uint32 index = fEntries[i].hash & mask;
+		while (entries[index].name != NULL)
+			index = (index + 1) & mask;
+		entries[index] = fEntries[i];
+	}
+
+	free(fEntries);
+	fEntries = entries;
+	fTableSize = tableSize;
+	return true;
+}
+
+
+// #pragma mark -
+
+
 int
 resolve_symbol(image_t* rootImage, image_t* image, elf_sym* sym,
 	SymbolLookupCache* cache, addr_t* symAddress, image_t** symbolImage)
 {
 	uint32 index = sym - image->syms;
 
-	// check the cache first
-	if (cache->IsSymbolValueCached(index)) {
+	// check the cache first (there is none when binding lazily)
+	if (cache != NULL && cache->IsSymbolValueCached(index)) {
 		*symAddress = cache->SymbolValueAt(index, symbolImage);
 		return B_OK;
 	}
@@ -509,9 +722,25 @@ resolve_symbol(image_t* rootImage, image_t* image, elf_sym* sym,
 				versionInfo = image->versions + versionIndex;
 		}
 
-		// search the symbol
-		sharedSym = rootImage->find_undefined_symbol(rootImage, image,
-			SymbolLookupInfo(symName, type, versionInfo, 0, sym), &sharedImage);
+		// search the symbol, unless we've already done so for another image
+		// or during an earlier start of the program
+		RelocationCache* relocationCache
+			= cache != NULL ? cache->GetRelocationCache() : NULL;
+		if (relocationCache == NULL || !relocationCache->Lookup(image, index,
+				symName, versionInfo, &sharedSym, &sharedImage)) {
+			SymbolLookupInfo lookupInfo(symName, type, versionInfo, 0, sym);
+			SymbolLookupMemo* memo = cache != NULL ? cache->Memo() : NULL;
+			if (memo == NULL
+				|| !memo->Lookup(image, lookupInfo, &sharedSym, &sharedImage)) {
+				sharedSym = rootImage->find_undefined_symbol(rootImage, image,
+					lookupInfo, &sharedImage);
+				if (memo != NULL)
+					memo->Add(image, lookupInfo, sharedSym, sharedImage);
+			}
+
+			if (relocationCache != NULL)
+				relocationCache->Add(image, index, sharedSym, sharedImage);
+		}
 	}
 
 	enum {
@@ -586,7 +815,8 @@ resolve_symbol(image_t* rootImage, image_t* image, elf_sym* sym,
 		return B_MISSING_SYMBOL;
 	}
 
-	cache->SetSymbolValueAt(index, (addr_t)location, sharedImage);
+	if (cache != NULL)
+		cache->SetSymbolValueAt(index, (addr_t)location, sharedImage);
 
 	if (symbolImage)
 		*symbolImage = sharedImage;
@@ -12,17 +12,21 @@
 #include <runtime_loader.h>
 
 
+class RelocationCache;
+
 // values for SymbolLookupInfo::flags
 #define LOOKUP_FLAG_DEFAULT_VERSION	0x01
 
 
 uint32 elf_hash(const char* name);
+uint32 elf_gnu_hash(const char* name);
 
 
 struct SymbolLookupInfo {
 	const char*				name;
 	int32					type;
 	uint32					hash;
+	uint32					gnuHash;
 	uint32					flags;
 	const elf_version_info*	version;
 	elf_sym*				requestingSymbol;
@@ -34,6 +38,7 @@ struct SymbolLookupInfo {
 		name(name),
 		type(type),
 		hash(hash),
+		gnuHash(elf_gnu_hash(name)),
 		flags(flags),
 		version(version),
 		requestingSymbol(requestingSymbol)
@@ -47,6 +52,7 @@ struct SymbolLookupInfo {
 		name(name),
 		type(type),
 		hash(elf_hash(name)),
+		gnuHash(elf_gnu_hash(name)),
 		flags(flags),
 		version(version),
 		requestingSymbol(requestingSymbol)
@@ -55,9 +61,58 @@ struct SymbolLookupInfo {
 };
 
 
+/*!	Remembers the results of undefined symbol lookups during the relocation
+	of a set of images, so that symbols referenced by many images (like
+	operator new or the libbe classes) have to be searched for only once.
+	The memo is only valid as long as the set of loaded images and their
+	flags don't change.
+*/
+struct SymbolLookupMemo {
+	SymbolLookupMemo(image_t* rootImage)
+		:
+		fRootImage(rootImage),
+		fEntries(NULL),
+		fTableSize(0),
+		fCount(0)
+	{
+	}
+
+	~SymbolLookupMemo()
+	{
+		free(fEntries);
+	}
+
+	bool Lookup(image_t* image, const SymbolLookupInfo& lookupInfo,
+		elf_sym** _symbol, image_t** _foundInImage) const;
+	void Add(image_t* image, const SymbolLookupInfo& lookupInfo,
+		elf_sym* symbol, image_t* foundInImage);
+
+private:
+	struct Entry {
+		const char*				name;
+		uint32					hash;
+		int32					type;
+		const elf_version_info*	version;
+		elf_sym*				symbol;
+		image_t*				image;
+	};
+
+	bool IsMemoizable(image_t* image) const;
+	bool Resize();
+
+	image_t*	fRootImage;
+	Entry*		fEntries;
+	uint32		fTableSize;
+	uint32		fCount;
+};
+
+
 struct SymbolLookupCache {
-	SymbolLookupCache(image_t* image)
+	SymbolLookupCache(image_t* image, SymbolLookupMemo* memo = NULL,
+		RelocationCache* relocationCache = NULL)
 		:
+		fMemo(memo),
+		fRelocationCache(relocationCache),
 		fTableSize(image->symhash != NULL ? image->symhash[1] : 0),
 		fValues(NULL),
 		fDSOs(NULL),
@@ -118,7 +173,19 @@ struct SymbolLookupCache {
 		}
 	}
 
+	SymbolLookupMemo* Memo() const
+	{
+		return fMemo;
+	}
+
+	RelocationCache* GetRelocationCache() const
+	{
+		return fRelocationCache;
+	}
+
 private:
+	SymbolLookupMemo* fMemo;
+	RelocationCache* fRelocationCache;
 	size_t		fTableSize;
 	addr_t*		fValues;
 	image_t**	fDSOs;
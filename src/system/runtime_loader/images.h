@@ -28,8 +28,10 @@ enum {
 	RFLAG_REMAPPED				= 0x8000,
 
 	RFLAG_VISITED				= 0x10000,
-	RFLAG_USE_FOR_RESOLVING		= 0x20000
+	RFLAG_USE_FOR_RESOLVING		= 0x20000,
 		// temporarily set in the symbol resolution code
+	RFLAG_BIND_NOW				= 0x40000
+		// the image must not be bound lazily (DT_BIND_NOW, DF_BIND_NOW)
 };
 
 
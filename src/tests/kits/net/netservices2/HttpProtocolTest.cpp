@@ -8,6 +8,11 @@
 
 #include "HttpProtocolTest.h"
 
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
 #include <cppunit/TestAssert.h>
 #include <cppunit/TestCaller.h>
 #include <cppunit/TestSuite.h>
@@ -278,7 +283,6 @@ HttpProtocolTest::HttpMethodTest()
 constexpr std::string_view kExpectedRequestText = "GET / HTTP/1.1\r\n"
 												  "Host: www.haiku-os.org\r\n"
 												  "Accept-Encoding: gzip\r\n"
-												  "Connection: close\r\n"
 												  "Api-Key: 01234567890abcdef\r\n\r\n";
 
 
@@ -403,6 +407,8 @@ HttpIntegrationTest::HttpIntegrationTest(TestServerMode mode)
 		fLogger->SetConsoleLogging(LOG_TO_CONSOLE);
 		if (mode == TestServerMode::Http)
 			fLogger->SetFileLogging("http-messages.log");
+		else if (mode == TestServerMode::HttpKeepAlive)
+			fLogger->SetFileLogging("http-keepalive-messages.log");
 		else
 			fLogger->SetFileLogging("https-messages.log");
 		fLogger->Run();
@@ -482,6 +488,21 @@ HttpIntegrationTest::AddTests(BTestSuite& parent)
 		suite.addTest(testCaller);
 		parent.addTest("HttpsIntegrationTest", &suite);
 	}
+
+	// Http with persistent connections
+	{
+		CppUnit::TestSuite& suite = *new CppUnit::TestSuite("HttpKeepAliveTest");
+
+		HttpIntegrationTest* keepAliveTest = new HttpIntegrationTest(TestServerMode::HttpKeepAlive);
+		BThreadedTestCaller<HttpIntegrationTest>* testCaller
+			= new BThreadedTestCaller<HttpIntegrationTest>("HttpKeepAliveTest::", keepAliveTest);
+
+		testCaller->addThread("KeepAliveTest", &HttpIntegrationTest::KeepAliveTest);
+		testCaller->addThread("ManySmallRequestsTest", &HttpIntegrationTest::ManySmallRequestsTest);
+
+		suite.addTest(testCaller);
+		parent.addTest("HttpKeepAliveTest", &suite);
+	}
 }
 
 
@@ -519,7 +540,7 @@ static const BHttpFields kExpectedGetFields = {
 	{"Server"sv, "Test HTTP Server for Haiku"sv},
 	{"Date"sv, "Sun, 09 Feb 2020 19:32:42 GMT"sv},
 	{"Content-Type"sv, "text/plain"sv},
-	{"Content-Length"sv, "107"sv},
+	{"Content-Length"sv, "88"sv},
 	{"Content-Encoding"sv, "gzip"sv},
 };
 
@@ -529,8 +550,7 @@ constexpr std::string_view kExpectedGetBody = {"Path: /\r\n"
 											   "Headers:\r\n"
 											   "--------\r\n"
 											   "Host: 127.0.0.1:PORT\r\n"
-											   "Accept-Encoding: gzip\r\n"
-											   "Connection: close\r\n"};
+											   "Accept-Encoding: gzip\r\n"};
 
 
 void
@@ -744,7 +764,6 @@ static BString kExpectedPostBody = BString().SetToFormat("Path: /post\r\n"
 														 "--------\r\n"
 														 "Host: 127.0.0.1:PORT\r\n"
 														 "Accept-Encoding: gzip\r\n"
-														 "Connection: close\r\n"
 														 "Content-Type: text/plain\r\n"
 														 "Content-Length: 1083\r\n"
 														 "\r\n"
@@ -880,3 +899,79 @@ HttpIntegrationTest::PostTest()
 
 	observer->Quit();
 }
+
+
+static int32
+connection_request(const BHttpResult& result)
+{
+	auto field = result.Fields().FindField("X-Connection-Request"sv);
+	if (field == result.Fields().end())
+		return 0;
+
+	return atoi(std::string((*field).Value()).c_str());
+}
+
+
+void
+HttpIntegrationTest::KeepAliveTest()
+{
+	// Sequential requests to the same host should share a connection
+	int32 maxConnectionRequest = 0;
+	for (int i = 0; i < 10; i++) {
+		auto request = BHttpRequest(BUrl(fTestServer.BaseUrl(), "/"));
+		auto result = fSession.Execute(std::move(request), nullptr, fLoggerMessenger);
+		try {
+			CPPUNIT_ASSERT_EQUAL(200, result.Status().code);
+			CPPUNIT_ASSERT_EQUAL(kExpectedGetBody, result.Body().text.value().String());
+			maxConnectionRequest = std::max(maxConnectionRequest, connection_request(result));
+		} catch (const BPrivate::Network::BError& e) {
+			CPPUNIT_FAIL(e.DebugMessage().String());
+		}
+	}
+
+	CPPUNIT_ASSERT_MESSAGE("Expected the connection to be reused", maxConnectionRequest > 1);
+}
+
+
+static bigtime_t
+execute_many_requests(BHttpSession& session, const BUrl& baseUrl, int count)
+{
+	bigtime_t start = system_time();
+
+	std::vector<BHttpResult> results;
+	results.reserve(count);
+	for (int i = 0; i < count; i++)
+		results.push_back(session.Execute(BHttpRequest(BUrl(baseUrl, "/"))));
+
+	for (auto& result: results) {
+		try {
+			CPPUNIT_ASSERT_EQUAL(200, result.Status().code);
+			CPPUNIT_ASSERT_EQUAL(kExpectedGetBody, result.Body().text.value().String());
+		} catch (const BPrivate::Network::BError& e) {
+			CPPUNIT_FAIL(e.DebugMessage().String());
+		}
+	}
+
+	return system_time() - start;
+}
+
+
+void
+HttpIntegrationTest::ManySmallRequestsTest()
+{
+	// Many concurrent requests to the same host are spread over the existing
+	// connections, and pipelined if the server keeps them open. This is not
+	// a benchmark, but the timings are printed to make regressions visible.
+	static const int kRequestCount = 200;
+
+	bigtime_t pipelined = execute_many_requests(fSession, fTestServer.BaseUrl(), kRequestCount);
+
+	BHttpSession session;
+	session.SetMaxConnectionsPerHost(4);
+	session.SetMaxPipelinedRequests(1);
+	bigtime_t sequential = execute_many_requests(session, fTestServer.BaseUrl(), kRequestCount);
+
+	printf("\n%d requests: %.0f requests/s pipelined, %.0f requests/s without pipelining\n",
+		kRequestCount, kRequestCount * 1000000.0 / pipelined,
+		kRequestCount * 1000000.0 / sequential);
+}
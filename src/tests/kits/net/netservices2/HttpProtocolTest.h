@@ -49,6 +49,8 @@ public:
 			void				StopOnErrorTest();
 			void				RequestCancelTest();
 			void				PostTest();
+			void				KeepAliveTest();
+			void				ManySmallRequestsTest();
 
 	static	void				AddTests(BTestSuite& suite);
 
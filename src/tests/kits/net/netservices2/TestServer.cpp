@@ -241,6 +241,8 @@ TestServer::Start()
 
 	if (fMode == TestServerMode::Https) {
 		child_process_args.push_back("--use-tls");
+	} else if (fMode == TestServerMode::HttpKeepAlive) {
+		child_process_args.push_back("--keep-alive");
 	}
 
 	// After this the child process has started. It may take a short amount of
@@ -260,6 +262,7 @@ TestServer::BaseUrl() const
 	std::string scheme;
 	switch (fMode) {
 		case TestServerMode::Http:
+		case TestServerMode::HttpKeepAlive:
 			scheme = "http://";
 			break;
 
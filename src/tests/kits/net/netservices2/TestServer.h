@@ -49,6 +49,7 @@ private:
 enum class TestServerMode {
 	Http,
 	Https,
+	HttpKeepAlive,
 };
 
 
@@ -299,6 +299,29 @@ class RequestHandler(http.server.BaseHTTPRequestHandler):
         return True, extra_headers
 
 
+class KeepAliveRequestHandler(RequestHandler):
+    """
+    Speaks HTTP/1.1 and keeps connections open between requests. Every
+    response carries an X-Connection-Request header that counts the requests
+    that were served on the same connection, so that the tests can verify
+    that the client reuses its connections.
+    """
+    protocol_version = 'HTTP/1.1'
+
+    def setup(self):
+        super().setup()
+        self.connection_requests = 0
+
+    def handle_one_request(self):
+        self.connection_requests += 1
+        super().handle_one_request()
+
+    def send_response(self, code, message=None):
+        super().send_response(code, message)
+        self.send_header(
+            'X-Connection-Request', str(self.connection_requests))
+
+
 class ResponseBodyBuilder(object):
     __meta__ = abc.ABCMeta
 
@@ -455,10 +478,18 @@ def main():
         options.bind_addr,
         0 if options.port is None else options.port)
 
-    server = http.server.HTTPServer(
-        bind_addr,
-        RequestHandler,
-        bind_and_activate=False)
+    if options.keep_alive:
+        # Persistent connections would block all other clients of a single
+        # threaded server.
+        server = http.server.ThreadingHTTPServer(
+            bind_addr,
+            KeepAliveRequestHandler,
+            bind_and_activate=False)
+    else:
+        server = http.server.HTTPServer(
+            bind_addr,
+            RequestHandler,
+            bind_and_activate=False)
     if options.port is None:
         server.server_port = server.socket.getsockname()[1]
     else:
@@ -519,6 +550,12 @@ def parse_args(argv):
         action='store_true',
         help='If set, a self-signed TLS certificate, key and CA will be'
         ' generated for testing purposes.')
+    parser.add_option(
+        '--keep-alive',
+        dest='keep_alive',
+        default=False,
+        action='store_true',
+        help='If set, the server speaks HTTP/1.1 and keeps connections open')
     parser.add_option(
         '--port',
         dest='port',
@@ -19,6 +19,7 @@
 #include "RandomLineTest.h"
 #include "StringTest.h"
 #include "VerticalLineTest.h"
+#include "WidgetTest.h"
 
 
 struct test_info {
@@ -31,6 +32,7 @@ const test_info kTestInfos[] = {
 	{ "RandomLines",		RandomLineTest::CreateTest },
 	{ "Strings",			StringTest::CreateTest },
 	{ "VerticalLines",		VerticalLineTest::CreateTest },
+	{ "Widgets",			WidgetTest::CreateTest },
 	{ NULL, NULL }
 };
 
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Redraws a grid of button-like widgets, each made of a few small fills,
+	lines and a label with color changes in between, like the controls of
+	a typical window do. The view is synced after every redraw, so that the
+	whole round trip to the app_server is measured, and not just how fast
+	the commands can be queued.
+*/
+
+#include "WidgetTest.h"
+
+#include <stdio.h>
+
+#include <View.h>
+
+
+static const float kWidgetWidth = 80;
+static const float kWidgetHeight = 24;
+static const float kWidgetSpacing = 4;
+
+
+WidgetTest::WidgetTest()
+	: Test(),
+	  fTestDuration(0),
+	  fTestStart(-1),
+
+	  fWidgetsRendered(0),
+
+	  fIterations(0),
+	  fMaxIterations(1500),
+
+	  fViewBounds(0, 0, -1, -1),
+	  fTextBaseline(0)
+{
+}
+
+
+WidgetTest::~WidgetTest()
+{
+}
+
+
+void
+WidgetTest::Prepare(BView* view)
+{
+	fViewBounds = view->Bounds();
+
+	font_height fontHeight;
+	view->GetFontHeight(&fontHeight);
+	fTextBaseline = floorf((kWidgetHeight + fontHeight.ascent
+		- fontHeight.descent) / 2);
+
+	fTestDuration = 0;
+	fWidgetsRendered = 0;
+	fIterations = 0;
+	fTestStart = system_time();
+}
+
+
+bool
+WidgetTest::RunIteration(BView* view)
+{
+	bigtime_t now = system_time();
+
+	uint32 index = fIterations;
+	for (float y = fViewBounds.top + kWidgetSpacing;
+			y + kWidgetHeight <= fViewBounds.bottom;
+			y += kWidgetHeight + kWidgetSpacing) {
+		for (float x = fViewBounds.left + kWidgetSpacing;
+				x + kWidgetWidth <= fViewBounds.right;
+				x += kWidgetWidth + kWidgetSpacing) {
+			BRect frame(x, y, x + kWidgetWidth - 1, y + kWidgetHeight - 1);
+			_DrawWidget(view, frame, (index++ % 7) == 0);
+			fWidgetsRendered++;
+		}
+	}
+
+	view->Sync();
+
+	fTestDuration += system_time() - now;
+	fIterations++;
+
+	return fIterations < fMaxIterations;
+}
+
+
+void
+WidgetTest::PrintResults(BView* view)
+{
+	if (fTestDuration == 0) {
+		printf("Test was not run.\n");
+		return;
+	}
+	bigtime_t timeLeak = system_time() - fTestStart - fTestDuration;
+
+	Test::PrintResults(view);
+
+	printf("Widgets per iteration: %llu\n", fWidgetsRendered / fIterations);
+	printf("Total widgets rendered: %llu\n", fWidgetsRendered);
+	printf("Widgets per second: %.3f\n",
+		fWidgetsRendered * 1000000.0 / fTestDuration);
+	printf("Average redraw time, including the round trip: %.4f ms\n",
+		(float)fTestDuration / fIterations / 1000);
+	printf("Average time between iterations: %.4f seconds.\n",
+		(float)timeLeak / fIterations / 1000000);
+}
+
+
+Test*
+WidgetTest::CreateTest()
+{
+	return new WidgetTest();
+}
+
+
+void
+WidgetTest::_DrawWidget(BView* view, BRect frame, bool pressed)
+{
+	rgb_color base = { 216, 216, 216, 255 };
+	rgb_color light = { 255, 255, 255, 255 };
+	rgb_color shadow = { 152, 152, 152, 255 };
+	rgb_color text = { 0, 0, 0, 255 };
+
+	// frame
+	view->SetHighColor(shadow);
+	view->StrokeRect(frame);
+	frame.InsetBy(1, 1);
+
+	// bevel
+	view->SetHighColor(pressed ? shadow : light);
+	view->StrokeLine(frame.LeftBottom(), frame.LeftTop());
+	view->StrokeLine(frame.RightTop());
+	view->SetHighColor(pressed ? light : shadow);
+	view->StrokeLine(frame.RightBottom());
+	view->StrokeLine(frame.LeftBottom());
+	frame.InsetBy(1, 1);
+
+	// background
+	view->SetHighColor(pressed ? shadow : base);
+	view->FillRect(frame);
+
+	// label
+	view->SetHighColor(text);
+	view->SetLowColor(pressed ? shadow : base);
+	view->DrawString("Button", BPoint(frame.left + 8,
+		frame.top - 2 + fTextBaseline));
+}
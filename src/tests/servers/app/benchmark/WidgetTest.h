@@ -0,0 +1,38 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef WIDGET_TEST_H
+#define WIDGET_TEST_H
+
+#include <Rect.h>
+
+#include "Test.h"
+
+class WidgetTest : public Test {
+public:
+								WidgetTest();
+	virtual						~WidgetTest();
+
+	virtual	void				Prepare(BView* view);
+	virtual	bool				RunIteration(BView* view);
+	virtual	void				PrintResults(BView* view);
+
+	static	Test*				CreateTest();
+
+private:
+			void				_DrawWidget(BView* view, BRect frame,
+									bool pressed);
+
+			bigtime_t			fTestDuration;
+			bigtime_t			fTestStart;
+			uint64				fWidgetsRendered;
+
+			uint32				fIterations;
+			uint32				fMaxIterations;
+
+			BRect				fViewBounds;
+			float				fTextBaseline;
+};
+
+#endif // WIDGET_TEST_H
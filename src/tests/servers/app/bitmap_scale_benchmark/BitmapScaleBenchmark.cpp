@@ -0,0 +1,345 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Scales rows of a bitmap like the bilinear and nearest neighbor bitmap
+	painters do, and reports how many pixels per second the scalar loops and
+	the SSE2 and AVX2 versions manage. Before that, random rows are scaled
+	with all versions, and the results are compared pixel by pixel, since
+	the SIMD versions must not change a single pixel.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include "DrawBitmapBilinear.h"
+
+
+using namespace BitmapPainterPrivate;
+
+
+extern uint32 gSIMDFlags;
+
+
+static const int32 kSourceWidth = 300;
+static const int32 kSourceHeight = 2;
+static const int32 kWidth = 1024;
+static const int32 kRandomRows = 20000;
+
+
+enum scale_mode {
+	kBilinearCopy,
+	kBilinearAlphaOverlay,
+	kNearestNeighbor
+};
+
+
+struct Scenario {
+	const char*		name;
+	scale_mode		mode;
+};
+
+
+static const Scenario kScenarios[] = {
+	{ "bilinear, B_OP_COPY", kBilinearCopy },
+	{ "bilinear, B_OP_ALPHA", kBilinearAlphaOverlay },
+	{ "nearest neighbor, B_OP_COPY", kNearestNeighbor }
+};
+static const int32 kScenarioCount = sizeof(kScenarios) / sizeof(kScenarios[0]);
+
+
+struct Version {
+	const char*		name;
+	uint32			flags;
+		// the SIMD flags that are cleared for this version
+};
+
+
+static const Version kVersions[] = {
+	{ "scalar", APPSERVER_SIMD_SSE2 | APPSERVER_SIMD_AVX2 },
+	{ "SSE2", APPSERVER_SIMD_AVX2 },
+	{ "AVX2", 0 }
+};
+static const int32 kVersionCount = sizeof(kVersions) / sizeof(kVersions[0]);
+
+
+/*!	The inner loop of BilinearDefault, for a row that is not the last one.
+*/
+template<class ColorType, class DrawMode>
+static void
+bilinear_scale_row(uint8* d, const uint8* src, uint32 bytesPerRow,
+	const FilterInfo* weightsX, int32 count, uint16 wTop)
+{
+	const uint16 wBottom = 255 - wTop;
+
+	int32 x = bilinear_scale_row_simd(d, src, bytesPerRow, weightsX, count,
+		wTop, DrawMode::kSIMDMode);
+	d += x * 4;
+
+	for (; x < count; x++) {
+		const uint8* s = src + weightsX[x].index;
+		const uint16 wLeft = weightsX[x].weight;
+		const uint16 wRight = 255 - wLeft;
+
+		uint32 t[4];
+		ColorType::Interpolate(&t[0], s, bytesPerRow, wLeft, wTop, wRight,
+			wBottom);
+		DrawMode::Blend(d, &t[0]);
+	}
+}
+
+
+/*!	The inner loop of DrawBitmapNearestNeighborCopy.
+*/
+static void
+nearest_neighbor_scale_row(uint32* d, const uint8* src,
+	const uint16* indices, int32 count)
+{
+	int32 x = nearest_neighbor_scale_row_simd(d, src, indices, count);
+	d += x;
+
+	for (; x < count; x++)
+		*d++ = *(uint32*)(src + indices[x]);
+}
+
+
+/*!	Random values with a bias towards fully transparent and fully opaque,
+	since these are special cases in the alpha overlay mode.
+*/
+static uint8
+random_alpha()
+{
+	switch (rand() % 8) {
+		case 0:
+			return 0;
+		case 1:
+		case 2:
+			return 255;
+		default:
+			return rand() & 0xff;
+	}
+}
+
+
+class RowScaler {
+public:
+	RowScaler()
+	{
+		fBytesPerRow = (kSourceWidth + 1) * 4;
+		fSource = new uint8[fBytesPerRow * kSourceHeight];
+		fBits = new uint32[kWidth];
+		fBackground = new uint32[kWidth];
+
+		Randomize();
+	}
+
+	~RowScaler()
+	{
+		delete[] fSource;
+		delete[] fBits;
+		delete[] fBackground;
+	}
+
+	uint32* Bits()
+	{
+		return fBits;
+	}
+
+	size_t BitsLength() const
+	{
+		return kWidth * 4;
+	}
+
+	void Randomize()
+	{
+		for (uint32 i = 0; i < fBytesPerRow * kSourceHeight; i++)
+			fSource[i] = i % 4 == 3 ? random_alpha() : rand() & 0xff;
+
+		for (int32 i = 0; i < kWidth; i++) {
+			// the last source column is never the left one of a pair
+			fWeightsX[i].index = (rand() % (kSourceWidth - 1)) * 4;
+			fWeightsX[i].weight = rand() % 8 == 0 ? 255 : rand() & 0xff;
+			fIndices[i] = fWeightsX[i].index;
+			fBackground[i] = rand() ^ (rand() << 16);
+		}
+		fTopWeight = rand() & 0xff;
+	}
+
+	void SetUpScaling()
+	{
+		// a steady up-scaling, like the painters would compute it
+		for (int32 i = 0; i < kWidth; i++) {
+			float index = (float)i * (kSourceWidth - 1) / kWidth;
+			fWeightsX[i].index = (uint16)index * 4;
+			fWeightsX[i].weight = 255 - (uint16)((index - (uint16)index) * 255);
+			fIndices[i] = fWeightsX[i].index;
+		}
+	}
+
+	void Clear()
+	{
+		memcpy(fBits, fBackground, BitsLength());
+	}
+
+	void Scale(scale_mode mode, int32 count, uint16 topWeight)
+	{
+		switch (mode) {
+			case kBilinearCopy:
+				bilinear_scale_row<ColorTypeRgb, DrawModeCopy>((uint8*)fBits,
+					fSource, fBytesPerRow, fWeightsX, count, topWeight);
+				break;
+			case kBilinearAlphaOverlay:
+				bilinear_scale_row<ColorTypeRgba, DrawModeAlphaOverlay>(
+					(uint8*)fBits, fSource, fBytesPerRow, fWeightsX, count,
+					topWeight);
+				break;
+			case kNearestNeighbor:
+				nearest_neighbor_scale_row(fBits, fSource, fIndices, count);
+				break;
+		}
+	}
+
+	uint16 TopWeight() const
+	{
+		return fTopWeight;
+	}
+
+private:
+	uint8*				fSource;
+	uint32				fBytesPerRow;
+	uint32*				fBits;
+	uint32*				fBackground;
+	FilterInfo			fWeightsX[kWidth];
+	uint16				fIndices[kWidth];
+	uint16				fTopWeight;
+};
+
+
+/*!	Scales the same random rows with every available version, and makes sure
+	they all produce the same pixels as the scalar version.
+*/
+static bool
+check_scenario(RowScaler& scaler, const Scenario& scenario,
+	uint32 availableFlags)
+{
+	uint8* expected = new uint8[scaler.BitsLength()];
+	bool success = true;
+
+	for (int32 row = 0; row < kRandomRows && success; row++) {
+		scaler.Randomize();
+		int32 count = 1 + rand() % kWidth;
+
+		for (int32 i = 0; i < kVersionCount; i++) {
+			gSIMDFlags = availableFlags & ~kVersions[i].flags;
+			if (i > 0
+				&& gSIMDFlags == (availableFlags & ~kVersions[i - 1].flags)) {
+				continue;
+			}
+
+			scaler.Clear();
+			scaler.Scale(scenario.mode, count, scaler.TopWeight());
+
+			if (i == 0) {
+				memcpy(expected, scaler.Bits(), scaler.BitsLength());
+				continue;
+			}
+
+			if (memcmp(expected, scaler.Bits(), scaler.BitsLength()) != 0) {
+				fprintf(stderr, "%s: the %s version differs from the scalar "
+					"one!\n", scenario.name, kVersions[i].name);
+				success = false;
+			}
+		}
+	}
+
+	delete[] expected;
+	return success;
+}
+
+
+static void
+benchmark_scenario(RowScaler& scaler, const Scenario& scenario,
+	uint32 availableFlags, int32 iterations)
+{
+	scaler.SetUpScaling();
+
+	printf("%s\n", scenario.name);
+
+	bigtime_t scalarTime = 0;
+	for (int32 i = 0; i < kVersionCount; i++) {
+		gSIMDFlags = availableFlags & ~kVersions[i].flags;
+		if (i > 0 && gSIMDFlags == (availableFlags & ~kVersions[i - 1].flags))
+			continue;
+
+		scaler.Clear();
+
+		bigtime_t start = system_time();
+		for (int32 j = 0; j < iterations; j++)
+			scaler.Scale(scenario.mode, kWidth, j & 0xff);
+		bigtime_t time = max_c(system_time() - start, 1);
+
+		if (i == 0)
+			scalarTime = time;
+
+		double pixels = (double)kWidth * iterations;
+		printf("  %-8s %8.1f Mpixels/s (%.2fx)\n", kVersions[i].name,
+			pixels / time, (double)scalarTime / time);
+	}
+}
+
+
+static void
+usage()
+{
+	fprintf(stderr, "Usage: bitmap_scale_benchmark [-i iterations]\n");
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 iterations = 20000;
+
+	int option;
+	while ((option = getopt(argc, argv, "i:")) != -1) {
+		switch (option) {
+			case 'i':
+				iterations = atol(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (iterations <= 0 || optind != argc)
+		usage();
+
+	uint32 availableFlags = gSIMDFlags;
+	if ((availableFlags & APPSERVER_SIMD_SSE2) == 0)
+		printf("This CPU does not support SSE2, only the scalar version "
+			"is used.\n");
+	else if ((availableFlags & APPSERVER_SIMD_AVX2) == 0)
+		printf("This CPU does not support AVX2.\n");
+
+	RowScaler scaler;
+	bool success = true;
+
+	srand(1);
+	for (int32 i = 0; i < kScenarioCount; i++) {
+		if (!check_scenario(scaler, kScenarios[i], availableFlags))
+			success = false;
+	}
+
+	for (int32 i = 0; i < kScenarioCount; i++)
+		benchmark_scenario(scaler, kScenarios[i], availableFlags, iterations);
+
+	gSIMDFlags = availableFlags;
+	return success ? 0 : 1;
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Blends spans with the app_server's PixelFormat in the drawing modes that
+	have SSE2 and AVX2 versions, and reports how many pixels per second the
+	scalar and each of the SIMD versions manage. Before that, random spans are
+	blended with all versions, and the results are compared pixel by pixel,
+	since the SIMD versions must not change a single pixel.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include "Painter.h"
+#include "PatternHandler.h"
+#include "PixelFormat.h"
+
+
+extern uint32 gSIMDFlags;
+
+
+typedef PixelFormat::color_type color_type;
+
+
+static const int32 kWidth = 1024;
+static const int32 kHeight = 64;
+static const int32 kRandomSpans = 20000;
+
+
+struct Scenario {
+	const char*		name;
+	drawing_mode	mode;
+	bool			solid;
+		// blend_solid_hspan() instead of blend_color_hspan()
+	bool			covers;
+	uint8			cover;
+		// used if there are no covers
+};
+
+
+static const Scenario kScenarios[] = {
+	{ "B_OP_ALPHA, colors", B_OP_ALPHA, false, true, 255 },
+	{ "B_OP_ALPHA, colors, one cover", B_OP_ALPHA, false, false, 160 },
+	{ "B_OP_ALPHA, solid", B_OP_ALPHA, true, true, 255 },
+	{ "B_OP_OVER, colors", B_OP_OVER, false, true, 255 },
+	{ "B_OP_OVER, colors, one cover", B_OP_OVER, false, false, 160 },
+	{ "B_OP_OVER, solid", B_OP_OVER, true, true, 255 },
+	{ "B_OP_COPY, colors", B_OP_COPY, false, false, 255 },
+	{ "B_OP_COPY, solid", B_OP_COPY, true, true, 255 }
+};
+static const int32 kScenarioCount = sizeof(kScenarios) / sizeof(kScenarios[0]);
+
+
+struct Version {
+	const char*		name;
+	uint32			flags;
+		// the SIMD flags that are cleared for this version
+};
+
+
+static const Version kVersions[] = {
+	{ "scalar", APPSERVER_SIMD_SSE2 | APPSERVER_SIMD_AVX2 },
+	{ "SSE2", APPSERVER_SIMD_AVX2 },
+	{ "AVX2", 0 }
+};
+static const int32 kVersionCount = sizeof(kVersions) / sizeof(kVersions[0]);
+
+
+struct Span {
+	int32	x;
+	int32	y;
+	int32	length;
+};
+
+
+/*!	Random values with a bias towards fully transparent and fully opaque,
+	since these are special cases in all drawing modes.
+*/
+static uint8
+random_alpha()
+{
+	switch (rand() % 8) {
+		case 0:
+			return 0;
+		case 1:
+		case 2:
+			return 255;
+		default:
+			return rand() & 0xff;
+	}
+}
+
+
+class SpanBlender {
+public:
+	SpanBlender()
+		:
+		fPixelFormat(fBuffer, &fPatternHandler)
+	{
+		fBits = new uint32[kWidth * kHeight];
+		fBuffer.attach((uint8*)fBits, kWidth, kHeight, kWidth * 4);
+
+		for (int32 i = 0; i < kWidth; i++) {
+			fColors[i] = color_type(rand() & 0xff, rand() & 0xff,
+				rand() & 0xff, random_alpha());
+			fCovers[i] = random_alpha();
+		}
+	}
+
+	~SpanBlender()
+	{
+		delete[] fBits;
+	}
+
+	uint32* Bits()
+	{
+		return fBits;
+	}
+
+	size_t BitsLength() const
+	{
+		return kWidth * kHeight * 4;
+	}
+
+	void Clear()
+	{
+		// always the same background, without disturbing rand()
+		uint32 value = 42;
+		for (int32 i = 0; i < kWidth * kHeight; i++) {
+			value = value * 1103515245 + 12345;
+			fBits[i] = value;
+		}
+	}
+
+	void SetScenario(const Scenario& scenario)
+	{
+		fScenario = scenario;
+		fPixelFormat.SetDrawingMode(scenario.mode, B_PIXEL_ALPHA,
+			B_ALPHA_OVERLAY);
+	}
+
+	void Blend(const Span* spans, int32 count)
+	{
+		for (int32 i = 0; i < count; i++) {
+			const Span& span = spans[i];
+			if (fScenario.solid) {
+				fPixelFormat.blend_solid_hspan(span.x, span.y, span.length,
+					fColors[span.y], fCovers + span.x);
+			} else {
+				fPixelFormat.blend_color_hspan(span.x, span.y, span.length,
+					fColors + span.x,
+					fScenario.covers ? fCovers + span.x : NULL,
+					fScenario.cover);
+			}
+		}
+	}
+
+private:
+	uint32*				fBits;
+	agg::rendering_buffer fBuffer;
+	PatternHandler		fPatternHandler;
+	PixelFormat			fPixelFormat;
+	Scenario			fScenario;
+	color_type			fColors[kWidth];
+	uint8				fCovers[kWidth];
+};
+
+
+/*!	Blends the same random spans with every available version, and makes sure
+	they all produce the same pixels as the scalar version.
+*/
+static bool
+check_scenario(SpanBlender& blender, const Scenario& scenario,
+	uint32 availableFlags)
+{
+	Span* spans = new Span[kRandomSpans];
+	for (int32 i = 0; i < kRandomSpans; i++) {
+		spans[i].y = rand() % kHeight;
+		spans[i].length = 1 + rand() % kWidth;
+		spans[i].x = rand() % (kWidth - spans[i].length + 1);
+	}
+
+	uint8* expected = new uint8[blender.BitsLength()];
+	bool success = true;
+
+	for (int32 i = 0; i < kVersionCount; i++) {
+		gSIMDFlags = availableFlags & ~kVersions[i].flags;
+		if (i > 0 && gSIMDFlags == (availableFlags & ~kVersions[i - 1].flags))
+			continue;
+
+		blender.Clear();
+		blender.SetScenario(scenario);
+		blender.Blend(spans, kRandomSpans);
+
+		if (i == 0) {
+			memcpy(expected, blender.Bits(), blender.BitsLength());
+			continue;
+		}
+
+		if (memcmp(expected, blender.Bits(), blender.BitsLength()) != 0) {
+			fprintf(stderr, "%s: the %s version differs from the scalar "
+				"one!\n", scenario.name, kVersions[i].name);
+			success = false;
+		}
+	}
+
+	delete[] expected;
+	delete[] spans;
+	return success;
+}
+
+
+static void
+benchmark_scenario(SpanBlender& blender, const Scenario& scenario,
+	uint32 availableFlags, int32 iterations)
+{
+	Span spans[kHeight];
+	for (int32 y = 0; y < kHeight; y++) {
+		spans[y].x = 0;
+		spans[y].y = y;
+		spans[y].length = kWidth;
+	}
+
+	printf("%s\n", scenario.name);
+
+	bigtime_t scalarTime = 0;
+	for (int32 i = 0; i < kVersionCount; i++) {
+		gSIMDFlags = availableFlags & ~kVersions[i].flags;
+		if (i > 0 && gSIMDFlags == (availableFlags & ~kVersions[i - 1].flags))
+			continue;
+
+		blender.Clear();
+		blender.SetScenario(scenario);
+
+		bigtime_t start = system_time();
+		for (int32 j = 0; j < iterations; j++)
+			blender.Blend(spans, kHeight);
+		bigtime_t time = max_c(system_time() - start, 1);
+
+		if (i == 0)
+			scalarTime = time;
+
+		double pixels = (double)kWidth * kHeight * iterations;
+		printf("  %-8s %8.1f Mpixels/s (%.2fx)\n", kVersions[i].name,
+			pixels / time, (double)scalarTime / time);
+	}
+}
+
+
+static void
+usage()
+{
+	fprintf(stderr, "Usage: drawing_mode_benchmark [-i iterations]\n");
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 iterations = 200;
+
+	int option;
+	while ((option = getopt(argc, argv, "i:")) != -1) {
+		switch (option) {
+			case 'i':
+				iterations = atol(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (iterations <= 0 || optind != argc)
+		usage();
+
+	uint32 availableFlags = gSIMDFlags;
+	if ((availableFlags & APPSERVER_SIMD_SSE2) == 0)
+		printf("This CPU does not support SSE2, only the scalar version "
+			"is used.\n");
+	else if ((availableFlags & APPSERVER_SIMD_AVX2) == 0)
+		printf("This CPU does not support AVX2.\n");
+
+	SpanBlender blender;
+	bool success = true;
+
+	srand(1);
+	for (int32 i = 0; i < kScenarioCount; i++) {
+		if (!check_scenario(blender, kScenarios[i], availableFlags))
+			success = false;
+	}
+
+	for (int32 i = 0; i < kScenarioCount; i++)
+		benchmark_scenario(blender, kScenarios[i], availableFlags, iterations);
+
+	gSIMDFlags = availableFlags;
+	return success ? 0 : 1;
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Renders a picture into an off-screen buffer with the app_server's
+	DrawingEngine, once on a single thread, and once with the Painter's
+	tiled renderer, and reports how long a frame took in both cases.
+	Since splitting the drawing into bands must not change the result,
+	both renderings are also compared pixel by pixel.
+
+	Without a picture file, a built-in scene of large fills, gradients,
+	ellipses and scaled bitmaps is used. A picture file must contain a
+	BPicture as written by BPicture::Flatten(), without sub-pictures.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <File.h>
+#include <GradientLinear.h>
+#include <GradientRadial.h>
+#include <OS.h>
+#include <Region.h>
+
+#include "BitmapDrawingEngine.h"
+#include "Canvas.h"
+#include "DrawState.h"
+#include "ServerBitmap.h"
+#include "ServerPicture.h"
+#include "TiledRenderer.h"
+
+
+static const int32 kPictureDataOffset = 16;
+	// version, unused, sub-picture count, and size of the data
+
+
+static ServerPicture*
+create_scene(int32 width, int32 height)
+{
+	ServerPicture* picture = new ServerPicture;
+
+	BRect bounds(0, 0, width - 1, height - 1);
+	rgb_color black = {0, 0, 0, 255};
+	rgb_color white = {255, 255, 255, 255};
+	rgb_color blue = {40, 80, 200, 255};
+	rgb_color orange = {250, 140, 20, 255};
+
+	picture->WritePushState();
+
+	picture->WriteSetDrawingMode(B_OP_COPY);
+	picture->WriteSetHighColor(white);
+	picture->WriteDrawRect(bounds, true);
+
+	BGradientLinear vertical(bounds.LeftTop(), bounds.LeftBottom());
+	vertical.AddColor(blue, 0);
+	vertical.AddColor(white, 255);
+	picture->WriteDrawRectGradient(bounds, vertical, true);
+
+	BRect inset = bounds.InsetByCopy(width / 8, height / 8);
+	BGradientLinear diagonal(inset.LeftTop(), inset.RightBottom());
+	diagonal.AddColor(orange, 0);
+	diagonal.AddColor(blue, 128);
+	diagonal.AddColor(black, 255);
+	picture->WriteDrawRectGradient(inset, diagonal, true);
+
+	BGradientRadial radial(bounds.LeftTop() + BPoint(width / 2, height / 2),
+		height / 2);
+	radial.AddColor(white, 0);
+	radial.AddColor(orange, 255);
+	picture->WriteDrawEllipseGradient(inset.InsetByCopy(width / 8, 0),
+		radial, true);
+
+	picture->WriteSetHighColor(blue);
+	picture->WriteDrawEllipse(bounds.InsetByCopy(width / 4, height / 16),
+		true);
+
+	// a translucent overlay
+	picture->WriteSetDrawingMode(B_OP_ALPHA);
+	rgb_color translucent = {0, 0, 0, 96};
+	picture->WriteSetHighColor(translucent);
+	picture->WriteDrawRect(bounds.InsetByCopy(width / 16, height / 16), true);
+
+	// a small bitmap, scaled up to cover most of the frame
+	const int32 kBitmapSize = 64;
+	uint32 bits[kBitmapSize * kBitmapSize];
+	for (int32 y = 0; y < kBitmapSize; y++) {
+		for (int32 x = 0; x < kBitmapSize; x++) {
+			uint8 alpha = (x ^ y) & 0x20 ? 255 : 160;
+			bits[y * kBitmapSize + x] = ((uint32)alpha << 24)
+				| ((x * 4) << 16) | ((y * 4) << 8) | ((x + y) * 2);
+		}
+	}
+
+	BRect source(0, 0, kBitmapSize - 1, kBitmapSize - 1);
+	picture->WriteSetDrawingMode(B_OP_COPY);
+	picture->WriteDrawBitmap(source, inset, kBitmapSize, kBitmapSize,
+		kBitmapSize * 4, B_RGBA32, B_FILTER_BITMAP_BILINEAR, bits,
+		sizeof(bits));
+	picture->WriteDrawBitmap(source, bounds.InsetByCopy(width / 3, 0),
+		kBitmapSize, kBitmapSize, kBitmapSize * 4, B_RGBA32, 0, bits,
+		sizeof(bits));
+
+	picture->WriteSetDrawingMode(B_OP_ALPHA);
+	picture->WriteDrawBitmap(source, bounds.InsetByCopy(0, height / 3),
+		kBitmapSize, kBitmapSize, kBitmapSize * 4, B_RGBA32,
+		B_FILTER_BITMAP_BILINEAR, bits, sizeof(bits));
+
+	picture->WritePopState();
+	return picture;
+}
+
+
+static ServerPicture*
+load_picture(const char* fileName)
+{
+	BFile file(fileName, B_READ_ONLY);
+	int32 header[3];
+	if (file.InitCheck() != B_OK
+		|| file.Read(header, sizeof(header)) != (ssize_t)sizeof(header)) {
+		fprintf(stderr, "Could not read \"%s\".\n", fileName);
+		return NULL;
+	}
+	if (header[0] != 2 || header[2] != 0) {
+		fprintf(stderr, "\"%s\" is not a flattened BPicture without "
+			"sub-pictures.\n", fileName);
+		return NULL;
+	}
+
+	// Only pictures in memory can be played, so copy it
+	ServerPicture filePicture(fileName, kPictureDataOffset);
+	if (filePicture.DataLength() <= 0) {
+		fprintf(stderr, "Could not open \"%s\".\n", fileName);
+		return NULL;
+	}
+
+	return new ServerPicture(filePicture);
+}
+
+
+/*!	Returns the average time it took to play \a picture, or -1 on error.
+	The contents of the engine's buffer are left in \a _result.
+*/
+static bigtime_t
+render(ServerPicture* picture, BitmapDrawingEngine& engine, int32 width,
+	int32 height, int32 iterations, BReference<UtilityBitmap>& _result)
+{
+	BRect bounds(0, 0, width - 1, height - 1);
+	BRegion clipping(bounds);
+	rgb_color background = {0, 0, 0, 255};
+
+	bigtime_t total = 0;
+	for (int32 i = 0; i < iterations; i++) {
+		DrawState state;
+		OffscreenCanvas canvas(&engine, state,
+			IntRect(0, 0, width - 1, height - 1));
+
+		if (!engine.LockParallelAccess())
+			return -1;
+
+		engine.ConstrainClippingRegion(&clipping);
+		engine.FillRect(bounds, background);
+
+		bigtime_t start = system_time();
+		picture->Play(&canvas);
+		total += system_time() - start;
+
+		engine.UnlockParallelAccess();
+	}
+
+	_result.SetTo(engine.ExportToBitmap(width, height, B_RGBA32), true);
+	if (_result == NULL)
+		return -1;
+
+	return total / iterations;
+}
+
+
+static void
+usage()
+{
+	fprintf(stderr, "Usage: picture_benchmark [-w width] [-h height] "
+		"[-i iterations] [picture-file]\n");
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 width = 1920;
+	int32 height = 1080;
+	int32 iterations = 50;
+
+	int option;
+	while ((option = getopt(argc, argv, "w:h:i:")) != -1) {
+		switch (option) {
+			case 'w':
+				width = atol(optarg);
+				break;
+			case 'h':
+				height = atol(optarg);
+				break;
+			case 'i':
+				iterations = atol(optarg);
+				break;
+			default:
+				usage();
+		}
+	}
+
+	if (width <= 0 || height <= 0 || iterations <= 0 || argc - optind > 1)
+		usage();
+
+	ServerPicture* picture;
+	if (optind < argc)
+		picture = load_picture(argv[optind]);
+	else
+		picture = create_scene(width, height);
+	if (picture == NULL)
+		return 1;
+
+	BReference<ServerPicture> pictureReference(picture, true);
+
+	BitmapDrawingEngine engine(B_RGBA32);
+	if (engine.SetSize(width, height) != B_OK) {
+		fprintf(stderr, "Could not create a %" B_PRId32 "x%" B_PRId32
+			" buffer.\n", width, height);
+		return 1;
+	}
+
+	TiledRenderer::SetEnabled(false);
+	BReference<UtilityBitmap> single;
+	bigtime_t singleTime = render(picture, engine, width, height, iterations,
+		single);
+
+	TiledRenderer::SetEnabled(true);
+	if (!TiledRenderer::IsEnabled())
+		printf("Tiled rendering is not available on this system.\n");
+
+	BReference<UtilityBitmap> tiled;
+	bigtime_t tiledTime = render(picture, engine, width, height, iterations,
+		tiled);
+
+	if (singleTime < 0 || tiledTime < 0) {
+		fprintf(stderr, "Rendering failed.\n");
+		return 1;
+	}
+
+	printf("%" B_PRId32 "x%" B_PRId32 ", %" B_PRId32 " frames\n", width,
+		height, iterations);
+	printf("single threaded: %8.2f ms/frame\n", singleTime / 1000.0);
+	printf("tiled:           %8.2f ms/frame (%.2fx)\n", tiledTime / 1000.0,
+		tiledTime > 0 ? (double)singleTime / tiledTime : 0.0);
+
+	if (single->BitsLength() != tiled->BitsLength()
+		|| memcmp(single->Bits(), tiled->Bits(), single->BitsLength()) != 0) {
+		fprintf(stderr, "The tiled rendering differs from the single "
+			"threaded one!\n");
+		return 1;
+	}
+
+	return 0;
+}
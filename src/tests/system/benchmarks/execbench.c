@@ -3,11 +3,95 @@
  */
 #define errx(x,y...) { fprintf(stderr, y); fprintf(stderr, "\n"); exit(x); }
 
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+extern char **environ;
+
+/*
+ * Returns a copy of the environment in which the binding mode of the
+ * runtime loader is only controlled by the given variable.
+ */
+static char **
+binding_environment(char *variable)
+{
+	char **env;
+	int i, count = 0;
+
+	while (environ[count] != NULL)
+		count++;
+
+	env = malloc((count + 2) * sizeof(char *));
+	if (env == NULL)
+		errx(1, "out of memory");
+
+	count = 0;
+	for (i = 0; environ[i] != NULL; i++) {
+		if (strncmp(environ[i], "LD_BIND_LAZY=", 13) == 0
+		    || strncmp(environ[i], "LD_BIND_NOW=", 12) == 0)
+			continue;
+		env[count++] = environ[i];
+	}
+	env[count++] = variable;
+	env[count] = NULL;
+
+	return env;
+}
+
+/*
+ * Runs the program iter times, and returns the average time from spawning
+ * it until it has exited, in microseconds.
+ */
+static unsigned long
+spawn_bench(int iter, char **args, char **env)
+{
+	struct timeval before, after;
+	pid_t pid;
+	int i, status;
+
+	gettimeofday(&before, NULL);
+	for (i = 0; i < iter; i++) {
+		if (posix_spawnp(&pid, args[0], NULL, NULL, args, env) != 0)
+			errx(1, "could not start %s", args[0]);
+		if (waitpid(pid, &status, 0) < 0)
+			errx(1, "waitpid failed");
+	}
+	gettimeofday(&after, NULL);
+
+	return ((1000000 * after.tv_sec + after.tv_usec)
+	    - (1000000 * before.tv_sec + before.tv_usec)) / iter;
+}
+
+/*
+ * Compares the startup time of a program with eager and lazy binding of
+ * its PLT entries.
+ */
+static int
+binding_bench(int iter, char **args)
+{
+	char **eager = binding_environment("LD_BIND_NOW=1");
+	char **lazy = binding_environment("LD_BIND_LAZY=1");
+
+	if (iter <= 0)
+		errx(1, "invalid number of iterations");
+
+	/* warm up the caches, so that both modes start from the same state */
+	spawn_bench(1, args, eager);
+	spawn_bench(1, args, lazy);
+
+	printf("eager binding: %lu microseconds\n", spawn_bench(iter, args, eager));
+	printf("lazy binding:  %lu microseconds\n", spawn_bench(iter, args, lazy));
+
+	free(eager);
+	free(lazy);
+	return (0);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -15,10 +99,19 @@ main(int argc, char *argv[])
 	unsigned long time, elapsed;
 	char timestr[12], iterstr[12];
 	char *timeptr, *countptr;
+	const char *binding;
         int iter, count;
 
 	if (argc < 2)
-		errx(1, "Usage: %s iterations", argv[0]);
+		errx(1, "Usage: %s iterations\n"
+		    "       %s -b iterations program [arguments]", argv[0], argv[0]);
+
+	if (strcmp(argv[1], "-b") == 0) {
+		if (argc < 4)
+			errx(1, "Usage: %s -b iterations program [arguments]",
+			    argv[0]);
+		return binding_bench(atoi(argv[2]), argv + 3);
+	}
 
 	iter = atoi(argv[1]);
 	if (iter > 0) {  
@@ -46,7 +139,11 @@ main(int argc, char *argv[])
 	elapsed = 1000000 * after.tv_sec + after.tv_usec;
 	elapsed -= time;
 
-	printf("time: %lu microseconds\n", elapsed / count);
+	/* the runtime loader binds lazily when asked to via LD_BIND_LAZY */
+	binding = getenv("LD_BIND_LAZY") != NULL && getenv("LD_BIND_NOW") == NULL
+		? "lazy" : "now";
+
+	printf("time: %lu microseconds (%s binding)\n", elapsed / count, binding);
 
 	return (1);
 }
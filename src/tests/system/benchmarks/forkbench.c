@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 
@@ -16,6 +17,8 @@
  * forks and exits while parent waits.
  * The time to run this program is used
  * in calculating exec overhead.
+ * With "vfork" as third argument, vfork()
+ * is used instead of fork().
  */
 
 int
@@ -24,12 +27,12 @@ main(argc, argv)
 {
         int nforks, i;
         char *cp;
-        int pid, child, status, brksize;
+        int pid, child, status, brksize, usevfork;
         struct timeval before, after;
 	unsigned elapsed;
 
         if (argc < 3) {
-                printf("usage: %s number-of-forks sbrk-size\n", argv[0]);
+                printf("usage: %s number-of-forks sbrk-size [vfork]\n", argv[0]);
                 exit(1);
         }
         nforks = atoi(argv[1]);
@@ -43,6 +46,8 @@ main(argc, argv)
                 exit(3);
         }
 
+        usevfork = argc > 3 && strcmp(argv[3], "vfork") == 0;
+
         gettimeofday(&before, NULL);
         cp = (char *)sbrk(brksize);
         if (cp == (void *)-1) {
@@ -52,9 +57,9 @@ main(argc, argv)
         for (i = 0; i < brksize; i += 1024)
                 cp[i] = i;
 	for (i=0; i<nforks; i++) {
-                child = fork();
+                child = usevfork ? vfork() : fork();
                 if (child == -1) {
-                        perror("fork");
+                        perror(usevfork ? "vfork" : "fork");
                         exit(-1);
                 }
                 if (child == 0)
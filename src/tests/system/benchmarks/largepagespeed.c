@@ -0,0 +1,106 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures random access latency in an anonymous area with and without
+	B_LARGE_PAGES_AREA. The random walk over a large working set is dominated
+	by TLB misses, so it shows the effect of the background large page
+	promotion directly.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include <vm_defs.h>
+
+
+#define MB					(1024 * 1024)
+
+#define DEFAULT_SIZE		(256 * MB)
+#define ACCESS_COUNT		(16 * 1024 * 1024)
+#define PROMOTION_DELAY		15
+
+
+static double
+random_walk(size_t* memory, size_t count)
+{
+	size_t i;
+	size_t index = 0;
+	bigtime_t start;
+
+	// build a single random cycle through all cache line sized slots
+	size_t stride = 64 / sizeof(size_t);
+	size_t slots = count / stride;
+	for (i = 0; i < slots; i++)
+		memory[i * stride] = i * stride;
+	for (i = slots - 1; i > 0; i--) {
+		size_t j = (size_t)rand() % i;
+		size_t temp = memory[i * stride];
+		memory[i * stride] = memory[j * stride];
+		memory[j * stride] = temp;
+	}
+
+	start = system_time();
+	for (i = 0; i < ACCESS_COUNT; i++)
+		index = memory[index];
+
+	// keep the compiler from dropping the loop
+	if (index == (size_t)-1)
+		printf("\n");
+
+	return (double)(system_time() - start) * 1000 / ACCESS_COUNT;
+}
+
+
+static void
+run_test(const char* name, size_t size, uint32 protection, int delay)
+{
+	size_t* memory;
+	area_id area = create_area(name, (void**)&memory, B_ANY_ADDRESS, size,
+		B_NO_LOCK, protection);
+	if (area < 0) {
+		fprintf(stderr, "Failed to create area: %s\n", strerror(area));
+		return;
+	}
+
+	// fault everything in and give the promoter a chance to run
+	memset(memory, 0, size);
+	if (delay > 0)
+		sleep(delay);
+
+	printf("%-12s %8.2f ns/access\n", name,
+		random_walk(memory, size / sizeof(size_t)));
+
+	delete_area(area);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	size_t size = DEFAULT_SIZE;
+	int delay = PROMOTION_DELAY;
+
+	if (argc > 1)
+		size = (size_t)atol(argv[1]) * MB;
+	if (argc > 2)
+		delay = atoi(argv[2]);
+	if (argc > 3 || size == 0) {
+		fprintf(stderr, "Usage: %s [megabytes [promotion delay]]\n", argv[0]);
+		return 1;
+	}
+
+	srand(42);
+	run_test("base pages", size, B_READ_AREA | B_WRITE_AREA, delay);
+	srand(42);
+	run_test("large pages", size,
+		B_READ_AREA | B_WRITE_AREA | B_LARGE_PAGES_AREA, delay);
+
+	return 0;
+}
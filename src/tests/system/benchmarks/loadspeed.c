@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how long it takes to load a program and all of its libraries.
+	load_image() returns only after the runtime loader has loaded and
+	relocated everything, so for large C++ applications the time is dominated
+	by symbol resolution. The new team is killed before it gets to run.
+*/
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <OS.h>
+#include <image.h>
+
+
+#define DEFAULT_ITERATIONS	20
+
+
+extern char** environ;
+
+static const char* kDefaultPrograms[] = {
+	"/boot/system/apps/StyledEdit",
+	"/boot/system/apps/Debugger",
+	"/boot/system/apps/WebPositive",
+	NULL
+};
+
+
+static void
+run_test(const char* path, int iterations)
+{
+	const char* args[] = { path, NULL };
+	bigtime_t total = 0;
+	bigtime_t fastest = B_INFINITE_TIMEOUT;
+	int i;
+
+	if (access(path, X_OK) != 0) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return;
+	}
+
+	for (i = 0; i < iterations; i++) {
+		status_t status;
+		bigtime_t time = system_time();
+		thread_id thread = load_image(1, args, (const char**)environ);
+		time = system_time() - time;
+
+		if (thread < 0) {
+			fprintf(stderr, "%s: loading failed: %s\n", path,
+				strerror(thread));
+			return;
+		}
+
+		kill_thread(thread);
+		wait_for_thread(thread, &status);
+
+		total += time;
+		if (time < fastest)
+			fastest = time;
+	}
+
+	printf("%-40s %8.2f ms average, %8.2f ms fastest\n", path,
+		total / 1000.0 / iterations, fastest / 1000.0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int iterations = DEFAULT_ITERATIONS;
+	int i;
+
+	if (argc > 1 && strcmp(argv[1], "-n") == 0) {
+		if (argc < 3 || (iterations = atoi(argv[2])) <= 0) {
+			fprintf(stderr, "Usage: %s [-n iterations] [program ...]\n",
+				argv[0]);
+			return 1;
+		}
+		argc -= 2;
+		argv += 2;
+	}
+
+	if (argc > 1) {
+		for (i = 1; i < argc; i++)
+			run_test(argv[i], iterations);
+	} else {
+		for (i = 0; kDefaultPrograms[i] != NULL; i++)
+			run_test(kDefaultPrograms[i], iterations);
+	}
+
+	return 0;
+}
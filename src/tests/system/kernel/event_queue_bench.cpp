@@ -0,0 +1,223 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures how the cost of waiting for a single ready file descriptor
+	scales with the number of descriptors waited on, with poll() compared to
+	an event queue. All but one of the descriptors are duplicates of the read
+	end of a pipe that never becomes readable; the last one is the read end of
+	a pipe that gets a byte written to it before every wait.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static int sIterations = 10000;
+
+
+static bool
+set_fd_limit(int count)
+{
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+		return false;
+
+	if (limit.rlim_cur >= (rlim_t)count)
+		return true;
+
+	limit.rlim_cur = count;
+	return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+}
+
+
+static bool
+create_fds(int count, int* fds, int activePipe[2])
+{
+	int idlePipe[2];
+	if (pipe(idlePipe) != 0 || pipe(activePipe) != 0) {
+		perror("pipe");
+		return false;
+	}
+
+	fds[0] = idlePipe[0];
+	for (int i = 1; i < count - 1; i++) {
+		fds[i] = dup(idlePipe[0]);
+		if (fds[i] < 0) {
+			fprintf(stderr, "dup: %s (%d descriptors)\n", strerror(errno), i);
+			return false;
+		}
+	}
+	fds[count - 1] = activePipe[0];
+
+	close(idlePipe[1]);
+	return true;
+}
+
+
+static void
+close_fds(int count, int* fds, int activePipe[2])
+{
+	for (int i = 0; i < count; i++)
+		close(fds[i]);
+	close(activePipe[1]);
+}
+
+
+static double
+bench_poll(int count, int* fds, int writeFD)
+{
+	struct pollfd* pollFDs = new pollfd[count];
+	for (int i = 0; i < count; i++) {
+		pollFDs[i].fd = fds[i];
+		pollFDs[i].events = POLLIN;
+	}
+
+	bigtime_t start = system_time();
+	for (int i = 0; i < sIterations; i++) {
+		char byte = 0;
+		write(writeFD, &byte, 1);
+
+		if (poll(pollFDs, count, -1) != 1
+			|| (pollFDs[count - 1].revents & POLLIN) == 0) {
+			fprintf(stderr, "poll: unexpected result\n");
+			break;
+		}
+		read(fds[count - 1], &byte, 1);
+	}
+	bigtime_t elapsed = system_time() - start;
+
+	delete[] pollFDs;
+	return (double)elapsed / sIterations;
+}
+
+
+static double
+bench_event_queue(int count, int* fds, int writeFD, bool edgeTriggered)
+{
+	int queue = create_event_queue(O_CLOEXEC);
+	if (queue < 0) {
+		fprintf(stderr, "create_event_queue: %s\n", strerror(queue));
+		return -1;
+	}
+
+	for (int i = 0; i < count; i++) {
+		event_wait_info info;
+		info.object = fds[i];
+		info.type = B_OBJECT_TYPE_FD;
+		info.events = B_EVENT_READ
+			| (edgeTriggered ? B_EVENT_EDGE_TRIGGERED : 0);
+		info.user_data = NULL;
+
+		status_t status = event_queue_select(queue, &info);
+		if (status != B_OK) {
+			fprintf(stderr, "event_queue_select: %s\n", strerror(status));
+			close(queue);
+			return -1;
+		}
+	}
+	bigtime_t start = system_time();
+	for (int i = 0; i < sIterations; i++) {
+		char byte = 0;
+		write(writeFD, &byte, 1);
+
+		event_wait_info info;
+		if (event_queue_wait(queue, &info, 1, 0, 0) != 1
+			|| info.object != fds[count - 1]) {
+			fprintf(stderr, "event_queue_wait: unexpected result\n");
+			break;
+		}
+		read(fds[count - 1], &byte, 1);
+	}
+	bigtime_t elapsed = system_time() - start;
+
+	close(queue);
+	return (double)elapsed / sIterations;
+}
+
+
+static bool
+run(int count)
+{
+	if (!set_fd_limit(count + 16)) {
+		fprintf(stderr, "could not raise the descriptor limit to %d\n",
+			count + 16);
+		return false;
+	}
+
+	int* fds = new int[count];
+	int activePipe[2];
+	if (!create_fds(count, fds, activePipe)) {
+		delete[] fds;
+		return false;
+	}
+
+	double pollTime = bench_poll(count, fds, activePipe[1]);
+	double levelTime = bench_event_queue(count, fds, activePipe[1], false);
+	double edgeTime = bench_event_queue(count, fds, activePipe[1], true);
+
+	printf("%6d fds: poll %9.2f us, queue %6.2f us, edge-triggered %6.2f us\n",
+		count, pollTime, levelTime, edgeTime);
+
+	close_fds(count, fds, activePipe);
+	delete[] fds;
+	return levelTime >= 0 && edgeTime >= 0;
+}
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-i iterations] [fd-count ...]\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "i:")) != -1) {
+		switch (option) {
+			case 'i':
+				sIterations = atoi(optarg);
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (sIterations <= 0)
+		usage(argv[0]);
+
+	bool ok = true;
+	if (optind == argc) {
+		// the largest count stays below the descriptor limit of a team
+		static const int kCounts[] = {10, 100, 1000, 8000};
+		for (size_t i = 0; i < sizeof(kCounts) / sizeof(kCounts[0]); i++) {
+			// poll() gets slow with many descriptors; don't wait forever
+			if (kCounts[i] >= 8000 && sIterations > 1000)
+				sIterations = 1000;
+			ok &= run(kCounts[i]);
+		}
+	}
+
+	for (int i = optind; i < argc; i++) {
+		int count = atoi(argv[i]);
+		if (count < 2)
+			usage(argv[0]);
+		ok &= run(count);
+	}
+
+	return ok ? 0 : 1;
+}
@@ -5,6 +5,7 @@
 #include "BOpenHashTableTest.h"
 #include "BitmapTest.h"
 #include "DoublyLinkedListTest.h"
+#include "LZCompressionTest.h"
 #include "SinglyLinkedListTest.h"
 #include "VectorMapTest.h"
 #include "VectorSetTest.h"
@@ -18,6 +19,7 @@ BTestSuite* getTestSuite() {
 	suite->addTest("Bitmap", BitmapTest::Suite());
 	suite->addTest("SinglyLinkedList", SinglyLinkedListTest::Suite());
 	suite->addTest("DoublyLinkedList", DoublyLinkedListTest::Suite());
+	suite->addTest("LZCompression", LZCompressionTest::Suite());
 	suite->addTest("VectorMap", VectorMapTest::Suite());
 	suite->addTest("VectorSet", VectorSetTest::Suite());
 	suite->addTest("Vector", VectorTest::Suite());
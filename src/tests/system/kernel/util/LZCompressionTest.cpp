@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <cppunit/Test.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+#include <stdlib.h>
+#include <string.h>
+#include <TestUtils.h>
+
+#include "LZCompressionTest.h"
+#include "lz_compression.h"
+
+static const size_t kPageSize = 4096;
+
+LZCompressionTest::LZCompressionTest(std::string name)
+	: BTestCase(name)
+{
+}
+
+CppUnit::Test*
+LZCompressionTest::Suite()
+{
+	CppUnit::TestSuite *suite = new CppUnit::TestSuite("LZCompression");
+
+	suite->addTest(new CppUnit::TestCaller<LZCompressionTest>(
+		"LZCompression::RoundTrip test", &LZCompressionTest::RoundTripTest));
+	suite->addTest(new CppUnit::TestCaller<LZCompressionTest>(
+		"LZCompression::Incompressible test",
+		&LZCompressionTest::IncompressibleTest));
+	suite->addTest(new CppUnit::TestCaller<LZCompressionTest>(
+		"LZCompression::CorruptData test",
+		&LZCompressionTest::CorruptDataTest));
+
+	return suite;
+}
+
+void
+LZCompressionTest::RoundTripTest()
+{
+	uint16 hashTable[LZ_HASH_TABLE_SIZE];
+	uint8 source[kPageSize];
+	uint8 compressed[kPageSize * 2];
+	uint8 decompressed[kPageSize];
+
+	// an empty page compresses very well
+	memset(source, 0, kPageSize);
+	size_t length = lz_compress(source, kPageSize, compressed,
+		sizeof(compressed), hashTable);
+	CPPUNIT_ASSERT(length > 0 && length < 64);
+	CPPUNIT_ASSERT(lz_decompress(compressed, length, decompressed, kPageSize)
+		== (ssize_t)kPageSize);
+	CPPUNIT_ASSERT(memcmp(source, decompressed, kPageSize) == 0);
+
+	// repeating structures with some noise, and odd sizes
+	srand(42);
+	for (size_t size = 1; size <= kPageSize; size += 123) {
+		for (size_t i = 0; i < size; i++)
+			source[i] = (i % 37) + (rand() % 64 == 0 ? 1 : 0);
+
+		length = lz_compress(source, size, compressed, sizeof(compressed),
+			hashTable);
+		CPPUNIT_ASSERT(length > 0);
+		CPPUNIT_ASSERT(lz_decompress(compressed, length, decompressed,
+			kPageSize) == (ssize_t)size);
+		CPPUNIT_ASSERT(memcmp(source, decompressed, size) == 0);
+	}
+}
+
+void
+LZCompressionTest::IncompressibleTest()
+{
+	uint16 hashTable[LZ_HASH_TABLE_SIZE];
+	uint8 source[kPageSize];
+	uint8 compressed[kPageSize * 2];
+	uint8 decompressed[kPageSize];
+
+	srand(42);
+	for (size_t i = 0; i < kPageSize; i++)
+		source[i] = rand();
+
+	// random data does not fit into a smaller buffer
+	CPPUNIT_ASSERT(lz_compress(source, kPageSize, compressed, kPageSize / 2,
+		hashTable) == 0);
+
+	// but it still survives the round trip, given enough room
+	size_t length = lz_compress(source, kPageSize, compressed,
+		sizeof(compressed), hashTable);
+	CPPUNIT_ASSERT(length > 0);
+	CPPUNIT_ASSERT(lz_decompress(compressed, length, decompressed, kPageSize)
+		== (ssize_t)kPageSize);
+	CPPUNIT_ASSERT(memcmp(source, decompressed, kPageSize) == 0);
+}
+
+void
+LZCompressionTest::CorruptDataTest()
+{
+	uint16 hashTable[LZ_HASH_TABLE_SIZE];
+	uint8 source[kPageSize];
+	uint8 compressed[kPageSize * 2];
+	uint8 decompressed[kPageSize];
+
+	for (size_t i = 0; i < kPageSize; i++)
+		source[i] = i % 251;
+
+	size_t length = lz_compress(source, kPageSize, compressed,
+		sizeof(compressed), hashTable);
+	CPPUNIT_ASSERT(length > 0);
+
+	// the output buffer is too small
+	CPPUNIT_ASSERT(lz_decompress(compressed, length, decompressed,
+		kPageSize - 1) == B_BAD_DATA);
+
+	// a truncated block
+	CPPUNIT_ASSERT(lz_decompress(compressed, length - 1, decompressed,
+		kPageSize) != (ssize_t)kPageSize);
+
+	// a back reference before the start of the data
+	uint8 invalid[] = { 0x10, 'a', 0x05, 0x00 };
+	CPPUNIT_ASSERT(lz_decompress(invalid, sizeof(invalid), decompressed,
+		kPageSize) == B_BAD_DATA);
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _lz_compression_test_h_
+#define _lz_compression_test_h_
+
+#include <TestCase.h>
+
+class LZCompressionTest : public BTestCase {
+public:
+	LZCompressionTest(std::string name = "");
+
+	static CppUnit::Test* Suite();
+
+	void RoundTripTest();
+	void IncompressibleTest();
+	void CorruptDataTest();
+};
+
+#endif // _lz_compression_test_h_
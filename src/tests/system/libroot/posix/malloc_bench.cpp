@@ -0,0 +1,413 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Allocator benchmark, modelled after a few well-known allocator tests:
+
+	larson		Threads replace random objects in their own arrays, which are
+				passed on to new threads after each round, so that many
+				objects are freed by another thread than the allocating one.
+	threadtest	Threads allocate batches of small objects and free them again.
+	mstress		Random sizes from tiny to a few megabytes, with realloc(),
+				calloc() and memalign(). The contents are verified.
+
+	It only uses POSIX APIs, so it can be built on other systems, too:
+		g++ -O2 -o malloc_bench malloc_bench.cpp -lpthread
+	To compare the allocators of libroot, run it on builds with either of
+	them (see HAIKU_LIBROOT_MALLOC).
+*/
+
+
+#include <malloc.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static int sThreadCount = 4;
+static int sScale = 1;
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static inline uint32_t
+next_random(uint32_t& state)
+{
+	// xorshift32
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+
+static void
+run_threads(void* (*function)(void*), void** arguments)
+{
+	pthread_t* threads = new pthread_t[sThreadCount];
+	for (int i = 0; i < sThreadCount; i++)
+		pthread_create(&threads[i], NULL, function, arguments[i]);
+	for (int i = 0; i < sThreadCount; i++)
+		pthread_join(threads[i], NULL);
+	delete[] threads;
+}
+
+
+static void
+report(const char* name, double elapsed, uint64_t operations)
+{
+	printf("%-12s %2d threads: %8.3f s, %10.0f operations/s\n", name,
+		sThreadCount, elapsed, operations / elapsed);
+}
+
+
+//	#pragma mark - larson
+
+
+static const int kLarsonSlots = 1000;
+static const int kLarsonRounds = 30;
+static const int kLarsonMinSize = 10;
+static const int kLarsonMaxSize = 500;
+
+
+struct LarsonArray {
+	void*		slots[kLarsonSlots];
+	uint32_t	random;
+	uint64_t	operations;
+};
+
+
+static void*
+larson_thread(void* _array)
+{
+	LarsonArray* array = (LarsonArray*)_array;
+	int iterations = 20000 * sScale;
+
+	for (int i = 0; i < iterations; i++) {
+		int slot = next_random(array->random) % kLarsonSlots;
+		free(array->slots[slot]);
+
+		size_t size = kLarsonMinSize
+			+ next_random(array->random) % (kLarsonMaxSize - kLarsonMinSize);
+		array->slots[slot] = malloc(size);
+		((char*)array->slots[slot])[0] = (char)i;
+	}
+
+	array->operations += iterations;
+	return NULL;
+}
+
+
+static void
+larson()
+{
+	LarsonArray** arrays = new LarsonArray*[sThreadCount];
+	for (int i = 0; i < sThreadCount; i++) {
+		arrays[i] = new LarsonArray;
+		arrays[i]->random = 0x12345 + i;
+		arrays[i]->operations = 0;
+		for (int j = 0; j < kLarsonSlots; j++)
+			arrays[i]->slots[j] = malloc(kLarsonMinSize);
+	}
+
+	double start = current_time();
+
+	for (int round = 0; round < kLarsonRounds; round++) {
+		run_threads(larson_thread, (void**)arrays);
+
+		// hand each array to another thread in the next round
+		LarsonArray* first = arrays[0];
+		memmove(arrays, arrays + 1, (sThreadCount - 1) * sizeof(LarsonArray*));
+		arrays[sThreadCount - 1] = first;
+	}
+
+	double elapsed = current_time() - start;
+
+	uint64_t operations = 0;
+	for (int i = 0; i < sThreadCount; i++) {
+		operations += arrays[i]->operations;
+		for (int j = 0; j < kLarsonSlots; j++)
+			free(arrays[i]->slots[j]);
+		delete arrays[i];
+	}
+	delete[] arrays;
+
+	report("larson", elapsed, operations);
+}
+
+
+//	#pragma mark - threadtest
+
+
+static const int kThreadTestObjects = 10000;
+static const size_t kThreadTestSize = 64;
+
+
+static void*
+threadtest_thread(void* _operations)
+{
+	uint64_t* operations = (uint64_t*)_operations;
+	void** objects = new void*[kThreadTestObjects];
+	int iterations = 50 * sScale;
+
+	for (int i = 0; i < iterations; i++) {
+		for (int j = 0; j < kThreadTestObjects; j++) {
+			objects[j] = malloc(kThreadTestSize);
+			memset(objects[j], j, 8);
+		}
+		for (int j = 0; j < kThreadTestObjects; j++)
+			free(objects[j]);
+	}
+
+	delete[] objects;
+	*operations = (uint64_t)iterations * kThreadTestObjects;
+	return NULL;
+}
+
+
+static void
+threadtest()
+{
+	uint64_t* operations = new uint64_t[sThreadCount];
+	void** arguments = new void*[sThreadCount];
+	for (int i = 0; i < sThreadCount; i++)
+		arguments[i] = &operations[i];
+
+	double start = current_time();
+	run_threads(threadtest_thread, arguments);
+	double elapsed = current_time() - start;
+
+	uint64_t total = 0;
+	for (int i = 0; i < sThreadCount; i++)
+		total += operations[i];
+
+	delete[] arguments;
+	delete[] operations;
+
+	report("threadtest", elapsed, total);
+}
+
+
+//	#pragma mark - mstress
+
+
+static const int kStressSlots = 2000;
+
+
+struct StressState {
+	uint32_t	random;
+	uint64_t	operations;
+	bool		failed;
+};
+
+
+static size_t
+stress_size(uint32_t& random)
+{
+	// mostly small, sometimes medium, rarely huge allocations
+	uint32_t kind = next_random(random) % 1000;
+	if (kind < 900)
+		return next_random(random) % 512;
+	if (kind < 995)
+		return next_random(random) % (128 * 1024);
+	return next_random(random) % (4 * 1024 * 1024);
+}
+
+
+static void
+stress_fill(void* address, size_t size, uint8_t pattern)
+{
+	// only the start and the end, touching everything would dominate
+	size_t length = size < 64 ? size : 64;
+	memset(address, pattern, length);
+	memset((uint8_t*)address + size - length, pattern, length);
+}
+
+
+static bool
+stress_check(const void* address, size_t size, uint8_t pattern)
+{
+	size_t length = size < 64 ? size : 64;
+	const uint8_t* bytes = (const uint8_t*)address;
+	for (size_t i = 0; i < length; i++) {
+		if (bytes[i] != pattern || bytes[size - length + i] != pattern)
+			return false;
+	}
+	return true;
+}
+
+
+static void*
+mstress_thread(void* _state)
+{
+	StressState* state = (StressState*)_state;
+	void* objects[kStressSlots] = {};
+	size_t sizes[kStressSlots] = {};
+	int iterations = 20000 * sScale;
+
+	for (int i = 0; i < iterations; i++) {
+		int slot = next_random(state->random) % kStressSlots;
+		uint8_t pattern = (uint8_t)slot;
+
+		if (objects[slot] != NULL
+			&& !stress_check(objects[slot], sizes[slot], pattern)) {
+			fprintf(stderr, "mstress: corrupted object %p (%zu bytes)\n",
+				objects[slot], sizes[slot]);
+			state->failed = true;
+			return NULL;
+		}
+
+		size_t size = stress_size(state->random);
+		switch (next_random(state->random) % 4) {
+			case 0:
+			{
+				// realloc() keeps the contents
+				void* address = realloc(objects[slot], size + 1);
+				if (address == NULL)
+					break;
+				objects[slot] = address;
+				sizes[slot] = size + 1;
+				break;
+			}
+			case 1:
+			{
+				free(objects[slot]);
+				objects[slot] = calloc(1, size + 1);
+				sizes[slot] = size + 1;
+				if (objects[slot] != NULL
+					&& !stress_check(objects[slot], size + 1, 0)) {
+					fprintf(stderr, "mstress: calloc() memory not zeroed\n");
+					state->failed = true;
+					return NULL;
+				}
+				break;
+			}
+			case 2:
+			{
+				size_t alignment = (size_t)16 << (next_random(state->random) % 9);
+				free(objects[slot]);
+				if (posix_memalign(&objects[slot], alignment, size + 1) != 0)
+					objects[slot] = NULL;
+				sizes[slot] = size + 1;
+				if (((uintptr_t)objects[slot] & (alignment - 1)) != 0) {
+					fprintf(stderr, "mstress: %p is not aligned to %zu\n",
+						objects[slot], alignment);
+					state->failed = true;
+					return NULL;
+				}
+				break;
+			}
+			default:
+				free(objects[slot]);
+				objects[slot] = malloc(size + 1);
+				sizes[slot] = size + 1;
+				break;
+		}
+
+		if (objects[slot] != NULL)
+			stress_fill(objects[slot], sizes[slot], pattern);
+	}
+
+	for (int i = 0; i < kStressSlots; i++)
+		free(objects[i]);
+
+	state->operations = iterations;
+	return NULL;
+}
+
+
+static bool
+mstress()
+{
+	StressState* states = new StressState[sThreadCount];
+	void** arguments = new void*[sThreadCount];
+	for (int i = 0; i < sThreadCount; i++) {
+		states[i].random = 0x4711 + i;
+		states[i].operations = 0;
+		states[i].failed = false;
+		arguments[i] = &states[i];
+	}
+
+	double start = current_time();
+	run_threads(mstress_thread, arguments);
+	double elapsed = current_time() - start;
+
+	uint64_t total = 0;
+	bool failed = false;
+	for (int i = 0; i < sThreadCount; i++) {
+		total += states[i].operations;
+		failed |= states[i].failed;
+	}
+
+	delete[] arguments;
+	delete[] states;
+
+	report("mstress", elapsed, total);
+	return !failed;
+}
+
+
+//	#pragma mark -
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-t threads] [-s scale] "
+		"[larson|threadtest|mstress ...]\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "t:s:")) != -1) {
+		switch (option) {
+			case 't':
+				sThreadCount = atoi(optarg);
+				break;
+			case 's':
+				sScale = atoi(optarg);
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (sThreadCount < 1 || sScale < 1)
+		usage(argv[0]);
+
+	if (optind == argc) {
+		larson();
+		threadtest();
+		return mstress() ? 0 : 1;
+	}
+
+	bool ok = true;
+	for (int i = optind; i < argc; i++) {
+		if (strcmp(argv[i], "larson") == 0)
+			larson();
+		else if (strcmp(argv[i], "threadtest") == 0)
+			threadtest();
+		else if (strcmp(argv[i], "mstress") == 0)
+			ok &= mstress();
+		else
+			usage(argv[0]);
+	}
+
+	return ok ? 0 : 1;
+}
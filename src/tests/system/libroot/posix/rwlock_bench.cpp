@@ -0,0 +1,338 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Contention benchmark for pthread rwlocks and barriers.
+
+	rwlock		Threads access a shared structure under a read lock and modify
+				it under a write lock now and then (see -w). Readers verify
+				that they never see a half-done modification.
+	mutex		The same with a mutex, for comparison.
+	barrier		Threads repeatedly wait on a barrier.
+
+	It only uses POSIX APIs, so it can be built on other systems, too:
+		g++ -O2 -o rwlock_bench rwlock_bench.cpp -lpthread
+*/
+
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static int sThreadCount = 4;
+static int sWritePermille = 10;
+static double sDuration = 1.0;
+static bool sPreferReaders = false;
+
+static volatile bool sStop;
+static bool sFailed;
+
+
+struct SharedData {
+	pthread_rwlock_t	rwlock;
+	pthread_mutex_t		mutex;
+	uint64_t			values[8];
+		// all equal, unless someone sees a partial update
+};
+
+static SharedData sData;
+
+
+struct ThreadState {
+	uint32_t	random;
+	uint64_t	reads;
+	uint64_t	writes;
+	bool		useMutex;
+};
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static inline uint32_t
+next_random(uint32_t& state)
+{
+	// xorshift32
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+
+static void
+run_threads(void* (*function)(void*), void** arguments)
+{
+	pthread_t* threads = new pthread_t[sThreadCount];
+	for (int i = 0; i < sThreadCount; i++)
+		pthread_create(&threads[i], NULL, function, arguments[i]);
+	for (int i = 0; i < sThreadCount; i++)
+		pthread_join(threads[i], NULL);
+	delete[] threads;
+}
+
+
+//	#pragma mark - rwlock
+
+
+static void
+read_data(ThreadState* state)
+{
+	uint64_t first = sData.values[0];
+	for (int i = 1; i < 8; i++) {
+		if (sData.values[i] != first) {
+			fprintf(stderr, "reader saw a partial update\n");
+			sFailed = true;
+			sStop = true;
+		}
+	}
+	state->reads++;
+}
+
+
+static void
+write_data(ThreadState* state)
+{
+	for (int i = 0; i < 8; i++)
+		sData.values[i]++;
+	state->writes++;
+}
+
+
+static void*
+lock_thread(void* _state)
+{
+	ThreadState* state = (ThreadState*)_state;
+
+	while (!sStop) {
+		bool write = next_random(state->random) % 1000
+			< (uint32_t)sWritePermille;
+
+		if (state->useMutex) {
+			pthread_mutex_lock(&sData.mutex);
+			if (write)
+				write_data(state);
+			else
+				read_data(state);
+			pthread_mutex_unlock(&sData.mutex);
+		} else if (write) {
+			pthread_rwlock_wrlock(&sData.rwlock);
+			write_data(state);
+			pthread_rwlock_unlock(&sData.rwlock);
+		} else {
+			pthread_rwlock_rdlock(&sData.rwlock);
+			read_data(state);
+			pthread_rwlock_unlock(&sData.rwlock);
+		}
+	}
+
+	return NULL;
+}
+
+
+static void*
+stop_thread(void*)
+{
+	usleep((useconds_t)(sDuration * 1000000));
+	sStop = true;
+	return NULL;
+}
+
+
+static void
+lock_test(bool useMutex)
+{
+	pthread_rwlockattr_t attributes;
+	pthread_rwlockattr_init(&attributes);
+#ifdef PTHREAD_RWLOCK_PREFER_READER_NP
+	if (sPreferReaders) {
+		pthread_rwlockattr_setkind_np(&attributes,
+			PTHREAD_RWLOCK_PREFER_READER_NP);
+	}
+#endif
+	pthread_rwlock_init(&sData.rwlock, &attributes);
+	pthread_rwlockattr_destroy(&attributes);
+	pthread_mutex_init(&sData.mutex, NULL);
+	memset(sData.values, 0, sizeof(sData.values));
+
+	ThreadState* states = new ThreadState[sThreadCount];
+	void** arguments = new void*[sThreadCount];
+	for (int i = 0; i < sThreadCount; i++) {
+		states[i].random = 0x1234 + i;
+		states[i].reads = 0;
+		states[i].writes = 0;
+		states[i].useMutex = useMutex;
+		arguments[i] = &states[i];
+	}
+
+	sStop = false;
+	pthread_t stopper;
+	pthread_create(&stopper, NULL, stop_thread, NULL);
+
+	double start = current_time();
+	run_threads(lock_thread, arguments);
+	double elapsed = current_time() - start;
+	pthread_join(stopper, NULL);
+
+	uint64_t reads = 0;
+	uint64_t writes = 0;
+	for (int i = 0; i < sThreadCount; i++) {
+		reads += states[i].reads;
+		writes += states[i].writes;
+	}
+
+	if (sData.values[0] != writes) {
+		fprintf(stderr, "lost updates: %llu instead of %llu\n",
+			(unsigned long long)sData.values[0], (unsigned long long)writes);
+		sFailed = true;
+	}
+
+	printf("%-8s %2d threads, %4.1f%% writes: %12.0f operations/s\n",
+		useMutex ? "mutex" : "rwlock", sThreadCount, sWritePermille / 10.0,
+		(reads + writes) / elapsed);
+
+	delete[] arguments;
+	delete[] states;
+	pthread_rwlock_destroy(&sData.rwlock);
+	pthread_mutex_destroy(&sData.mutex);
+}
+
+
+//	#pragma mark - barrier
+
+
+static const int kBarrierRounds = 20000;
+
+static pthread_barrier_t sBarrier;
+static int32_t sSerialCount;
+static volatile int32_t sArrived;
+
+
+static void*
+barrier_thread(void*)
+{
+	for (int i = 0; i < kBarrierRounds; i++) {
+		__sync_fetch_and_add(&sArrived, 1);
+
+		int result = pthread_barrier_wait(&sBarrier);
+		if (result == PTHREAD_BARRIER_SERIAL_THREAD)
+			__sync_fetch_and_add(&sSerialCount, 1);
+		else if (result != 0) {
+			fprintf(stderr, "pthread_barrier_wait() failed: %s\n",
+				strerror(result));
+			sFailed = true;
+			break;
+		}
+
+		// everyone must have arrived in this round
+		if (sArrived < (i + 1) * sThreadCount) {
+			fprintf(stderr, "barrier released too early\n");
+			sFailed = true;
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+
+static void
+barrier_test()
+{
+	pthread_barrier_init(&sBarrier, NULL, sThreadCount);
+	sSerialCount = 0;
+	sArrived = 0;
+
+	void** arguments = new void*[sThreadCount];
+	memset(arguments, 0, sizeof(void*) * sThreadCount);
+
+	double start = current_time();
+	run_threads(barrier_thread, arguments);
+	double elapsed = current_time() - start;
+
+	if (sSerialCount != kBarrierRounds) {
+		fprintf(stderr, "%d serial threads in %d rounds\n", (int)sSerialCount,
+			kBarrierRounds);
+		sFailed = true;
+	}
+
+	printf("%-8s %2d threads: %12.0f rounds/s\n", "barrier", sThreadCount,
+		kBarrierRounds / elapsed);
+
+	delete[] arguments;
+	pthread_barrier_destroy(&sBarrier);
+}
+
+
+//	#pragma mark -
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-t threads] [-w write-permille] "
+		"[-d seconds] [-r] [rwlock|mutex|barrier ...]\n"
+		"  -r  prefer readers (if supported)\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "t:w:d:r")) != -1) {
+		switch (option) {
+			case 't':
+				sThreadCount = atoi(optarg);
+				break;
+			case 'w':
+				sWritePermille = atoi(optarg);
+				break;
+			case 'd':
+				sDuration = atof(optarg);
+				break;
+			case 'r':
+				sPreferReaders = true;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (sThreadCount < 1 || sWritePermille < 0 || sWritePermille > 1000
+		|| sDuration <= 0) {
+		usage(argv[0]);
+	}
+
+	if (optind == argc) {
+		lock_test(false);
+		lock_test(true);
+		barrier_test();
+	}
+
+	for (int i = optind; i < argc; i++) {
+		if (strcmp(argv[i], "rwlock") == 0)
+			lock_test(false);
+		else if (strcmp(argv[i], "mutex") == 0)
+			lock_test(true);
+		else if (strcmp(argv[i], "barrier") == 0)
+			barrier_test();
+		else
+			usage(argv[0]);
+	}
+
+	return sFailed ? 1 : 0;
+}
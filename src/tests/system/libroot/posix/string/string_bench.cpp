@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Microbenchmark for the string functions of the C library. It only uses
+	POSIX APIs, so it can be built on other systems, too, for a comparison:
+		g++ -O2 -fno-builtin -o string_bench string_bench.cpp
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+static const size_t kSizes[] = { 7, 16, 31, 64, 256, 1024, 4096, 65536 };
+static const size_t kSizeCount = sizeof(kSizes) / sizeof(kSizes[0]);
+static const size_t kBytesPerRun = 64 * 1024 * 1024;
+
+static volatile size_t sSink;
+
+
+typedef size_t (*test_function)(const char* a, const char* b, size_t size);
+
+
+struct Test {
+	const char*		name;
+	test_function	function;
+};
+
+
+static size_t
+test_strlen(const char* a, const char* b, size_t size)
+{
+	return strlen(a);
+}
+
+
+static size_t
+test_strnlen(const char* a, const char* b, size_t size)
+{
+	return strnlen(a, size + 1);
+}
+
+
+static size_t
+test_strchr(const char* a, const char* b, size_t size)
+{
+	return (size_t)strchr(a, 'x');
+}
+
+
+static size_t
+test_memchr(const char* a, const char* b, size_t size)
+{
+	return (size_t)memchr(a, 'x', size);
+}
+
+
+static size_t
+test_memcmp(const char* a, const char* b, size_t size)
+{
+	return memcmp(a, b, size);
+}
+
+
+static size_t
+test_strcmp(const char* a, const char* b, size_t size)
+{
+	return strcmp(a, b);
+}
+
+
+static const Test kTests[] = {
+	{ "strlen", test_strlen },
+	{ "strnlen", test_strnlen },
+	{ "strchr", test_strchr },
+	{ "memchr", test_memchr },
+	{ "memcmp", test_memcmp },
+	{ "strcmp", test_strcmp },
+};
+static const size_t kTestCount = sizeof(kTests) / sizeof(kTests[0]);
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static bool
+verify(const char* a, const char* b, size_t size)
+{
+	// the buffers only differ in the last byte before the terminator
+	bool ok = strlen(a) == size
+		&& strnlen(a, size / 2) == size / 2
+		&& strchr(a, 'x') == a + size - 1
+		&& strchr(a, '\0') == a + size
+		&& memchr(a, 'x', size) == a + size - 1
+		&& memchr(a, 'x', size - 1) == NULL
+		&& memcmp(a, b, size - 1) == 0
+		&& memcmp(a, b, size) > 0
+		&& strcmp(a, b) > 0
+		&& strcmp(a, a) == 0;
+	if (!ok)
+		fprintf(stderr, "verification failed for size %zu\n", size);
+
+	return ok;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	// "misaligned" shifts the second buffer to exercise unaligned accesses
+	bool misaligned = argc > 1 && strcmp(argv[1], "-u") == 0;
+
+	size_t maxSize = kSizes[kSizeCount - 1];
+	char* bufferA = (char*)malloc(maxSize + 64);
+	char* bufferB = (char*)malloc(maxSize + 64);
+	if (bufferA == NULL || bufferB == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	char* b = bufferB + (misaligned ? 3 : 0);
+
+	printf("%-8s", "size");
+	for (size_t i = 0; i < kTestCount; i++)
+		printf("%12s", kTests[i].name);
+	printf("\n");
+
+	for (size_t s = 0; s < kSizeCount; s++) {
+		size_t size = kSizes[s];
+		memset(bufferA, 'a', size);
+		memset(b, 'a', size);
+		bufferA[size - 1] = 'x';
+		b[size - 1] = 'b';
+		bufferA[size] = '\0';
+		b[size] = '\0';
+
+		if (!verify(bufferA, b, size))
+			return 1;
+
+		printf("%-8zu", size);
+		for (size_t i = 0; i < kTestCount; i++) {
+			size_t iterations = kBytesPerRun / size;
+			double start = current_time();
+			for (size_t j = 0; j < iterations; j++)
+				sSink += kTests[i].function(bufferA, b, size);
+			double elapsed = current_time() - start;
+
+			// GB/s
+			printf("%12.2f", iterations * size / elapsed / 1e9);
+		}
+		printf("\n");
+	}
+
+	printf("(GB/s%s)\n", misaligned ? ", misaligned" : "");
+
+	free(bufferA);
+	free(bufferB);
+	return 0;
+}
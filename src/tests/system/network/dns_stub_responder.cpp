@@ -0,0 +1,229 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	A minimal DNS server to test the cache of the dns_resolver_server against.
+	It answers every A query with the same address and TTL, except for names
+	that start with "nx", which get an NXDOMAIN answer. It prints each query
+	it receives, so that one can see which lookups the cache did not answer
+	itself. The -d option delays the answers, which makes it easier to see
+	concurrent identical lookups being merged.
+
+	Point the "nameserver" entry in /boot/system/settings/network/resolv.conf
+	to the address it listens on, and use the dnscache command to look up
+	names, and to watch the cache statistics.
+
+	It only uses POSIX APIs, so it can be built on other systems, too:
+		g++ -O2 -o dns_stub_responder dns_stub_responder.cpp
+*/
+
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+static const uint16_t kTypeA = 1;
+static const uint16_t kClassIN = 1;
+static const uint8_t kNameError = 3;
+
+static uint16_t sPort = 53;
+static uint32_t sTTL = 60;
+static in_addr sAddress;
+static int sDelay = 0;
+static uint64_t sQueries = 0;
+
+
+static uint16_t
+read16(const uint8_t* data)
+{
+	return (data[0] << 8) | data[1];
+}
+
+
+static void
+write16(uint8_t* data, uint16_t value)
+{
+	data[0] = value >> 8;
+	data[1] = value & 0xff;
+}
+
+
+static void
+write32(uint8_t* data, uint32_t value)
+{
+	write16(data, value >> 16);
+	write16(data + 2, value & 0xffff);
+}
+
+
+/*!	Parses the question name starting at \a offset into \a name, and returns
+	the offset following it, or -1 if the packet is malformed.
+*/
+static ssize_t
+parse_name(const uint8_t* packet, size_t size, size_t offset, char* name,
+	size_t nameSize)
+{
+	size_t length = 0;
+	while (offset < size) {
+		uint8_t labelLength = packet[offset++];
+		if (labelLength == 0) {
+			name[length] = '\0';
+			return offset;
+		}
+		if ((labelLength & 0xc0) != 0 || offset + labelLength > size
+			|| length + labelLength + 2 > nameSize)
+			return -1;
+
+		if (length > 0)
+			name[length++] = '.';
+		memcpy(name + length, packet + offset, labelLength);
+		length += labelLength;
+		offset += labelLength;
+	}
+
+	return -1;
+}
+
+
+/*!	Turns the query in \a packet into its answer, and returns the size of the
+	answer, or 0 if the query should be ignored.
+*/
+static size_t
+answer_query(uint8_t* packet, size_t size, size_t bufferSize)
+{
+	if (size < 12 || (packet[2] & 0x80) != 0 || read16(packet + 4) != 1)
+		return 0;
+
+	char name[256];
+	ssize_t offset = parse_name(packet, size, 12, name, sizeof(name));
+	if (offset < 0 || (size_t)offset + 4 > size)
+		return 0;
+
+	uint16_t type = read16(packet + offset);
+	uint16_t questionClass = read16(packet + offset + 2);
+	size_t questionEnd = offset + 4;
+
+	bool nameError = strncmp(name, "nx", 2) == 0;
+	bool answer = !nameError && type == kTypeA && questionClass == kClassIN;
+
+	sQueries++;
+	printf("%llu: %s query for %s (type %u)\n",
+		(unsigned long long)sQueries, nameError ? "negative"
+			: answer ? "positive" : "empty", name, type);
+	fflush(stdout);
+
+	// header: response, authoritative, copy recursion desired, recursion
+	// available
+	packet[2] = 0x84 | (packet[2] & 0x01);
+	packet[3] = 0x80 | (nameError ? kNameError : 0);
+	write16(packet + 6, answer ? 1 : 0);
+	write16(packet + 8, 0);
+	write16(packet + 10, 0);
+
+	if (!answer)
+		return questionEnd;
+	if (questionEnd + 16 > bufferSize)
+		return 0;
+
+	// the answer refers to the name in the question
+	uint8_t* record = packet + questionEnd;
+	write16(record, 0xc000 | 12);
+	write16(record + 2, kTypeA);
+	write16(record + 4, kClassIN);
+	write32(record + 6, sTTL);
+	write16(record + 10, sizeof(sAddress));
+	memcpy(record + 12, &sAddress, sizeof(sAddress));
+
+	return questionEnd + 16;
+}
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-p port] [-t ttl] [-a address] "
+		"[-d delay-ms]\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	inet_pton(AF_INET, "192.0.2.1", &sAddress);
+
+	int option;
+	while ((option = getopt(argc, argv, "p:t:a:d:")) != -1) {
+		switch (option) {
+			case 'p':
+				sPort = strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				sTTL = strtoul(optarg, NULL, 0);
+				break;
+			case 'a':
+				if (inet_pton(AF_INET, optarg, &sAddress) != 1)
+					usage(argv[0]);
+				break;
+			case 'd':
+				sDelay = atoi(optarg);
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	int socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+	if (socket < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(sPort);
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+	if (bind(socket, (sockaddr*)&address, sizeof(address)) != 0) {
+		perror("bind");
+		return 1;
+	}
+
+	printf("answering on port %u with TTL %u\n", sPort, sTTL);
+	fflush(stdout);
+
+	while (true) {
+		uint8_t packet[512];
+		sockaddr_in source;
+		socklen_t sourceLength = sizeof(source);
+		ssize_t size = recvfrom(socket, packet, sizeof(packet), 0,
+			(sockaddr*)&source, &sourceLength);
+		if (size < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("recvfrom");
+			return 1;
+		}
+
+		size_t answerSize = answer_query(packet, size, sizeof(packet));
+		if (answerSize == 0)
+			continue;
+
+		if (sDelay > 0)
+			usleep(sDelay * 1000);
+
+		sendto(socket, packet, answerSize, 0, (sockaddr*)&source,
+			sourceLength);
+	}
+
+	return 0;
+}
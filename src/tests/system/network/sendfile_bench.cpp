@@ -0,0 +1,296 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Compares the throughput of sending a file over a TCP connection with
+	sendfile() to reading it into a buffer, and sending that with write().
+	The file is created in the given directory, and read once before the
+	measurement, so that it is served from the file cache.
+
+	It can be built on Linux as well:
+		g++ -O2 -o sendfile_bench sendfile_bench.cpp -lpthread
+*/
+
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static const char* sAddress = "127.0.0.1";
+static const char* sDirectory = "/tmp";
+static double sDuration = 2.0;
+static size_t sFileSize = 16 * 1024 * 1024;
+static size_t sBufferSize = 64 * 1024;
+	// the buffer size of the copying method
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static void*
+receiver_thread(void* _socket)
+{
+	int socket = *(int*)_socket;
+
+	char* buffer = (char*)malloc(256 * 1024);
+	uint64_t* received = new uint64_t(0);
+	while (true) {
+		ssize_t bytesRead = read(socket, buffer, 256 * 1024);
+		if (bytesRead <= 0)
+			break;
+		*received += bytesRead;
+	}
+
+	free(buffer);
+	close(socket);
+	return received;
+}
+
+
+static int
+create_file(char* path, size_t pathSize)
+{
+	snprintf(path, pathSize, "%s/sendfile_bench.XXXXXX", sDirectory);
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		return -1;
+	}
+
+	char buffer[64 * 1024];
+	for (size_t i = 0; i < sizeof(buffer); i++)
+		buffer[i] = (char)i;
+
+	for (size_t size = 0; size < sFileSize; size += sizeof(buffer)) {
+		if (write(fd, buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer)) {
+			perror("write");
+			close(fd);
+			unlink(path);
+			return -1;
+		}
+	}
+
+	// bring the file into the cache
+	for (off_t offset = 0; offset < (off_t)sFileSize;
+			offset += sizeof(buffer)) {
+		pread(fd, buffer, sizeof(buffer), offset);
+	}
+
+	return fd;
+}
+
+
+static bool
+connect_sockets(int& sender, int& receiver)
+{
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0) {
+		perror("socket");
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = 0;
+	if (inet_pton(AF_INET, sAddress, &address.sin_addr) != 1) {
+		fprintf(stderr, "invalid address: %s\n", sAddress);
+		close(listener);
+		return false;
+	}
+
+	socklen_t length = sizeof(address);
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0
+		|| listen(listener, 1) != 0
+		|| getsockname(listener, (sockaddr*)&address, &length) != 0) {
+		perror("listen");
+		close(listener);
+		return false;
+	}
+
+	sender = socket(AF_INET, SOCK_STREAM, 0);
+	if (connect(sender, (sockaddr*)&address, sizeof(address)) != 0) {
+		perror("connect");
+		close(sender);
+		close(listener);
+		return false;
+	}
+
+	receiver = accept(listener, NULL, NULL);
+	close(listener);
+	if (receiver < 0) {
+		perror("accept");
+		close(sender);
+		return false;
+	}
+
+	return true;
+}
+
+
+static ssize_t
+send_with_sendfile(int socket, int fd)
+{
+	off_t offset = 0;
+	while (offset < (off_t)sFileSize) {
+		ssize_t bytesSent = sendfile(socket, fd, &offset, sFileSize - offset);
+		if (bytesSent <= 0) {
+			if (bytesSent < 0 && errno == EINTR)
+				continue;
+			return -1;
+		}
+	}
+
+	return offset;
+}
+
+
+static ssize_t
+send_with_copy(int socket, int fd, char* buffer)
+{
+	off_t offset = 0;
+	while (offset < (off_t)sFileSize) {
+		ssize_t bytesRead = pread(fd, buffer, sBufferSize, offset);
+		if (bytesRead <= 0)
+			return -1;
+
+		for (ssize_t written = 0; written < bytesRead;) {
+			ssize_t bytesWritten = write(socket, buffer + written,
+				bytesRead - written);
+			if (bytesWritten < 0) {
+				if (errno == EINTR)
+					continue;
+				return -1;
+			}
+			written += bytesWritten;
+		}
+
+		offset += bytesRead;
+	}
+
+	return offset;
+}
+
+
+static bool
+run(int fd, bool useSendfile)
+{
+	int sender;
+	int receiver;
+	if (!connect_sockets(sender, receiver))
+		return false;
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, receiver_thread, &receiver);
+
+	char* buffer = (char*)malloc(sBufferSize);
+
+	uint64_t sent = 0;
+	uint32_t files = 0;
+	double start = current_time();
+	double elapsed = 0;
+	do {
+		ssize_t bytesSent = useSendfile
+			? send_with_sendfile(sender, fd) : send_with_copy(sender, fd, buffer);
+		if (bytesSent < 0) {
+			perror(useSendfile ? "sendfile" : "write");
+			break;
+		}
+
+		sent += bytesSent;
+		files++;
+		elapsed = current_time() - start;
+	} while (elapsed < sDuration);
+
+	close(sender);
+
+	uint64_t* received;
+	pthread_join(thread, (void**)&received);
+	elapsed = current_time() - start;
+	free(buffer);
+
+	printf("%-9s %10.1f MB/s, %6u files\n",
+		useSendfile ? "sendfile:" : "copy:", *received / elapsed / 1000000,
+		(unsigned)files);
+
+	bool ok = *received == sent && sent > 0;
+	if (*received != sent) {
+		fprintf(stderr, "received %llu instead of %llu bytes\n",
+			(unsigned long long)*received, (unsigned long long)sent);
+	}
+
+	delete received;
+	return ok;
+}
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-a address] [-d seconds] [-s file-size] "
+		"[-b buffer-size] [-t directory]\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "a:d:s:b:t:")) != -1) {
+		switch (option) {
+			case 'a':
+				sAddress = optarg;
+				break;
+			case 'd':
+				sDuration = atof(optarg);
+				break;
+			case 's':
+				sFileSize = strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				sBufferSize = strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				sDirectory = optarg;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (sDuration <= 0 || sFileSize == 0 || sBufferSize == 0)
+		usage(argv[0]);
+
+	char path[PATH_MAX];
+	int fd = create_file(path, sizeof(path));
+	if (fd < 0)
+		return 1;
+
+	bool ok = run(fd, false);
+	ok &= run(fd, true);
+
+	close(fd);
+	unlink(path);
+
+	return ok ? 0 : 1;
+}
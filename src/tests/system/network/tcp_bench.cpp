@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures the bulk TCP throughput of a single connection, by default over
+	the loopback interface. The sending side writes buffers of the given
+	sizes as fast as it can, the receiving side only counts the bytes.
+
+	It only uses POSIX APIs, so it can be built on other systems, too:
+		g++ -O2 -o tcp_bench tcp_bench.cpp -lpthread
+*/
+
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static const char* sAddress = "127.0.0.1";
+static double sDuration = 2.0;
+static int sBufferSize = 0;
+	// socket buffer size, 0 keeps the default
+static bool sNoDelay = false;
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static void
+set_buffer_size(int socket)
+{
+	if (sBufferSize <= 0)
+		return;
+
+	setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &sBufferSize,
+		sizeof(sBufferSize));
+	setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &sBufferSize,
+		sizeof(sBufferSize));
+}
+
+
+static void*
+receiver_thread(void* _socket)
+{
+	int socket = *(int*)_socket;
+
+	char* buffer = (char*)malloc(256 * 1024);
+	uint64_t* received = new uint64_t(0);
+	while (true) {
+		ssize_t bytesRead = read(socket, buffer, 256 * 1024);
+		if (bytesRead <= 0)
+			break;
+		*received += bytesRead;
+	}
+
+	free(buffer);
+	close(socket);
+	return received;
+}
+
+
+static bool
+run(size_t writeSize)
+{
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0) {
+		perror("socket");
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = 0;
+	if (inet_pton(AF_INET, sAddress, &address.sin_addr) != 1) {
+		fprintf(stderr, "invalid address: %s\n", sAddress);
+		close(listener);
+		return false;
+	}
+
+	socklen_t length = sizeof(address);
+	set_buffer_size(listener);
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0
+		|| listen(listener, 1) != 0
+		|| getsockname(listener, (sockaddr*)&address, &length) != 0) {
+		perror("listen");
+		close(listener);
+		return false;
+	}
+
+	int sender = socket(AF_INET, SOCK_STREAM, 0);
+	set_buffer_size(sender);
+	if (sNoDelay) {
+		int value = 1;
+		setsockopt(sender, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+	}
+
+	if (connect(sender, (sockaddr*)&address, sizeof(address)) != 0) {
+		perror("connect");
+		close(sender);
+		close(listener);
+		return false;
+	}
+
+	int receiver = accept(listener, NULL, NULL);
+	close(listener);
+	if (receiver < 0) {
+		perror("accept");
+		close(sender);
+		return false;
+	}
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, receiver_thread, &receiver);
+
+	char* buffer = (char*)malloc(writeSize);
+	memset(buffer, 0x55, writeSize);
+
+	uint64_t sent = 0;
+	uint64_t writes = 0;
+	double start = current_time();
+	double elapsed = 0;
+	do {
+		ssize_t bytesWritten = write(sender, buffer, writeSize);
+		if (bytesWritten < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("write");
+			break;
+		}
+		sent += bytesWritten;
+		writes++;
+		elapsed = current_time() - start;
+	} while (elapsed < sDuration);
+
+	close(sender);
+
+	uint64_t* received;
+	pthread_join(thread, (void**)&received);
+	elapsed = current_time() - start;
+	free(buffer);
+
+	printf("%8zu bytes/write: %10.1f MB/s, %10.0f writes/s\n", writeSize,
+		*received / elapsed / 1000000, writes / elapsed);
+
+	bool ok = *received == sent;
+	if (!ok) {
+		fprintf(stderr, "received %llu instead of %llu bytes\n",
+			(unsigned long long)*received, (unsigned long long)sent);
+	}
+
+	delete received;
+	return ok;
+}
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-a address] [-d seconds] [-b buffer-size] "
+		"[-n] [write-size ...]\n"
+		"  -n  set TCP_NODELAY\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "a:d:b:n")) != -1) {
+		switch (option) {
+			case 'a':
+				sAddress = optarg;
+				break;
+			case 'd':
+				sDuration = atof(optarg);
+				break;
+			case 'b':
+				sBufferSize = atoi(optarg);
+				break;
+			case 'n':
+				sNoDelay = true;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (sDuration <= 0)
+		usage(argv[0]);
+
+	bool ok = true;
+	if (optind == argc) {
+		static const size_t kSizes[] = {1024, 16 * 1024, 64 * 1024,
+			256 * 1024};
+		for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); i++)
+			ok &= run(kSizes[i]);
+	}
+
+	for (int i = optind; i < argc; i++) {
+		size_t size = strtoul(argv[i], NULL, 0);
+		if (size == 0)
+			usage(argv[0]);
+		ok &= run(size);
+	}
+
+	return ok ? 0 : 1;
+}
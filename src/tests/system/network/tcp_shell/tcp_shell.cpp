@@ -30,6 +30,7 @@
 
 #include <ctype.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <new>
 #include <set>
 #include <stdio.h>
@@ -1529,6 +1530,40 @@ do_round_trip_time(int argc, char** argv)
 }
 
 
+static void
+do_congestion(int argc, char** argv)
+{
+	net_protocol* protocol = gClientSocket->first_protocol;
+
+	if (argc == 1) {
+		// show current algorithm
+		char name[TCP_CA_NAME_MAX];
+		int length = sizeof(name);
+		status_t status = gTCPModule->getsockopt(protocol, IPPROTO_TCP,
+			TCP_CONGESTION, name, &length);
+		if (status != B_OK) {
+			fprintf(stderr, "Could not get congestion control: %s\n",
+				strerror(status));
+			return;
+		}
+
+		printf("Congestion control is %s.\n", name);
+	} else if (argc == 2 && argv[1][0] != '-') {
+		status_t status = gTCPModule->setsockopt(protocol, IPPROTO_TCP,
+			TCP_CONGESTION, argv[1], strlen(argv[1]));
+		if (status != B_OK) {
+			fprintf(stderr, "Could not set congestion control \"%s\": %s\n",
+				argv[1], strerror(status));
+		}
+	} else {
+		// print usage
+		puts("usage: congestion [cubic|newreno]\n\n"
+			"Sets the congestion control algorithm of the client; without any\n"
+			"arguments, the current one is printed.");
+	}
+}
+
+
 static void
 do_dprintf(int argc, char** argv)
 {
@@ -1550,6 +1585,8 @@ static cmd_entry sBuiltinCommands[] = {
 	{"reorder", do_reorder, "Lets you reorder packets during transfer"},
 	{"help", do_help, "prints this help text"},
 	{"rtt", do_round_trip_time, "Specifies the round trip time"},
+	{"congestion", do_congestion,
+		"Selects the congestion control algorithm of the client"},
 	{"quit", NULL, "exits the application"},
 	{NULL, NULL, NULL},
 };
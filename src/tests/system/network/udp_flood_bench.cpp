@@ -0,0 +1,257 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Floods a UDP port over the loopback interface from several sender
+	threads, each using its own socket, and therefore its own flow. On the
+	receiving side, there is either one socket per receiver thread, all bound
+	to the same port with SO_REUSEPORT, or a single socket shared by all
+	receiver threads.
+
+	It only uses POSIX APIs, so it can be built on other systems, too:
+		g++ -O2 -o udp_flood_bench udp_flood_bench.cpp -lpthread
+*/
+
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static double sDuration = 2.0;
+static int sSenders = 4;
+static int sReceivers = 4;
+static size_t sDatagramSize = 64;
+static bool sReusePort = true;
+
+static volatile bool sQuit;
+
+
+struct receiver {
+	pthread_t	thread;
+	int			socket;
+	uint64_t	received;
+};
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static void*
+receiver_thread(void* _receiver)
+{
+	receiver* info = (receiver*)_receiver;
+
+	char buffer[65536];
+	while (!sQuit) {
+		ssize_t bytesRead = recv(info->socket, buffer, sizeof(buffer), 0);
+		if (bytesRead < 0) {
+			if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+				continue;
+			break;
+		}
+		info->received++;
+	}
+
+	return NULL;
+}
+
+
+static void*
+sender_thread(void* _address)
+{
+	const sockaddr_in* address = (const sockaddr_in*)_address;
+
+	int socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+	if (socket < 0) {
+		perror("socket");
+		return NULL;
+	}
+
+	char* buffer = (char*)calloc(1, sDatagramSize);
+	uint64_t* sent = new uint64_t(0);
+	while (!sQuit) {
+		if (sendto(socket, buffer, sDatagramSize, 0, (const sockaddr*)address,
+				sizeof(*address)) >= 0)
+			(*sent)++;
+	}
+
+	free(buffer);
+	close(socket);
+	return sent;
+}
+
+
+static int
+create_receiver_socket(sockaddr_in& address)
+{
+	int socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+	if (socket < 0) {
+		perror("socket");
+		return -1;
+	}
+
+	if (sReusePort) {
+		int value = 1;
+		if (setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &value,
+				sizeof(value)) != 0) {
+			perror("SO_REUSEPORT");
+			close(socket);
+			return -1;
+		}
+	}
+
+	// don't block forever, so that the receivers notice when to quit
+	struct timeval timeout = {0, 100000};
+	setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	socklen_t length = sizeof(address);
+	if (bind(socket, (sockaddr*)&address, sizeof(address)) != 0
+		|| getsockname(socket, (sockaddr*)&address, &length) != 0) {
+		perror("bind");
+		close(socket);
+		return -1;
+	}
+
+	return socket;
+}
+
+
+static bool
+run()
+{
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+
+	receiver* receivers = new receiver[sReceivers];
+	int sharedSocket = -1;
+	for (int i = 0; i < sReceivers; i++) {
+		if (sReusePort || i == 0) {
+			// the first bind chooses the port, the others follow it
+			receivers[i].socket = create_receiver_socket(address);
+			if (receivers[i].socket < 0)
+				return false;
+			if (i == 0)
+				sharedSocket = receivers[i].socket;
+		} else
+			receivers[i].socket = sharedSocket;
+		receivers[i].received = 0;
+	}
+
+	sQuit = false;
+	for (int i = 0; i < sReceivers; i++) {
+		pthread_create(&receivers[i].thread, NULL, receiver_thread,
+			&receivers[i]);
+	}
+
+	pthread_t* senders = new pthread_t[sSenders];
+	for (int i = 0; i < sSenders; i++)
+		pthread_create(&senders[i], NULL, sender_thread, &address);
+
+	double start = current_time();
+	usleep((useconds_t)(sDuration * 1000000));
+	sQuit = true;
+	double elapsed = current_time() - start;
+
+	uint64_t sent = 0;
+	for (int i = 0; i < sSenders; i++) {
+		uint64_t* count;
+		pthread_join(senders[i], (void**)&count);
+		if (count != NULL) {
+			sent += *count;
+			delete count;
+		}
+	}
+
+	uint64_t received = 0;
+	for (int i = 0; i < sReceivers; i++) {
+		pthread_join(receivers[i].thread, NULL);
+		received += receivers[i].received;
+	}
+
+	printf("%d senders, %d receivers%s: %10.0f datagrams/s received, "
+		"%10.0f sent\n", sSenders, sReceivers,
+		sReusePort ? " (SO_REUSEPORT)" : "", received / elapsed,
+		sent / elapsed);
+	if (sReceivers > 1) {
+		printf("  per receiver:");
+		for (int i = 0; i < sReceivers; i++) {
+			printf(" %.0f", received > 0
+				? receivers[i].received * 100.0 / received : 0.0);
+			printf(i < sReceivers - 1 ? "%%," : "%%\n");
+		}
+	}
+
+	for (int i = 0; i < sReceivers; i++) {
+		if (sReusePort || i == 0)
+			close(receivers[i].socket);
+	}
+
+	delete[] senders;
+	delete[] receivers;
+	return received > 0;
+}
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-d seconds] [-s senders] [-r receivers] "
+		"[-b datagram-size] [-n]\n"
+		"  -n  share one socket between all receivers instead of using "
+		"SO_REUSEPORT\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "d:s:r:b:n")) != -1) {
+		switch (option) {
+			case 'd':
+				sDuration = atof(optarg);
+				break;
+			case 's':
+				sSenders = atoi(optarg);
+				break;
+			case 'r':
+				sReceivers = atoi(optarg);
+				break;
+			case 'b':
+				sDatagramSize = strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				sReusePort = false;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (sDuration <= 0 || sSenders <= 0 || sReceivers <= 0
+		|| sDatagramSize == 0 || sDatagramSize > 65507)
+		usage(argv[0]);
+
+	return run() ? 0 : 1;
+}
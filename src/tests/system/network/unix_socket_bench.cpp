@@ -0,0 +1,265 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures the round trip latency, and the throughput of an AF_UNIX stream
+	socket pair between two teams. For the latency, small messages are sent
+	back and forth; for the throughput, one side writes buffers of the given
+	sizes as fast as it can, while the other side only counts the bytes.
+
+	It only uses POSIX APIs, so it can be built on other systems, too:
+		g++ -O2 -o unix_socket_bench unix_socket_bench.cpp
+*/
+
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static double sDuration = 2.0;
+static size_t sMessageSize = 1;
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static bool
+read_fully(int socket, void* _buffer, size_t size)
+{
+	uint8_t* buffer = (uint8_t*)_buffer;
+	while (size > 0) {
+		ssize_t bytesRead = read(socket, buffer, size);
+		if (bytesRead < 0 && errno == EINTR)
+			continue;
+		if (bytesRead <= 0)
+			return false;
+
+		buffer += bytesRead;
+		size -= bytesRead;
+	}
+
+	return true;
+}
+
+
+static bool
+write_fully(int socket, const void* _buffer, size_t size)
+{
+	const uint8_t* buffer = (const uint8_t*)_buffer;
+	while (size > 0) {
+		ssize_t bytesWritten = write(socket, buffer, size);
+		if (bytesWritten < 0 && errno == EINTR)
+			continue;
+		if (bytesWritten <= 0)
+			return false;
+
+		buffer += bytesWritten;
+		size -= bytesWritten;
+	}
+
+	return true;
+}
+
+
+static bool
+create_pair(int sockets[2])
+{
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+		perror("socketpair");
+		return false;
+	}
+
+	return true;
+}
+
+
+static bool
+run_ping_pong()
+{
+	int sockets[2];
+	if (!create_pair(sockets))
+		return false;
+
+	char* buffer = (char*)calloc(1, sMessageSize);
+
+	pid_t child = fork();
+	if (child < 0) {
+		perror("fork");
+		return false;
+	}
+
+	if (child == 0) {
+		// echo everything back
+		close(sockets[0]);
+		while (read_fully(sockets[1], buffer, sMessageSize)
+			&& write_fully(sockets[1], buffer, sMessageSize)) {
+		}
+		_exit(0);
+	}
+
+	close(sockets[1]);
+
+	uint64_t roundTrips = 0;
+	double start = current_time();
+	double elapsed = 0;
+	bool ok = true;
+	do {
+		if (!write_fully(sockets[0], buffer, sMessageSize)
+			|| !read_fully(sockets[0], buffer, sMessageSize)) {
+			perror("ping-pong");
+			ok = false;
+			break;
+		}
+
+		roundTrips++;
+		if ((roundTrips & 255) == 0)
+			elapsed = current_time() - start;
+	} while (elapsed < sDuration);
+
+	elapsed = current_time() - start;
+	close(sockets[0]);
+	waitpid(child, NULL, 0);
+	free(buffer);
+
+	printf("ping-pong %6zu bytes: %8.2f us/round trip, %10.0f round trips/s\n",
+		sMessageSize, elapsed * 1000000 / roundTrips, roundTrips / elapsed);
+	return ok;
+}
+
+
+static bool
+run_throughput(size_t writeSize)
+{
+	int sockets[2];
+	if (!create_pair(sockets))
+		return false;
+
+	pid_t child = fork();
+	if (child < 0) {
+		perror("fork");
+		return false;
+	}
+
+	if (child == 0) {
+		// count the bytes until the other side is done, and report them
+		close(sockets[0]);
+
+		char* buffer = (char*)malloc(1024 * 1024);
+		uint64_t received = 0;
+		while (true) {
+			ssize_t bytesRead = read(sockets[1], buffer, 1024 * 1024);
+			if (bytesRead < 0 && errno == EINTR)
+				continue;
+			if (bytesRead <= 0)
+				break;
+			received += bytesRead;
+		}
+
+		write_fully(sockets[1], &received, sizeof(received));
+		_exit(0);
+	}
+
+	close(sockets[1]);
+
+	char* buffer = (char*)malloc(writeSize);
+	memset(buffer, 0x55, writeSize);
+
+	uint64_t sent = 0;
+	double start = current_time();
+	double elapsed = 0;
+	do {
+		if (!write_fully(sockets[0], buffer, writeSize)) {
+			perror("write");
+			break;
+		}
+		sent += writeSize;
+		elapsed = current_time() - start;
+	} while (elapsed < sDuration);
+
+	shutdown(sockets[0], SHUT_WR);
+
+	uint64_t received = 0;
+	bool ok = read_fully(sockets[0], &received, sizeof(received));
+	elapsed = current_time() - start;
+
+	close(sockets[0]);
+	waitpid(child, NULL, 0);
+	free(buffer);
+
+	printf("throughput %8zu bytes/write: %10.1f MB/s\n", writeSize,
+		received / elapsed / 1000000);
+
+	if (!ok || received != sent) {
+		fprintf(stderr, "received %llu instead of %llu bytes\n",
+			(unsigned long long)received, (unsigned long long)sent);
+		return false;
+	}
+
+	return true;
+}
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [-d seconds] [-m message-size] "
+		"[write-size ...]\n", program);
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "d:m:")) != -1) {
+		switch (option) {
+			case 'd':
+				sDuration = atof(optarg);
+				break;
+			case 'm':
+				sMessageSize = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (sDuration <= 0 || sMessageSize == 0)
+		usage(argv[0]);
+
+	signal(SIGPIPE, SIG_IGN);
+
+	bool ok = run_ping_pong();
+
+	if (optind == argc) {
+		static const size_t kSizes[] = {1024, 16 * 1024, 64 * 1024,
+			256 * 1024, 1024 * 1024};
+		for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); i++)
+			ok &= run_throughput(kSizes[i]);
+	}
+
+	for (int i = optind; i < argc; i++) {
+		size_t size = strtoul(argv[i], NULL, 0);
+		if (size == 0)
+			usage(argv[0]);
+		ok &= run_throughput(size);
+	}
+
+	return ok ? 0 : 1;
+}